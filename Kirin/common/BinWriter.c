@@ -26,6 +26,6 @@ void BinWriter_WriteBytes(BinWriter* self, void* source, int64 size)
 		self->data = MRealloc(self->data, (size_t)self->dataLength);
 	}
 
-	MemCpy(self->data, source, (size_t)size);
+	MemCpy(self->data+self->length, source, (size_t)size);
 	self->length += size;
 }
@@ -0,0 +1,597 @@
+#include "common/Bvh.h"
+
+#include "common/Math.h"
+#include "common/Thread.h"
+
+#define Bvh_BinCount 16
+// cost of visiting a node relative to testing a primitive.
+#define Bvh_TraversalCost 1.0f
+// the parallel build splits this many levels at most on the calling thread before handing subtrees to the workers.
+#define Bvh_MaxTopLevelDepth 10
+#define Bvh_MaxTasks (1 << Bvh_MaxTopLevelDepth)
+#define Bvh_MaxTopLevelNodes (2*Bvh_MaxTasks)
+
+// nodes while building, the children are linked explicitly and flattened depth first at the end.
+typedef struct BuildNode
+{
+	Aabb bounds;
+	int32 left;
+	int32 right;
+	int32 start;
+	// 0 for inner nodes.
+	int32 count;
+} BuildNode;
+
+// a subtree left for the workers, its root node is already allocated.
+typedef struct BuildTask
+{
+	int32 nodeIndex;
+	int32 start;
+	int32 count;
+} BuildTask;
+
+typedef struct Builder
+{
+	const Aabb* bounds;
+	Vec3* centroids;
+	// partitioned in place, every node owns a contiguous range.
+	int32* indices;
+	BuildNode* nodes;
+	BuildTask* tasks;
+	int32 taskCount;
+	// ranges up to this size become tasks during the top level split.
+	int32 taskThreshold;
+	volatile int32 nextTask;
+} Builder;
+
+typedef struct Bin
+{
+	Aabb bounds;
+	int32 count;
+} Bin;
+
+// half the surface area, only ever compared.
+static float HalfArea(const Aabb* box)
+{
+	Vec3 size = Vec3_Sub(box->max, box->min);
+	return size.x*size.y+size.y*size.z+size.z*size.x;
+}
+
+static inline float GetAxis(const Vec3* v, int32 axis)
+{
+	return (&v->x)[axis];
+}
+
+static inline int32 GetBin(float centroid, float binMin, float binScale)
+{
+	int32 bin = (int32)((centroid-binMin)*binScale);
+	return bin < Bvh_BinCount-1 ? bin : Bvh_BinCount-1;
+}
+
+static void MakeLeaf(BuildNode* node, int32 start, int32 count)
+{
+	node->left = -1;
+	node->right = -1;
+	node->start = start;
+	node->count = count;
+}
+
+// fills node nodeIndex for indices [start, start+count) and builds its subtree, taking new nodes from *cursor.
+// during the top level split, small enough ranges are recorded as tasks instead of being built.
+static void BuildRange(Builder* b, int32 nodeIndex, int32 start, int32 count, int32* cursor, int32 depth, bool topLevel)
+{
+	if (topLevel && (count <= b->taskThreshold || depth >= Bvh_MaxTopLevelDepth))
+	{
+		b->tasks[b->taskCount++] = (BuildTask){ nodeIndex, start, count };
+		return;
+	}
+
+	const int32* indices = b->indices;
+	Aabb bounds = Aabb_empty;
+	Aabb centroidBounds = Aabb_empty;
+	for (int32 i = start; i < start+count; i++)
+	{
+		bounds = Aabb_Union(bounds, b->bounds[indices[i]]);
+		centroidBounds = Aabb_AddPoint(centroidBounds, b->centroids[indices[i]]);
+	}
+	BuildNode* node = &b->nodes[nodeIndex];
+	node->bounds = bounds;
+
+	if (count == 1)
+	{
+		MakeLeaf(node, start, count);
+		return;
+	}
+
+	// binned sah over all three axes.
+	int32 bestAxis = -1;
+	int32 bestBin = 0;
+	float bestCost = FloatMax;
+	float bestBinMin = 0;
+	float bestBinScale = 0;
+	for (int32 axis = 0; axis < 3; axis++)
+	{
+		float binMin = GetAxis(&centroidBounds.min, axis);
+		float extent = GetAxis(&centroidBounds.max, axis)-binMin;
+		if (extent <= 0)
+		{
+			continue;
+		}
+		float binScale = Bvh_BinCount/extent;
+
+		Bin bins[Bvh_BinCount];
+		for (int32 i = 0; i < Bvh_BinCount; i++)
+		{
+			bins[i].bounds = Aabb_empty;
+			bins[i].count = 0;
+		}
+		for (int32 i = start; i < start+count; i++)
+		{
+			int32 bin = GetBin(GetAxis(&b->centroids[indices[i]], axis), binMin, binScale);
+			bins[bin].bounds = Aabb_Union(bins[bin].bounds, b->bounds[indices[i]]);
+			bins[bin].count++;
+		}
+
+		// rightCosts[i] is for splitting after bin i.
+		float rightCosts[Bvh_BinCount-1];
+		Aabb rightBounds = Aabb_empty;
+		int32 rightCount = 0;
+		for (int32 i = Bvh_BinCount-1; i > 0; i--)
+		{
+			rightBounds = Aabb_Union(rightBounds, bins[i].bounds);
+			rightCount += bins[i].count;
+			rightCosts[i-1] = rightCount > 0 ? HalfArea(&rightBounds)*rightCount : FloatMax;
+		}
+
+		Aabb leftBounds = Aabb_empty;
+		int32 leftCount = 0;
+		for (int32 i = 0; i < Bvh_BinCount-1; i++)
+		{
+			leftBounds = Aabb_Union(leftBounds, bins[i].bounds);
+			leftCount += bins[i].count;
+			if (leftCount == 0 || leftCount == count)
+			{
+				continue;
+			}
+			float cost = HalfArea(&leftBounds)*leftCount+rightCosts[i];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = i;
+				bestBinMin = binMin;
+				bestBinScale = binScale;
+			}
+		}
+	}
+
+	int32 leftCount;
+	if (bestAxis < 0)
+	{
+		// all centroids in the same spot, nothing to choose between.
+		if (count <= Bvh_MaxLeafSize)
+		{
+			MakeLeaf(node, start, count);
+			return;
+		}
+		leftCount = count/2;
+	}
+	else
+	{
+		float parentArea = HalfArea(&bounds);
+		float splitCost = parentArea > 0 ? Bvh_TraversalCost+bestCost/parentArea : Bvh_TraversalCost;
+		if (count <= Bvh_MaxLeafSize && count <= splitCost)
+		{
+			MakeLeaf(node, start, count);
+			return;
+		}
+
+		int32* first = b->indices+start;
+		int32* last = first+count-1;
+		while (first <= last)
+		{
+			if (GetBin(GetAxis(&b->centroids[*first], bestAxis), bestBinMin, bestBinScale) <= bestBin)
+			{
+				first++;
+			}
+			else
+			{
+				int32 temp = *first;
+				*first = *last;
+				*last = temp;
+				last--;
+			}
+		}
+		leftCount = (int32)(first-(b->indices+start));
+	}
+
+	int32 left = (*cursor)++;
+	int32 right = (*cursor)++;
+	// the nodes array never moves, but the recursion below writes to it, so no pointers into it past here.
+	node->left = left;
+	node->right = right;
+	node->start = start;
+	node->count = 0;
+	BuildRange(b, left, start, leftCount, cursor, depth+1, topLevel);
+	BuildRange(b, right, start+leftCount, count-leftCount, cursor, depth+1, topLevel);
+}
+
+static void BuildWorker(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	Unused(start);
+	Unused(count);
+	Unused(chunkIndex);
+	// tasks are taken one by one, biggest first, since the sah splits rarely leave them the same size.
+	Builder* b = (Builder*)userData;
+	for (;;)
+	{
+		int32 taskIndex = Atomic_Increment32(&b->nextTask)-1;
+		if (taskIndex >= b->taskCount)
+		{
+			break;
+		}
+		const BuildTask* task = &b->tasks[taskIndex];
+		// a subtree over n primitives has at most 2n-1 nodes. its root is already allocated, the rest fit in the task's own 2n slots.
+		int32 cursor = 2*task->start;
+		BuildRange(b, task->nodeIndex, task->start, task->count, &cursor, 0, false);
+	}
+}
+
+static void Flatten(const BuildNode* buildNodes, int32 index, BvhNode* nodes, int32* nodeCount)
+{
+	const BuildNode* buildNode = &buildNodes[index];
+	BvhNode* node = &nodes[(*nodeCount)++];
+	node->bounds = buildNode->bounds;
+	if (buildNode->count > 0)
+	{
+		node->skipOrFirst = buildNode->start;
+		node->primitiveCount = buildNode->count;
+	}
+	else
+	{
+		Flatten(buildNodes, buildNode->left, nodes, nodeCount);
+		Flatten(buildNodes, buildNode->right, nodes, nodeCount);
+		node->skipOrFirst = *nodeCount;
+		node->primitiveCount = 0;
+	}
+}
+
+void Bvh_Build(Bvh* self, const Aabb* bounds, int32 count, int32 threadCount)
+{
+	*self = (Bvh){ 0 };
+	if (count <= 0)
+	{
+		return;
+	}
+
+	Builder b = { 0 };
+	b.bounds = bounds;
+	b.centroids = MAlloc(count*sizeof(Vec3));
+	b.indices = MAlloc(count*sizeof(int32));
+	for (int32 i = 0; i < count; i++)
+	{
+		b.centroids[i] = Aabb_GetCenter(bounds[i]);
+		b.indices[i] = i;
+	}
+
+	if (threadCount <= 0)
+	{
+		threadCount = Thread_GetHardwareThreadCount();
+	}
+
+	int32 root;
+	if (threadCount > 1 && count >= Bvh_MinPrimitivesForParallelBuild)
+	{
+		// the top level nodes go after the 2n slots the tasks allocate from.
+		b.nodes = MAlloc((2*(size_t)count+Bvh_MaxTopLevelNodes)*sizeof(BuildNode));
+		b.tasks = MAlloc(Bvh_MaxTasks*sizeof(BuildTask));
+		b.taskThreshold = MaxI(count/(threadCount*8), 4096);
+		root = 2*count;
+		int32 cursor = root+1;
+		BuildRange(&b, root, 0, count, &cursor, 0, true);
+
+		for (int32 i = 1; i < b.taskCount; i++)
+		{
+			BuildTask task = b.tasks[i];
+			int32 j = i;
+			for (; j > 0 && b.tasks[j-1].count < task.count; j--)
+			{
+				b.tasks[j] = b.tasks[j-1];
+			}
+			b.tasks[j] = task;
+		}
+		Thread_ParallelFor(threadCount, threadCount, 1, 1, BuildWorker, &b);
+		MFree(b.tasks);
+	}
+	else
+	{
+		b.nodes = MAlloc((2*(size_t)count-1)*sizeof(BuildNode));
+		root = 0;
+		int32 cursor = 1;
+		BuildRange(&b, root, 0, count, &cursor, 0, false);
+	}
+
+	self->nodes = MAlloc((2*(size_t)count-1)*sizeof(BvhNode));
+	Flatten(b.nodes, root, self->nodes, &self->nodeCount);
+	self->nodes = MRealloc(self->nodes, self->nodeCount*sizeof(BvhNode));
+
+	self->primitives = b.indices;
+	self->primitiveCount = count;
+	self->primitiveBounds = MAlloc(count*sizeof(Aabb));
+	for (int32 i = 0; i < count; i++)
+	{
+		self->primitiveBounds[i] = bounds[self->primitives[i]];
+	}
+
+	MFree(b.nodes);
+	MFree(b.centroids);
+}
+
+void Bvh_Free(Bvh* self)
+{
+	if (self->nodes)
+	{
+		MFree(self->nodes);
+		MFree(self->primitives);
+		MFree(self->primitiveBounds);
+	}
+	*self = (Bvh){ 0 };
+}
+
+void Bvh_Refit(Bvh* self, const Aabb* bounds)
+{
+	for (int32 i = 0; i < self->primitiveCount; i++)
+	{
+		self->primitiveBounds[i] = bounds[self->primitives[i]];
+	}
+
+	// children always come after their parent, so going backwards visits them first.
+	for (int32 i = self->nodeCount-1; i >= 0; i--)
+	{
+		BvhNode* node = &self->nodes[i];
+		if (node->primitiveCount > 0)
+		{
+			Aabb nodeBounds = Aabb_empty;
+			for (int32 p = node->skipOrFirst; p < node->skipOrFirst+node->primitiveCount; p++)
+			{
+				nodeBounds = Aabb_Union(nodeBounds, self->primitiveBounds[p]);
+			}
+			node->bounds = nodeBounds;
+		}
+		else
+		{
+			const BvhNode* left = &self->nodes[i+1];
+			const BvhNode* right = &self->nodes[left->primitiveCount > 0 ? i+2 : left->skipOrFirst];
+			node->bounds = Aabb_Union(left->bounds, right->bounds);
+		}
+	}
+}
+
+// narrows [entry, exit] to where the ray is between one pair of planes. the near plane is picked from the direction's
+// sign rather than by comparing the two distances, because with a 0 direction component a ray starting exactly on a
+// plane computes 0*inf = nan. comparisons with nan are false, so the selects keep the range that plane would have
+// narrowed, and the ray touches the box like it does elsewhere in this file.
+static inline void ClipRayToSlab(float min, float max, float origin, float invDir, float* entry, float* exit)
+{
+	float nearDist = ((invDir < 0 ? max : min)-origin)*invDir;
+	float farDist = ((invDir < 0 ? min : max)-origin)*invDir;
+	*entry = nearDist > *entry ? nearDist : *entry;
+	*exit = farDist < *exit ? farDist : *exit;
+}
+
+// slab test. outEntry is where the ray enters the box, clamped to 0 when it starts inside.
+static inline bool RayHitsAabb(const Aabb* box, const Vec3 origin, const Vec3 invDir, float maxDist, float* outEntry)
+{
+	float entry = 0;
+	float exit = maxDist;
+	ClipRayToSlab(box->min.x, box->max.x, origin.x, invDir.x, &entry, &exit);
+	ClipRayToSlab(box->min.y, box->max.y, origin.y, invDir.y, &entry, &exit);
+	ClipRayToSlab(box->min.z, box->max.z, origin.z, invDir.z, &entry, &exit);
+	*outEntry = entry;
+	return entry <= exit;
+}
+
+static inline bool RayHitsPrimitive(const Bvh* self, int32 index, const Vec3 origin, const Vec3 dir, const Vec3 invDir, float maxDist, BvhRayFunction function, void* userData, float* outDist)
+{
+	if (function)
+	{
+		return function(userData, self->primitives[index], origin, dir, maxDist, outDist);
+	}
+	return RayHitsAabb(&self->primitiveBounds[index], origin, invDir, maxDist, outDist) && *outDist < maxDist;
+}
+
+// both ray casts walk the nodes in order without a stack: a hit goes to the next node, which is the first child for inner nodes,
+// and a miss skips the subtree.
+bool Bvh_RayCastClosest(const Bvh* self, const Vec3 origin, const Vec3 dir, float maxDist, BvhRayFunction function, void* userData, BvhHit* outHit)
+{
+	Vec3 invDir = Vec3_New(1.0f/dir.x, 1.0f/dir.y, 1.0f/dir.z);
+	BvhHit best = { -1, maxDist };
+	int32 i = 0;
+	while (i < self->nodeCount)
+	{
+		const BvhNode* node = &self->nodes[i];
+		float entry;
+		if (!RayHitsAabb(&node->bounds, origin, invDir, best.dist, &entry))
+		{
+			i = node->primitiveCount > 0 ? i+1 : node->skipOrFirst;
+			continue;
+		}
+
+		for (int32 p = node->skipOrFirst; p < node->skipOrFirst+node->primitiveCount; p++)
+		{
+			float dist;
+			if (RayHitsPrimitive(self, p, origin, dir, invDir, best.dist, function, userData, &dist))
+			{
+				best.primitive = self->primitives[p];
+				best.dist = dist;
+			}
+		}
+		i++;
+	}
+
+	if (best.primitive < 0)
+	{
+		return false;
+	}
+	*outHit = best;
+	return true;
+}
+
+bool Bvh_RayCastAny(const Bvh* self, const Vec3 origin, const Vec3 dir, float maxDist, BvhRayFunction function, void* userData)
+{
+	Vec3 invDir = Vec3_New(1.0f/dir.x, 1.0f/dir.y, 1.0f/dir.z);
+	int32 i = 0;
+	while (i < self->nodeCount)
+	{
+		const BvhNode* node = &self->nodes[i];
+		float entry;
+		if (!RayHitsAabb(&node->bounds, origin, invDir, maxDist, &entry))
+		{
+			i = node->primitiveCount > 0 ? i+1 : node->skipOrFirst;
+			continue;
+		}
+
+		for (int32 p = node->skipOrFirst; p < node->skipOrFirst+node->primitiveCount; p++)
+		{
+			float dist;
+			if (RayHitsPrimitive(self, p, origin, dir, invDir, maxDist, function, userData, &dist))
+			{
+				return true;
+			}
+		}
+		i++;
+	}
+	return false;
+}
+
+int32 Bvh_OverlapAabb(const Bvh* self, const Aabb box, int32* outPrimitives, int32 capacity)
+{
+	int32 count = 0;
+	int32 i = 0;
+	while (i < self->nodeCount)
+	{
+		const BvhNode* node = &self->nodes[i];
+		if (!Aabb_Overlaps(node->bounds, box))
+		{
+			i = node->primitiveCount > 0 ? i+1 : node->skipOrFirst;
+			continue;
+		}
+
+		for (int32 p = node->skipOrFirst; p < node->skipOrFirst+node->primitiveCount; p++)
+		{
+			if (Aabb_Overlaps(self->primitiveBounds[p], box))
+			{
+				if (count < capacity)
+				{
+					outPrimitives[count] = self->primitives[p];
+				}
+				count++;
+			}
+		}
+		i++;
+	}
+	return count;
+}
+
+static inline bool SphereOverlapsAabb(const Aabb* box, const Vec3 center, float sqrRadius)
+{
+	float dx = Max(Max(box->min.x-center.x, center.x-box->max.x), 0);
+	float dy = Max(Max(box->min.y-center.y, center.y-box->max.y), 0);
+	float dz = Max(Max(box->min.z-center.z, center.z-box->max.z), 0);
+	return dx*dx+dy*dy+dz*dz <= sqrRadius;
+}
+
+int32 Bvh_OverlapSphere(const Bvh* self, const Vec3 center, float radius, int32* outPrimitives, int32 capacity)
+{
+	float sqrRadius = radius*radius;
+	int32 count = 0;
+	int32 i = 0;
+	while (i < self->nodeCount)
+	{
+		const BvhNode* node = &self->nodes[i];
+		if (!SphereOverlapsAabb(&node->bounds, center, sqrRadius))
+		{
+			i = node->primitiveCount > 0 ? i+1 : node->skipOrFirst;
+			continue;
+		}
+
+		for (int32 p = node->skipOrFirst; p < node->skipOrFirst+node->primitiveCount; p++)
+		{
+			if (SphereOverlapsAabb(&self->primitiveBounds[p], center, sqrRadius))
+			{
+				if (count < capacity)
+				{
+					outPrimitives[count] = self->primitives[p];
+				}
+				count++;
+			}
+		}
+		i++;
+	}
+	return count;
+}
+
+static inline void GetTriangle(const BvhTriangles* self, int32 triangle, Vec3* outV0, Vec3* outV1, Vec3* outV2)
+{
+	if (self->indices)
+	{
+		const int32* indices = self->indices+triangle*3;
+		*outV0 = self->vertices[indices[0]];
+		*outV1 = self->vertices[indices[1]];
+		*outV2 = self->vertices[indices[2]];
+	}
+	else
+	{
+		*outV0 = self->vertices[triangle*3];
+		*outV1 = self->vertices[triangle*3+1];
+		*outV2 = self->vertices[triangle*3+2];
+	}
+}
+
+void BvhTriangles_GetBounds(const BvhTriangles* self, int32 triangleCount, Aabb* outBounds)
+{
+	for (int32 i = 0; i < triangleCount; i++)
+	{
+		Vec3 v0, v1, v2;
+		GetTriangle(self, i, &v0, &v1, &v2);
+		Aabb bounds = { v0, v0 };
+		bounds = Aabb_AddPoint(bounds, v1);
+		outBounds[i] = Aabb_AddPoint(bounds, v2);
+	}
+}
+
+bool BvhTriangles_RayHit(void* userData, int32 primitive, const Vec3 origin, const Vec3 dir, float maxDist, float* outDist)
+{
+	// moller trumbore.
+	Vec3 v0, v1, v2;
+	GetTriangle((const BvhTriangles*)userData, primitive, &v0, &v1, &v2);
+	Vec3 edge0 = Vec3_Sub(v1, v0);
+	Vec3 edge1 = Vec3_Sub(v2, v0);
+	Vec3 p = Vec3_Cross(dir, edge1);
+	float det = Vec3_Dot(edge0, p);
+	if (det == 0)
+	{
+		return false;
+	}
+
+	float invDet = 1.0f/det;
+	Vec3 t = Vec3_Sub(origin, v0);
+	float u = Vec3_Dot(t, p)*invDet;
+	if (u < 0 || u > 1)
+	{
+		return false;
+	}
+	Vec3 q = Vec3_Cross(t, edge0);
+	float v = Vec3_Dot(dir, q)*invDet;
+	if (v < 0 || u+v > 1)
+	{
+		return false;
+	}
+	float dist = Vec3_Dot(edge1, q)*invDet;
+	if (dist < 0 || dist >= maxDist)
+	{
+		return false;
+	}
+	*outDist = dist;
+	return true;
+}
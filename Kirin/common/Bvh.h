@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Space.h"
+
+// nodes are stored depth first. an inner node's first child directly follows it, the second child follows the first child's subtree.
+typedef struct BvhNode
+{
+	Aabb bounds;
+	// inner nodes: index of the node after this subtree, where traversal continues when the bounds are missed.
+	// leaves: index of the first primitive in Bvh.primitives.
+	int32 skipOrFirst;
+	// 0 for inner nodes.
+	int32 primitiveCount;
+} BvhNode;
+
+typedef struct Bvh
+{
+	BvhNode* nodes;
+	int32 nodeCount;
+	// primitive indices in leaf order, with their bounds in the same order.
+	int32* primitives;
+	Aabb* primitiveBounds;
+	int32 primitiveCount;
+} Bvh;
+
+typedef struct BvhHit
+{
+	int32 primitive;
+	float dist;
+} BvhHit;
+
+// exact test of a ray against a primitive. returns whether it hits closer than maxDist, and the distance along dir.
+// with a null function the queries hit the primitive bounds instead.
+typedef bool (*BvhRayFunction)(void* userData, int32 primitive, const Vec3 origin, const Vec3 dir, float maxDist, float* outDist);
+
+// a triangle soup or indexed mesh for the ray functions. 3 indices per triangle, indices can be null for unindexed vertices.
+typedef struct BvhTriangles
+{
+	const Vec3* vertices;
+	const int32* indices;
+} BvhTriangles;
+
+#define Bvh_MaxLeafSize 8
+// inputs smaller than this are built on the calling thread.
+#define Bvh_MinPrimitivesForParallelBuild (64*1024)
+
+// binned surface area heuristic build over the primitives' bounds. threadCount <= 0 uses every hardware thread.
+void Bvh_Build(Bvh* self, const Aabb* bounds, int32 count, int32 threadCount);
+void Bvh_Free(Bvh* self);
+// updates the bounds after the primitives moved, keeping the tree. bounds is indexed like the array given to Bvh_Build.
+// the tree gets worse as primitives move away from where they were built, rebuild once they have moved a lot.
+void Bvh_Refit(Bvh* self, const Aabb* bounds);
+
+// dir doesn't have to be normalized, distances are in multiples of it.
+bool Bvh_RayCastClosest(const Bvh* self, const Vec3 origin, const Vec3 dir, float maxDist, BvhRayFunction function, void* userData, BvhHit* outHit);
+// stops at the first hit found, which isn't necessarily the closest. for line of sight checks.
+bool Bvh_RayCastAny(const Bvh* self, const Vec3 origin, const Vec3 dir, float maxDist, BvhRayFunction function, void* userData);
+// writes up to capacity primitives whose bounds overlap the query to outPrimitives. returns how many overlap in total, which can be more than capacity.
+int32 Bvh_OverlapAabb(const Bvh* self, const Aabb box, int32* outPrimitives, int32 capacity);
+int32 Bvh_OverlapSphere(const Bvh* self, const Vec3 center, float radius, int32* outPrimitives, int32 capacity);
+
+void BvhTriangles_GetBounds(const BvhTriangles* self, int32 triangleCount, Aabb* outBounds);
+// BvhRayFunction for a BvhTriangles passed as userData. both sides of a triangle are hit.
+bool BvhTriangles_RayHit(void* userData, int32 primitive, const Vec3 origin, const Vec3 dir, float maxDist, float* outDist);
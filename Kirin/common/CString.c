@@ -4,6 +4,8 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <wchar.h>
+#include <wctype.h>
 
 int64 StrLen(const char* a)
 {
@@ -24,8 +24,12 @@
 #define PLATFORM_WINDOWS 0
 #endif
 
-#if PLATFORM_WINDOWS != 1
-#error exactly one of the following must be defined: PLATFORM_WINDOWS
+#ifndef PLATFORM_LINUX
+#define PLATFORM_LINUX 0
+#endif
+
+#if PLATFORM_WINDOWS+PLATFORM_LINUX != 1
+#error exactly one of the following must be defined: PLATFORM_WINDOWS, PLATFORM_LINUX
 #endif
 
 #if PLATFORM_WINDOWS
@@ -38,8 +42,51 @@
 #endif
 #endif
 
-#if _WIN64
+#if PLATFORM_LINUX
+// exposes sched_setaffinity, CPU_SET and friends. must be defined before any system header.
+#define _GNU_SOURCE 1
+#endif
+
+#if _WIN64 || __x86_64__ || __aarch64__
 #define BITNESS_64 1
 #else
 #define BITNESS_32 1
 #endif
+
+#if _M_X64 || _M_IX86 || __x86_64__ || __i386__
+#define ARCH_X86 1
+#else
+#define ARCH_X86 0
+#endif
+
+// simd paths are picked at compile time from the target cpu flags (/arch on msvc, -m or -march on gcc and clang).
+// define SIMD_DISABLE to 1 to force the scalar reference paths.
+#ifndef SIMD_DISABLE
+#define SIMD_DISABLE 0
+#endif
+
+#if ARCH_X86 && !SIMD_DISABLE && (_M_X64 || _M_IX86_FP >= 2 || __SSE2__)
+#define SIMD_SSE2 1
+#else
+#define SIMD_SSE2 0
+#endif
+
+#if SIMD_SSE2 && __AVX__
+#define SIMD_AVX 1
+#else
+#define SIMD_AVX 0
+#endif
+
+// 256 bit integer ops, for the kernels that need them on 8 lanes.
+#if SIMD_AVX && __AVX2__
+#define SIMD_AVX2 1
+#else
+#define SIMD_AVX2 0
+#endif
+
+// msvc has no fma flag, /arch:AVX2 implies it.
+#if SIMD_AVX && (__FMA__ || (PLATFORM_WINDOWS && __AVX2__))
+#define SIMD_FMA 1
+#else
+#define SIMD_FMA 0
+#endif
@@ -0,0 +1,804 @@
+#include "common/FastMath.h"
+
+#include "common/Math.h"
+
+// the polynomials are the cephes single precision ones.
+
+// pi/2 split in three for the cody waite reduction, the first two have few enough bits that multiples of them stay exact.
+#define FastMath_HalfPi0 1.5703125f
+#define FastMath_HalfPi1 4.837512969970703125e-4f
+#define FastMath_HalfPi2 7.54978995489188216e-8f
+#define FastMath_TwoOverPi 0.636619772367581343f
+
+#define FastMath_Sin0 -1.6666654611e-1f
+#define FastMath_Sin1 8.3321608736e-3f
+#define FastMath_Sin2 -1.9515295891e-4f
+#define FastMath_Cos0 4.166664568298827e-2f
+#define FastMath_Cos1 -1.388731625493765e-3f
+#define FastMath_Cos2 2.443315711809948e-5f
+
+#define FastMath_TanPi8 0.4142135623730950f
+#define FastMath_Tan3Pi8 2.414213562373095f
+#define FastMath_Atan0 8.05374449538e-2f
+#define FastMath_Atan1 -1.38776856032e-1f
+#define FastMath_Atan2 1.99777106478e-1f
+#define FastMath_Atan3 -3.33329491539e-1f
+
+// exp is clamped to where the result over or underflows anyway.
+#define FastMath_ExpMax 89.0f
+#define FastMath_ExpMin -104.0f
+#define FastMath_Log2E 1.44269504088896341f
+// ln 2 split in two like pi/2 above.
+#define FastMath_Ln2Hi 0.693359375f
+#define FastMath_Ln2Lo -2.12194440e-4f
+#define FastMath_Exp0 1.9875691500e-4f
+#define FastMath_Exp1 1.3981999507e-3f
+#define FastMath_Exp2 8.3334519073e-3f
+#define FastMath_Exp3 4.1665795894e-2f
+#define FastMath_Exp4 1.6666665459e-1f
+#define FastMath_Exp5 5.0000001201e-1f
+
+// 2^23.
+#define FastMath_DenormalScale 8388608.0f
+#define FastMath_SqrtHalf 0.707106781186547524f
+#define FastMath_Log0 7.0376836292e-2f
+#define FastMath_Log1 -1.1514610310e-1f
+#define FastMath_Log2 1.1676998740e-1f
+#define FastMath_Log3 -1.2420140846e-1f
+#define FastMath_Log4 1.4249322787e-1f
+#define FastMath_Log5 -1.6668057665e-1f
+#define FastMath_Log6 2.0000714765e-1f
+#define FastMath_Log7 -2.4999993993e-1f
+#define FastMath_Log8 3.3333331174e-1f
+
+typedef union FloatBits
+{
+	float f;
+	uint32 u;
+	int32 i;
+} FloatBits;
+
+static inline float FloatFromBits(uint32 bits)
+{
+	FloatBits result;
+	result.u = bits;
+	return result.f;
+}
+
+static inline uint32 BitsFromFloat(float v)
+{
+	FloatBits result;
+	result.f = v;
+	return result.u;
+}
+
+float FastSin(float v)
+{
+	float result, unused;
+	FastSinCos(v, &result, &unused);
+	return result;
+}
+
+float FastCos(float v)
+{
+	float unused, result;
+	FastSinCos(v, &unused, &result);
+	return result;
+}
+
+void FastSinCos(float v, float* outSin, float* outCos)
+{
+	// reduce to r in [-pi/4, pi/4] with v = r + j*pi/2, the low bits of j pick the quadrant.
+	float quadrants = v*FastMath_TwoOverPi;
+	int32 j = (int32)(quadrants+(quadrants >= 0 ? 0.5f : -0.5f));
+	float fj = (float)j;
+	float r = ((v-fj*FastMath_HalfPi0)-fj*FastMath_HalfPi1)-fj*FastMath_HalfPi2;
+	float z = r*r;
+
+	float s = r+r*z*(FastMath_Sin0+z*(FastMath_Sin1+z*FastMath_Sin2));
+	float c = 1.0f-0.5f*z+z*z*(FastMath_Cos0+z*(FastMath_Cos1+z*FastMath_Cos2));
+	if (j & 1)
+	{
+		float temp = s;
+		s = c;
+		c = temp;
+	}
+	*outSin = (j & 2) ? -s : s;
+	*outCos = ((j+1) & 2) ? -c : c;
+}
+
+float FastTan(float v)
+{
+	float s, c;
+	FastSinCos(v, &s, &c);
+	return s/c;
+}
+
+float FastAtan(float v)
+{
+	// atan(x) = pi/2+atan(-1/x) = pi/4+atan((x-1)/(x+1)) brings x into [0, tan(pi/8)].
+	float x = Abs(v);
+	float offset = 0;
+	if (x > FastMath_Tan3Pi8)
+	{
+		offset = PI32*0.5f;
+		x = -1.0f/x;
+	}
+	else if (x > FastMath_TanPi8)
+	{
+		offset = PI32*0.25f;
+		x = (x-1.0f)/(x+1.0f);
+	}
+	float z = x*x;
+	float result = offset+(((FastMath_Atan0*z+FastMath_Atan1)*z+FastMath_Atan2)*z+FastMath_Atan3)*z*x+x;
+	return v < 0 ? -result : result;
+}
+
+float FastAtan2(float y, float x)
+{
+	float ratio = (x == 0 && y == 0) ? 0 : y/x;
+	float result = FastAtan(ratio);
+	if (x < 0)
+	{
+		result += (BitsFromFloat(y) & 0x80000000) ? -PI32 : PI32;
+	}
+	return result;
+}
+
+float FastExp(float v)
+{
+	// e^v = 2^n*e^r with r in [-ln2/2, ln2/2]. 2^n is applied in two halves so denormal results come out right.
+	float x = Min(FastMath_ExpMax, Max(FastMath_ExpMin, v));
+	float n = x*FastMath_Log2E;
+	int32 ni = (int32)(n+(n >= 0 ? 0.5f : -0.5f));
+	float fn = (float)ni;
+	float r = (x-fn*FastMath_Ln2Hi)-fn*FastMath_Ln2Lo;
+	float p = ((((FastMath_Exp0*r+FastMath_Exp1)*r+FastMath_Exp2)*r+FastMath_Exp3)*r+FastMath_Exp4)*r+FastMath_Exp5;
+	float e = p*r*r+r+1.0f;
+	int32 half = ni >> 1;
+	float scale0 = FloatFromBits((uint32)(half+127) << 23);
+	float scale1 = FloatFromBits((uint32)(ni-half+127) << 23);
+	return e*scale0*scale1;
+}
+
+float FastLog(float v)
+{
+	if (!(v > 0))
+	{
+		return v == 0 ? FloatNegInfinity : FloatFromBits(0x7fc00000);
+	}
+	if (v == FloatInfinity)
+	{
+		return v;
+	}
+
+	// denormals are scaled into the normal range first.
+	float denormalExponent = 0;
+	if (v < FloatMin)
+	{
+		v *= FastMath_DenormalScale;
+		denormalExponent = 23.0f;
+	}
+
+	// v = m*2^e with m in [sqrt(0.5), sqrt(2)), then log(v) = log(m)+e*ln2.
+	uint32 bits = BitsFromFloat(v);
+	float e = (float)((int32)(bits >> 23)-126)-denormalExponent;
+	float m = FloatFromBits((bits & 0x007fffff) | 0x3f000000);
+	if (m < FastMath_SqrtHalf)
+	{
+		e -= 1.0f;
+		m += m;
+	}
+	float x = m-1.0f;
+	float z = x*x;
+	float p = FastMath_Log0;
+	p = p*x+FastMath_Log1;
+	p = p*x+FastMath_Log2;
+	p = p*x+FastMath_Log3;
+	p = p*x+FastMath_Log4;
+	p = p*x+FastMath_Log5;
+	p = p*x+FastMath_Log6;
+	p = p*x+FastMath_Log7;
+	p = p*x+FastMath_Log8;
+	float y = p*x*z;
+	y += e*FastMath_Ln2Lo;
+	y -= 0.5f*z;
+	return x+y+e*FastMath_Ln2Hi;
+}
+
+float FastPow(float a, float b)
+{
+	return b == 0 ? 1.0f : FastExp(b*FastLog(a));
+}
+
+#if SIMD_SSE2
+static inline __m128 MulAdd4(__m128 a, __m128 b, __m128 c)
+{
+#if SIMD_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+// mask ? a : b per lane, mask lanes all ones or all zeros.
+static inline __m128 Select4(__m128 mask, __m128 a, __m128 b)
+{
+#if SIMD_AVX
+	return _mm_blendv_ps(b, a, mask);
+#else
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#endif
+}
+
+static inline void SinCos4(__m128 v, __m128* outSin, __m128* outCos)
+{
+	__m128i j = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(FastMath_TwoOverPi)));
+	__m128 fj = _mm_cvtepi32_ps(j);
+	__m128 r = MulAdd4(fj, _mm_set1_ps(-FastMath_HalfPi0), v);
+	r = MulAdd4(fj, _mm_set1_ps(-FastMath_HalfPi1), r);
+	r = MulAdd4(fj, _mm_set1_ps(-FastMath_HalfPi2), r);
+	__m128 z = _mm_mul_ps(r, r);
+
+	__m128 s = MulAdd4(z, _mm_set1_ps(FastMath_Sin2), _mm_set1_ps(FastMath_Sin1));
+	s = MulAdd4(s, z, _mm_set1_ps(FastMath_Sin0));
+	s = MulAdd4(_mm_mul_ps(r, z), s, r);
+	__m128 c = MulAdd4(z, _mm_set1_ps(FastMath_Cos2), _mm_set1_ps(FastMath_Cos1));
+	c = MulAdd4(c, z, _mm_set1_ps(FastMath_Cos0));
+	c = MulAdd4(_mm_mul_ps(z, z), c, MulAdd4(z, _mm_set1_ps(-0.5f), _mm_set1_ps(1.0f)));
+
+	__m128i one = _mm_set1_epi32(1);
+	__m128i two = _mm_set1_epi32(2);
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, one), one));
+	__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, two), 30));
+	__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, one), two), 30));
+	*outSin = _mm_xor_ps(Select4(swap, c, s), sinSign);
+	*outCos = _mm_xor_ps(Select4(swap, s, c), cosSign);
+}
+
+static inline __m128 Sin4(__m128 v)
+{
+	__m128 result, unused;
+	SinCos4(v, &result, &unused);
+	return result;
+}
+
+static inline __m128 Cos4(__m128 v)
+{
+	__m128 unused, result;
+	SinCos4(v, &unused, &result);
+	return result;
+}
+
+static inline __m128 Tan4(__m128 v)
+{
+	__m128 s, c;
+	SinCos4(v, &s, &c);
+	return _mm_div_ps(s, c);
+}
+
+static inline __m128 Atan4(__m128 v)
+{
+	__m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 x = _mm_andnot_ps(signMask, v);
+	__m128 big = _mm_cmpgt_ps(x, _mm_set1_ps(FastMath_Tan3Pi8));
+	__m128 mid = _mm_andnot_ps(big, _mm_cmpgt_ps(x, _mm_set1_ps(FastMath_TanPi8)));
+	// one divide for all three ranges: -1/x, (x-1)/(x+1) or x/1.
+	__m128 num = Select4(big, _mm_set1_ps(-1.0f), Select4(mid, _mm_sub_ps(x, one), x));
+	__m128 den = Select4(big, x, Select4(mid, _mm_add_ps(x, one), one));
+	x = _mm_div_ps(num, den);
+	__m128 offset = _mm_or_ps(_mm_and_ps(big, _mm_set1_ps(PI32*0.5f)), _mm_and_ps(mid, _mm_set1_ps(PI32*0.25f)));
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 p = MulAdd4(_mm_set1_ps(FastMath_Atan0), z, _mm_set1_ps(FastMath_Atan1));
+	p = MulAdd4(p, z, _mm_set1_ps(FastMath_Atan2));
+	p = MulAdd4(p, z, _mm_set1_ps(FastMath_Atan3));
+	__m128 result = _mm_add_ps(offset, MulAdd4(_mm_mul_ps(p, z), x, x));
+	return _mm_xor_ps(result, _mm_and_ps(v, signMask));
+}
+
+static inline __m128 Atan2_4(__m128 y, __m128 x)
+{
+	__m128 zero = _mm_setzero_ps();
+	__m128 bothZero = _mm_and_ps(_mm_cmpeq_ps(x, zero), _mm_cmpeq_ps(y, zero));
+	__m128 ratio = _mm_andnot_ps(bothZero, _mm_div_ps(y, x));
+	__m128 result = Atan4(ratio);
+	// +-pi on the left half, by the sign of y.
+	__m128 offset = _mm_or_ps(_mm_set1_ps(PI32), _mm_and_ps(y, _mm_set1_ps(-0.0f)));
+	return _mm_add_ps(result, _mm_and_ps(_mm_cmplt_ps(x, zero), offset));
+}
+
+static inline __m128 Exp4(__m128 v)
+{
+	// max and min return the second operand for nan, this order lets nans through.
+	__m128 x = _mm_min_ps(_mm_set1_ps(FastMath_ExpMax), _mm_max_ps(_mm_set1_ps(FastMath_ExpMin), v));
+	__m128i ni = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(FastMath_Log2E)));
+	__m128 fn = _mm_cvtepi32_ps(ni);
+	__m128 r = MulAdd4(fn, _mm_set1_ps(-FastMath_Ln2Hi), x);
+	r = MulAdd4(fn, _mm_set1_ps(-FastMath_Ln2Lo), r);
+	__m128 p = MulAdd4(_mm_set1_ps(FastMath_Exp0), r, _mm_set1_ps(FastMath_Exp1));
+	p = MulAdd4(p, r, _mm_set1_ps(FastMath_Exp2));
+	p = MulAdd4(p, r, _mm_set1_ps(FastMath_Exp3));
+	p = MulAdd4(p, r, _mm_set1_ps(FastMath_Exp4));
+	p = MulAdd4(p, r, _mm_set1_ps(FastMath_Exp5));
+	__m128 e = MulAdd4(_mm_mul_ps(p, r), r, _mm_add_ps(r, _mm_set1_ps(1.0f)));
+
+	__m128i bias = _mm_set1_epi32(127);
+	__m128i half = _mm_srai_epi32(ni, 1);
+	__m128 scale0 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(half, bias), 23));
+	__m128 scale1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(ni, half), bias), 23));
+	return _mm_mul_ps(_mm_mul_ps(e, scale0), scale1);
+}
+
+static inline __m128 Log4(__m128 v)
+{
+	__m128 denormal = _mm_cmplt_ps(v, _mm_set1_ps(FloatMin));
+	__m128i bits = _mm_castps_si128(Select4(denormal, _mm_mul_ps(v, _mm_set1_ps(FastMath_DenormalScale)), v));
+	__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+	e = _mm_sub_ps(e, _mm_and_ps(denormal, _mm_set1_ps(23.0f)));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000)));
+	__m128 small = _mm_cmplt_ps(m, _mm_set1_ps(FastMath_SqrtHalf));
+	__m128 one = _mm_set1_ps(1.0f);
+	e = _mm_sub_ps(e, _mm_and_ps(small, one));
+	__m128 x = _mm_sub_ps(_mm_add_ps(m, _mm_and_ps(small, m)), one);
+
+	__m128 z = _mm_mul_ps(x, x);
+	__m128 p = MulAdd4(_mm_set1_ps(FastMath_Log0), x, _mm_set1_ps(FastMath_Log1));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log2));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log3));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log4));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log5));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log6));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log7));
+	p = MulAdd4(p, x, _mm_set1_ps(FastMath_Log8));
+	__m128 y = _mm_mul_ps(_mm_mul_ps(p, x), z);
+	y = MulAdd4(e, _mm_set1_ps(FastMath_Ln2Lo), y);
+	y = MulAdd4(z, _mm_set1_ps(-0.5f), y);
+	__m128 result = MulAdd4(e, _mm_set1_ps(FastMath_Ln2Hi), _mm_add_ps(x, y));
+
+	// 0 gives -inf, negatives and nan give nan, inf stays inf.
+	__m128 zero = _mm_setzero_ps();
+	__m128 infinity = _mm_set1_ps(FloatInfinity);
+	__m128 invalid = Select4(_mm_cmpeq_ps(v, zero), _mm_set1_ps(FloatNegInfinity), _mm_castsi128_ps(_mm_set1_epi32(0x7fc00000)));
+	result = Select4(_mm_cmpgt_ps(v, zero), result, invalid);
+	return Select4(_mm_cmpeq_ps(v, infinity), infinity, result);
+}
+
+static inline __m128 Pow4(__m128 a, __m128 b)
+{
+	__m128 result = Exp4(_mm_mul_ps(b, Log4(a)));
+	return Select4(_mm_cmpeq_ps(b, _mm_setzero_ps()), _mm_set1_ps(1.0f), result);
+}
+
+// the exported forms, the array loops below use the kernels directly so they get inlined.
+void FastSinCos4(__m128 v, __m128* outSin, __m128* outCos)
+{
+	SinCos4(v, outSin, outCos);
+}
+
+__m128 FastSin4(__m128 v)
+{
+	return Sin4(v);
+}
+
+__m128 FastCos4(__m128 v)
+{
+	return Cos4(v);
+}
+
+__m128 FastTan4(__m128 v)
+{
+	return Tan4(v);
+}
+
+__m128 FastAtan4(__m128 v)
+{
+	return Atan4(v);
+}
+
+__m128 FastAtan2_4(__m128 y, __m128 x)
+{
+	return Atan2_4(y, x);
+}
+
+__m128 FastExp4(__m128 v)
+{
+	return Exp4(v);
+}
+
+__m128 FastLog4(__m128 v)
+{
+	return Log4(v);
+}
+
+__m128 FastPow4(__m128 a, __m128 b)
+{
+	return Pow4(a, b);
+}
+#endif
+
+#if SIMD_AVX2
+static inline __m256 MulAdd8(__m256 a, __m256 b, __m256 c)
+{
+#if SIMD_FMA
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+static inline __m256 Select8(__m256 mask, __m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(b, a, mask);
+}
+
+static inline void SinCos8(__m256 v, __m256* outSin, __m256* outCos)
+{
+	__m256i j = _mm256_cvtps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(FastMath_TwoOverPi)));
+	__m256 fj = _mm256_cvtepi32_ps(j);
+	__m256 r = MulAdd8(fj, _mm256_set1_ps(-FastMath_HalfPi0), v);
+	r = MulAdd8(fj, _mm256_set1_ps(-FastMath_HalfPi1), r);
+	r = MulAdd8(fj, _mm256_set1_ps(-FastMath_HalfPi2), r);
+	__m256 z = _mm256_mul_ps(r, r);
+
+	__m256 s = MulAdd8(z, _mm256_set1_ps(FastMath_Sin2), _mm256_set1_ps(FastMath_Sin1));
+	s = MulAdd8(s, z, _mm256_set1_ps(FastMath_Sin0));
+	s = MulAdd8(_mm256_mul_ps(r, z), s, r);
+	__m256 c = MulAdd8(z, _mm256_set1_ps(FastMath_Cos2), _mm256_set1_ps(FastMath_Cos1));
+	c = MulAdd8(c, z, _mm256_set1_ps(FastMath_Cos0));
+	c = MulAdd8(_mm256_mul_ps(z, z), c, MulAdd8(z, _mm256_set1_ps(-0.5f), _mm256_set1_ps(1.0f)));
+
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i two = _mm256_set1_epi32(2);
+	__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, one), one));
+	__m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, two), 30));
+	__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(j, one), two), 30));
+	*outSin = _mm256_xor_ps(Select8(swap, c, s), sinSign);
+	*outCos = _mm256_xor_ps(Select8(swap, s, c), cosSign);
+}
+
+static inline __m256 Sin8(__m256 v)
+{
+	__m256 result, unused;
+	SinCos8(v, &result, &unused);
+	return result;
+}
+
+static inline __m256 Cos8(__m256 v)
+{
+	__m256 unused, result;
+	SinCos8(v, &unused, &result);
+	return result;
+}
+
+static inline __m256 Tan8(__m256 v)
+{
+	__m256 s, c;
+	SinCos8(v, &s, &c);
+	return _mm256_div_ps(s, c);
+}
+
+static inline __m256 Atan8(__m256 v)
+{
+	__m256 signMask = _mm256_set1_ps(-0.0f);
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 x = _mm256_andnot_ps(signMask, v);
+	__m256 big = _mm256_cmp_ps(x, _mm256_set1_ps(FastMath_Tan3Pi8), _CMP_GT_OQ);
+	__m256 mid = _mm256_andnot_ps(big, _mm256_cmp_ps(x, _mm256_set1_ps(FastMath_TanPi8), _CMP_GT_OQ));
+	__m256 num = Select8(big, _mm256_set1_ps(-1.0f), Select8(mid, _mm256_sub_ps(x, one), x));
+	__m256 den = Select8(big, x, Select8(mid, _mm256_add_ps(x, one), one));
+	x = _mm256_div_ps(num, den);
+	__m256 offset = _mm256_or_ps(_mm256_and_ps(big, _mm256_set1_ps(PI32*0.5f)), _mm256_and_ps(mid, _mm256_set1_ps(PI32*0.25f)));
+
+	__m256 z = _mm256_mul_ps(x, x);
+	__m256 p = MulAdd8(_mm256_set1_ps(FastMath_Atan0), z, _mm256_set1_ps(FastMath_Atan1));
+	p = MulAdd8(p, z, _mm256_set1_ps(FastMath_Atan2));
+	p = MulAdd8(p, z, _mm256_set1_ps(FastMath_Atan3));
+	__m256 result = _mm256_add_ps(offset, MulAdd8(_mm256_mul_ps(p, z), x, x));
+	return _mm256_xor_ps(result, _mm256_and_ps(v, signMask));
+}
+
+static inline __m256 Atan2_8(__m256 y, __m256 x)
+{
+	__m256 zero = _mm256_setzero_ps();
+	__m256 bothZero = _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_EQ_OQ), _mm256_cmp_ps(y, zero, _CMP_EQ_OQ));
+	__m256 ratio = _mm256_andnot_ps(bothZero, _mm256_div_ps(y, x));
+	__m256 result = Atan8(ratio);
+	__m256 offset = _mm256_or_ps(_mm256_set1_ps(PI32), _mm256_and_ps(y, _mm256_set1_ps(-0.0f)));
+	return _mm256_add_ps(result, _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), offset));
+}
+
+static inline __m256 Exp8(__m256 v)
+{
+	__m256 x = _mm256_min_ps(_mm256_set1_ps(FastMath_ExpMax), _mm256_max_ps(_mm256_set1_ps(FastMath_ExpMin), v));
+	__m256i ni = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FastMath_Log2E)));
+	__m256 fn = _mm256_cvtepi32_ps(ni);
+	__m256 r = MulAdd8(fn, _mm256_set1_ps(-FastMath_Ln2Hi), x);
+	r = MulAdd8(fn, _mm256_set1_ps(-FastMath_Ln2Lo), r);
+	__m256 p = MulAdd8(_mm256_set1_ps(FastMath_Exp0), r, _mm256_set1_ps(FastMath_Exp1));
+	p = MulAdd8(p, r, _mm256_set1_ps(FastMath_Exp2));
+	p = MulAdd8(p, r, _mm256_set1_ps(FastMath_Exp3));
+	p = MulAdd8(p, r, _mm256_set1_ps(FastMath_Exp4));
+	p = MulAdd8(p, r, _mm256_set1_ps(FastMath_Exp5));
+	__m256 e = MulAdd8(_mm256_mul_ps(p, r), r, _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+	__m256i bias = _mm256_set1_epi32(127);
+	__m256i half = _mm256_srai_epi32(ni, 1);
+	__m256 scale0 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(half, bias), 23));
+	__m256 scale1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_sub_epi32(ni, half), bias), 23));
+	return _mm256_mul_ps(_mm256_mul_ps(e, scale0), scale1);
+}
+
+static inline __m256 Log8(__m256 v)
+{
+	__m256 denormal = _mm256_cmp_ps(v, _mm256_set1_ps(FloatMin), _CMP_LT_OQ);
+	__m256i bits = _mm256_castps_si256(Select8(denormal, _mm256_mul_ps(v, _mm256_set1_ps(FastMath_DenormalScale)), v));
+	__m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+	e = _mm256_sub_ps(e, _mm256_and_ps(denormal, _mm256_set1_ps(23.0f)));
+	__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f000000)));
+	__m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(FastMath_SqrtHalf), _CMP_LT_OQ);
+	__m256 one = _mm256_set1_ps(1.0f);
+	e = _mm256_sub_ps(e, _mm256_and_ps(small, one));
+	__m256 x = _mm256_sub_ps(_mm256_add_ps(m, _mm256_and_ps(small, m)), one);
+
+	__m256 z = _mm256_mul_ps(x, x);
+	__m256 p = MulAdd8(_mm256_set1_ps(FastMath_Log0), x, _mm256_set1_ps(FastMath_Log1));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log2));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log3));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log4));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log5));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log6));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log7));
+	p = MulAdd8(p, x, _mm256_set1_ps(FastMath_Log8));
+	__m256 y = _mm256_mul_ps(_mm256_mul_ps(p, x), z);
+	y = MulAdd8(e, _mm256_set1_ps(FastMath_Ln2Lo), y);
+	y = MulAdd8(z, _mm256_set1_ps(-0.5f), y);
+	__m256 result = MulAdd8(e, _mm256_set1_ps(FastMath_Ln2Hi), _mm256_add_ps(x, y));
+
+	__m256 zero = _mm256_setzero_ps();
+	__m256 infinity = _mm256_set1_ps(FloatInfinity);
+	__m256 invalid = Select8(_mm256_cmp_ps(v, zero, _CMP_EQ_OQ), _mm256_set1_ps(FloatNegInfinity), _mm256_castsi256_ps(_mm256_set1_epi32(0x7fc00000)));
+	result = Select8(_mm256_cmp_ps(v, zero, _CMP_GT_OQ), result, invalid);
+	return Select8(_mm256_cmp_ps(v, infinity, _CMP_EQ_OQ), infinity, result);
+}
+
+static inline __m256 Pow8(__m256 a, __m256 b)
+{
+	__m256 result = Exp8(_mm256_mul_ps(b, Log8(a)));
+	return Select8(_mm256_cmp_ps(b, _mm256_setzero_ps(), _CMP_EQ_OQ), _mm256_set1_ps(1.0f), result);
+}
+
+void FastSinCos8(__m256 v, __m256* outSin, __m256* outCos)
+{
+	SinCos8(v, outSin, outCos);
+}
+
+__m256 FastSin8(__m256 v)
+{
+	return Sin8(v);
+}
+
+__m256 FastCos8(__m256 v)
+{
+	return Cos8(v);
+}
+
+__m256 FastTan8(__m256 v)
+{
+	return Tan8(v);
+}
+
+__m256 FastAtan8(__m256 v)
+{
+	return Atan8(v);
+}
+
+__m256 FastAtan2_8(__m256 y, __m256 x)
+{
+	return Atan2_8(y, x);
+}
+
+__m256 FastExp8(__m256 v)
+{
+	return Exp8(v);
+}
+
+__m256 FastLog8(__m256 v)
+{
+	return Log8(v);
+}
+
+__m256 FastPow8(__m256 a, __m256 b)
+{
+	return Pow8(a, b);
+}
+#endif
+
+// the array forms run the widest kernel over full blocks and the scalar one over the rest.
+
+void FastSinArray(const float* values, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Sin8(_mm256_loadu_ps(values+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Sin4(_mm_loadu_ps(values+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastSin(values[i]);
+	}
+}
+
+void FastCosArray(const float* values, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Cos8(_mm256_loadu_ps(values+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Cos4(_mm_loadu_ps(values+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastCos(values[i]);
+	}
+}
+
+void FastSinCosArray(const float* values, float* outSin, float* outCos, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		__m256 s, c;
+		SinCos8(_mm256_loadu_ps(values+i), &s, &c);
+		_mm256_storeu_ps(outSin+i, s);
+		_mm256_storeu_ps(outCos+i, c);
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		__m128 s, c;
+		SinCos4(_mm_loadu_ps(values+i), &s, &c);
+		_mm_storeu_ps(outSin+i, s);
+		_mm_storeu_ps(outCos+i, c);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		FastSinCos(values[i], outSin+i, outCos+i);
+	}
+}
+
+void FastTanArray(const float* values, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Tan8(_mm256_loadu_ps(values+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Tan4(_mm_loadu_ps(values+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastTan(values[i]);
+	}
+}
+
+void FastAtanArray(const float* values, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Atan8(_mm256_loadu_ps(values+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Atan4(_mm_loadu_ps(values+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastAtan(values[i]);
+	}
+}
+
+void FastAtan2Array(const float* y, const float* x, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Atan2_8(_mm256_loadu_ps(y+i), _mm256_loadu_ps(x+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Atan2_4(_mm_loadu_ps(y+i), _mm_loadu_ps(x+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastAtan2(y[i], x[i]);
+	}
+}
+
+void FastExpArray(const float* values, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Exp8(_mm256_loadu_ps(values+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Exp4(_mm_loadu_ps(values+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastExp(values[i]);
+	}
+}
+
+void FastLogArray(const float* values, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Log8(_mm256_loadu_ps(values+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Log4(_mm_loadu_ps(values+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastLog(values[i]);
+	}
+}
+
+void FastPowArray(const float* a, const float* b, float* outValues, int32 count)
+{
+	int32 i = 0;
+#if SIMD_AVX2
+	for (; i+8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(outValues+i, Pow8(_mm256_loadu_ps(a+i), _mm256_loadu_ps(b+i)));
+	}
+#elif SIMD_SSE2
+	for (; i+4 <= count; i += 4)
+	{
+		_mm_storeu_ps(outValues+i, Pow4(_mm_loadu_ps(a+i), _mm_loadu_ps(b+i)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		outValues[i] = FastPow(a[i], b[i]);
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "common/Standard.h"
+
+#if SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+// polynomial approximations of the Math.h transcendentals, for hot loops that can live with a few ulp of error.
+// errors are the max measured against the exact result over the stated range, 0.5 ulp being correctly rounded.
+// the speedup comes from the simd and array forms, 1.2 to 16 times glibc's throughput with sse2 alone and about 4 to 20
+// times with avx2. the scalar forms are mostly there for the ends of arrays and code that wants the same results outside
+// simd, they're often slower than a modern crt. none of these set errno.
+// tests/TestFastMath.c measures the errors and bench/BenchFastMath.c the speed.
+
+// 1.6 ulp for |v| <= pi. the range reduction is exact up to |v| = 8192, with an absolute error below 1e-7 there.
+// past that precision drops off, and past 2^31 quadrants the results are meaningless.
+float FastSin(float v);
+float FastCos(float v);
+void FastSinCos(float v, float* outSin, float* outCos);
+// 2.8 ulp for |v| <= pi/4, 3.3 ulp for |v| <= 1.5. same range limits as FastSinCos.
+float FastTan(float v);
+// 3.3 ulp.
+float FastAtan(float v);
+// 3.6 ulp. FastAtan2(0, 0) is 0, the signs of zero x are ignored.
+float FastAtan2(float y, float x);
+// 1.3 ulp, denormal results included. over and underflows to inf and 0.
+float FastExp(float v);
+// 0.9 ulp, denormals included. 0 gives -inf, negatives give nan.
+float FastLog(float v);
+// exp(b*log(a)), so the error grows with |b*Log(a)|: 19 ulp below 28, 68 ulp below 83. a must not be negative, pow(a, 0) is 1.
+float FastPow(float a, float b);
+
+// whole arrays, using the widest simd available. outputs may alias the inputs.
+void FastSinArray(const float* values, float* outValues, int32 count);
+void FastCosArray(const float* values, float* outValues, int32 count);
+void FastSinCosArray(const float* values, float* outSin, float* outCos, int32 count);
+void FastTanArray(const float* values, float* outValues, int32 count);
+void FastAtanArray(const float* values, float* outValues, int32 count);
+void FastAtan2Array(const float* y, const float* x, float* outValues, int32 count);
+void FastExpArray(const float* values, float* outValues, int32 count);
+void FastLogArray(const float* values, float* outValues, int32 count);
+void FastPowArray(const float* a, const float* b, float* outValues, int32 count);
+
+// the same approximations per lane, for kernels that are already simd. results can differ from the scalar forms in the last bit.
+// the 8 wide forms need avx2 for the integer parts.
+#if SIMD_SSE2
+__m128 FastSin4(__m128 v);
+__m128 FastCos4(__m128 v);
+void FastSinCos4(__m128 v, __m128* outSin, __m128* outCos);
+__m128 FastTan4(__m128 v);
+__m128 FastAtan4(__m128 v);
+__m128 FastAtan2_4(__m128 y, __m128 x);
+__m128 FastExp4(__m128 v);
+__m128 FastLog4(__m128 v);
+__m128 FastPow4(__m128 a, __m128 b);
+#endif
+
+#if SIMD_AVX2
+__m256 FastSin8(__m256 v);
+__m256 FastCos8(__m256 v);
+void FastSinCos8(__m256 v, __m256* outSin, __m256* outCos);
+__m256 FastTan8(__m256 v);
+__m256 FastAtan8(__m256 v);
+__m256 FastAtan2_8(__m256 y, __m256 x);
+__m256 FastExp8(__m256 v);
+__m256 FastLog8(__m256 v);
+__m256 FastPow8(__m256 a, __m256 b);
+#endif
@@ -4,7 +4,14 @@
 #include "common/CString.h"
 
 #include <stdio.h>
-
+#if PLATFORM_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if PLATFORM_WINDOWS
 const wchar_t* FileModeToCMode(FileMode mode)
 {
 	static_assert((int)FileMode_Count == 4, "FileMode_Count has changed.");
@@ -123,6 +130,16 @@ int64 File_WriteBinary(File* self, const uint8* source, int64 size)
 	return count;
 }
 
+void File_Flush(File* self)
+{
+	if (!self->fileHandle)
+	{
+		ErrorF("file is not open.");
+	}
+
+	fflush((FILE*)self->fileHandle);
+}
+
 void File_Close(File* self)
 {
 	if (self->fileHandle)
@@ -131,16 +148,185 @@ void File_Close(File* self)
 		self->fileHandle = null;
 	}
 }
+#elif PLATFORM_LINUX
+static void CheckOpen(File* self)
+{
+	if (self->fileDescriptor < 0)
+	{
+		ErrorF("file is not open.");
+	}
+}
 
-bool File_WriteBinaryFile(const char* path, const uint8* data, int64 size)
+bool File_Open(File* self, const char* path, FileMode mode)
 {
-	wchar_t* wpath = CStringToWideStringAlloc(path, -1);
-	bool result = File_WriteBinaryFileW(wpath, data, size);
-	MFree(wpath);
+	File_Init(self);
+	self->mode = mode;
+
+	static_assert((int)FileMode_Count == 4, "FileMode_Count has changed.");
+	int flags = O_CLOEXEC;
+	switch (mode)
+	{
+	case FileMode_Read:
+		flags |= O_RDONLY;
+		break;
+	case FileMode_Write:
+		flags |= O_WRONLY|O_CREAT|O_TRUNC;
+		break;
+	case FileMode_Append:
+		// matches "a+", readable and every write goes to the end.
+		flags |= O_RDWR|O_CREAT|O_APPEND;
+		break;
+	default:
+		Error("mode must be FileMode_Read, FileMode_Write, or FileMode_Append.");
+		break;
+	}
+
+	int fd;
+	do
+	{
+		fd = open(path, flags, 0666);
+	} while (fd < 0 && errno == EINTR);
+	if (fd < 0)
+	{
+		return false;
+	}
+	self->fileDescriptor = fd;
+
+	if (mode == FileMode_Read)
+	{
+		// files are nearly always read front to back in one go, let the kernel read ahead aggressively.
+		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+
+	return true;
+}
+
+bool File_OpenW(File* self, const wchar_t* path, FileMode mode)
+{
+	char* cpath = WideStringToCStringAlloc(path, -1);
+	bool result = File_Open(self, cpath, mode);
+	MFree(cpath);
 	return result;
 }
 
-bool File_WriteBinaryFileW(const wchar_t* path, const uint8* data, int64 size)
+int64 File_GetSize(File* self)
+{
+	CheckOpen(self);
+
+	struct stat info;
+	if (fstat(self->fileDescriptor, &info) != 0)
+	{
+		return 0;
+	}
+	return (int64)info.st_size;
+}
+
+int64 File_GetOffset(File* self)
+{
+	CheckOpen(self);
+	return self->offset;
+}
+
+void File_SetOffset(File* self, int64 value)
+{
+	CheckOpen(self);
+	self->offset = value;
+}
+
+int64 File_ReadBinary(File* self, uint8* dest, int64 size)
+{
+	CheckOpen(self);
+
+	if (!dest)
+	{
+		ErrorF("dest is null.");
+	}
+
+	int64 count = 0;
+	while (count < size)
+	{
+		ssize_t result = pread(self->fileDescriptor, dest+count, (size_t)(size-count), (off_t)(self->offset+count));
+		if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (result <= 0)
+		{
+			break;
+		}
+		count += result;
+	}
+	self->offset += count;
+	return count;
+}
+
+int64 File_WriteBinary(File* self, const uint8* source, int64 size)
+{
+	CheckOpen(self);
+
+	if (!source)
+	{
+		ErrorF("source is null.");
+	}
+
+	int64 count = 0;
+	while (count < size)
+	{
+		ssize_t result;
+		if (self->mode == FileMode_Append)
+		{
+			// pwrite ignores the offset with O_APPEND on linux anyway.
+			result = write(self->fileDescriptor, source+count, (size_t)(size-count));
+		}
+		else
+		{
+			result = pwrite(self->fileDescriptor, source+count, (size_t)(size-count), (off_t)(self->offset+count));
+		}
+		if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (result <= 0)
+		{
+			break;
+		}
+		count += result;
+	}
+
+	if (self->mode == FileMode_Append)
+	{
+		self->offset = (int64)lseek(self->fileDescriptor, 0, SEEK_CUR);
+	}
+	else
+	{
+		self->offset += count;
+	}
+	return count;
+}
+
+void File_Flush(File* self)
+{
+	// writes go straight to the kernel, there's no user space buffer to flush.
+	CheckOpen(self);
+}
+
+void File_Close(File* self)
+{
+	if (self->fileDescriptor >= 0)
+	{
+		close(self->fileDescriptor);
+		self->fileDescriptor = -1;
+	}
+}
+#endif
+
+// exactly one of path and wpath is set. keeps each platform on its native path type without converting back and forth.
+static bool OpenGeneric(File* file, const char* path, const wchar_t* wpath, FileMode mode)
+{
+	return path ? File_Open(file, path, mode) : File_OpenW(file, wpath, mode);
+}
+
+static bool WriteBinaryFileGeneric(const char* path, const wchar_t* wpath, const uint8* data, int64 size)
 {
 	if (data == null && size > 0)
 	{
@@ -149,7 +335,7 @@ bool File_WriteBinaryFileW(const wchar_t* path, const uint8* data, int64 size)
 	size = MaxI64(size, 0ll);
 
 	File file;
-	if (!File_OpenW(&file, path, FileMode_Write))
+	if (!OpenGeneric(&file, path, wpath, FileMode_Write))
 	{
 		return false;
 	}
@@ -161,26 +347,31 @@ bool File_WriteBinaryFileW(const wchar_t* path, const uint8* data, int64 size)
 	return true;
 }
 
-uint8* File_ReadBinaryFileAlloc(const char* path, int64* outSize)
+bool File_WriteBinaryFile(const char* path, const uint8* data, int64 size)
 {
-	wchar_t* wpath = CStringToWideStringAlloc(path, -1);
-	uint8* result = File_ReadBinaryFileWAlloc(wpath, outSize);
-	MFree(wpath);
-	return result;
+	return WriteBinaryFileGeneric(path, null, data, size);
 }
 
-uint8* File_ReadBinaryFileWAlloc(const wchar_t* path, int64* outSize)
+bool File_WriteBinaryFileW(const wchar_t* path, const uint8* data, int64 size)
+{
+	return WriteBinaryFileGeneric(null, path, data, size);
+}
+
+// reads the whole file and appends charSize zero bytes.
+static uint8* ReadFileGeneric(const char* path, const wchar_t* wpath, size_t charSize, int64* outSize)
 {
 	File file;
-	if (!File_OpenW(&file, path, FileMode_Read))
+	if (!OpenGeneric(&file, path, wpath, FileMode_Read))
 	{
 		return null;
 	}
 	int64 size = File_GetSize(&file);
-	uint8* data = (uint8*)MAlloc((size_t)size);
+	uint8* data = (uint8*)MAlloc((size_t)size+charSize);
 	File_ReadBinary(&file, data, size);
 	File_Close(&file);
 
+	MemSet(data+size, 0, charSize);
+
 	if (outSize)
 	{
 		*outSize = size;
@@ -189,50 +380,43 @@ uint8* File_ReadBinaryFileWAlloc(const wchar_t* path, int64* outSize)
 	return data;
 }
 
-static void* ReadCStringFileGeneric(const wchar_t* path, size_t charSize, int64* outLength)
+uint8* File_ReadBinaryFileAlloc(const char* path, int64* outSize)
 {
-	File file;
-	if (!File_OpenW(&file, path, FileMode_Read))
-	{
-		return null;
-	}
-	int64 size = File_GetSize(&file);
-	uint8* data = (uint8*)MAlloc((size_t)size+charSize);
-	File_ReadBinary(&file, data, size);
-	File_Close(&file);
-	
-	MemSet(data+size, 0, charSize);
+	return ReadFileGeneric(path, null, 0, outSize);
+}
+
+uint8* File_ReadBinaryFileWAlloc(const wchar_t* path, int64* outSize)
+{
+	return ReadFileGeneric(null, path, 0, outSize);
+}
 
-	if (outLength)
+static void* ReadCStringFileGeneric(const char* path, const wchar_t* wpath, size_t charSize, int64* outLength)
+{
+	int64 size;
+	uint8* data = ReadFileGeneric(path, wpath, charSize, &size);
+	if (data && outLength)
 	{
 		*outLength = size/charSize;
 	}
-
 	return data;
 }
 
 char* File_ReadCStringFileAlloc(const char* path, int64* outLength)
 {
-	wchar_t* wpath = CStringToWideStringAlloc(path, -1);
-	char* result = File_ReadCStringFileWAlloc(wpath, outLength);
-	MFree(wpath);
-	return result;
+	return (char*)ReadCStringFileGeneric(path, null, sizeof(char), outLength);
 }
 
 char* File_ReadCStringFileWAlloc(const wchar_t* path, int64* outLength)
 {
-	return (char*)ReadCStringFileGeneric(path, sizeof(char), outLength);
+	return (char*)ReadCStringFileGeneric(null, path, sizeof(char), outLength);
 }
 
 wchar_t* File_ReadWideCStringFileAlloc(const char* path, int64* outLength)
 {
-	wchar_t* wpath = CStringToWideStringAlloc(path, -1);
-	wchar_t* result = File_ReadWideCStringFileWAlloc(wpath, outLength);
-	MFree(wpath);
-	return result;
+	return (wchar_t*)ReadCStringFileGeneric(path, null, sizeof(wchar_t), outLength);
 }
 
 wchar_t* File_ReadWideCStringFileWAlloc(const wchar_t* path, int64* outLength)
 {
-	return (wchar_t*)ReadCStringFileGeneric(path, sizeof(wchar_t), outLength);
-}
\ No newline at end of file
+	return (wchar_t*)ReadCStringFileGeneric(null, path, sizeof(wchar_t), outLength);
+}
@@ -26,13 +26,25 @@ static const char* FileMode_ToString(FileMode value)
 typedef struct File
 {
 	FileMode mode;
+#if PLATFORM_WINDOWS
 	void* fileHandle;
+#else
+	// -1 when not open.
+	int32 fileDescriptor;
+	// reads and writes are positional, the descriptor's own offset isn't used.
+	int64 offset;
+#endif
 } File;
 
 static void File_Init(File* self)
 {
 	self->mode = FileMode_None;
+#if PLATFORM_WINDOWS
 	self->fileHandle = null;
+#else
+	self->fileDescriptor = -1;
+	self->offset = 0;
+#endif
 }
 
 bool File_Open(File* self, const char* path, FileMode mode);
@@ -43,6 +55,7 @@ int64 File_GetOffset(File* self);
 void File_SetOffset(File* self, int64 value);
 int64 File_ReadBinary(File* self, uint8* dest, int64 size);
 int64 File_WriteBinary(File* self, const uint8* source, int64 size);
+void File_Flush(File* self);
 void File_Close(File* self);
 
 bool File_WriteBinaryFile(const char* path, const uint8* data, int64 size);
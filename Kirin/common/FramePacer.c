@@ -0,0 +1,168 @@
+#include "common/FramePacer.h"
+
+#include "common/Math.h"
+#include "common/Time.h"
+
+// starting guess for sleepSlackTicks. 1 milisecond.
+#define FramePacer_InitialSleepSlackTicks 10000
+// never spin for less than this, even if the os has been sleeping accurately. 100 microseconds.
+#define FramePacer_MinSleepSlackTicks 1000
+
+void FramePacer_Init(FramePacer* self, int64 targetFrameTicks)
+{
+	*self = (FramePacer){ 0 };
+	self->getTicks = GetTicks;
+	self->sleepTicks = SleepTicks;
+	self->sleepSlackTicks = FramePacer_InitialSleepSlackTicks;
+	FramePacer_SetTargetFrameTicks(self, targetFrameTicks);
+	FramePacer_ResetStats(self);
+}
+
+void FramePacer_SetTargetFrameTicks(FramePacer* self, int64 targetFrameTicks)
+{
+	if (targetFrameTicks <= 0)
+	{
+		Error("targetFrameTicks must be greater than 0.");
+	}
+
+	self->targetFrameTicks = targetFrameTicks;
+	// restart the schedule from the next wait.
+	self->nextDeadline = 0;
+}
+
+static void RecordWake(FramePacer* self, int64 wakeError)
+{
+	FramePacerStats* stats = &self->stats;
+	stats->frameCount++;
+	stats->minWakeErrorTicks = MinI64(stats->minWakeErrorTicks, wakeError);
+	stats->maxWakeErrorTicks = MaxI64(stats->maxWakeErrorTicks, wakeError);
+	stats->wakeErrorSum += (double)wakeError;
+	stats->wakeErrorSqrSum += (double)wakeError*(double)wakeError;
+	if (wakeError > FramePacer_MissToleranceTicks)
+	{
+		stats->missedCount++;
+	}
+}
+
+int64 FramePacer_Wait(FramePacer* self)
+{
+	uint64 now = self->getTicks();
+	if (self->nextDeadline == 0)
+	{
+		// first frame just establishes the schedule.
+		self->nextDeadline = now+self->targetFrameTicks;
+		return 0;
+	}
+
+	uint64 deadline = self->nextDeadline;
+	if (now >= deadline)
+	{
+		self->stats.overrunCount++;
+	}
+	else
+	{
+		int64 remaining = (int64)(deadline-now);
+		if (remaining > self->sleepSlackTicks)
+		{
+			int64 requested = remaining-self->sleepSlackTicks;
+			self->sleepTicks(requested);
+			uint64 afterSleep = self->getTicks();
+
+			// track oversleep. grow immediately, shrink slowly so one lucky sleep doesn't cause a miss.
+			int64 oversleep = (int64)(afterSleep-now)-requested;
+			int64 wantedSlack = MaxI64(oversleep*2, FramePacer_MinSleepSlackTicks);
+			if (wantedSlack > self->sleepSlackTicks)
+			{
+				self->sleepSlackTicks = wantedSlack;
+			}
+			else
+			{
+				self->sleepSlackTicks -= (self->sleepSlackTicks-wantedSlack)/16;
+			}
+			now = afterSleep;
+		}
+
+		while (now < deadline)
+		{
+			now = self->getTicks();
+		}
+	}
+
+	int64 wakeError = (int64)(now-deadline);
+	RecordWake(self, wakeError);
+
+	self->nextDeadline += self->targetFrameTicks;
+	if (now >= self->nextDeadline)
+	{
+		// more than a whole frame behind. don't try to catch up, just restart the schedule from now.
+		self->nextDeadline = now+self->targetFrameTicks;
+	}
+
+	return wakeError;
+}
+
+void FramePacer_ResetStats(FramePacer* self)
+{
+	self->stats = (FramePacerStats){ 0 };
+	self->stats.minWakeErrorTicks = Int64Max;
+	self->stats.maxWakeErrorTicks = Int64Min;
+}
+
+double FramePacerStats_GetMeanWakeErrorTicks(const FramePacerStats* self)
+{
+	if (self->frameCount == 0)
+	{
+		return 0;
+	}
+	return self->wakeErrorSum/(double)self->frameCount;
+}
+
+double FramePacerStats_GetWakeErrorStdDevTicks(const FramePacerStats* self)
+{
+	if (self->frameCount == 0)
+	{
+		return 0;
+	}
+	double mean = FramePacerStats_GetMeanWakeErrorTicks(self);
+	double variance = self->wakeErrorSqrSum/(double)self->frameCount-mean*mean;
+	return SqrtD(MaxD(variance, 0));
+}
+
+void FixedTimestep_Init(FixedTimestep* self, int64 stepTicks, int32 maxStepsPerFrame)
+{
+	if (stepTicks <= 0)
+	{
+		Error("stepTicks must be greater than 0.");
+	}
+	if (maxStepsPerFrame <= 0)
+	{
+		Error("maxStepsPerFrame must be greater than 0.");
+	}
+
+	*self = (FixedTimestep){ 0 };
+	self->stepTicks = stepTicks;
+	self->maxStepsPerFrame = maxStepsPerFrame;
+}
+
+int32 FixedTimestep_Advance(FixedTimestep* self, int64 elapsedTicks)
+{
+	self->accumulatorTicks += MaxI64(elapsedTicks, 0);
+
+	int64 steps = self->accumulatorTicks/self->stepTicks;
+	if (steps > self->maxStepsPerFrame)
+	{
+		// drop whole steps past the cap but keep the fractional part so alpha stays continuous.
+		int64 dropped = (steps-self->maxStepsPerFrame)*self->stepTicks;
+		self->accumulatorTicks -= dropped;
+		self->droppedTicks += dropped;
+		steps = self->maxStepsPerFrame;
+	}
+
+	self->accumulatorTicks -= steps*self->stepTicks;
+	return (int32)steps;
+}
+
+float FixedTimestep_GetAlpha(const FixedTimestep* self)
+{
+	return (float)((double)self->accumulatorTicks/(double)self->stepTicks);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common/Standard.h"
+
+// frames that wake up later than this past their deadline are counted as missed. 50 microseconds.
+#define FramePacer_MissToleranceTicks 500
+
+typedef struct FramePacerStats
+{
+	uint64 frameCount;
+	uint64 missedCount;
+	// wake error is the wake time minus the deadline, in ticks. positive means late.
+	int64 minWakeErrorTicks;
+	int64 maxWakeErrorTicks;
+	double wakeErrorSum;
+	double wakeErrorSqrSum;
+	// frames where the caller was already past the deadline before waiting.
+	uint64 overrunCount;
+} FramePacerStats;
+
+typedef struct FramePacer
+{
+	int64 targetFrameTicks;
+	uint64 nextDeadline;
+	// estimate of how much the os oversleeps. the pacer stops sleeping this far before the deadline and spins the rest.
+	int64 sleepSlackTicks;
+	// time source. defaults to GetTicks/SleepTicks, replace to simulate frames headlessly. a simulated getTicks has to
+	// advance on every call, not only in sleepTicks, or the spin up to the deadline never ends.
+	uint64 (*getTicks)();
+	void (*sleepTicks)(int64 ticks);
+	FramePacerStats stats;
+} FramePacer;
+
+// targetFrameTicks is the frame duration. there are 10000 ticks in 1 milisecond.
+void FramePacer_Init(FramePacer* self, int64 targetFrameTicks);
+void FramePacer_SetTargetFrameTicks(FramePacer* self, int64 targetFrameTicks);
+// blocks until the current frame's deadline using a coarse sleep followed by a spin, then schedules the next deadline.
+// returns the wake error in ticks.
+int64 FramePacer_Wait(FramePacer* self);
+void FramePacer_ResetStats(FramePacer* self);
+double FramePacerStats_GetMeanWakeErrorTicks(const FramePacerStats* self);
+double FramePacerStats_GetWakeErrorStdDevTicks(const FramePacerStats* self);
+
+typedef struct FixedTimestep
+{
+	int64 stepTicks;
+	// caps catch up after a long frame so a hitch can't snowball into a spiral of updates.
+	int32 maxStepsPerFrame;
+	int64 accumulatorTicks;
+	// time thrown away because of maxStepsPerFrame.
+	uint64 droppedTicks;
+} FixedTimestep;
+
+void FixedTimestep_Init(FixedTimestep* self, int64 stepTicks, int32 maxStepsPerFrame);
+// adds elapsed frame time and returns the number of fixed updates to run this frame.
+int32 FixedTimestep_Advance(FixedTimestep* self, int64 elapsedTicks);
+// how far between the last two fixed updates the current frame is, in [0, 1). use it to interpolate rendered state.
+float FixedTimestep_GetAlpha(const FixedTimestep* self);
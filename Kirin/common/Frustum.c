@@ -0,0 +1,398 @@
+#include "common/Frustum.h"
+
+#include "common/Math.h"
+#include "common/Thread.h"
+
+#if SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+// parallel chunks start at multiples of this many objects, one full avx block.
+#define Frustum_ChunkAlignment 8
+
+static Plane TransformPlane(const Transformer* transformer, const Plane plane)
+{
+	Vec3 point = Transformer_ApplyPoint(transformer, Vec3_MulF(plane.dir, plane.dist));
+	Vec3 dir = Vec3_Normalize(Matrix3_ApplyPoint(&transformer->mat, plane.dir));
+	return Plane_NewFromPoint(dir, point);
+}
+
+Frustum Frustum_FromView(const View* view, const Transformer* cameraToWorld, float near, float far)
+{
+	Plane local[FrustumPlane_Count];
+	if (view->perspective)
+	{
+		// screen edges are at +-0.5 after View_ApplyPerspectiveToPoint.
+		float tanX = 0.5f/view->xScale;
+		float tanY = 0.5f/view->yScale;
+		local[FrustumPlane_Left] = Plane_New(Vec3_Normalize(Vec3_New(tanX, 1, 0)), 0);
+		local[FrustumPlane_Right] = Plane_New(Vec3_Normalize(Vec3_New(tanX, -1, 0)), 0);
+		local[FrustumPlane_Bottom] = Plane_New(Vec3_Normalize(Vec3_New(tanY, 0, 1)), 0);
+		local[FrustumPlane_Top] = Plane_New(Vec3_Normalize(Vec3_New(tanY, 0, -1)), 0);
+	}
+	else
+	{
+		float halfWidth = 0.5f/view->xScale;
+		float halfHeight = 0.5f/view->yScale;
+		local[FrustumPlane_Left] = Plane_New(Vec3_unitY, -halfWidth);
+		local[FrustumPlane_Right] = Plane_New(Vec3_Negate(Vec3_unitY), -halfWidth);
+		local[FrustumPlane_Bottom] = Plane_New(Vec3_unitZ, -halfHeight);
+		local[FrustumPlane_Top] = Plane_New(Vec3_Negate(Vec3_unitZ), -halfHeight);
+	}
+	local[FrustumPlane_Near] = Plane_New(Vec3_unitX, near);
+	local[FrustumPlane_Far] = Plane_New(Vec3_Negate(Vec3_unitX), -far);
+
+	Frustum result;
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		result.planes[i] = TransformPlane(cameraToWorld, local[i]);
+	}
+	return result;
+}
+
+Frustum Frustum_FromMatrix4(const Matrix4* worldToClip)
+{
+	// clip = point*worldToClip, so each clip coordinate is the dot of (point, 1) with a column.
+	// inside is -w <= x <= w and the same for y and z, which gives w+x >= 0, w-x >= 0 and so on.
+	static const int32 columns[FrustumPlane_Count] = { 0, 0, 1, 1, 2, 2 };
+	static const float signs[FrustumPlane_Count] = { 1, -1, 1, -1, 1, -1 };
+	static_assert(FrustumPlane_Count == 6, "enum has changed.");
+
+	const float (*m)[4] = worldToClip->values;
+	Frustum result;
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		int32 column = columns[i];
+		float sign = signs[i];
+		Vec3 dir = Vec3_New(
+			m[0][3]+sign*m[0][column],
+			m[1][3]+sign*m[1][column],
+			m[2][3]+sign*m[2][column]
+		);
+		float offset = m[3][3]+sign*m[3][column];
+		float length;
+		dir = Vec3_NormalizeGetLength(dir, &length);
+		result.planes[i] = Plane_New(dir, length > 0 ? -offset/length : 0);
+	}
+	return result;
+}
+
+// the smallest signed distance to any of the planes. the batch kernels compute the same thing, so they agree with these.
+static inline float MinPlaneDist(const Frustum* self, float x, float y, float z)
+{
+	float result = FloatMax;
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		const Plane* plane = &self->planes[i];
+		result = Min(result, x*plane->dir.x+y*plane->dir.y+z*plane->dir.z-plane->dist);
+	}
+	return result;
+}
+
+static inline float MinPlaneDistAabb(const Frustum* self, float x, float y, float z, float extentX, float extentY, float extentZ)
+{
+	float result = FloatMax;
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		const Plane* plane = &self->planes[i];
+		float dist = x*plane->dir.x+y*plane->dir.y+z*plane->dir.z-plane->dist;
+		// how far the box reaches towards the inside of the plane.
+		float reach = extentX*Abs(plane->dir.x)+extentY*Abs(plane->dir.y)+extentZ*Abs(plane->dir.z);
+		result = Min(result, dist+reach);
+	}
+	return result;
+}
+
+bool Frustum_TestSphere(const Frustum* self, const Vec3 center, float radius)
+{
+	return MinPlaneDist(self, center.x, center.y, center.z)+radius >= 0;
+}
+
+bool Frustum_TestAabb(const Frustum* self, const Vec3 center, const Vec3 extent)
+{
+	return MinPlaneDistAabb(self, center.x, center.y, center.z, extent.x, extent.y, extent.z) >= 0;
+}
+
+// writes an index for every bit and only advances past the set ones, no branches on the mask.
+// outCount never passes base+bit, so this doesn't write beyond the count indices the caller made room for.
+static inline int32 AppendVisible(int32* outIndices, int32 outCount, int32 base, uint32 mask, int32 width)
+{
+	for (int32 bit = 0; bit < width; bit++)
+	{
+		outIndices[outCount] = base+bit;
+		outCount += (mask >> bit) & 1;
+	}
+	return outCount;
+}
+
+#if SIMD_SSE2
+typedef struct SimdPlanes
+{
+	__m128 x[FrustumPlane_Count];
+	__m128 y[FrustumPlane_Count];
+	__m128 z[FrustumPlane_Count];
+	__m128 dist[FrustumPlane_Count];
+	__m128 absX[FrustumPlane_Count];
+	__m128 absY[FrustumPlane_Count];
+	__m128 absZ[FrustumPlane_Count];
+} SimdPlanes;
+
+static inline void SimdPlanes_Init(SimdPlanes* self, const Frustum* frustum)
+{
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		const Plane* plane = &frustum->planes[i];
+		self->x[i] = _mm_set1_ps(plane->dir.x);
+		self->y[i] = _mm_set1_ps(plane->dir.y);
+		self->z[i] = _mm_set1_ps(plane->dir.z);
+		self->dist[i] = _mm_set1_ps(plane->dist);
+		self->absX[i] = _mm_set1_ps(Abs(plane->dir.x));
+		self->absY[i] = _mm_set1_ps(Abs(plane->dir.y));
+		self->absZ[i] = _mm_set1_ps(Abs(plane->dir.z));
+	}
+}
+
+static inline __m128 Simd_MulAdd(__m128 a, __m128 b, __m128 c)
+{
+#if SIMD_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+static inline __m128 Simd_PlaneDist(const SimdPlanes* planes, int32 i, __m128 x, __m128 y, __m128 z)
+{
+	__m128 dist = Simd_MulAdd(z, planes->z[i], Simd_MulAdd(y, planes->y[i], _mm_mul_ps(x, planes->x[i])));
+	return _mm_sub_ps(dist, planes->dist[i]);
+}
+
+#if SIMD_AVX
+typedef struct SimdPlanes256
+{
+	__m256 x[FrustumPlane_Count];
+	__m256 y[FrustumPlane_Count];
+	__m256 z[FrustumPlane_Count];
+	__m256 dist[FrustumPlane_Count];
+	__m256 absX[FrustumPlane_Count];
+	__m256 absY[FrustumPlane_Count];
+	__m256 absZ[FrustumPlane_Count];
+} SimdPlanes256;
+
+static inline void SimdPlanes256_Init(SimdPlanes256* self, const Frustum* frustum)
+{
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		const Plane* plane = &frustum->planes[i];
+		self->x[i] = _mm256_set1_ps(plane->dir.x);
+		self->y[i] = _mm256_set1_ps(plane->dir.y);
+		self->z[i] = _mm256_set1_ps(plane->dir.z);
+		self->dist[i] = _mm256_set1_ps(plane->dist);
+		self->absX[i] = _mm256_set1_ps(Abs(plane->dir.x));
+		self->absY[i] = _mm256_set1_ps(Abs(plane->dir.y));
+		self->absZ[i] = _mm256_set1_ps(Abs(plane->dir.z));
+	}
+}
+
+static inline __m256 Simd_MulAdd256(__m256 a, __m256 b, __m256 c)
+{
+#if SIMD_FMA
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+static inline __m256 Simd_PlaneDist256(const SimdPlanes256* planes, int32 i, __m256 x, __m256 y, __m256 z)
+{
+	__m256 dist = Simd_MulAdd256(z, planes->z[i], Simd_MulAdd256(y, planes->y[i], _mm256_mul_ps(x, planes->x[i])));
+	return _mm256_sub_ps(dist, planes->dist[i]);
+}
+#endif
+#endif
+
+static int32 CullSpheresRange(const Frustum* self, const SphereSoA* spheres, int32 start, int32 count, int32* outIndices)
+{
+	const float* centerX = spheres->center.x;
+	const float* centerY = spheres->center.y;
+	const float* centerZ = spheres->center.z;
+	const float* radius = spheres->radius;
+	int32 end = start+count;
+	int32 outCount = 0;
+	int32 i = start;
+
+#if SIMD_AVX
+	SimdPlanes256 planes;
+	SimdPlanes256_Init(&planes, self);
+	for (; i+8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(centerX+i);
+		__m256 y = _mm256_loadu_ps(centerY+i);
+		__m256 z = _mm256_loadu_ps(centerZ+i);
+		__m256 minDist = Simd_PlaneDist256(&planes, 0, x, y, z);
+		for (int32 p = 1; p < FrustumPlane_Count; p++)
+		{
+			minDist = _mm256_min_ps(minDist, Simd_PlaneDist256(&planes, p, x, y, z));
+		}
+		__m256 visible = _mm256_cmp_ps(_mm256_add_ps(minDist, _mm256_loadu_ps(radius+i)), _mm256_setzero_ps(), _CMP_GE_OQ);
+		outCount = AppendVisible(outIndices, outCount, i, (uint32)_mm256_movemask_ps(visible), 8);
+	}
+#elif SIMD_SSE2
+	SimdPlanes planes;
+	SimdPlanes_Init(&planes, self);
+	for (; i+4 <= end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(centerX+i);
+		__m128 y = _mm_loadu_ps(centerY+i);
+		__m128 z = _mm_loadu_ps(centerZ+i);
+		__m128 minDist = Simd_PlaneDist(&planes, 0, x, y, z);
+		for (int32 p = 1; p < FrustumPlane_Count; p++)
+		{
+			minDist = _mm_min_ps(minDist, Simd_PlaneDist(&planes, p, x, y, z));
+		}
+		__m128 visible = _mm_cmpge_ps(_mm_add_ps(minDist, _mm_loadu_ps(radius+i)), _mm_setzero_ps());
+		outCount = AppendVisible(outIndices, outCount, i, (uint32)_mm_movemask_ps(visible), 4);
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		outIndices[outCount] = i;
+		outCount += MinPlaneDist(self, centerX[i], centerY[i], centerZ[i])+radius[i] >= 0;
+	}
+	return outCount;
+}
+
+static int32 CullAabbsRange(const Frustum* self, const AabbSoA* aabbs, int32 start, int32 count, int32* outIndices)
+{
+	const float* centerX = aabbs->center.x;
+	const float* centerY = aabbs->center.y;
+	const float* centerZ = aabbs->center.z;
+	const float* extentX = aabbs->extent.x;
+	const float* extentY = aabbs->extent.y;
+	const float* extentZ = aabbs->extent.z;
+	int32 end = start+count;
+	int32 outCount = 0;
+	int32 i = start;
+
+#if SIMD_AVX
+	SimdPlanes256 planes;
+	SimdPlanes256_Init(&planes, self);
+	for (; i+8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(centerX+i);
+		__m256 y = _mm256_loadu_ps(centerY+i);
+		__m256 z = _mm256_loadu_ps(centerZ+i);
+		__m256 ex = _mm256_loadu_ps(extentX+i);
+		__m256 ey = _mm256_loadu_ps(extentY+i);
+		__m256 ez = _mm256_loadu_ps(extentZ+i);
+		__m256 minDist = _mm256_set1_ps(FloatMax);
+		for (int32 p = 0; p < FrustumPlane_Count; p++)
+		{
+			__m256 reach = Simd_MulAdd256(ez, planes.absZ[p], Simd_MulAdd256(ey, planes.absY[p], _mm256_mul_ps(ex, planes.absX[p])));
+			minDist = _mm256_min_ps(minDist, _mm256_add_ps(Simd_PlaneDist256(&planes, p, x, y, z), reach));
+		}
+		__m256 visible = _mm256_cmp_ps(minDist, _mm256_setzero_ps(), _CMP_GE_OQ);
+		outCount = AppendVisible(outIndices, outCount, i, (uint32)_mm256_movemask_ps(visible), 8);
+	}
+#elif SIMD_SSE2
+	SimdPlanes planes;
+	SimdPlanes_Init(&planes, self);
+	for (; i+4 <= end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(centerX+i);
+		__m128 y = _mm_loadu_ps(centerY+i);
+		__m128 z = _mm_loadu_ps(centerZ+i);
+		__m128 ex = _mm_loadu_ps(extentX+i);
+		__m128 ey = _mm_loadu_ps(extentY+i);
+		__m128 ez = _mm_loadu_ps(extentZ+i);
+		__m128 minDist = _mm_set1_ps(FloatMax);
+		for (int32 p = 0; p < FrustumPlane_Count; p++)
+		{
+			__m128 reach = Simd_MulAdd(ez, planes.absZ[p], Simd_MulAdd(ey, planes.absY[p], _mm_mul_ps(ex, planes.absX[p])));
+			minDist = _mm_min_ps(minDist, _mm_add_ps(Simd_PlaneDist(&planes, p, x, y, z), reach));
+		}
+		__m128 visible = _mm_cmpge_ps(minDist, _mm_setzero_ps());
+		outCount = AppendVisible(outIndices, outCount, i, (uint32)_mm_movemask_ps(visible), 4);
+	}
+#endif
+
+	for (; i < end; i++)
+	{
+		outIndices[outCount] = i;
+		outCount += MinPlaneDistAabb(self, centerX[i], centerY[i], centerZ[i], extentX[i], extentY[i], extentZ[i]) >= 0;
+	}
+	return outCount;
+}
+
+int32 Frustum_CullSpheres(const Frustum* self, const SphereSoA* spheres, int32 count, int32* outIndices)
+{
+	return CullSpheresRange(self, spheres, 0, count, outIndices);
+}
+
+int32 Frustum_CullAabbs(const Frustum* self, const AabbSoA* aabbs, int32 count, int32* outIndices)
+{
+	return CullAabbsRange(self, aabbs, 0, count, outIndices);
+}
+
+typedef struct CullJob
+{
+	const Frustum* frustum;
+	// exactly one of these is used.
+	const SphereSoA* spheres;
+	const AabbSoA* aabbs;
+	int32* outIndices;
+	int32 chunkStarts[Thread_MaxParallelForChunks];
+	int32 chunkCounts[Thread_MaxParallelForChunks];
+} CullJob;
+
+static void CullJob_Run(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	// each chunk writes into its own part of outIndices, they're packed together afterwards.
+	CullJob* job = (CullJob*)userData;
+	int32* outIndices = job->outIndices+start;
+	job->chunkStarts[chunkIndex] = (int32)start;
+	if (job->spheres)
+	{
+		job->chunkCounts[chunkIndex] = CullSpheresRange(job->frustum, job->spheres, (int32)start, (int32)count, outIndices);
+	}
+	else
+	{
+		job->chunkCounts[chunkIndex] = CullAabbsRange(job->frustum, job->aabbs, (int32)start, (int32)count, outIndices);
+	}
+}
+
+static int32 CullJob_RunAll(CullJob* job, int32 count, int32 threadCount)
+{
+	int32 chunkCount = Thread_ParallelFor(count, threadCount, Frustum_MinObjectsPerThread, Frustum_ChunkAlignment, CullJob_Run, job);
+	int32 outCount = 0;
+	for (int32 i = 0; i < chunkCount; i++)
+	{
+		if (job->chunkStarts[i] != outCount)
+		{
+			MemMove(job->outIndices+outCount, job->outIndices+job->chunkStarts[i], job->chunkCounts[i]*sizeof(int32));
+		}
+		outCount += job->chunkCounts[i];
+	}
+	return outCount;
+}
+
+int32 Frustum_CullSpheresParallel(const Frustum* self, const SphereSoA* spheres, int32 count, int32* outIndices, int32 threadCount)
+{
+	CullJob job;
+	job.frustum = self;
+	job.spheres = spheres;
+	job.aabbs = null;
+	job.outIndices = outIndices;
+	return CullJob_RunAll(&job, count, threadCount);
+}
+
+int32 Frustum_CullAabbsParallel(const Frustum* self, const AabbSoA* aabbs, int32 count, int32* outIndices, int32 threadCount)
+{
+	CullJob job;
+	job.frustum = self;
+	job.spheres = null;
+	job.aabbs = aabbs;
+	job.outIndices = outIndices;
+	return CullJob_RunAll(&job, count, threadCount);
+}
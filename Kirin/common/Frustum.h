@@ -0,0 +1,73 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Space.h"
+#include "common/SpaceBatch.h"
+#include "common/View.h"
+
+typedef enum FrustumPlane
+{
+	FrustumPlane_Left,
+	FrustumPlane_Right,
+	FrustumPlane_Bottom,
+	FrustumPlane_Top,
+	FrustumPlane_Near,
+	FrustumPlane_Far,
+	FrustumPlane_Count,
+} FrustumPlane;
+
+static const char* FrustumPlane_ToString(FrustumPlane value)
+{
+	switch (value) {
+	case FrustumPlane_Left: return "FrustumPlane_Left"; break;
+	case FrustumPlane_Right: return "FrustumPlane_Right"; break;
+	case FrustumPlane_Bottom: return "FrustumPlane_Bottom"; break;
+	case FrustumPlane_Top: return "FrustumPlane_Top"; break;
+	case FrustumPlane_Near: return "FrustumPlane_Near"; break;
+	case FrustumPlane_Far: return "FrustumPlane_Far"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(FrustumPlane_Count == 6, "enum has changed.");
+}
+
+// planes face inwards, Plane_DistToPoint is positive inside.
+typedef struct Frustum
+{
+	Plane planes[FrustumPlane_Count];
+} Frustum;
+
+// bounding spheres as structure of arrays, each array holds count floats.
+typedef struct SphereSoA
+{
+	Vec3SoA center;
+	float* radius;
+} SphereSoA;
+
+// axis aligned boxes as center and half size, structure of arrays.
+typedef struct AabbSoA
+{
+	Vec3SoA center;
+	Vec3SoA extent;
+} AabbSoA;
+
+// below this many objects per thread the parallel versions don't bother with threads.
+#define Frustum_MinObjectsPerThread (64*1024)
+
+// cameraToWorld places the camera in the world, x forward, y right, z up like everything else. it has to be rigid.
+// ortho views span 1/xScale by 1/yScale around the camera's x axis, the same area View_WorldToView maps onto the screen.
+Frustum Frustum_FromView(const View* view, const Transformer* cameraToWorld, float near, float far);
+// extracts the planes from a world to clip matrix applied to row vectors, with -w to w clip depth like Matrix4_CreatePerspectiveMatrix.
+// planes are named after clip space, -w <= y is the bottom.
+Frustum Frustum_FromMatrix4(const Matrix4* worldToClip);
+
+// the tests are conservative, objects just outside a corner of the frustum can pass.
+bool Frustum_TestSphere(const Frustum* self, const Vec3 center, float radius);
+bool Frustum_TestAabb(const Frustum* self, const Vec3 center, const Vec3 extent);
+
+// writes the indices of the objects that pass the test to outIndices in increasing order and returns how many there are.
+// outIndices needs room for count indices.
+int32 Frustum_CullSpheres(const Frustum* self, const SphereSoA* spheres, int32 count, int32* outIndices);
+int32 Frustum_CullAabbs(const Frustum* self, const AabbSoA* aabbs, int32 count, int32* outIndices);
+// same results as above. threadCount <= 0 uses every hardware thread.
+int32 Frustum_CullSpheresParallel(const Frustum* self, const SphereSoA* spheres, int32 count, int32* outIndices, int32 threadCount);
+int32 Frustum_CullAabbsParallel(const Frustum* self, const AabbSoA* aabbs, int32 count, int32* outIndices, int32 threadCount);
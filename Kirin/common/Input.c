@@ -61,7 +61,7 @@ void Input_ClearFrameStatesAndDependents(InputState* state)
 	}
 }
 
-static DependentHandleKeyboardInput(InputState* state, InputState* dependentState, Keycode keycode, bool value)
+static void DependentHandleKeyboardInput(InputState* state, InputState* dependentState, Keycode keycode, bool value)
 {
 	dependentState->keyStates[(int32)keycode] = state->keyStates[(int32)keycode];
 	if (value)
@@ -197,7 +197,7 @@ float Input_GetMouseWheelTickScalerY()
 	return 3;
 }
 
-static DependentHandleMouseButtonEvent(InputState* state, InputState* dependentState, int32 button, bool value)
+static void DependentHandleMouseButtonEvent(InputState* state, InputState* dependentState, int32 button, bool value)
 {
 	dependentState->mouseButtonStates[button] = state->mouseButtonStates[button];
 	if (value)
@@ -0,0 +1,1057 @@
+#include "common/Log.h"
+
+#include "common/CString.h"
+#include "common/File.h"
+#include "common/Math.h"
+#include "common/Thread.h"
+#include "common/Time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+
+// how long the flush thread sleeps between drains. 2 miliseconds.
+#define Log_FlushIntervalTicks 20000
+// records that don't fit are formatted and written right away on the calling thread.
+#define Log_MaxRecordSize (Log_ThreadBufferSize/4)
+#define Log_MaxSpecLength 32
+#define Log_ArgAlignment 8
+
+static_assert((Log_ThreadBufferSize & (Log_ThreadBufferSize-1)) == 0, "Log_ThreadBufferSize must be a power of 2.");
+
+typedef enum LogRecordType
+{
+	LogRecordType_Padding,
+	LogRecordType_Format,
+	LogRecordType_Text,
+} LogRecordType;
+
+// records are written at 8 byte aligned offsets. padding records only ever write size and type since they can be as small as 8 bytes.
+typedef struct LogRecordHeader
+{
+	uint32 size;
+	uint8 type;
+	uint8 level;
+	uint8 category;
+	uint8 pad;
+	uint64 cycles;
+	const char* format;
+} LogRecordHeader;
+
+typedef enum LogArgType
+{
+	LogArgType_None,
+	LogArgType_Int,
+	LogArgType_Long,
+	LogArgType_LongLong,
+	LogArgType_SizeT,
+	LogArgType_PtrDiff,
+	LogArgType_IntMax,
+	LogArgType_Double,
+	LogArgType_LongDouble,
+	LogArgType_Pointer,
+	LogArgType_String,
+	LogArgType_WideString,
+	// %n. the argument is consumed but nothing is written.
+	LogArgType_Ignored,
+} LogArgType;
+
+typedef struct LogSpec
+{
+	// includes the '%'.
+	int32 length;
+	int32 starCount;
+	LogArgType type;
+} LogSpec;
+
+// single producer (the owning thread), single consumer (whoever holds consumerMutex).
+typedef struct LogThreadBuffer
+{
+	volatile uint32 writeOffset;
+	// keep the producer and consumer offsets on separate cache lines.
+	uint8 pad0[60];
+	volatile uint32 readOffset;
+	uint8 pad1[60];
+	// set when the owning thread exits. the next drain that empties the buffer frees it.
+	volatile uint32 retired;
+	struct LogThreadBuffer* next;
+	uint64 data[Log_ThreadBufferSize/sizeof(uint64)];
+} LogThreadBuffer;
+
+static volatile uint32 running;
+static volatile uint32 minLevel = LogLevel_Debug;
+static volatile uint32 categoryMask = 0xffffffff;
+static volatile int32 droppedCount;
+static int32 reportedDroppedCount;
+
+// bumped whenever the buffers are freed so threads know their cached buffer is gone.
+static volatile uint32 generation = 1;
+// threads that may be using their buffer right now, counted in the slot of the epoch they started in.
+// Log_Free moves to the next epoch and only waits for the previous slot to empty, so threads that keep logging while
+// it waits can't hold it up.
+static volatile uint32 producerEpoch;
+static volatile int32 activeProducers[2];
+static ThreadLocal LogThreadBuffer* threadBuffer;
+static ThreadLocal uint32 threadBufferGeneration;
+static ThreadLocal bool threadExitRegistered;
+static ThreadLocal uint64 threadScratch[Log_MaxRecordSize/sizeof(uint64)];
+static Mutex registryMutex;
+static LogThreadBuffer* firstThreadBuffer;
+
+static Mutex consumerMutex;
+static char* formatBuffer;
+static int32 formatBufferCapacity;
+
+static Thread flushThread;
+static volatile uint32 flushThreadStopRequested;
+
+static void ConsoleSinkWrite(LogSink* self, LogLevel level, LogCategory category, const char* text, int32 length)
+{
+	Unused(self);
+	Unused(level);
+	Unused(category);
+	fwrite(text, 1, (size_t)length, stdout);
+}
+
+static void ConsoleSinkFlush(LogSink* self)
+{
+	Unused(self);
+	fflush(stdout);
+}
+
+static LogSink consoleSink = {
+	.write = ConsoleSinkWrite,
+	.flush = ConsoleSinkFlush,
+};
+static int32 sinkCount = 1;
+static LogSink* sinks[Log_MaxSinks] = { &consoleSink };
+
+static void FileSinkWrite(LogSink* self, LogLevel level, LogCategory category, const char* text, int32 length)
+{
+	Unused(level);
+	Unused(category);
+	File_WriteBinary((File*)self->userData, (const uint8*)text, length);
+}
+
+static void FileSinkFlush(LogSink* self)
+{
+	File_Flush((File*)self->userData);
+}
+
+static int32 AlignArg(int32 offset)
+{
+	return (offset+Log_ArgAlignment-1) & ~(Log_ArgAlignment-1);
+}
+
+static bool IsFlagChar(char c)
+{
+	return c == '-' || c == '+' || c == ' ' || c == '#' || c == '0' || c == '\'';
+}
+
+// p points at a '%'. a spec with type LogArgType_None is copied through as text, that covers "%%" too.
+static const char* ParseSpec(const char* p, LogSpec* out)
+{
+	const char* start = p;
+	p++;
+
+	out->starCount = 0;
+	out->type = LogArgType_None;
+
+	while (IsFlagChar(*p))
+	{
+		p++;
+	}
+
+	if (*p == '*')
+	{
+		out->starCount++;
+		p++;
+	}
+	while (IsDigit(*p))
+	{
+		p++;
+	}
+	if (*p == '.')
+	{
+		p++;
+		if (*p == '*')
+		{
+			out->starCount++;
+			p++;
+		}
+		while (IsDigit(*p))
+		{
+			p++;
+		}
+	}
+
+	LogArgType intType = LogArgType_Int;
+	bool wide = false;
+	bool longDouble = false;
+	switch (*p)
+	{
+	case 'h':
+		p++;
+		if (*p == 'h')
+		{
+			p++;
+		}
+		break;
+	case 'l':
+		p++;
+		wide = true;
+		intType = LogArgType_Long;
+		if (*p == 'l')
+		{
+			p++;
+			intType = LogArgType_LongLong;
+		}
+		break;
+	case 'j':
+		p++;
+		intType = LogArgType_IntMax;
+		break;
+	case 'z':
+		p++;
+		intType = LogArgType_SizeT;
+		break;
+	case 't':
+		p++;
+		intType = LogArgType_PtrDiff;
+		break;
+	case 'L':
+		p++;
+		longDouble = true;
+		break;
+	case 'I':
+		// msvc length modifiers.
+		p++;
+		if (p[0] == '6' && p[1] == '4')
+		{
+			p += 2;
+			intType = LogArgType_LongLong;
+		}
+		else if (p[0] == '3' && p[1] == '2')
+		{
+			p += 2;
+		}
+		else
+		{
+			intType = LogArgType_SizeT;
+		}
+		break;
+	default:
+		break;
+	}
+
+	char conversion = *p;
+	if (conversion)
+	{
+		p++;
+	}
+
+	switch (conversion)
+	{
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		out->type = intType;
+		break;
+	case 'c':
+	case 'C':
+		// char and wint_t are both promoted to int.
+		out->type = LogArgType_Int;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		out->type = longDouble ? LogArgType_LongDouble : LogArgType_Double;
+		break;
+	case 'p':
+		out->type = LogArgType_Pointer;
+		break;
+	case 's':
+		out->type = wide ? LogArgType_WideString : LogArgType_String;
+		break;
+	case 'S':
+		out->type = LogArgType_WideString;
+		break;
+	case 'n':
+		out->type = LogArgType_Ignored;
+		break;
+	default:
+		break;
+	}
+
+	out->length = (int32)(p-start);
+	return p;
+}
+
+// copies the arguments described by format into dest. returns the number of bytes written or -1 if they don't fit.
+static int32 EncodeArgs(uint8* dest, int32 capacity, const char* format, va_list args)
+{
+	int32 offset = 0;
+	const char* p = format;
+	while (*p)
+	{
+		if (*p != '%')
+		{
+			p++;
+			continue;
+		}
+
+		LogSpec spec;
+		p = ParseSpec(p, &spec);
+		if (spec.type == LogArgType_None)
+		{
+			continue;
+		}
+
+		for (int32 i = 0; i < spec.starCount; i++)
+		{
+			if (offset+Log_ArgAlignment > capacity)
+			{
+				return -1;
+			}
+			int32 star = va_arg(args, int);
+			MemCpy(dest+offset, &star, sizeof(int32));
+			offset += Log_ArgAlignment;
+		}
+
+		int64 intValue = 0;
+		double doubleValue = 0;
+		bool isDouble = false;
+		switch (spec.type)
+		{
+		case LogArgType_Int: intValue = va_arg(args, int); break;
+		case LogArgType_Long: intValue = va_arg(args, long); break;
+		case LogArgType_LongLong: intValue = va_arg(args, long long); break;
+		case LogArgType_SizeT: intValue = (int64)va_arg(args, size_t); break;
+		case LogArgType_PtrDiff: intValue = va_arg(args, ptrdiff_t); break;
+		case LogArgType_IntMax: intValue = va_arg(args, intmax_t); break;
+		case LogArgType_Pointer: intValue = (int64)(size_t)va_arg(args, void*); break;
+		case LogArgType_Ignored: va_arg(args, void*); continue;
+		case LogArgType_Double: doubleValue = va_arg(args, double); isDouble = true; break;
+		// stored as a double, the extra precision is lost.
+		case LogArgType_LongDouble: doubleValue = (double)va_arg(args, long double); isDouble = true; break;
+		case LogArgType_String:
+		case LogArgType_WideString:
+		{
+			int32 charSize = spec.type == LogArgType_String ? (int32)sizeof(char) : (int32)sizeof(wchar_t);
+			const void* str = spec.type == LogArgType_String ? (const void*)va_arg(args, const char*) : (const void*)va_arg(args, const wchar_t*);
+			// -1 marks a null string.
+			int32 length = -1;
+			if (str)
+			{
+				int64 fullLength = spec.type == LogArgType_String ? StrLen((const char*)str) : StrLenW((const wchar_t*)str);
+				if (fullLength > capacity)
+				{
+					return -1;
+				}
+				length = (int32)fullLength;
+			}
+			int32 byteCount = MaxI(length, 0)*charSize;
+			int32 needed = Log_ArgAlignment+byteCount+charSize;
+			if (offset+needed > capacity)
+			{
+				return -1;
+			}
+			MemCpy(dest+offset, &length, sizeof(int32));
+			offset += Log_ArgAlignment;
+			if (byteCount > 0)
+			{
+				MemCpy(dest+offset, str, byteCount);
+			}
+			MemSet(dest+offset+byteCount, 0, charSize);
+			offset = AlignArg(offset+byteCount+charSize);
+			continue;
+		}
+		default:
+			continue;
+		}
+
+		if (offset+Log_ArgAlignment > capacity)
+		{
+			return -1;
+		}
+		if (isDouble)
+		{
+			MemCpy(dest+offset, &doubleValue, sizeof(double));
+		}
+		else
+		{
+			MemCpy(dest+offset, &intValue, sizeof(int64));
+		}
+		offset += Log_ArgAlignment;
+	}
+	return offset;
+}
+
+static void EnsureFormatCapacity(int32 capacity)
+{
+	if (capacity > formatBufferCapacity)
+	{
+		formatBufferCapacity = MaxI(capacity, formatBufferCapacity*2);
+		// not tracked by MAlloc. it lives for the whole process and is still used by Error after leak detection has run.
+		formatBuffer = (char*)realloc(formatBuffer, formatBufferCapacity);
+		if (!formatBuffer)
+		{
+			abort();
+		}
+	}
+}
+
+#define FormatWithStars(value) \
+	(starCount == 0 ? snprintf(dest, capacity, spec, value) : \
+	starCount == 1 ? snprintf(dest, capacity, spec, stars[0], value) : \
+	snprintf(dest, capacity, spec, stars[0], stars[1], value))
+
+static int32 FormatArg(char* dest, size_t capacity, const char* spec, int32 starCount, const int32* stars, LogArgType type, const uint8* value)
+{
+	int64 intValue;
+	double doubleValue;
+	MemCpy(&intValue, value, sizeof(int64));
+	MemCpy(&doubleValue, value, sizeof(double));
+
+	switch (type)
+	{
+	case LogArgType_Int: return FormatWithStars((int)intValue);
+	case LogArgType_Long: return FormatWithStars((long)intValue);
+	case LogArgType_LongLong: return FormatWithStars((long long)intValue);
+	case LogArgType_SizeT: return FormatWithStars((size_t)intValue);
+	case LogArgType_PtrDiff: return FormatWithStars((ptrdiff_t)intValue);
+	case LogArgType_IntMax: return FormatWithStars((intmax_t)intValue);
+	case LogArgType_Pointer: return FormatWithStars((void*)(size_t)intValue);
+	case LogArgType_Double: return FormatWithStars(doubleValue);
+	case LogArgType_LongDouble: return FormatWithStars((long double)doubleValue);
+	case LogArgType_String:
+	{
+		int32 length;
+		MemCpy(&length, value, sizeof(int32));
+		return FormatWithStars(length < 0 ? (const char*)null : (const char*)(value+Log_ArgAlignment));
+	}
+	case LogArgType_WideString:
+	{
+		int32 length;
+		MemCpy(&length, value, sizeof(int32));
+		return FormatWithStars(length < 0 ? (const wchar_t*)null : (const wchar_t*)(value+Log_ArgAlignment));
+	}
+	default:
+		return 0;
+	}
+}
+
+#undef FormatWithStars
+
+static void AppendText(int32* length, const char* text, int32 count)
+{
+	EnsureFormatCapacity(*length+count+1);
+	MemCpy(formatBuffer+*length, text, count);
+	*length += count;
+	formatBuffer[*length] = 0;
+}
+
+// formats a record into formatBuffer. must hold consumerMutex. returns the text length.
+static int32 FormatRecord(const LogRecordHeader* header)
+{
+	const uint8* payload = (const uint8*)header+sizeof(LogRecordHeader);
+	int32 length = 0;
+	EnsureFormatCapacity(256);
+	formatBuffer[0] = 0;
+
+	if (header->type == LogRecordType_Text)
+	{
+		int32 textLength;
+		MemCpy(&textLength, payload, sizeof(int32));
+		AppendText(&length, (const char*)payload+Log_ArgAlignment, textLength);
+		return length;
+	}
+
+	int32 argOffset = 0;
+	const char* p = header->format;
+	while (*p)
+	{
+		const char* runStart = p;
+		while (*p && *p != '%')
+		{
+			p++;
+		}
+		if (p != runStart)
+		{
+			AppendText(&length, runStart, (int32)(p-runStart));
+		}
+		if (!*p)
+		{
+			break;
+		}
+
+		const char* specStart = p;
+		LogSpec spec;
+		p = ParseSpec(p, &spec);
+		if (spec.type == LogArgType_None || spec.length >= Log_MaxSpecLength)
+		{
+			if (spec.length == 2 && specStart[1] == '%')
+			{
+				AppendText(&length, "%", 1);
+			}
+			else
+			{
+				AppendText(&length, specStart, spec.length);
+			}
+			continue;
+		}
+
+		int32 stars[2] = { 0 };
+		for (int32 i = 0; i < spec.starCount; i++)
+		{
+			MemCpy(&stars[i], payload+argOffset, sizeof(int32));
+			argOffset += Log_ArgAlignment;
+		}
+
+		if (spec.type == LogArgType_Ignored)
+		{
+			continue;
+		}
+
+		char specString[Log_MaxSpecLength];
+		MemCpy(specString, specStart, spec.length);
+		specString[spec.length] = 0;
+
+		const uint8* value = payload+argOffset;
+		int32 available = formatBufferCapacity-length;
+		int32 written = FormatArg(formatBuffer+length, available, specString, spec.starCount, stars, spec.type, value);
+		if (written >= available)
+		{
+			EnsureFormatCapacity(length+written+1);
+			written = FormatArg(formatBuffer+length, formatBufferCapacity-length, specString, spec.starCount, stars, spec.type, value);
+		}
+		if (written > 0)
+		{
+			length += written;
+		}
+
+		if (spec.type == LogArgType_String || spec.type == LogArgType_WideString)
+		{
+			int32 charSize = spec.type == LogArgType_String ? (int32)sizeof(char) : (int32)sizeof(wchar_t);
+			int32 stringLength;
+			MemCpy(&stringLength, value, sizeof(int32));
+			argOffset = AlignArg(argOffset+Log_ArgAlignment+MaxI(stringLength, 0)*charSize+charSize);
+		}
+		else
+		{
+			argOffset += Log_ArgAlignment;
+		}
+	}
+
+	return length;
+}
+
+// must hold consumerMutex.
+static void WriteTextToSinks(LogLevel level, LogCategory category, const char* text, int32 length)
+{
+	for (int32 i = 0; i < sinkCount; i++)
+	{
+		sinks[i]->write(sinks[i], level, category, text, length);
+	}
+}
+
+// must hold consumerMutex.
+static void WriteToSinks(const LogRecordHeader* header)
+{
+	int32 length = FormatRecord(header);
+	WriteTextToSinks((LogLevel)header->level, (LogCategory)header->category, formatBuffer, length);
+}
+
+// threads come and go, with Thread_ParallelFor a few per call, so their buffers can't live until Log_Free.
+static void RetireThreadBuffer(void* userData)
+{
+	Unused(userData);
+	Mutex_Lock(&registryMutex);
+	// a buffer from before the last Log_Free is already gone.
+	if (threadBuffer && threadBufferGeneration == generation)
+	{
+		Atomic_StoreRelease32(&threadBuffer->retired, true);
+	}
+	Mutex_Unlock(&registryMutex);
+	// anything the thread still logs after this goes to a new buffer, which lives until Log_Free.
+	threadBuffer = null;
+}
+
+static LogThreadBuffer* GetThreadBuffer()
+{
+	uint32 currentGeneration = Atomic_LoadAcquire32(&generation);
+	if (threadBuffer && threadBufferGeneration == currentGeneration)
+	{
+		return threadBuffer;
+	}
+
+	LogThreadBuffer* buffer = (LogThreadBuffer*)MAlloc(sizeof(LogThreadBuffer));
+	MemSet(buffer, 0, sizeof(LogThreadBuffer) - sizeof(buffer->data));
+
+	Mutex_Lock(&registryMutex);
+	buffer->next = firstThreadBuffer;
+	firstThreadBuffer = buffer;
+	Mutex_Unlock(&registryMutex);
+
+	threadBuffer = buffer;
+	threadBufferGeneration = currentGeneration;
+	if (!threadExitRegistered)
+	{
+		threadExitRegistered = true;
+		Thread_AtExit(RetireThreadBuffer, null);
+	}
+	return buffer;
+}
+
+// copies a finished record into the calling thread's ring. never blocks, returns false if there's no room.
+static bool PushRecord(const uint8* record, uint32 size)
+{
+	LogThreadBuffer* buffer = GetThreadBuffer();
+	uint8* data = (uint8*)buffer->data;
+
+	uint32 write = buffer->writeOffset;
+	uint32 read = Atomic_LoadAcquire32(&buffer->readOffset);
+	uint32 position = write & (Log_ThreadBufferSize-1);
+	uint32 contiguous = Log_ThreadBufferSize-position;
+	uint32 needed = contiguous < size ? size+contiguous : size;
+
+	if ((write-read)+needed > Log_ThreadBufferSize)
+	{
+		return false;
+	}
+
+	if (contiguous < size)
+	{
+		LogRecordHeader* padding = (LogRecordHeader*)(data+position);
+		padding->size = contiguous;
+		padding->type = LogRecordType_Padding;
+		write += contiguous;
+		position = 0;
+	}
+
+	MemCpy(data+position, record, size);
+	Atomic_StoreRelease32(&buffer->writeOffset, write+size);
+	return true;
+}
+
+// returns the oldest unread record in buffer, skipping padding, or null.
+static LogRecordHeader* PeekRecord(LogThreadBuffer* buffer)
+{
+	uint8* data = (uint8*)buffer->data;
+	uint32 read = buffer->readOffset;
+	uint32 write = Atomic_LoadAcquire32(&buffer->writeOffset);
+	while (read != write)
+	{
+		LogRecordHeader* header = (LogRecordHeader*)(data+(read & (Log_ThreadBufferSize-1)));
+		if (header->type != LogRecordType_Padding)
+		{
+			if (read != buffer->readOffset)
+			{
+				Atomic_StoreRelease32(&buffer->readOffset, read);
+			}
+			return header;
+		}
+		read += header->size;
+	}
+	if (read != buffer->readOffset)
+	{
+		Atomic_StoreRelease32(&buffer->readOffset, read);
+	}
+	return null;
+}
+
+// must hold consumerMutex.
+static void DrainThreadBuffers()
+{
+	Mutex_Lock(&registryMutex);
+	LogThreadBuffer* first = firstThreadBuffer;
+	Mutex_Unlock(&registryMutex);
+
+	// merge the per thread streams by timestamp so output from different threads stays in order.
+	while (true)
+	{
+		LogThreadBuffer* oldestBuffer = null;
+		LogRecordHeader* oldest = null;
+		for (LogThreadBuffer* buffer = first; buffer; buffer = buffer->next)
+		{
+			LogRecordHeader* header = PeekRecord(buffer);
+			if (header && (!oldest || header->cycles < oldest->cycles))
+			{
+				oldest = header;
+				oldestBuffer = buffer;
+			}
+		}
+
+		if (!oldest)
+		{
+			break;
+		}
+
+		WriteToSinks(oldest);
+		Atomic_StoreRelease32(&oldestBuffer->readOffset, oldestBuffer->readOffset+oldest->size);
+	}
+
+	// the buffers of threads that have exited go once they're empty. a thread that exits after its buffer was checked
+	// above may have written more since, the read offset is behind then and the buffer waits for the next drain.
+	Mutex_Lock(&registryMutex);
+	LogThreadBuffer** link = &firstThreadBuffer;
+	while (*link)
+	{
+		LogThreadBuffer* buffer = *link;
+		if (Atomic_LoadAcquire32(&buffer->retired) && buffer->readOffset == Atomic_LoadAcquire32(&buffer->writeOffset))
+		{
+			*link = buffer->next;
+			MFree(buffer);
+		}
+		else
+		{
+			link = &buffer->next;
+		}
+	}
+	Mutex_Unlock(&registryMutex);
+
+	int32 dropped = (int32)Atomic_LoadAcquire32((volatile uint32*)&droppedCount);
+	if (dropped != reportedDroppedCount)
+	{
+		char message[64];
+		SPrintF(message, sizeof(message), "log: dropped %d messages.\n", dropped-reportedDroppedCount);
+		reportedDroppedCount = dropped;
+		WriteTextToSinks(LogLevel_Warning, LogCategory_General, message, (int32)StrLen(message));
+	}
+}
+
+static void FlushSinks()
+{
+	for (int32 i = 0; i < sinkCount; i++)
+	{
+		if (sinks[i]->flush)
+		{
+			sinks[i]->flush(sinks[i]);
+		}
+	}
+}
+
+// for records written on the calling thread. what's already buffered goes out first, so the output stays in order.
+static void LockAndDrain()
+{
+	Mutex_Lock(&consumerMutex);
+	DrainThreadBuffers();
+}
+
+static void SubmitRecord(LogRecordHeader* header)
+{
+	// counting this thread as a producer before it checks running means Log_Free either waits for it, or it sees the log
+	// has stopped and doesn't touch its buffer.
+	volatile int32* producers = &activeProducers[Atomic_LoadAcquire32(&producerEpoch) & 1];
+	Atomic_Increment32(producers);
+	bool buffered = false;
+	bool dropped = false;
+	if (Atomic_LoadAcquire32(&running))
+	{
+		buffered = PushRecord((const uint8*)header, header->size);
+		// warnings and errors are never dropped, they're written right away when the buffer is full.
+		dropped = !buffered && header->level < LogLevel_Warning;
+	}
+	Atomic_Decrement32(producers);
+
+	if (dropped)
+	{
+		Atomic_Increment32(&droppedCount);
+	}
+	else if (!buffered)
+	{
+		LockAndDrain();
+		WriteToSinks(header);
+		Mutex_Unlock(&consumerMutex);
+	}
+}
+
+// for messages too big for a record.
+static void WriteFormattedNow(LogLevel level, LogCategory category, const char* format, va_list args)
+{
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	int32 length = vsnprintf(null, 0, format, argsCopy);
+	va_end(argsCopy);
+	if (length < 0)
+	{
+		return;
+	}
+
+	LockAndDrain();
+	EnsureFormatCapacity(length+1);
+	vsnprintf(formatBuffer, (size_t)length+1, format, args);
+	WriteTextToSinks(level, category, formatBuffer, length);
+	Mutex_Unlock(&consumerMutex);
+}
+
+static void FlushThreadMain(void* userData)
+{
+	Unused(userData);
+	while (!Atomic_LoadAcquire32(&flushThreadStopRequested))
+	{
+		Log_Flush();
+		SleepTicks(Log_FlushIntervalTicks);
+	}
+}
+
+void Log_Init()
+{
+	if (Atomic_LoadAcquire32(&running))
+	{
+		Error("log is already running.");
+	}
+
+	flushThreadStopRequested = false;
+	Atomic_StoreRelease32(&running, true);
+	Thread_Start(&flushThread, FlushThreadMain, null);
+}
+
+void Log_Free()
+{
+	if (!Atomic_LoadAcquire32(&running))
+	{
+		return;
+	}
+
+	Atomic_StoreRelease32(&flushThreadStopRequested, true);
+	Thread_Join(&flushThread);
+
+	// new records are written synchronously from here on. threads that saw running before it changed may still be
+	// writing to their buffer, wait for them before the buffers go away.
+	Atomic_StoreRelease32(&running, false);
+	uint32 epoch = producerEpoch;
+	Atomic_StoreRelease32(&producerEpoch, epoch+1);
+	KMemoryBarrier();
+	while (Atomic_LoadAcquire32((volatile uint32*)&activeProducers[epoch & 1]) != 0)
+	{
+		Thread_Yield();
+	}
+
+	Mutex_Lock(&consumerMutex);
+	DrainThreadBuffers();
+	FlushSinks();
+
+	Mutex_Lock(&registryMutex);
+	LogThreadBuffer* buffer = firstThreadBuffer;
+	while (buffer)
+	{
+		LogThreadBuffer* next = buffer->next;
+		MFree(buffer);
+		buffer = next;
+	}
+	firstThreadBuffer = null;
+	Atomic_StoreRelease32(&generation, generation+1);
+	Mutex_Unlock(&registryMutex);
+
+	Mutex_Unlock(&consumerMutex);
+}
+
+bool Log_IsRunning()
+{
+	return Atomic_LoadAcquire32(&running) != 0;
+}
+
+void Log_AddSink(LogSink* sink)
+{
+	Mutex_Lock(&consumerMutex);
+	if (sinkCount >= Log_MaxSinks)
+	{
+		Mutex_Unlock(&consumerMutex);
+		Error("too many log sinks.");
+	}
+	sinks[sinkCount++] = sink;
+	Mutex_Unlock(&consumerMutex);
+}
+
+void Log_RemoveSink(LogSink* sink)
+{
+	Mutex_Lock(&consumerMutex);
+	for (int32 i = 0; i < sinkCount; i++)
+	{
+		if (sinks[i] == sink)
+		{
+			if (sink->flush)
+			{
+				sink->flush(sink);
+			}
+			for (int32 j = i; j < sinkCount-1; j++)
+			{
+				sinks[j] = sinks[j+1];
+			}
+			sinkCount--;
+			break;
+		}
+	}
+	Mutex_Unlock(&consumerMutex);
+}
+
+LogSink* Log_GetConsoleSink()
+{
+	return &consoleSink;
+}
+
+bool LogSink_InitFile(LogSink* self, const char* path)
+{
+	*self = (LogSink){ 0 };
+
+	File* file = (File*)MAlloc(sizeof(File));
+	File_Init(file);
+	if (!File_Open(file, path, FileMode_Write))
+	{
+		MFree(file);
+		return false;
+	}
+
+	self->write = FileSinkWrite;
+	self->flush = FileSinkFlush;
+	self->userData = file;
+	return true;
+}
+
+void LogSink_FreeFile(LogSink* self)
+{
+	File* file = (File*)self->userData;
+	if (file)
+	{
+		File_Close(file);
+		MFree(file);
+		self->userData = null;
+	}
+}
+
+void Log_SetMinLevel(LogLevel level)
+{
+	Atomic_StoreRelease32(&minLevel, (uint32)level);
+}
+
+void Log_SetCategoryEnabled(LogCategory category, bool enabled)
+{
+	// only called from setup code, a lost update between two concurrent calls isn't a concern.
+	uint32 mask = Atomic_LoadAcquire32(&categoryMask);
+	if (enabled)
+	{
+		mask |= 1u << category;
+	}
+	else
+	{
+		mask &= ~(1u << category);
+	}
+	Atomic_StoreRelease32(&categoryMask, mask);
+}
+
+bool Log_IsEnabled(LogLevel level, LogCategory category)
+{
+	return (uint32)level >= minLevel && (categoryMask & (1u << category)) != 0;
+}
+
+void LogV(LogLevel level, LogCategory category, const char* format, va_list args)
+{
+	if (!Log_IsEnabled(level, category))
+	{
+		return;
+	}
+
+	LogRecordHeader* header = (LogRecordHeader*)threadScratch;
+	uint8* payload = (uint8*)threadScratch+sizeof(LogRecordHeader);
+	int32 payloadCapacity = Log_MaxRecordSize-(int32)sizeof(LogRecordHeader);
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	int32 payloadSize = EncodeArgs(payload, payloadCapacity, format, args);
+	if (payloadSize < 0)
+	{
+		WriteFormattedNow(level, category, format, argsCopy);
+		va_end(argsCopy);
+		return;
+	}
+	va_end(argsCopy);
+
+	header->size = (uint32)AlignArg((int32)sizeof(LogRecordHeader)+payloadSize);
+	header->type = LogRecordType_Format;
+	header->level = (uint8)level;
+	header->category = (uint8)category;
+	header->pad = 0;
+	header->cycles = GetCycles();
+	header->format = format;
+	SubmitRecord(header);
+}
+
+void LogF(LogLevel level, LogCategory category, PrintFormatStringAttribute const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(level, category, format, args);
+	va_end(args);
+}
+
+void Log_Write(LogLevel level, LogCategory category, const char* text)
+{
+	if (!Log_IsEnabled(level, category))
+	{
+		return;
+	}
+
+	LogRecordHeader* header = (LogRecordHeader*)threadScratch;
+	uint8* payload = (uint8*)threadScratch+sizeof(LogRecordHeader);
+	int32 payloadCapacity = Log_MaxRecordSize-(int32)sizeof(LogRecordHeader);
+
+	int32 length = (int32)StrLen(text);
+	if (Log_ArgAlignment+length > payloadCapacity)
+	{
+		// too big for a record.
+		LockAndDrain();
+		WriteTextToSinks(level, category, text, length);
+		Mutex_Unlock(&consumerMutex);
+		return;
+	}
+	MemCpy(payload, &length, sizeof(int32));
+	MemCpy(payload+Log_ArgAlignment, text, length);
+
+	header->size = (uint32)AlignArg((int32)sizeof(LogRecordHeader)+Log_ArgAlignment+length);
+	header->type = LogRecordType_Text;
+	header->level = (uint8)level;
+	header->category = (uint8)category;
+	header->pad = 0;
+	header->cycles = GetCycles();
+	header->format = null;
+	SubmitRecord(header);
+}
+
+void Log_Flush()
+{
+	Mutex_Lock(&consumerMutex);
+	if (Atomic_LoadAcquire32(&running))
+	{
+		DrainThreadBuffers();
+	}
+	FlushSinks();
+	Mutex_Unlock(&consumerMutex);
+}
+
+uint32 Log_GetDroppedCount()
+{
+	return Atomic_LoadAcquire32((volatile uint32*)&droppedCount);
+}
+
+int32 Log_GetThreadBufferCount()
+{
+	int32 count = 0;
+	Mutex_Lock(&registryMutex);
+	for (LogThreadBuffer* buffer = firstThreadBuffer; buffer; buffer = buffer->next)
+	{
+		count++;
+	}
+	Mutex_Unlock(&registryMutex);
+	return count;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "common/Standard.h"
+
+#include <stdarg.h>
+
+typedef enum LogLevel
+{
+	LogLevel_Debug,
+	LogLevel_Info,
+	LogLevel_Warning,
+	LogLevel_Error,
+	LogLevel_Count,
+} LogLevel;
+
+static const char* LogLevel_ToString(LogLevel value)
+{
+	switch (value) {
+	case LogLevel_Debug: return "LogLevel_Debug"; break;
+	case LogLevel_Info: return "LogLevel_Info"; break;
+	case LogLevel_Warning: return "LogLevel_Warning"; break;
+	case LogLevel_Error: return "LogLevel_Error"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(LogLevel_Count == 4, "enum has changed.");
+}
+
+typedef enum LogCategory
+{
+	LogCategory_General,
+	LogCategory_Draw,
+	LogCategory_Platform,
+	LogCategory_Input,
+	LogCategory_Count,
+} LogCategory;
+
+static const char* LogCategory_ToString(LogCategory value)
+{
+	switch (value) {
+	case LogCategory_General: return "LogCategory_General"; break;
+	case LogCategory_Draw: return "LogCategory_Draw"; break;
+	case LogCategory_Platform: return "LogCategory_Platform"; break;
+	case LogCategory_Input: return "LogCategory_Input"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(LogCategory_Count == 4, "enum has changed.");
+}
+
+typedef struct LogSink
+{
+	// text is not null terminated.
+	void (*write)(struct LogSink* self, LogLevel level, LogCategory category, const char* text, int32 length);
+	void (*flush)(struct LogSink* self);
+	void* userData;
+} LogSink;
+
+#define Log_MaxSinks 8
+// per thread ring buffer size. debug and info messages that don't fit are dropped and counted rather than blocking the
+// caller, warnings and errors are written synchronously instead.
+// every thread that logs while the log is running gets a ring, freed once the thread has exited and the ring is drained.
+// every thread that logs at all has a quarter of the ring size of thread local scratch for building records, 64KB plus
+// 16KB per thread with the default size.
+// messages bigger than the scratch are formatted and written synchronously, nothing is truncated.
+#define Log_ThreadBufferSize (64*1024)
+
+// starts the background flush thread.
+// before Log_Init and after Log_Free messages are formatted and written synchronously on the calling thread.
+void Log_Init();
+// writes out everything still buffered and stops the flush thread.
+// other threads may keep logging, Log_Free waits for the ones in the middle of buffering a message and later ones
+// write synchronously.
+void Log_Free();
+bool Log_IsRunning();
+// the console sink is added by default.
+void Log_AddSink(LogSink* sink);
+void Log_RemoveSink(LogSink* sink);
+LogSink* Log_GetConsoleSink();
+bool LogSink_InitFile(LogSink* self, const char* path);
+void LogSink_FreeFile(LogSink* self);
+
+void Log_SetMinLevel(LogLevel level);
+void Log_SetCategoryEnabled(LogCategory category, bool enabled);
+bool Log_IsEnabled(LogLevel level, LogCategory category);
+
+// arguments are copied into the calling thread's buffer and formatted later on the flush thread.
+// format is not copied, it must stay valid until it has been flushed. string literals are fine.
+// %s arguments are copied in full. %n is not supported.
+void LogF(LogLevel level, LogCategory category, PrintFormatStringAttribute const char* format, ...);
+void LogV(LogLevel level, LogCategory category, const char* format, va_list args);
+// text is copied.
+void Log_Write(LogLevel level, LogCategory category, const char* text);
+// formats and writes everything buffered so far on the calling thread.
+void Log_Flush();
+uint32 Log_GetDroppedCount();
+// rings currently allocated, one for each thread that logged and either is still running or hasn't been drained since.
+int32 Log_GetThreadBufferCount();
@@ -2,86 +2,9 @@
 #include "common/Math.h"
 
 #include <math.h>
-
-float Floor(float v)
-{
-	return floorf(v);
-}
-
-double FloorD(double v)
-{
-	return floor(v);
-}
-
-float Ceil(float v)
-{
-	return ceilf(v);
-}
-
-double CeilD(double v)
-{
-	return ceil(v);
-}
-
-float Round(float v)
-{
-	return roundf(v);
-}
-
-double RoundD(double v)
-{
-	return round(v);
-}
-
-float Abs(float v)
-{
-	return v >= 0.0f ? v : -v;
-}
-
-double AbsD(double v)
-{
-	return v >= 0.0 ? v : -v;
-}
-
-int32 AbsI(int32 v)
-{
-	return v >= 0 ? v : -v;
-}
-
-int64 AbsI64(int64 v)
-{
-	return v >= 0 ? v : -v;
-}
-
-float Sign(float v)
-{
-	return v == 0 ? 0.0f : v > 0 ? 1.0f : -1.0f;
-}
-
-double SignD(double v)
-{
-	return v == 0 ? 0.0 : v > 0 ? 1.0 : -1.0;
-}
-
-float SignBinary(float v)
-{
-	return v >= 0 ? 1.0f : -1.0f;
-}
-
-double SignBinaryD(double v)
-{
-	return v >= 0 ? 1.0 : -1.0;
-}
-
-int32 SignI(int32 v)
-{
-	return v == 0 ? 0 : v > 0 ? 1 : -1;
-}
-
-int64 SignI64(int64 v)
-{
-	return v == 0 ? 0 : v > 0 ? 1 : -1;
-}
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#endif
 
 float Pow(float a, float b)
 {
@@ -203,106 +126,6 @@ double FModD(double v0, double v1)
 	return fmod(v0, v1);
 }
 
-float Sqrt(float v)
-{
-	return sqrtf(v);
-}
-
-double SqrtD(double v)
-{
-	return sqrt(v);
-}
-
-float Max(float a, float b)
-{
-	return a > b ? a : b;
-}
-
-double MaxD(double a, double b)
-{
-	return a > b ? a : b;
-}
-
-int32 MaxI(int32 a, int32 b)
-{
-	return a > b ? a : b;
-}
-
-uint32 MaxUI(uint32 a, uint32 b)
-{
-	return a > b ? a : b;
-}
-
-int64 MaxI64(int64 a, int64 b)
-{
-	return a > b ? a : b;
-}
-
-uint64 MaxUI64(uint64 a, uint64 b)
-{
-	return a > b ? a : b;
-}
-
-float Min(float a, float b)
-{
-	return a < b ? a : b;
-}
-
-double MinD(double a, double b)
-{
-	return a < b ? a : b;
-}
-
-int32 MinI(int32 a, int32 b)
-{
-	return a < b ? a : b;
-}
-
-uint32 MinUI(uint32 a, uint32 b)
-{
-	return a < b ? a : b;
-}
-
-int64 MinI64(int64 a, int64 b)
-{
-	return a < b ? a : b;
-}
-
-uint64 MinUI64(uint64 a, uint64 b)
-{
-	return a < b ? a : b;
-}
-
-float Clamp(float v, float min, float max)
-{
-	return Min(Max(v, min), max);
-}
-
-double ClampD(double v, double min, double max)
-{
-	return MinD(MaxD(v, min), max);
-}
-
-int32 ClampI(int32 v, int32 min, int32 max)
-{
-	return MinI(MaxI(v, min), max);
-}
-
-uint32 ClampUI(uint32 v, uint32 min, uint32 max)
-{
-	return MinUI(MaxUI(v, min), max);
-}
-
-int64 ClampI64(int64 v, int64 min, int64 max)
-{
-	return MinI64(MaxI64(v, min), max);
-}
-
-uint64 ClampUI64(uint64 v, uint64 min, uint64 max)
-{
-	return MinUI64(MaxUI64(v, min), max);
-}
-
 float Wrap(float v, float max)
 {
 	return Clamp(v-Floor(v/max)*max, 0, max);
@@ -385,48 +208,25 @@ double LerpAngleD(double current, double target, double amount)
 	return current+delta*ClampD(amount, 0, 1);
 }
 
-float Lerp(float from, float to, float factor)
-{
-	factor = Clamp(factor, 0, 1);
-	return from+(to-from)*factor;
-}
-
-double LerpD(double from, double to, double factor)
-{
-	factor = ClampD(factor, 0, 1);
-	return from+(to-from)*factor;
-}
-
-float LerpUnclamped(float from, float to, float factor)
-{
-	return from+(to-from)*factor;
-}
-
-double LerpUnclampedD(double from, double to, double factor)
+int32 FloorLog2UI64(uint64 v)
 {
-	return from+(to-from)*factor;
-}
-
-float RadToDeg(float v)
-{
-	static const float scaler = 180.0f/PI32;
-	return v*scaler;
-}
-
-double RadToDegD(double v)
-{
-	static const double scaler = 180.0l/PI64;
-	return v*scaler;
-}
-
-float DegToRad(float v)
-{
-	static const float scaler = PI32/180.0f;
-	return v*scaler;
-}
-
-double DegToRadD(double v)
-{
-	static const double scaler = PI64/180.0l;
-	return v*scaler;
+	if (v == 0)
+	{
+		return -1;
+	}
+#if PLATFORM_WINDOWS && BITNESS_64
+	unsigned long index;
+	_BitScanReverse64(&index, v);
+	return (int32)index;
+#elif PLATFORM_WINDOWS
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(v >> 32)))
+	{
+		return (int32)index+32;
+	}
+	_BitScanReverse(&index, (unsigned long)v);
+	return (int32)index;
+#else
+	return 63-__builtin_clzll(v);
+#endif
 }
@@ -2,6 +2,8 @@
 
 #include "common/Standard.h"
 
+#include <math.h>
+
 #define PI32 ((float)3.14159265358979323846)
 #define PI64 (3.14159265358979323846)
 
@@ -41,22 +43,6 @@
 #define DoubleNegMax (-1.7976931348623158e+308)
 #define DoubleNegInfinity (-((double)(1e+300*1e+300)))
 
-float Floor(float v);
-double FloorD(double v);
-float Ceil(float v);
-double CeilD(double v);
-float Round(float v);
-double RoundD(double v);
-float Abs(float v);
-double AbsD(double v);
-int32 AbsI(int32 v);
-int64 AbsI64(int64 v);
-float Sign(float v);
-double SignD(double v);
-float SignBinary(float v);
-double SignBinaryD(double v);
-int32 SignI(int32 v);
-int64 SignI64(int64 v);
 float Pow(float a, float b);
 double PowD(double a, double b);
 float Log(float v);
@@ -81,26 +67,6 @@ float Atan2(float v0, float v1);
 double Atan2D(double v0, double v1);
 float FMod(float v0, float v1);
 double FModD(double v0, double v1);
-float Sqrt(float v);
-double SqrtD(double v);
-float Max(float a, float b);
-double MaxD(double a, double b);
-int32 MaxI(int32 a, int32 b);
-uint32 MaxUI(uint32 a, uint32 b);
-int64 MaxI64(int64 a, int64 b);
-uint64 MaxUI64(uint64 a, uint64 b);
-float Min(float a, float b);
-double MinD(double a, double b);
-int32 MinI(int32 a, int32 b);
-uint32 MinUI(uint32 a, uint32 b);
-int64 MinI64(int64 a, int64 b);
-uint64 MinUI64(uint64 a, uint64 b);
-float Clamp(float v, float min, float max);
-double ClampD(double v, double min, double max);
-int32 ClampI(int32 v, int32 min, int32 max);
-uint32 ClampUI(uint32 v, uint32 min, uint32 max);
-int64 ClampI64(int64 v, int64 min, int64 max);
-uint64 ClampUI64(uint64 v, uint64 min, uint64 max);
 float Wrap(float v, float max);
 double WrapD(double v, double max);
 float WrapAngle(float v);
@@ -113,11 +79,232 @@ float MoveTowardsAngle(float from, float to, float amount);
 double MoveTowardsAngleD(double from, double to, double amount);
 float LerpAngle(float current, float target, float amount);
 double LerpAngleD(double current, double target, double amount);
-float Lerp(float from, float to, float factor);
-double LerpD(double from, double to, double factor);
-float LerpUnclamped(float from, float to, float factor);
-double LerpUnclampedD(double from, double to, double factor);
-float RadToDeg(float v);
-double RadToDegD(double v);
-float DegToRad(float v);
-double DegToRadD(double v);
+// index of the highest set bit, or -1 if v is 0.
+int32 FloorLog2UI64(uint64 v);
+
+// the small helpers are inline so loops calling them can be vectorized.
+static inline float Floor(float v)
+{
+	return floorf(v);
+}
+
+static inline double FloorD(double v)
+{
+	return floor(v);
+}
+
+static inline float Ceil(float v)
+{
+	return ceilf(v);
+}
+
+static inline double CeilD(double v)
+{
+	return ceil(v);
+}
+
+static inline float Round(float v)
+{
+	return roundf(v);
+}
+
+static inline double RoundD(double v)
+{
+	return round(v);
+}
+
+static inline float Abs(float v)
+{
+	return v >= 0.0f ? v : -v;
+}
+
+static inline double AbsD(double v)
+{
+	return v >= 0.0 ? v : -v;
+}
+
+static inline int32 AbsI(int32 v)
+{
+	return v >= 0 ? v : -v;
+}
+
+static inline int64 AbsI64(int64 v)
+{
+	return v >= 0 ? v : -v;
+}
+
+static inline float Sign(float v)
+{
+	return v == 0 ? 0.0f : v > 0 ? 1.0f : -1.0f;
+}
+
+static inline double SignD(double v)
+{
+	return v == 0 ? 0.0 : v > 0 ? 1.0 : -1.0;
+}
+
+static inline float SignBinary(float v)
+{
+	return v >= 0 ? 1.0f : -1.0f;
+}
+
+static inline double SignBinaryD(double v)
+{
+	return v >= 0 ? 1.0 : -1.0;
+}
+
+static inline int32 SignI(int32 v)
+{
+	return v == 0 ? 0 : v > 0 ? 1 : -1;
+}
+
+static inline int64 SignI64(int64 v)
+{
+	return v == 0 ? 0 : v > 0 ? 1 : -1;
+}
+
+static inline float Sqrt(float v)
+{
+	return sqrtf(v);
+}
+
+static inline double SqrtD(double v)
+{
+	return sqrt(v);
+}
+
+static inline float Max(float a, float b)
+{
+	return a > b ? a : b;
+}
+
+static inline double MaxD(double a, double b)
+{
+	return a > b ? a : b;
+}
+
+static inline int32 MaxI(int32 a, int32 b)
+{
+	return a > b ? a : b;
+}
+
+static inline uint32 MaxUI(uint32 a, uint32 b)
+{
+	return a > b ? a : b;
+}
+
+static inline int64 MaxI64(int64 a, int64 b)
+{
+	return a > b ? a : b;
+}
+
+static inline uint64 MaxUI64(uint64 a, uint64 b)
+{
+	return a > b ? a : b;
+}
+
+static inline float Min(float a, float b)
+{
+	return a < b ? a : b;
+}
+
+static inline double MinD(double a, double b)
+{
+	return a < b ? a : b;
+}
+
+static inline int32 MinI(int32 a, int32 b)
+{
+	return a < b ? a : b;
+}
+
+static inline uint32 MinUI(uint32 a, uint32 b)
+{
+	return a < b ? a : b;
+}
+
+static inline int64 MinI64(int64 a, int64 b)
+{
+	return a < b ? a : b;
+}
+
+static inline uint64 MinUI64(uint64 a, uint64 b)
+{
+	return a < b ? a : b;
+}
+
+static inline float Clamp(float v, float min, float max)
+{
+	return Min(Max(v, min), max);
+}
+
+static inline double ClampD(double v, double min, double max)
+{
+	return MinD(MaxD(v, min), max);
+}
+
+static inline int32 ClampI(int32 v, int32 min, int32 max)
+{
+	return MinI(MaxI(v, min), max);
+}
+
+static inline uint32 ClampUI(uint32 v, uint32 min, uint32 max)
+{
+	return MinUI(MaxUI(v, min), max);
+}
+
+static inline int64 ClampI64(int64 v, int64 min, int64 max)
+{
+	return MinI64(MaxI64(v, min), max);
+}
+
+static inline uint64 ClampUI64(uint64 v, uint64 min, uint64 max)
+{
+	return MinUI64(MaxUI64(v, min), max);
+}
+
+static inline float Lerp(float from, float to, float factor)
+{
+	factor = Clamp(factor, 0, 1);
+	return from+(to-from)*factor;
+}
+
+static inline double LerpD(double from, double to, double factor)
+{
+	factor = ClampD(factor, 0, 1);
+	return from+(to-from)*factor;
+}
+
+static inline float LerpUnclamped(float from, float to, float factor)
+{
+	return from+(to-from)*factor;
+}
+
+static inline double LerpUnclampedD(double from, double to, double factor)
+{
+	return from+(to-from)*factor;
+}
+
+static inline float RadToDeg(float v)
+{
+	static const float scaler = 180.0f/PI32;
+	return v*scaler;
+}
+
+static inline double RadToDegD(double v)
+{
+	static const double scaler = 180.0l/PI64;
+	return v*scaler;
+}
+
+static inline float DegToRad(float v)
+{
+	static const float scaler = PI32/180.0f;
+	return v*scaler;
+}
+
+static inline double DegToRadD(double v)
+{
+	static const double scaler = PI64/180.0l;
+	return v*scaler;
+}
@@ -0,0 +1,356 @@
+#include "common/RadixSort.h"
+
+#include "common/Thread.h"
+
+#define RadixSort_DigitBits 8
+#define RadixSort_BucketCount (1 << RadixSort_DigitBits)
+#define RadixSort_MaxDigits 8
+
+typedef int64 DigitCounts[RadixSort_BucketCount];
+
+size_t RadixSort_GetScratchSize(int64 count, int32 keySize, bool hasValues)
+{
+	return (size_t)count*(keySize+(hasValues ? sizeof(int32) : 0));
+}
+
+static void InsertionSortU32(uint32* keys, int32* values, int64 count)
+{
+	for (int64 i = 1; i < count; i++)
+	{
+		uint32 key = keys[i];
+		int32 value = values ? values[i] : 0;
+		int64 j = i;
+		for (; j > 0 && keys[j-1] > key; j--)
+		{
+			keys[j] = keys[j-1];
+			if (values)
+			{
+				values[j] = values[j-1];
+			}
+		}
+		keys[j] = key;
+		if (values)
+		{
+			values[j] = value;
+		}
+	}
+}
+
+static void InsertionSortU64(uint64* keys, int32* values, int64 count)
+{
+	for (int64 i = 1; i < count; i++)
+	{
+		uint64 key = keys[i];
+		int32 value = values ? values[i] : 0;
+		int64 j = i;
+		for (; j > 0 && keys[j-1] > key; j--)
+		{
+			keys[j] = keys[j-1];
+			if (values)
+			{
+				values[j] = values[j-1];
+			}
+		}
+		keys[j] = key;
+		if (values)
+		{
+			values[j] = value;
+		}
+	}
+}
+
+// counts every digit of [start, start+count) in one pass.
+static void CountAllDigits(const void* keys, int32 keySize, int64 start, int64 count, DigitCounts* counts)
+{
+	if (keySize == 4)
+	{
+		const uint32* k = (const uint32*)keys+start;
+		for (int64 i = 0; i < count; i++)
+		{
+			uint32 key = k[i];
+			counts[0][key & 0xff]++;
+			counts[1][(key >> 8) & 0xff]++;
+			counts[2][(key >> 16) & 0xff]++;
+			counts[3][key >> 24]++;
+		}
+	}
+	else
+	{
+		const uint64* k = (const uint64*)keys+start;
+		for (int64 i = 0; i < count; i++)
+		{
+			uint64 key = k[i];
+			counts[0][key & 0xff]++;
+			counts[1][(key >> 8) & 0xff]++;
+			counts[2][(key >> 16) & 0xff]++;
+			counts[3][(key >> 24) & 0xff]++;
+			counts[4][(key >> 32) & 0xff]++;
+			counts[5][(key >> 40) & 0xff]++;
+			counts[6][(key >> 48) & 0xff]++;
+			counts[7][key >> 56]++;
+		}
+	}
+}
+
+static void CountDigit(const void* keys, int32 keySize, int64 start, int64 count, int32 shift, int64* counts)
+{
+	if (keySize == 4)
+	{
+		const uint32* k = (const uint32*)keys+start;
+		for (int64 i = 0; i < count; i++)
+		{
+			counts[(k[i] >> shift) & 0xff]++;
+		}
+	}
+	else
+	{
+		const uint64* k = (const uint64*)keys+start;
+		for (int64 i = 0; i < count; i++)
+		{
+			counts[(k[i] >> shift) & 0xff]++;
+		}
+	}
+}
+
+// moves [start, start+count) to where offsets says each bucket continues, advancing the offsets.
+static void Scatter(const void* srcKeys, const int32* srcValues, void* dstKeys, int32* dstValues, int32 keySize, int64 start, int64 count, int32 shift, int64* offsets)
+{
+	if (keySize == 4)
+	{
+		const uint32* src = (const uint32*)srcKeys;
+		uint32* dst = (uint32*)dstKeys;
+		if (srcValues)
+		{
+			for (int64 i = start; i < start+count; i++)
+			{
+				uint32 key = src[i];
+				int64 index = offsets[(key >> shift) & 0xff]++;
+				dst[index] = key;
+				dstValues[index] = srcValues[i];
+			}
+		}
+		else
+		{
+			for (int64 i = start; i < start+count; i++)
+			{
+				uint32 key = src[i];
+				dst[offsets[(key >> shift) & 0xff]++] = key;
+			}
+		}
+	}
+	else
+	{
+		const uint64* src = (const uint64*)srcKeys;
+		uint64* dst = (uint64*)dstKeys;
+		if (srcValues)
+		{
+			for (int64 i = start; i < start+count; i++)
+			{
+				uint64 key = src[i];
+				int64 index = offsets[(key >> shift) & 0xff]++;
+				dst[index] = key;
+				dstValues[index] = srcValues[i];
+			}
+		}
+		else
+		{
+			for (int64 i = start; i < start+count; i++)
+			{
+				uint64 key = src[i];
+				dst[offsets[(key >> shift) & 0xff]++] = key;
+			}
+		}
+	}
+}
+
+static inline int32 GetDigit(const void* keys, int32 keySize, int32 shift)
+{
+	uint64 key = keySize == 4 ? *(const uint32*)keys : *(const uint64*)keys;
+	return (int32)((key >> shift) & 0xff);
+}
+
+// the sort runs back and forth between the input and scratch, and ends with a copy if it stopped in scratch.
+typedef struct SortBuffers
+{
+	void* keys[2];
+	int32* values[2];
+	int32 current;
+	void* allocatedScratch;
+} SortBuffers;
+
+static void SortBuffers_Init(SortBuffers* self, void* keys, int32* values, int64 count, int32 keySize, void* scratch)
+{
+	self->allocatedScratch = null;
+	if (!scratch)
+	{
+		scratch = self->allocatedScratch = MAlloc(RadixSort_GetScratchSize(count, keySize, values != null));
+	}
+	self->keys[0] = keys;
+	self->keys[1] = scratch;
+	self->values[0] = values;
+	self->values[1] = values ? (int32*)((uint8*)scratch+(size_t)count*keySize) : null;
+	self->current = 0;
+}
+
+static void SortBuffers_Finish(SortBuffers* self, int64 count, int32 keySize)
+{
+	if (self->current != 0)
+	{
+		MemCpy(self->keys[0], self->keys[1], (size_t)count*keySize);
+		if (self->values[0])
+		{
+			MemCpy(self->values[0], self->values[1], (size_t)count*sizeof(int32));
+		}
+	}
+	if (self->allocatedScratch)
+	{
+		MFree(self->allocatedScratch);
+	}
+}
+
+static void RadixSort(void* keys, int32* values, int64 count, void* scratch, int32 keySize)
+{
+	if (count <= RadixSort_InsertionSortMaxCount)
+	{
+		if (keySize == 4)
+		{
+			InsertionSortU32(keys, values, count);
+		}
+		else
+		{
+			InsertionSortU64(keys, values, count);
+		}
+		return;
+	}
+
+	// the digit counts don't depend on the order, so all of them come from the first pass over the keys.
+	DigitCounts counts[RadixSort_MaxDigits];
+	MemSet(counts, 0, sizeof(counts));
+	CountAllDigits(keys, keySize, 0, count, counts);
+
+	SortBuffers buffers;
+	SortBuffers_Init(&buffers, keys, values, count, keySize, scratch);
+	for (int32 digit = 0; digit < keySize; digit++)
+	{
+		int32 shift = digit*RadixSort_DigitBits;
+		if (counts[digit][GetDigit(keys, keySize, shift)] == count)
+		{
+			continue;
+		}
+
+		int64 offsets[RadixSort_BucketCount];
+		int64 offset = 0;
+		for (int32 b = 0; b < RadixSort_BucketCount; b++)
+		{
+			offsets[b] = offset;
+			offset += counts[digit][b];
+		}
+		int32 current = buffers.current;
+		Scatter(buffers.keys[current], buffers.values[current], buffers.keys[1-current], buffers.values[1-current], keySize, 0, count, shift, offsets);
+		buffers.current = 1-current;
+	}
+	SortBuffers_Finish(&buffers, count, keySize);
+}
+
+void RadixSort_U32(uint32* keys, int32* values, int64 count, void* scratch)
+{
+	RadixSort(keys, values, count, scratch, sizeof(uint32));
+}
+
+void RadixSort_U64(uint64* keys, int32* values, int64 count, void* scratch)
+{
+	RadixSort(keys, values, count, scratch, sizeof(uint64));
+}
+
+typedef struct ParallelSort
+{
+	SortBuffers buffers;
+	int32 keySize;
+	int32 shift;
+	// per chunk counts of the current digit, turned into the chunk's starting offsets before the scatter.
+	DigitCounts chunkCounts[Thread_MaxParallelForChunks];
+} ParallelSort;
+
+static void ParallelSort_Count(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	ParallelSort* sort = (ParallelSort*)userData;
+	int64* counts = sort->chunkCounts[chunkIndex];
+	MemSet(counts, 0, sizeof(DigitCounts));
+	CountDigit(sort->buffers.keys[sort->buffers.current], sort->keySize, start, count, sort->shift, counts);
+}
+
+static void ParallelSort_Scatter(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	ParallelSort* sort = (ParallelSort*)userData;
+	int32 current = sort->buffers.current;
+	Scatter(sort->buffers.keys[current], sort->buffers.values[current], sort->buffers.keys[1-current], sort->buffers.values[1-current],
+		sort->keySize, start, count, sort->shift, sort->chunkCounts[chunkIndex]);
+}
+
+static void RadixSortParallel(void* keys, int32* values, int64 count, void* scratch, int32 keySize, int32 threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = Thread_GetHardwareThreadCount();
+	}
+	if (threadCount <= 1 || count < 2*RadixSort_MinKeysPerThread)
+	{
+		RadixSort(keys, values, count, scratch, keySize);
+		return;
+	}
+
+	ParallelSort* sort = MAlloc(sizeof(ParallelSort));
+	SortBuffers_Init(&sort->buffers, keys, values, count, keySize, scratch);
+	sort->keySize = keySize;
+	for (int32 digit = 0; digit < keySize; digit++)
+	{
+		sort->shift = digit*RadixSort_DigitBits;
+		// both calls split the array the same way, so chunk i scatters what it counted.
+		int32 chunkCount = Thread_ParallelFor(count, threadCount, RadixSort_MinKeysPerThread, 1, ParallelSort_Count, sort);
+
+		int32 firstDigit = GetDigit(sort->buffers.keys[sort->buffers.current], keySize, sort->shift);
+		int64 firstDigitCount = 0;
+		for (int32 c = 0; c < chunkCount; c++)
+		{
+			firstDigitCount += sort->chunkCounts[c][firstDigit];
+		}
+		if (firstDigitCount == count)
+		{
+			continue;
+		}
+
+		// buckets in order, and within a bucket the chunks in order, keeps the sort stable.
+		int64 offset = 0;
+		for (int32 b = 0; b < RadixSort_BucketCount; b++)
+		{
+			for (int32 c = 0; c < chunkCount; c++)
+			{
+				int64 bucketCount = sort->chunkCounts[c][b];
+				sort->chunkCounts[c][b] = offset;
+				offset += bucketCount;
+			}
+		}
+		Thread_ParallelFor(count, threadCount, RadixSort_MinKeysPerThread, 1, ParallelSort_Scatter, sort);
+		sort->buffers.current = 1-sort->buffers.current;
+	}
+	SortBuffers_Finish(&sort->buffers, count, keySize);
+	MFree(sort);
+}
+
+void RadixSort_U32Parallel(uint32* keys, int32* values, int64 count, void* scratch, int32 threadCount)
+{
+	RadixSortParallel(keys, values, count, scratch, sizeof(uint32), threadCount);
+}
+
+void RadixSort_U64Parallel(uint64* keys, int32* values, int64 count, void* scratch, int32 threadCount)
+{
+	RadixSortParallel(keys, values, count, scratch, sizeof(uint64), threadCount);
+}
+
+void RadixSort_FloatsToKeys(const float* values, uint32* outKeys, int64 count)
+{
+	for (int64 i = 0; i < count; i++)
+	{
+		outKeys[i] = RadixSort_FloatToKey(values[i]);
+	}
+}
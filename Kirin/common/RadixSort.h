@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/Standard.h"
+
+// stable lsd radix sorts with 8 bit digits. keys end up ascending and values, usually payload indices, get the same permutation.
+// values can be null. scratch must hold RadixSort_GetScratchSize bytes, or be null to have each call allocate its own.
+// short arrays use insertion sort instead, and digits that are the same in every key are skipped.
+
+#define RadixSort_InsertionSortMaxCount 64
+// below this many keys per thread the parallel versions don't bother with threads.
+#define RadixSort_MinKeysPerThread (256*1024)
+
+size_t RadixSort_GetScratchSize(int64 count, int32 keySize, bool hasValues);
+void RadixSort_U32(uint32* keys, int32* values, int64 count, void* scratch);
+void RadixSort_U64(uint64* keys, int32* values, int64 count, void* scratch);
+// every digit is counted and scattered by one chunk per thread. threadCount <= 0 uses every hardware thread.
+// threads are started per pass, this only pays off for big arrays.
+void RadixSort_U32Parallel(uint32* keys, int32* values, int64 count, void* scratch, int32 threadCount);
+void RadixSort_U64Parallel(uint64* keys, int32* values, int64 count, void* scratch, int32 threadCount);
+
+// maps floats onto keys in the same order. flips every bit of negatives and just the sign bit of positives.
+// -0 sorts right before 0, nans sort outside the infinities on the side of their sign.
+static inline uint32 RadixSort_FloatToKey(float v)
+{
+	union { float f; uint32 u; } bits;
+	bits.f = v;
+	uint32 mask = (uint32)-(int32)(bits.u >> 31) | 0x80000000;
+	return bits.u ^ mask;
+}
+
+static inline float RadixSort_KeyToFloat(uint32 key)
+{
+	union { float f; uint32 u; } bits;
+	uint32 mask = ((key >> 31)-1) | 0x80000000;
+	bits.u = key ^ mask;
+	return bits.f;
+}
+
+void RadixSort_FloatsToKeys(const float* values, uint32* outKeys, int64 count);
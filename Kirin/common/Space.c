@@ -2,103 +2,107 @@
 
 #include "common/Math.h"
 
-Vec3 Vec3_Add(const Vec3 v0, const Vec3 v1)
-{
-	return Vec3_New(v0.x+v1.x, v0.y+v1.y, v0.z+v1.z);
-}
-
-Vec3 Vec3_Sub(const Vec3 v0, const Vec3 v1)
-{
-	return Vec3_New(v0.x-v1.x, v0.y-v1.y, v0.z-v1.z);
-}
+#if SIMD_SSE2
+#include <immintrin.h>
 
-Vec3 Vec3_Mul(const Vec3 v0, const Vec3 v1)
-{
-	return Vec3_New(v0.x*v1.x, v0.y*v1.y, v0.z*v1.z);
-}
+#define Simd_Shuffle(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define Simd_Swizzle(v, x, y, z, w) _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(w, z, y, x)))
+#define Simd_Splat(v, i) Simd_Swizzle(v, i, i, i, i)
 
-Vec3 Vec3_MulF(const Vec3 v0, float s)
+// a*b+c. fused when the target has fma, so results can differ from the scalar path in the last bit.
+static inline __m128 Simd_MulAdd(__m128 a, __m128 b, __m128 c)
 {
-	return Vec3_New(v0.x*s, v0.y*s, v0.z*s);
+#if SIMD_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
 }
 
-Vec3 Vec3_Div(const Vec3 v0, const Vec3 v1)
+#if SIMD_AVX
+static inline __m256 Simd_MulAdd256(__m256 a, __m256 b, __m256 c)
 {
-	return Vec3_New(v0.x/v1.x, v0.y/v1.y, v0.z/v1.z);
+#if SIMD_FMA
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
 }
+#endif
 
-Vec3 Vec3_DivF(const Vec3 v0, float s)
+// row vector times matrix, the way all the Matrix4 point transforms work.
+static inline __m128 Simd_ApplyRows(__m128 v, __m128 row0, __m128 row1, __m128 row2, __m128 row3)
 {
-	return Vec3_New(v0.x/s, v0.y/s, v0.z/s);
+	__m128 result = _mm_mul_ps(Simd_Splat(v, 0), row0);
+	result = Simd_MulAdd(Simd_Splat(v, 1), row1, result);
+	result = Simd_MulAdd(Simd_Splat(v, 2), row2, result);
+	return Simd_MulAdd(Simd_Splat(v, 3), row3, result);
 }
 
-Vec3 Vec3_Negate(const Vec3 v)
+// 2x2 row major helpers for the block inverse. A# is the adjugate.
+// A*B
+static inline __m128 Simd_Mat2Mul(__m128 a, __m128 b)
 {
-	return Vec3_New(-v.x, -v.y, -v.z);
+	return _mm_add_ps(_mm_mul_ps(a, Simd_Swizzle(b, 0, 3, 0, 3)), _mm_mul_ps(Simd_Swizzle(a, 1, 0, 3, 2), Simd_Swizzle(b, 2, 1, 2, 1)));
 }
 
-Vec3 Vec3_Lerp(const Vec3 from, const Vec3 to, float factor)
+// A#*B
+static inline __m128 Simd_Mat2AdjMul(__m128 a, __m128 b)
 {
-	return (Vec3) {
-		Lerp(from.x, to.x, factor),
-		Lerp(from.y, to.y, factor),
-		Lerp(from.z, to.z, factor),
-	};
+	return _mm_sub_ps(_mm_mul_ps(Simd_Swizzle(a, 3, 3, 0, 0), b), _mm_mul_ps(Simd_Swizzle(a, 1, 1, 2, 2), Simd_Swizzle(b, 2, 3, 0, 1)));
 }
 
-float Vec3_Dot(const Vec3 v0, const Vec3 v1)
+// A*B#
+static inline __m128 Simd_Mat2MulAdj(__m128 a, __m128 b)
 {
-	return v0.x*v1.x + v0.y*v1.y + v0.z*v1.z;
+	return _mm_sub_ps(_mm_mul_ps(a, Simd_Swizzle(b, 3, 0, 3, 0)), _mm_mul_ps(Simd_Swizzle(a, 1, 0, 3, 2), Simd_Swizzle(b, 2, 1, 2, 1)));
 }
 
-Vec3 Vec3_Cross(const Vec3 v0, const Vec3 v1)
+// the 3 floats of v in xyz and 0 in w, without reading past the end of v.
+static inline __m128 Simd_LoadVec3(const Vec3* v)
 {
-	return Vec3_New(
-		v0.y*v1.z-v0.z*v1.y,
-		v0.z*v1.x-v0.x*v1.z,
-		v0.x*v1.y-v0.y*v1.x
-	);
+	return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&v->x), _mm_load_ss(&v->z));
 }
 
-float Vec3_SqrLength(const Vec3 v)
+// writes the xyz of 3 rows and a position as the 12 floats of a Transformer.
+// packed into 3 full stores, overlapping or partial stores would make the caller's copy of the result stall on store forwarding.
+static inline void Simd_StoreTransformer(Transformer* dest, __m128 row0, __m128 row1, __m128 row2, __m128 pos)
 {
-	return v.x*v.x+v.y*v.y+v.z*v.z;
-}
+	__m128 packed0 = Simd_Shuffle(row0, Simd_Shuffle(row0, row1, 2, 2, 0, 0), 0, 1, 0, 2);
+	__m128 packed1 = Simd_Shuffle(row1, row2, 1, 2, 0, 1);
+	__m128 packed2 = Simd_Shuffle(Simd_Shuffle(row2, pos, 2, 2, 0, 0), pos, 0, 2, 1, 2);
 
-float Vec3_Length(const Vec3 v)
-{
-	return Sqrt(Vec3_SqrLength(v));
+	float* destValues = &dest->mat.values[0][0];
+	_mm_storeu_ps(destValues, packed0);
+	_mm_storeu_ps(destValues+4, packed1);
+	_mm_storeu_ps(destValues+8, packed2);
 }
 
-Vec3 Vec3_NormalizeGetLength(const Vec3 v, float* outLength)
+// xyz only, w is a.w*b.w-a.w*b.w.
+static inline __m128 Simd_Cross(__m128 a, __m128 b)
 {
-	Vec3 temp = { 0 };
-	float len = Vec3_Length(v);
-	if (len > 0)
-	{
-		temp = Vec3_DivF(v, len);
-	}
-	*outLength = len;
-	return temp;
+	return _mm_sub_ps(_mm_mul_ps(Simd_Swizzle(a, 1, 2, 0, 3), Simd_Swizzle(b, 2, 0, 1, 3)), _mm_mul_ps(Simd_Swizzle(a, 2, 0, 1, 3), Simd_Swizzle(b, 1, 2, 0, 3)));
 }
 
-Vec3 Vec3_Normalize(const Vec3 v)
+// same as Quat_Multiply. xyz = a.w*b.xyz+b.w*a.xyz+cross(a.xyz, b.xyz), w = a.w*b.w-dot(a.xyz, b.xyz).
+static inline __m128 Simd_QuatMultiply(__m128 a, __m128 b)
 {
-	Vec3 temp = {0};
-	float len = Vec3_Length(v);
-	if (len > 0)
-	{
-		temp = Vec3_DivF(v, len);
-	}
-	return temp;
+	const __m128 signW = _mm_castsi128_ps(_mm_set_epi32((int32)0x80000000, 0, 0, 0));
+	__m128 t0 = _mm_mul_ps(Simd_Splat(a, 3), b);
+	__m128 t1 = _mm_mul_ps(Simd_Swizzle(a, 0, 1, 2, 2), Simd_Swizzle(b, 3, 3, 3, 2));
+	__m128 t2 = _mm_mul_ps(Simd_Swizzle(a, 1, 2, 0, 0), Simd_Swizzle(b, 2, 0, 1, 0));
+	__m128 t3 = _mm_mul_ps(Simd_Swizzle(a, 2, 0, 1, 1), Simd_Swizzle(b, 1, 2, 0, 1));
+	return _mm_sub_ps(_mm_add_ps(t0, _mm_xor_ps(_mm_add_ps(t1, t2), signW)), t3);
 }
 
-Vec3 Vec3_Project(const Vec3 v, const Vec3 normal)
+// same as Quat_ApplyPoint. the w of point passes through unchanged.
+static inline __m128 Simd_QuatApplyPoint(__m128 q, __m128 point)
 {
-	float dot = Vec3_Dot(v, normal);
-	Vec3 result = Vec3_MulF(normal, dot);
-	return result;
+	__m128 t = Simd_Cross(point, q);
+	t = _mm_add_ps(t, t);
+	return _mm_add_ps(Simd_MulAdd(Simd_Splat(q, 3), t, point), Simd_Cross(t, q));
 }
+#endif
 
 Vec3 Vec3_FromAnglesYawPitch(float yaw, float pitch)
 {
@@ -118,7 +122,7 @@ Plane Plane_New(const Vec3 dir, float dist)
 
 Plane Plane_NewFromPoint(const Vec3 dir, const Vec3 pos)
 {
-	return Plane_New(dir, -Vec3_Dot(dir, pos));
+	return Plane_New(dir, Vec3_Dot(dir, pos));
 }
 
 Plane Plane_NewFromPoints(const Vec3 pos0, const Vec3 pos1, const Vec3 pos2)
@@ -137,11 +141,6 @@ Plane Plane_NewFromPoints(const Vec3 pos0, const Vec3 pos1, const Vec3 pos2)
 	return self;
 }
 
-float Plane_DistToPoint(const Plane self, const Vec3 pos)
-{
-	return Vec3_Dot(self.dir, pos)-self.dist;
-}
-
 bool Plane_RayIntersect(const Plane plane, const Vec3 rayOrigin, const Vec3 rayDir, float* outDist)
 {
 	float denom = Vec3_Dot(plane.dir, rayDir);
@@ -272,7 +271,7 @@ Matrix3 Matrix3_Multiply(const Matrix3* a, const Matrix3* b)
 	return result;
 }
 
-Matrix4 Matrix4_Transpose(const Matrix4* matrix)
+Matrix4 Matrix4_TransposeScalar(const Matrix4* matrix)
 {
 	Matrix4 result;
 	for (int32 y = 0; y < 4; y++)
@@ -285,7 +284,7 @@ Matrix4 Matrix4_Transpose(const Matrix4* matrix)
 	return result;
 }
 
-Matrix4 Matrix4_Inverse(const Matrix4* matrix)
+Matrix4 Matrix4_InverseScalar(const Matrix4* matrix)
 {
 	float s[6];
 	float c[6];
@@ -330,7 +329,7 @@ Matrix4 Matrix4_Inverse(const Matrix4* matrix)
 	return result;
 }
 
-Vec3 Matrix4_ApplyPoint(const Matrix4* mat, const Vec3 point)
+Vec3 Matrix4_ApplyPointScalar(const Matrix4* mat, const Vec3 point)
 {
 	Vec3 result;
 
@@ -341,7 +340,7 @@ Vec3 Matrix4_ApplyPoint(const Matrix4* mat, const Vec3 point)
 	return result;
 }
 
-Vec4 Matrix4_ApplyPoint4(const Matrix4* mat, const Vec4 point)
+Vec4 Matrix4_ApplyPoint4Scalar(const Matrix4* mat, const Vec4 point)
 {
 	Vec4 result;
 
@@ -353,7 +352,7 @@ Vec4 Matrix4_ApplyPoint4(const Matrix4* mat, const Vec4 point)
 	return result;
 }
 
-Matrix4 Matrix4_Multiply(const Matrix4* a, const Matrix4* b)
+Matrix4 Matrix4_MultiplyScalar(const Matrix4* a, const Matrix4* b)
 {
 	float a11 = a->values[0][0];
 	float a12 = a->values[0][1];
@@ -409,6 +408,164 @@ Matrix4 Matrix4_Multiply(const Matrix4* a, const Matrix4* b)
 	return result;
 }
 
+Matrix4 Matrix4_Transpose(const Matrix4* matrix)
+{
+#if SIMD_SSE2
+	__m128 row0 = _mm_loadu_ps(matrix->values[0]);
+	__m128 row1 = _mm_loadu_ps(matrix->values[1]);
+	__m128 row2 = _mm_loadu_ps(matrix->values[2]);
+	__m128 row3 = _mm_loadu_ps(matrix->values[3]);
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+	Matrix4 result;
+	_mm_storeu_ps(result.values[0], row0);
+	_mm_storeu_ps(result.values[1], row1);
+	_mm_storeu_ps(result.values[2], row2);
+	_mm_storeu_ps(result.values[3], row3);
+	return result;
+#else
+	return Matrix4_TransposeScalar(matrix);
+#endif
+}
+
+Matrix4 Matrix4_Inverse(const Matrix4* matrix)
+{
+#if SIMD_SSE2
+	// block inverse. with M split into 2x2 blocks | A B |
+	//                                             | C D |
+	// inverse(M) = 1/|M| * | X# Y# | where the blocks are built from adjugates of the sub blocks.
+	//                      | Z# W# |
+	__m128 row0 = _mm_loadu_ps(matrix->values[0]);
+	__m128 row1 = _mm_loadu_ps(matrix->values[1]);
+	__m128 row2 = _mm_loadu_ps(matrix->values[2]);
+	__m128 row3 = _mm_loadu_ps(matrix->values[3]);
+
+	__m128 a = _mm_movelh_ps(row0, row1);
+	__m128 b = _mm_movehl_ps(row1, row0);
+	__m128 c = _mm_movelh_ps(row2, row3);
+	__m128 d = _mm_movehl_ps(row3, row2);
+
+	// (|A| |B| |C| |D|)
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps(Simd_Shuffle(row0, row2, 0, 2, 0, 2), Simd_Shuffle(row1, row3, 1, 3, 1, 3)),
+		_mm_mul_ps(Simd_Shuffle(row0, row2, 1, 3, 1, 3), Simd_Shuffle(row1, row3, 0, 2, 0, 2)));
+	__m128 detA = Simd_Splat(detSub, 0);
+	__m128 detB = Simd_Splat(detSub, 1);
+	__m128 detC = Simd_Splat(detSub, 2);
+	__m128 detD = Simd_Splat(detSub, 3);
+
+	__m128 adjDC = Simd_Mat2AdjMul(d, c);
+	__m128 adjAB = Simd_Mat2AdjMul(a, b);
+	// X# = |D|A - B(D#C)
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Simd_Mat2Mul(b, adjDC));
+	// W# = |A|D - C(A#B)
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Simd_Mat2Mul(c, adjAB));
+	// Y# = |B|C - D(A#B)#
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Simd_Mat2MulAdj(d, adjAB));
+	// Z# = |C|B - A(D#C)#
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Simd_Mat2MulAdj(a, adjDC));
+
+	// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+	__m128 trace = _mm_mul_ps(adjAB, Simd_Swizzle(adjDC, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+	trace = _mm_add_ps(trace, Simd_Splat(trace, 1));
+	trace = Simd_Splat(trace, 0);
+	__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+	__m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+	x = _mm_mul_ps(x, invDet);
+	y = _mm_mul_ps(y, invDet);
+	z = _mm_mul_ps(z, invDet);
+	w = _mm_mul_ps(w, invDet);
+
+	// the adjugate swizzle and the block to row shuffle in one go.
+	Matrix4 result;
+	_mm_storeu_ps(result.values[0], Simd_Shuffle(x, y, 3, 1, 3, 1));
+	_mm_storeu_ps(result.values[1], Simd_Shuffle(x, y, 2, 0, 2, 0));
+	_mm_storeu_ps(result.values[2], Simd_Shuffle(z, w, 3, 1, 3, 1));
+	_mm_storeu_ps(result.values[3], Simd_Shuffle(z, w, 2, 0, 2, 0));
+	return result;
+#else
+	return Matrix4_InverseScalar(matrix);
+#endif
+}
+
+Vec3 Matrix4_ApplyPoint(const Matrix4* mat, const Vec3 point)
+{
+#if SIMD_SSE2
+	// built lane by lane, point arrives split across registers and a 16 byte reload of it would stall on store forwarding.
+	__m128 v = _mm_movelh_ps(_mm_unpacklo_ps(_mm_set_ss(point.x), _mm_set_ss(point.y)), _mm_unpacklo_ps(_mm_set_ss(point.z), _mm_set_ss(1.0f)));
+	__m128 transformed = Simd_ApplyRows(v, _mm_loadu_ps(mat->values[0]), _mm_loadu_ps(mat->values[1]), _mm_loadu_ps(mat->values[2]), _mm_loadu_ps(mat->values[3]));
+
+	float values[4];
+	_mm_storeu_ps(values, transformed);
+	return Vec3_New(values[0], values[1], values[2]);
+#else
+	return Matrix4_ApplyPointScalar(mat, point);
+#endif
+}
+
+Vec4 Matrix4_ApplyPoint4(const Matrix4* mat, const Vec4 point)
+{
+#if SIMD_SSE2
+	__m128 v = _mm_movelh_ps(_mm_unpacklo_ps(_mm_set_ss(point.x), _mm_set_ss(point.y)), _mm_unpacklo_ps(_mm_set_ss(point.z), _mm_set_ss(point.w)));
+	__m128 transformed = Simd_ApplyRows(v, _mm_loadu_ps(mat->values[0]), _mm_loadu_ps(mat->values[1]), _mm_loadu_ps(mat->values[2]), _mm_loadu_ps(mat->values[3]));
+
+	Vec4 result;
+	_mm_storeu_ps(&result.x, transformed);
+	return result;
+#else
+	return Matrix4_ApplyPoint4Scalar(mat, point);
+#endif
+}
+
+Matrix4 Matrix4_Multiply(const Matrix4* a, const Matrix4* b)
+{
+#if SIMD_AVX
+	// two result rows at a time, each 128 bit lane works on one row of a.
+	__m256 bRow0 = _mm256_broadcast_ps((const __m128*)b->values[0]);
+	__m256 bRow1 = _mm256_broadcast_ps((const __m128*)b->values[1]);
+	__m256 bRow2 = _mm256_broadcast_ps((const __m128*)b->values[2]);
+	__m256 bRow3 = _mm256_broadcast_ps((const __m128*)b->values[3]);
+
+	__m256 aRows01 = _mm256_loadu_ps(a->values[0]);
+	__m256 rows01 = _mm256_mul_ps(_mm256_shuffle_ps(aRows01, aRows01, 0x00), bRow0);
+	rows01 = Simd_MulAdd256(_mm256_shuffle_ps(aRows01, aRows01, 0x55), bRow1, rows01);
+	rows01 = Simd_MulAdd256(_mm256_shuffle_ps(aRows01, aRows01, 0xaa), bRow2, rows01);
+	rows01 = Simd_MulAdd256(_mm256_shuffle_ps(aRows01, aRows01, 0xff), bRow3, rows01);
+
+	__m256 aRows23 = _mm256_loadu_ps(a->values[2]);
+	__m256 rows23 = _mm256_mul_ps(_mm256_shuffle_ps(aRows23, aRows23, 0x00), bRow0);
+	rows23 = Simd_MulAdd256(_mm256_shuffle_ps(aRows23, aRows23, 0x55), bRow1, rows23);
+	rows23 = Simd_MulAdd256(_mm256_shuffle_ps(aRows23, aRows23, 0xaa), bRow2, rows23);
+	rows23 = Simd_MulAdd256(_mm256_shuffle_ps(aRows23, aRows23, 0xff), bRow3, rows23);
+
+	Matrix4 result;
+	_mm256_storeu_ps(result.values[0], rows01);
+	_mm256_storeu_ps(result.values[2], rows23);
+	return result;
+#elif SIMD_SSE2
+	__m128 bRow0 = _mm_loadu_ps(b->values[0]);
+	__m128 bRow1 = _mm_loadu_ps(b->values[1]);
+	__m128 bRow2 = _mm_loadu_ps(b->values[2]);
+	__m128 bRow3 = _mm_loadu_ps(b->values[3]);
+
+	__m128 row0 = Simd_ApplyRows(_mm_loadu_ps(a->values[0]), bRow0, bRow1, bRow2, bRow3);
+	__m128 row1 = Simd_ApplyRows(_mm_loadu_ps(a->values[1]), bRow0, bRow1, bRow2, bRow3);
+	__m128 row2 = Simd_ApplyRows(_mm_loadu_ps(a->values[2]), bRow0, bRow1, bRow2, bRow3);
+	__m128 row3 = Simd_ApplyRows(_mm_loadu_ps(a->values[3]), bRow0, bRow1, bRow2, bRow3);
+
+	Matrix4 result;
+	_mm_storeu_ps(result.values[0], row0);
+	_mm_storeu_ps(result.values[1], row1);
+	_mm_storeu_ps(result.values[2], row2);
+	_mm_storeu_ps(result.values[3], row3);
+	return result;
+#else
+	return Matrix4_MultiplyScalar(a, b);
+#endif
+}
+
 Matrix4 Matrix4_CreatePerspectiveMatrix(float fov, float aspect, float near, float far)
 {
 	Matrix4 result = { 0 };
@@ -424,20 +581,58 @@ Matrix4 Matrix4_CreatePerspectiveMatrix(float fov, float aspect, float near, flo
 }
 
 
+// rows that are orthogonal and of equal length, within this fraction of the squared length, count as rigid.
+// drift from composing a few dozen rigid transformers stays well below it.
+#define Transformer_RigidTolerance 1e-5f
+
 Transformer Transformer_Inverse(const Transformer* transformer)
 {
+	const Matrix3* mat = &transformer->mat;
+	float sqrScale = Vec3_Dot(mat->x, mat->x);
+	float errorY = Vec3_Dot(mat->y, mat->y)-sqrScale;
+	float errorZ = Vec3_Dot(mat->z, mat->z)-sqrScale;
+	float errorXY = Vec3_Dot(mat->x, mat->y);
+	float errorXZ = Vec3_Dot(mat->x, mat->z);
+	float errorYZ = Vec3_Dot(mat->y, mat->z);
+	// squared errors so the check compiles without branches on the signs.
+	float maxSqrError = Max(Max(Max(errorY*errorY, errorZ*errorZ), Max(errorXY*errorXY, errorXZ*errorXZ)), errorYZ*errorYZ);
+	float tolerance = sqrScale*Transformer_RigidTolerance;
+	bool rigid = sqrScale > 0 && maxSqrError <= tolerance*tolerance;
+
 	Transformer result;
-#if 1
-	// HACK:
-	Matrix4 temp = Transformer_ToMatrix4(transformer);
-	temp = Matrix4_Inverse(&temp);
-	result = Transformer_FromMatrix4(&temp);
-#else
-	result.mat = Matrix3_Inverse(&transformer->mat);
+	if (!rigid)
+	{
+		result.mat = Matrix3_Inverse(mat);
+		// point*mat+pos = p, so point = p*inverse-pos*inverse.
+		result.pos = Vec3_Negate(Matrix3_ApplyPoint(&result.mat, transformer->pos));
+		return result;
+	}
 
-	result.pos.x = -(result.mat.values[0][0]*transformer->pos.x+result.mat.values[0][1]*transformer->pos.y+result.mat.values[0][2]*transformer->pos.z);
-	result.pos.y = -(result.mat.values[1][0]*transformer->pos.x+result.mat.values[1][1]*transformer->pos.y+result.mat.values[1][2]*transformer->pos.z);
-	result.pos.z = -(result.mat.values[2][0]*transformer->pos.x+result.mat.values[2][1]*transformer->pos.y+result.mat.values[2][2]*transformer->pos.z);
+	// (s*R)^-1 = R^T/s = (s*R)^T/s^2. the position -pos*inverse is the dot of each row with pos.
+	float invSqrScale = 1.0f/sqrScale;
+#if SIMD_SSE2
+	// the rows are 3 floats apart, the last row picks up pos.x in w. transposing with pos as the 4th row leaves the columns in xyz.
+	const float* values = &mat->values[0][0];
+	__m128 column0 = _mm_loadu_ps(values);
+	__m128 column1 = _mm_loadu_ps(values+3);
+	__m128 column2 = _mm_loadu_ps(values+6);
+	__m128 pos = Simd_LoadVec3(&transformer->pos);
+	__m128 column3 = pos;
+	_MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+
+	__m128 scale = _mm_set1_ps(invSqrScale);
+	__m128 rowDots = Simd_MulAdd(Simd_Splat(pos, 2), column2, Simd_MulAdd(Simd_Splat(pos, 1), column1, _mm_mul_ps(Simd_Splat(pos, 0), column0)));
+	__m128 inversePos = _mm_mul_ps(rowDots, _mm_set1_ps(-invSqrScale));
+	Simd_StoreTransformer(&result, _mm_mul_ps(column0, scale), _mm_mul_ps(column1, scale), _mm_mul_ps(column2, scale), inversePos);
+#else
+	for (int32 y = 0; y < 3; y++)
+	{
+		for (int32 x = 0; x < 3; x++)
+		{
+			result.mat.values[y][x] = mat->values[x][y]*invSqrScale;
+		}
+	}
+	result.pos = Vec3_MulF(Matrix3_ApplyPointTransposed(mat, transformer->pos), -invSqrScale);
 #endif
 	return result;
 }
@@ -460,7 +655,7 @@ Vec3 Transformer_ApplyPointTransposed(const Transformer* transformer, const Vec3
 	return result;
 }
 
-Transformer Transformer_Multiply(const Transformer* a, const Transformer* b)
+Transformer Transformer_MultiplyScalar(const Transformer* a, const Transformer* b)
 {
 	Transformer result;
 	result.mat = Matrix3_Multiply(&a->mat, &b->mat);
@@ -475,6 +670,36 @@ Transformer Transformer_Multiply(const Transformer* a, const Transformer* b)
 	return result;
 }
 
+Transformer Transformer_Multiply(const Transformer* a, const Transformer* b)
+{
+#if SIMD_SSE2
+	// same as a 4x4 affine multiply with the implicit (0 0 0 1) column.
+	// the matrix rows are 3 floats apart so the 4 wide loads pick up the start of the next row in w, which never reaches the result.
+	const float* bValues = &b->mat.values[0][0];
+	__m128 bRow0 = _mm_loadu_ps(bValues);
+	__m128 bRow1 = _mm_loadu_ps(bValues+3);
+	__m128 bRow2 = _mm_loadu_ps(bValues+6);
+	__m128 bPos = Simd_LoadVec3(&b->pos);
+
+	const float* aValues = &a->mat.values[0][0];
+	__m128 aRow0 = _mm_loadu_ps(aValues);
+	__m128 aRow1 = _mm_loadu_ps(aValues+3);
+	__m128 aRow2 = _mm_loadu_ps(aValues+6);
+	__m128 aPos = Simd_LoadVec3(&a->pos);
+
+	__m128 row0 = Simd_MulAdd(Simd_Splat(aRow0, 2), bRow2, Simd_MulAdd(Simd_Splat(aRow0, 1), bRow1, _mm_mul_ps(Simd_Splat(aRow0, 0), bRow0)));
+	__m128 row1 = Simd_MulAdd(Simd_Splat(aRow1, 2), bRow2, Simd_MulAdd(Simd_Splat(aRow1, 1), bRow1, _mm_mul_ps(Simd_Splat(aRow1, 0), bRow0)));
+	__m128 row2 = Simd_MulAdd(Simd_Splat(aRow2, 2), bRow2, Simd_MulAdd(Simd_Splat(aRow2, 1), bRow1, _mm_mul_ps(Simd_Splat(aRow2, 0), bRow0)));
+	__m128 pos = Simd_MulAdd(Simd_Splat(aPos, 2), bRow2, Simd_MulAdd(Simd_Splat(aPos, 1), bRow1, Simd_MulAdd(Simd_Splat(aPos, 0), bRow0, bPos)));
+
+	Transformer result;
+	Simd_StoreTransformer(&result, row0, row1, row2, pos);
+	return result;
+#else
+	return Transformer_MultiplyScalar(a, b);
+#endif
+}
+
 Matrix4 Transformer_ToMatrix4(const Transformer* transformer)
 {
 	Matrix4 result;
@@ -515,3 +740,228 @@ Transformer Transformer_FromMatrix4(const Matrix4* matrix)
 
 	return result;
 }
+
+Quat Quat_FromAxisAngle(const Vec3 axis, float angle)
+{
+	float halfAngle = angle*0.5f;
+	float sin = Sin(halfAngle);
+	return Quat_New(axis.x*sin, axis.y*sin, axis.z*sin, Cos(halfAngle));
+}
+
+Quat Quat_FromMatrix3(const Matrix3* matrix)
+{
+	const float (*m)[3] = matrix->values;
+	float trace = m[0][0]+m[1][1]+m[2][2];
+
+	// pick the largest component to divide by to stay precise.
+	Quat result;
+	if (trace > 0)
+	{
+		float s = Sqrt(trace+1.0f)*2;
+		result = Quat_New((m[2][1]-m[1][2])/s, (m[0][2]-m[2][0])/s, (m[1][0]-m[0][1])/s, s*0.25f);
+	}
+	else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+	{
+		float s = Sqrt(1.0f+m[0][0]-m[1][1]-m[2][2])*2;
+		result = Quat_New(s*0.25f, (m[0][1]+m[1][0])/s, (m[0][2]+m[2][0])/s, (m[2][1]-m[1][2])/s);
+	}
+	else if (m[1][1] > m[2][2])
+	{
+		float s = Sqrt(1.0f+m[1][1]-m[0][0]-m[2][2])*2;
+		result = Quat_New((m[0][1]+m[1][0])/s, s*0.25f, (m[1][2]+m[2][1])/s, (m[0][2]-m[2][0])/s);
+	}
+	else
+	{
+		float s = Sqrt(1.0f+m[2][2]-m[0][0]-m[1][1])*2;
+		result = Quat_New((m[0][2]+m[2][0])/s, (m[1][2]+m[2][1])/s, s*0.25f, (m[1][0]-m[0][1])/s);
+	}
+	return result;
+}
+
+Matrix3 Quat_ToMatrix3(const Quat q)
+{
+	float xx = q.x*q.x;
+	float yy = q.y*q.y;
+	float zz = q.z*q.z;
+	float xy = q.x*q.y;
+	float xz = q.x*q.z;
+	float yz = q.y*q.z;
+	float wx = q.w*q.x;
+	float wy = q.w*q.y;
+	float wz = q.w*q.z;
+
+	Matrix3 result;
+	result.values[0][0] = 1-2*(yy+zz);
+	result.values[0][1] = 2*(xy-wz);
+	result.values[0][2] = 2*(xz+wy);
+	result.values[1][0] = 2*(xy+wz);
+	result.values[1][1] = 1-2*(xx+zz);
+	result.values[1][2] = 2*(yz-wx);
+	result.values[2][0] = 2*(xz-wy);
+	result.values[2][1] = 2*(yz+wx);
+	result.values[2][2] = 1-2*(xx+yy);
+	return result;
+}
+
+Quat Quat_Multiply(const Quat a, const Quat b)
+{
+	return Quat_New(
+		a.w*b.x+a.x*b.w+a.y*b.z-a.z*b.y,
+		a.w*b.y-a.x*b.z+a.y*b.w+a.z*b.x,
+		a.w*b.z+a.x*b.y-a.y*b.x+a.z*b.w,
+		a.w*b.w-a.x*b.x-a.y*b.y-a.z*b.z
+	);
+}
+
+Quat Quat_Normalize(const Quat q)
+{
+	float len = Sqrt(Quat_Dot(q, q));
+	if (len > 0)
+	{
+		float invLen = 1.0f/len;
+		return Quat_New(q.x*invLen, q.y*invLen, q.z*invLen, q.w*invLen);
+	}
+	return Quat_identity;
+}
+
+Vec3 Quat_ApplyPoint(const Quat q, const Vec3 point)
+{
+	// point*Quat_ToMatrix3(q) without building the matrix.
+	Vec3 axis = Vec3_New(q.x, q.y, q.z);
+	Vec3 t = Vec3_MulF(Vec3_Cross(point, axis), 2);
+	return Vec3_Add(Vec3_Add(point, Vec3_MulF(t, q.w)), Vec3_Cross(t, axis));
+}
+
+Quat Quat_Nlerp(const Quat from, const Quat to, float factor)
+{
+	factor = Clamp(factor, 0, 1);
+	float toFactor = Quat_Dot(from, to) < 0 ? -factor : factor;
+	float fromFactor = 1-factor;
+	return Quat_Normalize(Quat_New(
+		from.x*fromFactor+to.x*toFactor,
+		from.y*fromFactor+to.y*toFactor,
+		from.z*fromFactor+to.z*toFactor,
+		from.w*fromFactor+to.w*toFactor
+	));
+}
+
+Quat Quat_Slerp(const Quat from, const Quat to, float factor)
+{
+	factor = Clamp(factor, 0, 1);
+	float cosAngle = Quat_Dot(from, to);
+	float sign = 1;
+	if (cosAngle < 0)
+	{
+		cosAngle = -cosAngle;
+		sign = -1;
+	}
+
+	// sin(angle) gets too small to divide by for nearly identical rotations, where nlerp is just as good.
+	if (cosAngle > 0.9995f)
+	{
+		return Quat_Nlerp(from, to, factor);
+	}
+
+	float angle = ACos(cosAngle);
+	float invSin = 1.0f/Sin(angle);
+	float fromFactor = Sin((1-factor)*angle)*invSin;
+	float toFactor = Sin(factor*angle)*invSin*sign;
+	return Quat_New(
+		from.x*fromFactor+to.x*toFactor,
+		from.y*fromFactor+to.y*toFactor,
+		from.z*fromFactor+to.z*toFactor,
+		from.w*fromFactor+to.w*toFactor
+	);
+}
+
+RigidTransform RigidTransform_New(const Quat rot, const Vec3 pos, float scale)
+{
+	RigidTransform result = { rot, pos, scale };
+	return result;
+}
+
+Vec3 RigidTransform_ApplyPoint(const RigidTransform* transform, const Vec3 point)
+{
+	return Vec3_Add(Quat_ApplyPoint(transform->rot, Vec3_MulF(point, transform->scale)), transform->pos);
+}
+
+RigidTransform RigidTransform_Multiply(const RigidTransform* a, const RigidTransform* b)
+{
+	RigidTransform result;
+#if SIMD_SSE2
+	// pos and scale are loaded together, scale rides along in w.
+	static_assert(sizeof(RigidTransform) == 32, "RigidTransform has to be 2 vectors.");
+	const __m128 maskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	__m128 aRot = _mm_loadu_ps(&a->rot.x);
+	__m128 bRot = _mm_loadu_ps(&b->rot.x);
+	__m128 aPosScale = _mm_loadu_ps(&a->pos.x);
+	__m128 bPosScale = _mm_loadu_ps(&b->pos.x);
+
+	// (a.pos*b.scale, a.scale*b.scale), rotated by b, plus (b.pos, 0).
+	__m128 scaled = _mm_mul_ps(aPosScale, Simd_Splat(bPosScale, 3));
+	__m128 posScale = _mm_add_ps(Simd_QuatApplyPoint(bRot, scaled), _mm_and_ps(bPosScale, maskXYZ));
+
+	_mm_storeu_ps(&result.rot.x, Simd_QuatMultiply(aRot, bRot));
+	_mm_storeu_ps(&result.pos.x, posScale);
+#else
+	result.rot = Quat_Multiply(a->rot, b->rot);
+	result.pos = RigidTransform_ApplyPoint(b, a->pos);
+	result.scale = a->scale*b->scale;
+#endif
+	return result;
+}
+
+RigidTransform RigidTransform_Inverse(const RigidTransform* transform)
+{
+	RigidTransform result;
+#if SIMD_SSE2
+	const __m128 maskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128 signXYZ = _mm_castsi128_ps(_mm_set_epi32(0, (int32)0x80000000, (int32)0x80000000, (int32)0x80000000));
+	__m128 rot = _mm_xor_ps(_mm_loadu_ps(&transform->rot.x), signXYZ);
+	__m128 posScale = _mm_loadu_ps(&transform->pos.x);
+	__m128 invScale = _mm_div_ps(_mm_set1_ps(1), Simd_Splat(posScale, 3));
+
+	// (-pos rotated by the conjugate, 1)/scale
+	__m128 rotated = Simd_QuatApplyPoint(rot, _mm_xor_ps(posScale, signXYZ));
+	rotated = _mm_or_ps(_mm_and_ps(rotated, maskXYZ), _mm_setr_ps(0, 0, 0, 1));
+
+	_mm_storeu_ps(&result.rot.x, rot);
+	_mm_storeu_ps(&result.pos.x, _mm_mul_ps(rotated, invScale));
+#else
+	result.rot = Quat_Conjugate(transform->rot);
+	result.scale = 1.0f/transform->scale;
+	result.pos = Vec3_MulF(Quat_ApplyPoint(result.rot, Vec3_Negate(transform->pos)), result.scale);
+#endif
+	return result;
+}
+
+Transformer RigidTransform_ToTransformer(const RigidTransform* transform)
+{
+	Transformer result;
+	result.mat = Quat_ToMatrix3(transform->rot);
+	for (int32 y = 0; y < 3; y++)
+	{
+		result.mat.values[y][0] *= transform->scale;
+		result.mat.values[y][1] *= transform->scale;
+		result.mat.values[y][2] *= transform->scale;
+	}
+	result.pos = transform->pos;
+	return result;
+}
+
+RigidTransform RigidTransform_FromTransformer(const Transformer* transformer)
+{
+	RigidTransform result;
+	result.scale = Vec3_Length(transformer->mat.x);
+	float invScale = 1.0f/result.scale;
+	Matrix3 rotation;
+	for (int32 y = 0; y < 3; y++)
+	{
+		rotation.values[y][0] = transformer->mat.values[y][0]*invScale;
+		rotation.values[y][1] = transformer->mat.values[y][1]*invScale;
+		rotation.values[y][2] = transformer->mat.values[y][2]*invScale;
+	}
+	result.rot = Quat_FromMatrix3(&rotation);
+	result.pos = transformer->pos;
+	return result;
+}
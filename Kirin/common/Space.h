@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/Standard.h"
+#include "common/Math.h"
 
 typedef struct Vec3
 {
@@ -102,6 +103,43 @@ static const Transformer Transformer_identity = {
 	{0, 0, 0}
 };
 
+// unit quaternion rotation. maps to Matrix3 the same way Matrix3_FromAxisAngle does,
+// so Quat_Multiply(a, b) matches Matrix3_Multiply and applies a first.
+typedef struct Quat
+{
+	float x;
+	float y;
+	float z;
+	float w;
+} Quat;
+static const Quat Quat_identity = { 0, 0, 0, 1 };
+
+// rotation, uniform scale and translation. applies scale, then rotation, then pos, like a Transformer whose mat is rot*scale.
+// composing and inverting stay rigid and cost a couple of quaternion products, no matrix inverse.
+typedef struct RigidTransform
+{
+	Quat rot;
+	Vec3 pos;
+	float scale;
+} RigidTransform;
+static const RigidTransform RigidTransform_identity = {
+	{0, 0, 0, 1},
+	{0, 0, 0},
+	1
+};
+
+// axis aligned box. Aabb_empty has min above max, so the first union with it gives the other box.
+typedef struct Aabb
+{
+	Vec3 min;
+	Vec3 max;
+} Aabb;
+static const Aabb Aabb_empty = {
+	{FloatMax, FloatMax, FloatMax},
+	{-FloatMax, -FloatMax, -FloatMax}
+};
+
+// points on the plane have Vec3_Dot(dir, point) == dist, Plane_DistToPoint is positive on the side dir points to.
 typedef struct Plane
 {
 	Vec3 dir;
@@ -133,22 +171,153 @@ static inline IVec2 IVec2_New(int x, int y)
 	return (IVec2) { x, y };
 }
 
-Vec3 Vec3_Add(const Vec3 v0, const Vec3 v1);
-Vec3 Vec3_Sub(const Vec3 v0, const Vec3 v1);
-Vec3 Vec3_Mul(const Vec3 v0, const Vec3 v1);
-Vec3 Vec3_MulF(const Vec3 v0, float s);
-Vec3 Vec3_Div(const Vec3 v0, const Vec3 v1);
-Vec3 Vec3_DivF(const Vec3 v0, float s);
-Vec3 Vec3_Negate(const Vec3 v);
-Vec3 Vec3_Lerp(const Vec3 from, const Vec3 to, float factor);
+static inline Quat Quat_New(float x, float y, float z, float w)
+{
+	return (Quat) { x, y, z, w };
+}
+
+static inline Quat Quat_Conjugate(const Quat q)
+{
+	return Quat_New(-q.x, -q.y, -q.z, q.w);
+}
+
+static inline float Quat_Dot(const Quat q0, const Quat q1)
+{
+	return q0.x*q1.x+q0.y*q1.y+q0.z*q1.z+q0.w*q1.w;
+}
+
+static inline Vec3 Vec3_Add(const Vec3 v0, const Vec3 v1)
+{
+	return Vec3_New(v0.x+v1.x, v0.y+v1.y, v0.z+v1.z);
+}
+
+static inline Vec3 Vec3_Sub(const Vec3 v0, const Vec3 v1)
+{
+	return Vec3_New(v0.x-v1.x, v0.y-v1.y, v0.z-v1.z);
+}
+
+static inline Vec3 Vec3_Mul(const Vec3 v0, const Vec3 v1)
+{
+	return Vec3_New(v0.x*v1.x, v0.y*v1.y, v0.z*v1.z);
+}
+
+static inline Vec3 Vec3_MulF(const Vec3 v0, float s)
+{
+	return Vec3_New(v0.x*s, v0.y*s, v0.z*s);
+}
 
-float Vec3_Dot(const Vec3 v0, const Vec3 v1);
-Vec3 Vec3_Cross(const Vec3 v0, const Vec3 v1);
-float Vec3_SqrLength(const Vec3 v);
-float Vec3_Length(const Vec3 v);
-Vec3 Vec3_NormalizeGetLength(const Vec3 v, float* outLength);
-Vec3 Vec3_Normalize(const Vec3 v);
-Vec3 Vec3_Project(const Vec3 v, const Vec3 normal);
+static inline Vec3 Vec3_Div(const Vec3 v0, const Vec3 v1)
+{
+	return Vec3_New(v0.x/v1.x, v0.y/v1.y, v0.z/v1.z);
+}
+
+static inline Vec3 Vec3_DivF(const Vec3 v0, float s)
+{
+	return Vec3_New(v0.x/s, v0.y/s, v0.z/s);
+}
+
+static inline Vec3 Vec3_Negate(const Vec3 v)
+{
+	return Vec3_New(-v.x, -v.y, -v.z);
+}
+
+static inline Vec3 Vec3_Lerp(const Vec3 from, const Vec3 to, float factor)
+{
+	return (Vec3) {
+		Lerp(from.x, to.x, factor),
+		Lerp(from.y, to.y, factor),
+		Lerp(from.z, to.z, factor),
+	};
+}
+
+
+static inline float Vec3_Dot(const Vec3 v0, const Vec3 v1)
+{
+	return v0.x*v1.x + v0.y*v1.y + v0.z*v1.z;
+}
+
+static inline Vec3 Vec3_Cross(const Vec3 v0, const Vec3 v1)
+{
+	return Vec3_New(
+		v0.y*v1.z-v0.z*v1.y,
+		v0.z*v1.x-v0.x*v1.z,
+		v0.x*v1.y-v0.y*v1.x
+	);
+}
+
+static inline float Vec3_SqrLength(const Vec3 v)
+{
+	return v.x*v.x+v.y*v.y+v.z*v.z;
+}
+
+static inline float Vec3_Length(const Vec3 v)
+{
+	return Sqrt(Vec3_SqrLength(v));
+}
+
+static inline Vec3 Vec3_NormalizeGetLength(const Vec3 v, float* outLength)
+{
+	Vec3 temp = { 0 };
+	float len = Vec3_Length(v);
+	if (len > 0)
+	{
+		temp = Vec3_DivF(v, len);
+	}
+	*outLength = len;
+	return temp;
+}
+
+static inline Vec3 Vec3_Normalize(const Vec3 v)
+{
+	Vec3 temp = {0};
+	float len = Vec3_Length(v);
+	if (len > 0)
+	{
+		temp = Vec3_DivF(v, len);
+	}
+	return temp;
+}
+
+static inline Vec3 Vec3_Project(const Vec3 v, const Vec3 normal)
+{
+	float dot = Vec3_Dot(v, normal);
+	Vec3 result = Vec3_MulF(normal, dot);
+	return result;
+}
+
+static inline float Plane_DistToPoint(const Plane self, const Vec3 pos)
+{
+	return Vec3_Dot(self.dir, pos)-self.dist;
+}
+
+static inline Aabb Aabb_Union(const Aabb a, const Aabb b)
+{
+	Aabb result;
+	result.min = Vec3_New(Min(a.min.x, b.min.x), Min(a.min.y, b.min.y), Min(a.min.z, b.min.z));
+	result.max = Vec3_New(Max(a.max.x, b.max.x), Max(a.max.y, b.max.y), Max(a.max.z, b.max.z));
+	return result;
+}
+
+static inline Aabb Aabb_AddPoint(const Aabb box, const Vec3 point)
+{
+	Aabb result;
+	result.min = Vec3_New(Min(box.min.x, point.x), Min(box.min.y, point.y), Min(box.min.z, point.z));
+	result.max = Vec3_New(Max(box.max.x, point.x), Max(box.max.y, point.y), Max(box.max.z, point.z));
+	return result;
+}
+
+static inline Vec3 Aabb_GetCenter(const Aabb box)
+{
+	return Vec3_MulF(Vec3_Add(box.min, box.max), 0.5f);
+}
+
+// touching boxes overlap.
+static inline bool Aabb_Overlaps(const Aabb a, const Aabb b)
+{
+	return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+		a.min.y <= b.max.y && a.max.y >= b.min.y &&
+		a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
 
 // creates unit vector pointing in a direction specified by yaw and pitch.
 // yaw is rotated clockwise viewed from the top.
@@ -159,7 +328,6 @@ Vec3 Vec3_FromAnglesYawPitch(float yaw, float pitch);
 Plane Plane_New(const Vec3 dir, float dist);
 Plane Plane_NewFromPoint(const Vec3 dir, const Vec3 pos);
 Plane Plane_NewFromPoints(const Vec3 pos0, const Vec3 pos1, const Vec3 pos2);
-float Plane_DistToPoint(const Plane self, const Vec3 pos);
 bool Plane_RayIntersect(const Plane plane, const Vec3 rayOrigin, const Vec3 rayDir, float* outDist);
 
 Matrix3 Matrix3_FromAxisAngle(const Vec3 axis, float angle);
@@ -176,9 +344,40 @@ Vec4 Matrix4_ApplyPoint4(const Matrix4* mat, const Vec4 point);
 Matrix4 Matrix4_Multiply(const Matrix4* a, const Matrix4* b);
 Matrix4 Matrix4_CreatePerspectiveMatrix(float fov, float aspect, float, float);
 
+// rigid transformers (orthogonal rows of equal length) are inverted with a transpose, anything else with Matrix3_Inverse.
 Transformer Transformer_Inverse(const Transformer* transformer);
 Vec3 Transformer_ApplyPoint(const Transformer* transformer, const Vec3 point);
 Vec3 Transformer_ApplyPointTransposed(const Transformer* transformer, const Vec3 point);
 Transformer Transformer_Multiply(const Transformer* a, const Transformer* b);
 Matrix4 Transformer_ToMatrix4(const Transformer* transformer);
 Transformer Transformer_FromMatrix4(const Matrix4* matrix);
+
+// axis has to be normalized.
+Quat Quat_FromAxisAngle(const Vec3 axis, float angle);
+// matrix has to be a pure rotation.
+Quat Quat_FromMatrix3(const Matrix3* matrix);
+Matrix3 Quat_ToMatrix3(const Quat q);
+Quat Quat_Multiply(const Quat a, const Quat b);
+Quat Quat_Normalize(const Quat q);
+Vec3 Quat_ApplyPoint(const Quat q, const Vec3 point);
+// both take the shortest path. nlerp is cheaper but doesn't keep a constant angular velocity.
+Quat Quat_Nlerp(const Quat from, const Quat to, float factor);
+Quat Quat_Slerp(const Quat from, const Quat to, float factor);
+
+RigidTransform RigidTransform_New(const Quat rot, const Vec3 pos, float scale);
+Vec3 RigidTransform_ApplyPoint(const RigidTransform* transform, const Vec3 point);
+// same order as Transformer_Multiply, a is applied first.
+RigidTransform RigidTransform_Multiply(const RigidTransform* a, const RigidTransform* b);
+RigidTransform RigidTransform_Inverse(const RigidTransform* transform);
+Transformer RigidTransform_ToTransformer(const RigidTransform* transform);
+// transformer has to be rigid, see Transformer_Inverse.
+RigidTransform RigidTransform_FromTransformer(const Transformer* transformer);
+
+// scalar reference versions of the simd accelerated functions above. always compiled.
+// the simd versions match these to within a few ulp, they can differ in the last bits when fma is used.
+Matrix4 Matrix4_TransposeScalar(const Matrix4* matrix);
+Matrix4 Matrix4_InverseScalar(const Matrix4* matrix);
+Vec3 Matrix4_ApplyPointScalar(const Matrix4* mat, const Vec3 point);
+Vec4 Matrix4_ApplyPoint4Scalar(const Matrix4* mat, const Vec4 point);
+Matrix4 Matrix4_MultiplyScalar(const Matrix4* a, const Matrix4* b);
+Transformer Transformer_MultiplyScalar(const Transformer* a, const Transformer* b);
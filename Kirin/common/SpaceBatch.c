@@ -0,0 +1,439 @@
+#include "common/SpaceBatch.h"
+
+#include "common/Math.h"
+#include "common/Thread.h"
+
+#include <stdint.h>
+#if SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+// parallel chunks start at multiples of this many points so every chunk has the same alignment as the whole array.
+#define SpaceBatch_ChunkAlignment 8
+
+// the matrix a batch actually applies, prepared once per call.
+typedef struct BatchMatrix
+{
+	PointTransformMode mode;
+	// for normals this is the inverse transpose of the upper 3x3 with the translation row and w column cleared.
+	float m[4][4];
+} BatchMatrix;
+
+static BatchMatrix BatchMatrix_New(const Matrix4* mat, PointTransformMode mode)
+{
+	static_assert(PointTransformMode_Count == 3, "enum has changed.");
+	if (mode < 0 || mode >= PointTransformMode_Count)
+	{
+		ErrorF("invalid PointTransformMode %d.", mode);
+	}
+
+	BatchMatrix result;
+	result.mode = mode;
+	MemCpy(result.m, mat->values, sizeof(result.m));
+
+	if (mode == PointTransformMode_Normal)
+	{
+		Matrix3 upper;
+		for (int32 y = 0; y < 3; y++)
+		{
+			for (int32 x = 0; x < 3; x++)
+			{
+				upper.values[y][x] = mat->values[y][x];
+			}
+		}
+		Matrix3 inverse = Matrix3_Inverse(&upper);
+		Matrix3 normalMatrix = Matrix3_Transpose(&inverse);
+
+		MemSet(result.m, 0, sizeof(result.m));
+		for (int32 y = 0; y < 3; y++)
+		{
+			for (int32 x = 0; x < 3; x++)
+			{
+				result.m[y][x] = normalMatrix.values[y][x];
+			}
+		}
+	}
+
+	return result;
+}
+
+// reference path, also used for the ends of arrays that don't fill a simd block.
+// the simd kernels do the same operations in the same order, without fma they give identical results.
+static inline void TransformScalar(const BatchMatrix* b, float x, float y, float z, float* outX, float* outY, float* outZ)
+{
+	float rx = x*b->m[0][0]+y*b->m[1][0]+z*b->m[2][0]+b->m[3][0];
+	float ry = x*b->m[0][1]+y*b->m[1][1]+z*b->m[2][1]+b->m[3][1];
+	float rz = x*b->m[0][2]+y*b->m[1][2]+z*b->m[2][2]+b->m[3][2];
+
+	if (b->mode == PointTransformMode_Projective)
+	{
+		float rw = x*b->m[0][3]+y*b->m[1][3]+z*b->m[2][3]+b->m[3][3];
+		rx /= rw;
+		ry /= rw;
+		rz /= rw;
+	}
+	else if (b->mode == PointTransformMode_Normal)
+	{
+		float length = Sqrt(rx*rx+ry*ry+rz*rz);
+		if (length > 0)
+		{
+			rx /= length;
+			ry /= length;
+			rz /= length;
+		}
+		else
+		{
+			rx = ry = rz = 0;
+		}
+	}
+
+	*outX = rx;
+	*outY = ry;
+	*outZ = rz;
+}
+
+#if SIMD_SSE2
+typedef struct SimdMatrix
+{
+	__m128 m[4][4];
+} SimdMatrix;
+
+static SimdMatrix SimdMatrix_New(const BatchMatrix* b)
+{
+	SimdMatrix result;
+	for (int32 y = 0; y < 4; y++)
+	{
+		for (int32 x = 0; x < 4; x++)
+		{
+			result.m[y][x] = _mm_set1_ps(b->m[y][x]);
+		}
+	}
+	return result;
+}
+
+static inline __m128 Simd_MulAdd(__m128 a, __m128 b, __m128 c)
+{
+#if SIMD_FMA
+	return _mm_fmadd_ps(a, b, c);
+#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+static inline __m128 TransformColumn(const SimdMatrix* sm, int32 column, __m128 x, __m128 y, __m128 z)
+{
+	__m128 result = _mm_mul_ps(x, sm->m[0][column]);
+	result = Simd_MulAdd(y, sm->m[1][column], result);
+	result = Simd_MulAdd(z, sm->m[2][column], result);
+	return _mm_add_ps(result, sm->m[3][column]);
+}
+
+// transforms 4 points held as separate x, y and z vectors in place.
+static inline void Transform4(const SimdMatrix* sm, PointTransformMode mode, __m128* x, __m128* y, __m128* z)
+{
+	__m128 rx = TransformColumn(sm, 0, *x, *y, *z);
+	__m128 ry = TransformColumn(sm, 1, *x, *y, *z);
+	__m128 rz = TransformColumn(sm, 2, *x, *y, *z);
+
+	if (mode == PointTransformMode_Projective)
+	{
+		__m128 rw = TransformColumn(sm, 3, *x, *y, *z);
+		rx = _mm_div_ps(rx, rw);
+		ry = _mm_div_ps(ry, rw);
+		rz = _mm_div_ps(rz, rw);
+	}
+	else if (mode == PointTransformMode_Normal)
+	{
+		__m128 sqrLength = Simd_MulAdd(rz, rz, Simd_MulAdd(ry, ry, _mm_mul_ps(rx, rx)));
+		__m128 length = _mm_sqrt_ps(sqrLength);
+		__m128 nonZero = _mm_cmpgt_ps(length, _mm_setzero_ps());
+		rx = _mm_and_ps(_mm_div_ps(rx, length), nonZero);
+		ry = _mm_and_ps(_mm_div_ps(ry, length), nonZero);
+		rz = _mm_and_ps(_mm_div_ps(rz, length), nonZero);
+	}
+
+	*x = rx;
+	*y = ry;
+	*z = rz;
+}
+
+#define Simd_Shuffle(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+
+// (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3) to (x0 x1 x2 x3) (y0 y1 y2 y3) (z0 z1 z2 z3).
+static inline void Deinterleave4(__m128 v0, __m128 v1, __m128 v2, __m128* x, __m128* y, __m128* z)
+{
+	*x = Simd_Shuffle(v0, Simd_Shuffle(v1, v2, 2, 2, 1, 1), 0, 3, 0, 2);
+	*y = Simd_Shuffle(Simd_Shuffle(v0, v1, 1, 1, 0, 0), Simd_Shuffle(v1, v2, 3, 3, 2, 2), 0, 2, 0, 2);
+	*z = Simd_Shuffle(Simd_Shuffle(v0, v1, 2, 2, 1, 1), Simd_Shuffle(v2, v2, 0, 0, 3, 3), 0, 2, 0, 2);
+}
+
+static inline void Interleave4(__m128 x, __m128 y, __m128 z, __m128* v0, __m128* v1, __m128* v2)
+{
+	*v0 = Simd_Shuffle(Simd_Shuffle(x, y, 0, 0, 0, 0), Simd_Shuffle(z, x, 0, 0, 1, 1), 0, 2, 0, 2);
+	*v1 = Simd_Shuffle(Simd_Shuffle(y, z, 1, 1, 1, 1), Simd_Shuffle(x, y, 2, 2, 2, 2), 0, 2, 0, 2);
+	*v2 = Simd_Shuffle(Simd_Shuffle(z, x, 2, 2, 3, 3), Simd_Shuffle(y, z, 3, 3, 3, 3), 0, 2, 0, 2);
+}
+
+static inline void Store4(float* dest, __m128 value, bool stream)
+{
+	if (stream)
+	{
+		_mm_stream_ps(dest, value);
+	}
+	else
+	{
+		_mm_storeu_ps(dest, value);
+	}
+}
+
+#if SIMD_AVX
+typedef struct SimdMatrix256
+{
+	__m256 m[4][4];
+} SimdMatrix256;
+
+static SimdMatrix256 SimdMatrix256_New(const BatchMatrix* b)
+{
+	SimdMatrix256 result;
+	for (int32 y = 0; y < 4; y++)
+	{
+		for (int32 x = 0; x < 4; x++)
+		{
+			result.m[y][x] = _mm256_set1_ps(b->m[y][x]);
+		}
+	}
+	return result;
+}
+
+static inline __m256 Simd_MulAdd256(__m256 a, __m256 b, __m256 c)
+{
+#if SIMD_FMA
+	return _mm256_fmadd_ps(a, b, c);
+#else
+	return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+static inline __m256 TransformColumn8(const SimdMatrix256* sm, int32 column, __m256 x, __m256 y, __m256 z)
+{
+	__m256 result = _mm256_mul_ps(x, sm->m[0][column]);
+	result = Simd_MulAdd256(y, sm->m[1][column], result);
+	result = Simd_MulAdd256(z, sm->m[2][column], result);
+	return _mm256_add_ps(result, sm->m[3][column]);
+}
+
+static inline void Transform8(const SimdMatrix256* sm, PointTransformMode mode, __m256* x, __m256* y, __m256* z)
+{
+	__m256 rx = TransformColumn8(sm, 0, *x, *y, *z);
+	__m256 ry = TransformColumn8(sm, 1, *x, *y, *z);
+	__m256 rz = TransformColumn8(sm, 2, *x, *y, *z);
+
+	if (mode == PointTransformMode_Projective)
+	{
+		__m256 rw = TransformColumn8(sm, 3, *x, *y, *z);
+		rx = _mm256_div_ps(rx, rw);
+		ry = _mm256_div_ps(ry, rw);
+		rz = _mm256_div_ps(rz, rw);
+	}
+	else if (mode == PointTransformMode_Normal)
+	{
+		__m256 sqrLength = Simd_MulAdd256(rz, rz, Simd_MulAdd256(ry, ry, _mm256_mul_ps(rx, rx)));
+		__m256 length = _mm256_sqrt_ps(sqrLength);
+		__m256 nonZero = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ);
+		rx = _mm256_and_ps(_mm256_div_ps(rx, length), nonZero);
+		ry = _mm256_and_ps(_mm256_div_ps(ry, length), nonZero);
+		rz = _mm256_and_ps(_mm256_div_ps(rz, length), nonZero);
+	}
+
+	*x = rx;
+	*y = ry;
+	*z = rz;
+}
+
+static inline void Store8(float* dest, __m256 value, bool stream)
+{
+	if (stream)
+	{
+		_mm256_stream_ps(dest, value);
+	}
+	else
+	{
+		_mm256_storeu_ps(dest, value);
+	}
+}
+#endif
+#endif
+
+static bool ShouldStream(int64 count)
+{
+	return count*(int64)sizeof(Vec3) >= SpaceBatch_StreamingThresholdBytes;
+}
+
+static void TransformPointsRange(const BatchMatrix* b, const Vec3* points, Vec3* outPoints, int64 count, bool stream)
+{
+	int64 i = 0;
+
+#if SIMD_SSE2
+	if (stream)
+	{
+		// Vec3 is 12 bytes, at most 3 points until the output is 16 byte aligned.
+		while (i < count && ((uintptr_t)(outPoints+i) & 15) != 0)
+		{
+			TransformScalar(b, points[i].x, points[i].y, points[i].z, &outPoints[i].x, &outPoints[i].y, &outPoints[i].z);
+			i++;
+		}
+	}
+
+	SimdMatrix sm = SimdMatrix_New(b);
+	for (; i+4 <= count; i += 4)
+	{
+		const float* source = &points[i].x;
+		__m128 x, y, z;
+		Deinterleave4(_mm_loadu_ps(source), _mm_loadu_ps(source+4), _mm_loadu_ps(source+8), &x, &y, &z);
+		Transform4(&sm, b->mode, &x, &y, &z);
+
+		__m128 v0, v1, v2;
+		Interleave4(x, y, z, &v0, &v1, &v2);
+		float* dest = &outPoints[i].x;
+		Store4(dest, v0, stream);
+		Store4(dest+4, v1, stream);
+		Store4(dest+8, v2, stream);
+	}
+
+	if (stream)
+	{
+		_mm_sfence();
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		TransformScalar(b, points[i].x, points[i].y, points[i].z, &outPoints[i].x, &outPoints[i].y, &outPoints[i].z);
+	}
+}
+
+static void TransformPointsSoARange(const BatchMatrix* b, const Vec3SoA* points, const Vec3SoA* outPoints, int64 count, bool stream)
+{
+	const float* px = points->x;
+	const float* py = points->y;
+	const float* pz = points->z;
+	float* ox = outPoints->x;
+	float* oy = outPoints->y;
+	float* oz = outPoints->z;
+	int64 i = 0;
+
+#if SIMD_SSE2
+#if SIMD_AVX
+	const uintptr_t streamAlignment = 31;
+#else
+	const uintptr_t streamAlignment = 15;
+#endif
+	if (stream)
+	{
+		while (i < count && ((uintptr_t)(ox+i) & streamAlignment) != 0)
+		{
+			TransformScalar(b, px[i], py[i], pz[i], &ox[i], &oy[i], &oz[i]);
+			i++;
+		}
+		// the three output arrays have to line up for aligned stores.
+		stream = ((uintptr_t)(oy+i) & streamAlignment) == 0 && ((uintptr_t)(oz+i) & streamAlignment) == 0;
+	}
+
+#if SIMD_AVX
+	SimdMatrix256 sm = SimdMatrix256_New(b);
+	for (; i+8 <= count; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(px+i);
+		__m256 y = _mm256_loadu_ps(py+i);
+		__m256 z = _mm256_loadu_ps(pz+i);
+		Transform8(&sm, b->mode, &x, &y, &z);
+		Store8(ox+i, x, stream);
+		Store8(oy+i, y, stream);
+		Store8(oz+i, z, stream);
+	}
+#else
+	SimdMatrix sm = SimdMatrix_New(b);
+	for (; i+4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(px+i);
+		__m128 y = _mm_loadu_ps(py+i);
+		__m128 z = _mm_loadu_ps(pz+i);
+		Transform4(&sm, b->mode, &x, &y, &z);
+		Store4(ox+i, x, stream);
+		Store4(oy+i, y, stream);
+		Store4(oz+i, z, stream);
+	}
+#endif
+
+	if (stream)
+	{
+		_mm_sfence();
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		TransformScalar(b, px[i], py[i], pz[i], &ox[i], &oy[i], &oz[i]);
+	}
+}
+
+void Matrix4_TransformPoints(const Matrix4* mat, PointTransformMode mode, const Vec3* points, Vec3* outPoints, int64 count)
+{
+	BatchMatrix b = BatchMatrix_New(mat, mode);
+	TransformPointsRange(&b, points, outPoints, count, ShouldStream(count));
+}
+
+void Matrix4_TransformPointsSoA(const Matrix4* mat, PointTransformMode mode, const Vec3SoA* points, const Vec3SoA* outPoints, int64 count)
+{
+	BatchMatrix b = BatchMatrix_New(mat, mode);
+	TransformPointsSoARange(&b, points, outPoints, count, ShouldStream(count));
+}
+
+typedef struct BatchJob
+{
+	const BatchMatrix* matrix;
+	bool stream;
+	// exactly one of these pairs is used.
+	const Vec3* points;
+	Vec3* outPoints;
+	const Vec3SoA* pointsSoA;
+	const Vec3SoA* outPointsSoA;
+} BatchJob;
+
+static void BatchJob_Run(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	Unused(chunkIndex);
+	BatchJob* job = (BatchJob*)userData;
+	if (job->points)
+	{
+		TransformPointsRange(job->matrix, job->points+start, job->outPoints+start, count, job->stream);
+	}
+	else
+	{
+		Vec3SoA points = { job->pointsSoA->x+start, job->pointsSoA->y+start, job->pointsSoA->z+start };
+		Vec3SoA outPoints = { job->outPointsSoA->x+start, job->outPointsSoA->y+start, job->outPointsSoA->z+start };
+		TransformPointsSoARange(job->matrix, &points, &outPoints, count, job->stream);
+	}
+}
+
+void Matrix4_TransformPointsParallel(const Matrix4* mat, PointTransformMode mode, const Vec3* points, Vec3* outPoints, int64 count, int32 threadCount)
+{
+	BatchMatrix b = BatchMatrix_New(mat, mode);
+	BatchJob job = { 0 };
+	job.matrix = &b;
+	job.stream = ShouldStream(count);
+	job.points = points;
+	job.outPoints = outPoints;
+	Thread_ParallelFor(count, threadCount, SpaceBatch_MinPointsPerThread, SpaceBatch_ChunkAlignment, BatchJob_Run, &job);
+}
+
+void Matrix4_TransformPointsSoAParallel(const Matrix4* mat, PointTransformMode mode, const Vec3SoA* points, const Vec3SoA* outPoints, int64 count, int32 threadCount)
+{
+	BatchMatrix b = BatchMatrix_New(mat, mode);
+	BatchJob job = { 0 };
+	job.matrix = &b;
+	job.stream = ShouldStream(count);
+	job.pointsSoA = points;
+	job.outPointsSoA = outPoints;
+	Thread_ParallelFor(count, threadCount, SpaceBatch_MinPointsPerThread, SpaceBatch_ChunkAlignment, BatchJob_Run, &job);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Space.h"
+
+typedef enum PointTransformMode
+{
+	// point*matrix with w = 1, the w column is ignored. same as Matrix4_ApplyPoint.
+	PointTransformMode_Affine,
+	// point*matrix with w = 1, followed by the divide by w.
+	PointTransformMode_Projective,
+	// direction through the inverse transpose of the upper 3x3, renormalized. zero length results stay zero.
+	PointTransformMode_Normal,
+	PointTransformMode_Count,
+} PointTransformMode;
+
+static const char* PointTransformMode_ToString(PointTransformMode value)
+{
+	switch (value) {
+	case PointTransformMode_Affine: return "PointTransformMode_Affine"; break;
+	case PointTransformMode_Projective: return "PointTransformMode_Projective"; break;
+	case PointTransformMode_Normal: return "PointTransformMode_Normal"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(PointTransformMode_Count == 3, "enum has changed.");
+}
+
+// structure of arrays points. each array holds count floats.
+// arrays with matching 16 byte alignment are fastest.
+typedef struct Vec3SoA
+{
+	float* x;
+	float* y;
+	float* z;
+} Vec3SoA;
+
+// outputs larger than this are written with non temporal stores so they don't evict the inputs and everything else from cache.
+#define SpaceBatch_StreamingThresholdBytes (8*1024*1024)
+// below this many points per thread the parallel versions don't bother with threads.
+#define SpaceBatch_MinPointsPerThread (64*1024)
+
+// points and outPoints can be the same array. any other overlap is undefined.
+void Matrix4_TransformPoints(const Matrix4* mat, PointTransformMode mode, const Vec3* points, Vec3* outPoints, int64 count);
+void Matrix4_TransformPointsSoA(const Matrix4* mat, PointTransformMode mode, const Vec3SoA* points, const Vec3SoA* outPoints, int64 count);
+// splits the batch into one contiguous chunk per thread. threadCount <= 0 uses every hardware thread.
+// threads are started per call, this only pays off for big batches.
+void Matrix4_TransformPointsParallel(const Matrix4* mat, PointTransformMode mode, const Vec3* points, Vec3* outPoints, int64 count, int32 threadCount);
+void Matrix4_TransformPointsSoAParallel(const Matrix4* mat, PointTransformMode mode, const Vec3SoA* points, const Vec3SoA* outPoints, int64 count, int32 threadCount);
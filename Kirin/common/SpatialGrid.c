@@ -0,0 +1,432 @@
+#include "common/SpatialGrid.h"
+
+#include "common/Math.h"
+
+#define SpatialGrid_MinCellCapacity 4
+#define SpatialGrid_MinTableSize 64
+// compaction waits for at least this much garbage, so small grids don't compact all the time.
+#define SpatialGrid_MinDeadEntriesToCompact 1024
+#define SpatialGrid_MinEmptyCellsToCompact 64
+// cell coordinates are clamped to this so far away or huge queries can't overflow int32.
+// the extent of a range of cells then fits in 30 bits.
+#define SpatialGrid_MaxCoord (1 << 28)
+
+// grows an array to hold at least needed elements, doubling so repeated growth stays linear.
+static void* Reserve(void* array, int32* capacity, int32 needed, size_t elementSize)
+{
+	if (needed <= *capacity)
+	{
+		return array;
+	}
+	int32 newCapacity = MaxI(MaxI(*capacity*2, needed), 16);
+	*capacity = newCapacity;
+	return MRealloc(array, newCapacity*elementSize);
+}
+
+static inline int32 ToCoord(float v)
+{
+	v = Clamp(v, (float)-SpatialGrid_MaxCoord, (float)SpatialGrid_MaxCoord);
+	int32 i = (int32)v;
+	return i-(v < (float)i);
+}
+
+static inline IVec3 GetCellCoord(const SpatialGrid* self, const Vec3 pos)
+{
+	return IVec3_New(ToCoord(pos.x*self->invCellSize), ToCoord(pos.y*self->invCellSize), ToCoord(pos.z*self->invCellSize));
+}
+
+static inline bool IVec3_Equals(const IVec3 a, const IVec3 b)
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static inline uint32 HashCoord(const IVec3 coord)
+{
+	uint32 hash = (uint32)coord.x*0x8da6b343u ^ (uint32)coord.y*0xd8163841u ^ (uint32)coord.z*0xcb1ab31fu;
+	return hash ^ (hash >> 15);
+}
+
+static inline int32 FindCell(const SpatialGrid* self, const IVec3 coord)
+{
+	uint32 mask = (uint32)self->tableSize-1;
+	for (uint32 i = HashCoord(coord) & mask;; i = (i+1) & mask)
+	{
+		const SpatialGridSlot* slot = &self->table[i];
+		if (slot->cell < 0 || IVec3_Equals(slot->coord, coord))
+		{
+			return slot->cell;
+		}
+	}
+}
+
+static void RebuildTable(SpatialGrid* self, int32 tableSize)
+{
+	self->tableSize = tableSize;
+	self->table = MRealloc(self->table, tableSize*sizeof(SpatialGridSlot));
+	MemSet(self->table, 0xff, tableSize*sizeof(SpatialGridSlot));
+	uint32 mask = (uint32)tableSize-1;
+	for (int32 c = 0; c < self->cellCount; c++)
+	{
+		uint32 i = HashCoord(self->cells[c].coord) & mask;
+		while (self->table[i].cell >= 0)
+		{
+			i = (i+1) & mask;
+		}
+		self->table[i] = (SpatialGridSlot){ self->cells[c].coord, c };
+	}
+}
+
+static int32 FindOrAddCell(SpatialGrid* self, const IVec3 coord)
+{
+	uint32 mask = (uint32)self->tableSize-1;
+	uint32 i = HashCoord(coord) & mask;
+	for (;; i = (i+1) & mask)
+	{
+		const SpatialGridSlot* slot = &self->table[i];
+		if (slot->cell < 0)
+		{
+			break;
+		}
+		if (IVec3_Equals(slot->coord, coord))
+		{
+			return slot->cell;
+		}
+	}
+
+	int32 cellIndex = self->cellCount++;
+	self->cells = Reserve(self->cells, &self->cellCapacity, self->cellCount, sizeof(SpatialGridCell));
+	self->cells[cellIndex] = (SpatialGridCell){ coord, 0, 0, 0 };
+	// kept at most half full so probes stay short.
+	if (self->cellCount*2 > self->tableSize)
+	{
+		RebuildTable(self, self->tableSize*2);
+	}
+	else
+	{
+		self->table[i] = (SpatialGridSlot){ coord, cellIndex };
+	}
+	return cellIndex;
+}
+
+// packs the entries and drops empty cells. cell indices change.
+static void Compact(SpatialGrid* self)
+{
+	SpatialGridEntry* entries = MAlloc(MaxI(self->entryCapacity, 1)*sizeof(SpatialGridEntry));
+	int32 entryCount = 0;
+	int32 cellCount = 0;
+	for (int32 c = 0; c < self->cellCount; c++)
+	{
+		SpatialGridCell cell = self->cells[c];
+		if (cell.count == 0)
+		{
+			continue;
+		}
+		MemCpy(entries+entryCount, self->entries+cell.start, cell.count*sizeof(SpatialGridEntry));
+		cell.start = entryCount;
+		entryCount += cell.capacity;
+		for (int32 i = 0; i < cell.count; i++)
+		{
+			self->objects[entries[cell.start+i].handle].cell = cellCount;
+		}
+		self->cells[cellCount++] = cell;
+	}
+
+	MFree(self->entries);
+	self->entries = entries;
+	self->entryCount = entryCount;
+	self->deadEntryCount = 0;
+	self->cellCount = cellCount;
+	self->emptyCellCount = 0;
+	RebuildTable(self, self->tableSize);
+}
+
+static void GrowCell(SpatialGrid* self, SpatialGridCell* cell)
+{
+	int32 capacity = MaxI(cell->capacity*2, SpatialGrid_MinCellCapacity);
+	self->entries = Reserve(self->entries, &self->entryCapacity, self->entryCount+capacity, sizeof(SpatialGridEntry));
+	MemCpy(self->entries+self->entryCount, self->entries+cell->start, cell->count*sizeof(SpatialGridEntry));
+	self->deadEntryCount += cell->capacity;
+	cell->start = self->entryCount;
+	cell->capacity = capacity;
+	self->entryCount += capacity;
+}
+
+static void AddEntry(SpatialGrid* self, int32 handle, const Vec3 pos, float radius)
+{
+	if (self->deadEntryCount > MaxI(self->entryCount/2, SpatialGrid_MinDeadEntriesToCompact) ||
+		self->emptyCellCount > MaxI(self->cellCount/2, SpatialGrid_MinEmptyCellsToCompact))
+	{
+		Compact(self);
+	}
+
+	int32 cellIndex = FindOrAddCell(self, GetCellCoord(self, pos));
+	SpatialGridCell* cell = &self->cells[cellIndex];
+	if (cell->count == cell->capacity)
+	{
+		GrowCell(self, cell);
+	}
+	else if (cell->count == 0)
+	{
+		self->emptyCellCount--;
+	}
+
+	int32 slot = cell->count++;
+	self->entries[cell->start+slot] = (SpatialGridEntry){ pos, radius, handle };
+	self->objects[handle].cell = cellIndex;
+	self->objects[handle].slot = slot;
+	self->maxRadius = Max(self->maxRadius, radius);
+}
+
+static void RemoveEntry(SpatialGrid* self, const SpatialGridObject* object)
+{
+	SpatialGridCell* cell = &self->cells[object->cell];
+	int32 last = --cell->count;
+	if (object->slot != last)
+	{
+		SpatialGridEntry* entry = &self->entries[cell->start+object->slot];
+		*entry = self->entries[cell->start+last];
+		self->objects[entry->handle].slot = object->slot;
+	}
+	if (cell->count == 0)
+	{
+		self->emptyCellCount++;
+	}
+}
+
+void SpatialGrid_Init(SpatialGrid* self, float cellSize)
+{
+	*self = (SpatialGrid){ 0 };
+	self->cellSize = cellSize;
+	self->invCellSize = 1.0f/cellSize;
+	self->firstFreeHandle = -1;
+	RebuildTable(self, SpatialGrid_MinTableSize);
+}
+
+void SpatialGrid_Free(SpatialGrid* self)
+{
+	if (self->cells)
+	{
+		MFree(self->cells);
+	}
+	if (self->entries)
+	{
+		MFree(self->entries);
+	}
+	if (self->objects)
+	{
+		MFree(self->objects);
+	}
+	MFree(self->table);
+	*self = (SpatialGrid){ 0 };
+}
+
+int32 SpatialGrid_Insert(SpatialGrid* self, const Vec3 pos, float radius)
+{
+	int32 handle = self->firstFreeHandle;
+	if (handle >= 0)
+	{
+		self->firstFreeHandle = self->objects[handle].cell;
+	}
+	else
+	{
+		handle = self->objectCount++;
+		self->objects = Reserve(self->objects, &self->objectCapacity, self->objectCount, sizeof(SpatialGridObject));
+	}
+	AddEntry(self, handle, pos, radius);
+	return handle;
+}
+
+void SpatialGrid_Move(SpatialGrid* self, int32 handle, const Vec3 pos)
+{
+	DevAssert(handle >= 0 && handle < self->objectCount && self->objects[handle].slot >= 0);
+	SpatialGridObject* object = &self->objects[handle];
+	SpatialGridCell* cell = &self->cells[object->cell];
+	SpatialGridEntry* entry = &self->entries[cell->start+object->slot];
+	if (IVec3_Equals(cell->coord, GetCellCoord(self, pos)))
+	{
+		entry->pos = pos;
+		return;
+	}
+
+	float radius = entry->radius;
+	RemoveEntry(self, object);
+	AddEntry(self, handle, pos, radius);
+}
+
+void SpatialGrid_Remove(SpatialGrid* self, int32 handle)
+{
+	DevAssert(handle >= 0 && handle < self->objectCount && self->objects[handle].slot >= 0);
+	SpatialGridObject* object = &self->objects[handle];
+	RemoveEntry(self, object);
+	object->cell = self->firstFreeHandle;
+	object->slot = -1;
+	self->firstFreeHandle = handle;
+}
+
+void SpatialGrid_Rebuild(SpatialGrid* self, const Vec3SoA* positions, const float* radii, int32 count)
+{
+	self->cellCount = 0;
+	self->emptyCellCount = 0;
+	self->deadEntryCount = 0;
+	self->firstFreeHandle = -1;
+	self->maxRadius = 0;
+	MemSet(self->table, 0xff, self->tableSize*sizeof(SpatialGridSlot));
+	self->objectCount = count;
+	self->objects = Reserve(self->objects, &self->objectCapacity, count, sizeof(SpatialGridObject));
+	self->entryCount = count;
+	self->entries = Reserve(self->entries, &self->entryCapacity, count, sizeof(SpatialGridEntry));
+
+	// count the objects per cell, then place every cell's entries after the previous cell's.
+	for (int32 i = 0; i < count; i++)
+	{
+		Vec3 pos = Vec3_New(positions->x[i], positions->y[i], positions->z[i]);
+		int32 cell = FindOrAddCell(self, GetCellCoord(self, pos));
+		self->cells[cell].count++;
+		self->objects[i].cell = cell;
+	}
+
+	int32 start = 0;
+	for (int32 c = 0; c < self->cellCount; c++)
+	{
+		SpatialGridCell* cell = &self->cells[c];
+		cell->start = start;
+		cell->capacity = cell->count;
+		start += cell->count;
+		cell->count = 0;
+	}
+
+	for (int32 i = 0; i < count; i++)
+	{
+		SpatialGridCell* cell = &self->cells[self->objects[i].cell];
+		int32 slot = cell->count++;
+		float radius = radii ? radii[i] : 0;
+		self->entries[cell->start+slot] = (SpatialGridEntry){ Vec3_New(positions->x[i], positions->y[i], positions->z[i]), radius, i };
+		self->objects[i].slot = slot;
+		self->maxRadius = Max(self->maxRadius, radius);
+	}
+}
+
+static inline int32 AppendHandle(int32 handle, int32* outHandles, int32 capacity, int32 count)
+{
+	if (count < capacity)
+	{
+		outHandles[count] = handle;
+	}
+	return count+1;
+}
+
+static inline int32 QueryCellSphere(const SpatialGrid* self, const SpatialGridCell* cell, const Vec3 center, float radius, int32* outHandles, int32 capacity, int32 count)
+{
+	const SpatialGridEntry* entries = self->entries+cell->start;
+	for (int32 i = 0; i < cell->count; i++)
+	{
+		Vec3 offset = Vec3_Sub(entries[i].pos, center);
+		float reach = radius+entries[i].radius;
+		if (Vec3_SqrLength(offset) <= reach*reach)
+		{
+			count = AppendHandle(entries[i].handle, outHandles, capacity, count);
+		}
+	}
+	return count;
+}
+
+static inline int32 QueryCellAabb(const SpatialGrid* self, const SpatialGridCell* cell, const Aabb* box, int32* outHandles, int32 capacity, int32 count)
+{
+	const SpatialGridEntry* entries = self->entries+cell->start;
+	for (int32 i = 0; i < cell->count; i++)
+	{
+		Vec3 pos = entries[i].pos;
+		float dx = Max(Max(box->min.x-pos.x, pos.x-box->max.x), 0);
+		float dy = Max(Max(box->min.y-pos.y, pos.y-box->max.y), 0);
+		float dz = Max(Max(box->min.z-pos.z, pos.z-box->max.z), 0);
+		if (dx*dx+dy*dy+dz*dz <= entries[i].radius*entries[i].radius)
+		{
+			count = AppendHandle(entries[i].handle, outHandles, capacity, count);
+		}
+	}
+	return count;
+}
+
+static inline bool IsCoordInRange(const IVec3 coord, const IVec3 min, const IVec3 max)
+{
+	return coord.x >= min.x && coord.x <= max.x && coord.y >= min.y && coord.y <= max.y && coord.z >= min.z && coord.z <= max.z;
+}
+
+// the full product of three clamped extents can overflow int64. two of them can't, and when those are within limit,
+// which fits in int32, neither can the third.
+static inline bool HasMoreCellsThan(const IVec3 min, const IVec3 max, int32 limit)
+{
+	int64 area = (int64)(max.x-min.x+1)*(max.y-min.y+1);
+	return area > limit || area*(max.z-min.z+1) > limit;
+}
+
+// both queries look up every cell in range, or walk all the cells when there are fewer of those.
+int32 SpatialGrid_QuerySphere(const SpatialGrid* self, const Vec3 center, float radius, int32* outHandles, int32 capacity)
+{
+	float reach = radius+self->maxRadius;
+	IVec3 min = GetCellCoord(self, Vec3_Sub(center, Vec3_New(reach, reach, reach)));
+	IVec3 max = GetCellCoord(self, Vec3_Add(center, Vec3_New(reach, reach, reach)));
+	int32 count = 0;
+	if (HasMoreCellsThan(min, max, self->cellCount))
+	{
+		for (int32 c = 0; c < self->cellCount; c++)
+		{
+			if (IsCoordInRange(self->cells[c].coord, min, max))
+			{
+				count = QueryCellSphere(self, &self->cells[c], center, radius, outHandles, capacity, count);
+			}
+		}
+		return count;
+	}
+
+	for (int32 z = min.z; z <= max.z; z++)
+	{
+		for (int32 y = min.y; y <= max.y; y++)
+		{
+			for (int32 x = min.x; x <= max.x; x++)
+			{
+				int32 cell = FindCell(self, IVec3_New(x, y, z));
+				if (cell >= 0)
+				{
+					count = QueryCellSphere(self, &self->cells[cell], center, radius, outHandles, capacity, count);
+				}
+			}
+		}
+	}
+	return count;
+}
+
+int32 SpatialGrid_QueryAabb(const SpatialGrid* self, const Aabb box, int32* outHandles, int32 capacity)
+{
+	float reach = self->maxRadius;
+	IVec3 min = GetCellCoord(self, Vec3_Sub(box.min, Vec3_New(reach, reach, reach)));
+	IVec3 max = GetCellCoord(self, Vec3_Add(box.max, Vec3_New(reach, reach, reach)));
+	int32 count = 0;
+	if (HasMoreCellsThan(min, max, self->cellCount))
+	{
+		for (int32 c = 0; c < self->cellCount; c++)
+		{
+			if (IsCoordInRange(self->cells[c].coord, min, max))
+			{
+				count = QueryCellAabb(self, &self->cells[c], &box, outHandles, capacity, count);
+			}
+		}
+		return count;
+	}
+
+	for (int32 z = min.z; z <= max.z; z++)
+	{
+		for (int32 y = min.y; y <= max.y; y++)
+		{
+			for (int32 x = min.x; x <= max.x; x++)
+			{
+				int32 cell = FindCell(self, IVec3_New(x, y, z));
+				if (cell >= 0)
+				{
+					count = QueryCellAabb(self, &self->cells[cell], &box, outHandles, capacity, count);
+				}
+			}
+		}
+	}
+	return count;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Space.h"
+#include "common/SpaceBatch.h"
+
+// loose hash grid for broad phase neighbor queries. each object sits in the one cell its center falls in,
+// queries widen their cell range by the biggest radius so objects can stick out of their cell.
+// cells are found through an open addressing hash of their IVec3 coordinate, so the world has no bounds.
+
+// an object as stored in its cell, queries read only these.
+typedef struct SpatialGridEntry
+{
+	Vec3 pos;
+	float radius;
+	int32 handle;
+} SpatialGridEntry;
+
+// a cell's entries are contiguous in SpatialGrid.entries. a full cell moves its entries to a bigger block at the end.
+typedef struct SpatialGridCell
+{
+	IVec3 coord;
+	int32 start;
+	int32 count;
+	int32 capacity;
+} SpatialGridCell;
+
+// hash table slot. the coordinate is kept next to the index so a probe only touches the table.
+typedef struct SpatialGridSlot
+{
+	IVec3 coord;
+	// -1 for empty slots.
+	int32 cell;
+} SpatialGridSlot;
+
+typedef struct SpatialGridObject
+{
+	int32 cell;
+	// index in the cell's entries, -1 for free handles, which use cell to link the free list.
+	int32 slot;
+} SpatialGridObject;
+
+typedef struct SpatialGrid
+{
+	float cellSize;
+	float invCellSize;
+	// radius of the biggest object since the last rebuild.
+	float maxRadius;
+
+	SpatialGridCell* cells;
+	int32 cellCount;
+	int32 cellCapacity;
+	int32 emptyCellCount;
+	// tableSize is a power of two.
+	SpatialGridSlot* table;
+	int32 tableSize;
+
+	SpatialGridEntry* entries;
+	int32 entryCount;
+	int32 entryCapacity;
+	// entries in blocks cells have moved out of, reclaimed by compaction.
+	int32 deadEntryCount;
+
+	// indexed by handle.
+	SpatialGridObject* objects;
+	int32 objectCount;
+	int32 objectCapacity;
+	int32 firstFreeHandle;
+} SpatialGrid;
+
+// cellSize works best at one to two typical query diameters, and should be bigger than most objects.
+void SpatialGrid_Init(SpatialGrid* self, float cellSize);
+void SpatialGrid_Free(SpatialGrid* self);
+// returns the handle, freed handles are reused.
+int32 SpatialGrid_Insert(SpatialGrid* self, const Vec3 pos, float radius);
+// only touches the object's entry while it stays in the same cell.
+void SpatialGrid_Move(SpatialGrid* self, int32 handle, const Vec3 pos);
+void SpatialGrid_Remove(SpatialGrid* self, int32 handle);
+// replaces everything with count objects, object i gets handle i. radii can be null for points.
+// packs the cells tightly, cheaper than moving every object when most of them change cells.
+void SpatialGrid_Rebuild(SpatialGrid* self, const Vec3SoA* positions, const float* radii, int32 count);
+
+// write up to capacity handles of objects overlapping the query to outHandles, objects being spheres.
+// return how many overlap in total, which can be more than capacity.
+int32 SpatialGrid_QuerySphere(const SpatialGrid* self, const Vec3 center, float radius, int32* outHandles, int32 capacity);
+int32 SpatialGrid_QueryAabb(const SpatialGrid* self, const Aabb box, int32* outHandles, int32 capacity);
@@ -1,10 +1,12 @@
 
 #include "common/Standard.h"
+#include "common/Log.h"
 #include "common/Thread.h"
 
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <wchar.h>
 
 #define MALLOC_TRACKALLOCATIONS CONFIGTYPE_DEV
 #define MAlloc_Magic 0xcacacd35
@@ -146,6 +148,8 @@ void MAlloc_NoLeakCheck(void* ptr)
 	Mutex_Lock(&mAllocMutex);
 	UnlinkMAllocHeader(header);
 	Mutex_Unlock(&mAllocMutex);
+#else
+	Unused(ptr);
 #endif
 }
 
@@ -165,6 +169,11 @@ void MemCpy(void* dest, const void* source, size_t size)
 	memcpy(dest, source, size);
 }
 
+void MemMove(void* dest, const void* source, size_t size)
+{
+	memmove(dest, source, size);
+}
+
 void MemSet(void* dest, uint8 source, size_t size)
 {
 	memset(dest, source, size);
@@ -176,18 +185,51 @@ int32 MemCmp(const void* a, const void* b, size_t size)
 }
 
 
+// returns the number of characters format expands to, not including the null terminator.
+static size_t GetFormattedLengthW(const wchar_t* format, va_list args)
+{
+#if PLATFORM_WINDOWS
+	return (size_t)_vsnwprintf(null, 0, format, args);
+#else
+	// vswprintf can't measure without a buffer, keep doubling one until the output fits.
+	size_t capacity = 256;
+	while (true)
+	{
+		wchar_t* buffer = (wchar_t*)malloc(capacity*sizeof(wchar_t));
+		if (!buffer)
+		{
+			Error("allocation failed.");
+		}
+		va_list argsCopy;
+		va_copy(argsCopy, args);
+		int count = vswprintf(buffer, capacity, format, argsCopy);
+		va_end(argsCopy);
+		free(buffer);
+		if (count >= 0)
+		{
+			return (size_t)count;
+		}
+		capacity *= 2;
+	}
+#endif
+}
+
 bool SPrintF(char* dest, int32 destLength, PrintFormatStringAttribute const char* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
 
-	size_t needed = vsnprintf(null, 0, format, args)+1;
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	size_t needed = vsnprintf(null, 0, format, argsCopy)+1;
+	va_end(argsCopy);
 	if ((size_t)destLength < needed)
 	{
 		// not enough space in dest.
+		va_end(args);
 		return false;
 	}
-	vsprintf_s(dest, needed, format, args);
+	vsnprintf(dest, needed, format, args);
 
 	va_end(args);
 
@@ -196,12 +238,15 @@ bool SPrintF(char* dest, int32 destLength, PrintFormatStringAttribute const char
 
 char* SPrintFAlloc(PrintFormatStringAttribute const char* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
 
-	size_t needed = vsnprintf(null, 0, format, args)+1;
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	size_t needed = vsnprintf(null, 0, format, argsCopy)+1;
+	va_end(argsCopy);
 	char* mem = (char*)MAlloc(needed);
-	vsprintf_s(mem, needed, format, args);
+	vsnprintf(mem, needed, format, args);
 
 	va_end(args);
 	return mem;
@@ -209,16 +254,20 @@ char* SPrintFAlloc(PrintFormatStringAttribute const char* format, ...)
 
 bool SPrintFW(wchar_t* dest, int32 destLength, PrintFormatStringAttribute const wchar_t* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
 
-	size_t needed = _vsnwprintf(null, 0, format, args)+1;
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	size_t needed = GetFormattedLengthW(format, argsCopy)+1;
+	va_end(argsCopy);
 	if ((size_t)destLength < needed)
 	{
 		// not enough space in dest.
+		va_end(args);
 		return false;
 	}
-	vswprintf_s(dest, needed, format, args);
+	vswprintf(dest, needed, format, args);
 
 	va_end(args);
 
@@ -227,12 +276,15 @@ bool SPrintFW(wchar_t* dest, int32 destLength, PrintFormatStringAttribute const
 
 wchar_t* SPrintFWAlloc(PrintFormatStringAttribute const wchar_t* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
 
-	size_t needed = _vsnwprintf(null, 0, format, args)+1;
-	wchar_t* mem = (wchar_t*)MAlloc(needed);
-	vswprintf_s(mem, needed, format, args);
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	size_t needed = GetFormattedLengthW(format, argsCopy)+1;
+	va_end(argsCopy);
+	wchar_t* mem = (wchar_t*)MAlloc(needed*sizeof(wchar_t));
+	vswprintf(mem, needed, format, args);
 
 	va_end(args);
 	return mem;
@@ -240,7 +292,7 @@ wchar_t* SPrintFWAlloc(PrintFormatStringAttribute const wchar_t* format, ...)
 
 int32 SScanF(const char* buffer, ScanFormatStringAttribute const char* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
 	int32 result = vsscanf(buffer, format, args);
 	va_end(args);
@@ -249,7 +301,7 @@ int32 SScanF(const char* buffer, ScanFormatStringAttribute const char* format, .
 
 int32 SScanFW(const wchar_t* buffer, ScanFormatStringAttribute const wchar_t* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
 	int32 result = vswscanf(buffer, format, args);
 	va_end(args);
@@ -258,46 +310,74 @@ int32 SScanFW(const wchar_t* buffer, ScanFormatStringAttribute const wchar_t* fo
 
 void Print(const char* message)
 {
-	printf("%s", message);
+	Log_Write(LogLevel_Info, LogCategory_General, message);
 }
 
 void PrintLine(const char* message)
 {
-	printf("%s\n", message);
+	LogF(LogLevel_Info, LogCategory_General, "%s\n", message);
 }
 
 void PrintF(PrintFormatStringAttribute const char* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
-	vprintf(format, args);
+	LogV(LogLevel_Info, LogCategory_General, format, args);
 	va_end(args);
 }
 
 
 void ErrorFInternal(const char* file, int32 line, PrintFormatStringAttribute const char* format, ...)
 {
-	va_list args = null;
+	va_list args;
 	va_start(args, format);
-	vprintf(format, args);
+	LogV(LogLevel_Error, LogCategory_General, format, args);
 	va_end(args);
 
 	if (file)
 	{
-		PrintLine("");
-
-		PrintF("at %s:%d\n", file, line);
+		LogF(LogLevel_Error, LogCategory_General, "\nat %s:%d\n", file, line);
 	}
+
+	// the caller is about to break, make sure the message gets out first.
+	Log_Flush();
 }
 
 void ErrorInternal(const char* file, int32 line, const char* message)
 {
 	if (message)
 	{
-		PrintLine(message);
+		LogF(LogLevel_Error, LogCategory_General, "%s\n", message);
+	}
+	if (file)
+	{
+		LogF(LogLevel_Error, LogCategory_General, "at %s:%d\n", file, line);
+	}
+
+	Log_Flush();
+}
+
+void WarningFInternal(const char* file, int32 line, PrintFormatStringAttribute const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	LogV(LogLevel_Warning, LogCategory_General, format, args);
+	va_end(args);
+
+	if (file)
+	{
+		LogF(LogLevel_Warning, LogCategory_General, "\nat %s:%d\n", file, line);
+	}
+}
+
+void WarningInternal(const char* file, int32 line, const char* message)
+{
+	if (message)
+	{
+		LogF(LogLevel_Warning, LogCategory_General, "%s\n", message);
 	}
 	if (file)
 	{
-		PrintF("at %s:%d\n", file, line);
+		LogF(LogLevel_Warning, LogCategory_General, "at %s:%d\n", file, line);
 	}
 }
@@ -3,16 +3,28 @@
 #include "common/Defines.h"
 
 #include <stdlib.h>
+#if !PLATFORM_WINDOWS
+// static_assert is only a keyword in msvc's c dialect.
+#include <assert.h>
+#endif
 
 typedef signed char int8;
 typedef signed short int16;
 typedef signed int int32;
+#if PLATFORM_WINDOWS
 typedef __int64 int64;
+#else
+typedef long long int64;
+#endif
 
 typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint32;
+#if PLATFORM_WINDOWS
 typedef unsigned __int64 uint64;
+#else
+typedef unsigned long long uint64;
+#endif
 
 #ifndef __cplusplus
 typedef int bool;
@@ -25,6 +37,8 @@ typedef int bool;
 #define MaxPathLength 260
 
 #define ArrayCountOf(a) (sizeof(a) / sizeof(a[0]))
+// for parameters a function has to take but doesn't read, like backend entries that ignore some of their arguments.
+#define Unused(parameter) (void)(parameter)
 
 void* MAlloc(size_t size);
 void* MRealloc(void* block, size_t size);
@@ -33,6 +47,8 @@ void MAlloc_NoLeakCheck(void* ptr);
 bool MAlloc_DetectLeaks();
 
 void MemCpy(void* dest, const void* source, size_t size);
+// like MemCpy, but dest and source can overlap.
+void MemMove(void* dest, const void* source, size_t size);
 void MemSet(void* dest, uint8 source, size_t size);
 int32 MemCmp(const void* a, const void* b, size_t size);
 
@@ -56,25 +72,29 @@ void PrintF(PrintFormatStringAttribute const char* format, ...);
 
 void ErrorFInternal(const char* file, int32 line, PrintFormatStringAttribute const char* format, ...);
 void ErrorInternal(const char* file, int32 line, const char* message);
+void WarningFInternal(const char* file, int32 line, PrintFormatStringAttribute const char* format, ...);
+void WarningInternal(const char* file, int32 line, const char* message);
 #if PLATFORM_WINDOWS
 #define ERROR_BREAK __debugbreak()
+#elif PLATFORM_LINUX
+#define ERROR_BREAK __builtin_trap()
 #else
 #define ERROR_BREAK exit(1)
 #endif
 
-#define ErrorF(format, ...) { ErrorFInternal(__FILE__, __LINE__, format, __VA_ARGS__); ERROR_BREAK; }
+#define ErrorF(format, ...) { ErrorFInternal(__FILE__, __LINE__, format, ##__VA_ARGS__); ERROR_BREAK; }
 #define Error(message) { ErrorInternal(__FILE__, __LINE__, message); ERROR_BREAK; }
-#define WarningF(format, ...) { ErrorFInternal(__FILE__, __LINE__, format, __VA_ARGS__); }
-#define Warning(message) { ErrorInternal(__FILE__, __LINE__, message); }
+#define WarningF(format, ...) { WarningFInternal(__FILE__, __LINE__, format, ##__VA_ARGS__); }
+#define Warning(message) { WarningInternal(__FILE__, __LINE__, message); }
 #define AssertMessage(expression, message) if (!(expression)) { ErrorF("assert failed: %s", message); }
 #define Assert(expression) if (!(expression)) { ErrorF("assert failed: (%s)", #expression); }
 #if CONFIGTYPE_DEV
 // removed from release config.
-#define DevErrorF(format, ...) ErrorF(format, __VA_ARGS__)
+#define DevErrorF(format, ...) ErrorF(format, ##__VA_ARGS__)
 // removed from release config.
 #define DevError(message) Error(message)
 // removed from release config.
-#define DevWarningF(format, ...) WarningF(format, __VA_ARGS__)
+#define DevWarningF(format, ...) WarningF(format, ##__VA_ARGS__)
 // removed from release config.
 #define DevWarning(message) Warning(message)
 // removed from release config.
@@ -1,9 +1,52 @@
 #include "common/Thread.h"
 
+#if PLATFORM_WINDOWS
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#elif PLATFORM_LINUX
+#include "common/CString.h"
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include <stdio.h>
 
+typedef struct ThreadExitEntry
+{
+    ThreadExitFunction function;
+    void* userData;
+} ThreadExitEntry;
+
+static ThreadLocal ThreadExitEntry exitEntries[Thread_MaxExitFunctions];
+static ThreadLocal int32 exitEntryCount;
+
+static void AddExitEntry(ThreadExitFunction function, void* userData)
+{
+    if (exitEntryCount >= Thread_MaxExitFunctions)
+    {
+        Error("too many thread exit functions.");
+    }
+    exitEntries[exitEntryCount++] = (ThreadExitEntry){ function, userData };
+}
+
+static void RunExitEntries()
+{
+    while (exitEntryCount > 0)
+    {
+        exitEntryCount--;
+        exitEntries[exitEntryCount].function(exitEntries[exitEntryCount].userData);
+    }
+}
+
+#if PLATFORM_WINDOWS
+
 void Mutex_Free(Mutex* self)
 {
     CloseHandle(self->internalHandle);
@@ -30,3 +73,498 @@ void Mutex_Unlock(Mutex* self)
 {
     ReleaseMutex(self->internalHandle);
 }
+
+void Semaphore_Free(Semaphore* self)
+{
+    if (self->internalHandle)
+    {
+        CloseHandle(self->internalHandle);
+        self->internalHandle = null;
+    }
+}
+
+static HANDLE Semaphore_GetHandle(Semaphore* self)
+{
+    if (self->internalHandle == null)
+    {
+        HANDLE p = CreateSemaphore(NULL, 0, MAXLONG, NULL);
+        if (!p)
+        {
+            ErrorF("failed to create semaphore: %d", GetLastError());
+        }
+        if (InterlockedCompareExchangePointer(&self->internalHandle, (void*)p, null) != null)
+        {
+            CloseHandle(p);
+        }
+    }
+    return self->internalHandle;
+}
+
+void Semaphore_Signal(Semaphore* self)
+{
+    ReleaseSemaphore(Semaphore_GetHandle(self), 1, NULL);
+}
+
+void Semaphore_Wait(Semaphore* self)
+{
+    WaitForSingleObject(Semaphore_GetHandle(self), INFINITE);
+}
+
+static DWORD WINAPI ThreadEntry(LPVOID parameter)
+{
+    Thread* self = (Thread*)parameter;
+    self->function(self->userData);
+    return 0;
+}
+
+void Thread_Start(Thread* self, ThreadFunction function, void* userData)
+{
+    self->function = function;
+    self->userData = userData;
+    self->internalHandle = CreateThread(NULL, 0, ThreadEntry, self, 0, NULL);
+    if (!self->internalHandle)
+    {
+        ErrorF("failed to create thread: %d", GetLastError());
+    }
+}
+
+void Thread_Join(Thread* self)
+{
+    if (self->internalHandle)
+    {
+        WaitForSingleObject(self->internalHandle, INFINITE);
+        CloseHandle(self->internalHandle);
+        self->internalHandle = null;
+    }
+}
+
+uint32 Thread_GetCurrentId()
+{
+    return (uint32)GetCurrentThreadId();
+}
+
+void Thread_Yield()
+{
+    SwitchToThread();
+}
+
+// fiber local storage has a callback on thread exit, thread local storage doesn't.
+static DWORD exitFlsIndex = FLS_OUT_OF_INDEXES;
+static INIT_ONCE exitFlsOnce = INIT_ONCE_STATIC_INIT;
+
+static VOID NTAPI ExitFlsCallback(PVOID value)
+{
+    if (value)
+    {
+        RunExitEntries();
+    }
+}
+
+static BOOL CALLBACK AllocExitFls(PINIT_ONCE once, PVOID parameter, PVOID* context)
+{
+    Unused(once);
+    Unused(parameter);
+    Unused(context);
+    exitFlsIndex = FlsAlloc(ExitFlsCallback);
+    return exitFlsIndex != FLS_OUT_OF_INDEXES;
+}
+
+void Thread_AtExit(ThreadExitFunction function, void* userData)
+{
+    if (!InitOnceExecuteOnce(&exitFlsOnce, AllocExitFls, null, null))
+    {
+        ErrorF("failed to allocate fiber local storage: %d", GetLastError());
+    }
+    AddExitEntry(function, userData);
+    // the callback only runs for threads with a value set.
+    FlsSetValue(exitFlsIndex, (PVOID)1);
+}
+
+int32 Thread_GetHardwareThreadCount()
+{
+    static uint32 cachedCount = 0;
+    int32 result = (int32)Atomic_LoadAcquire32(&cachedCount);
+    if (result == 0)
+    {
+        // processors in the process's affinity mask, which can be fewer than the system has.
+        DWORD_PTR processMask;
+        DWORD_PTR systemMask;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) && processMask != 0)
+        {
+            for (; processMask; processMask &= processMask-1)
+            {
+                result++;
+            }
+        }
+        else
+        {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            result = info.dwNumberOfProcessors > 0 ? (int32)info.dwNumberOfProcessors : 1;
+        }
+        Atomic_StoreRelease32(&cachedCount, (uint32)result);
+    }
+    return result;
+}
+#elif PLATFORM_LINUX
+static_assert(sizeof(pthread_t) <= sizeof(void*), "pthread_t must fit in Thread.internalHandle.");
+
+static ThreadLocal uint32 currentThreadId;
+
+static void Futex_Wait(volatile uint32* address, uint32 expected)
+{
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, null, null, 0);
+}
+
+static void Futex_WakeOne(volatile uint32* address)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, null, null, 0);
+}
+
+void Mutex_Free(Mutex* self)
+{
+    Unused(self);
+}
+
+void Mutex_Lock(volatile Mutex* self)
+{
+    uint32 threadId = Thread_GetCurrentId();
+    if (__atomic_load_n(&self->ownerThreadId, __ATOMIC_RELAXED) == threadId)
+    {
+        self->recursionCount++;
+        return;
+    }
+
+    // the usual three state futex lock. uncontended lock and unlock never enter the kernel.
+    uint32 state = 0;
+    if (!__atomic_compare_exchange_n(&self->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        if (state != 2)
+        {
+            state = __atomic_exchange_n(&self->state, 2, __ATOMIC_ACQUIRE);
+        }
+        while (state != 0)
+        {
+            Futex_Wait(&self->state, 2);
+            state = __atomic_exchange_n(&self->state, 2, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    __atomic_store_n(&self->ownerThreadId, threadId, __ATOMIC_RELAXED);
+    self->recursionCount = 1;
+}
+
+void Mutex_Unlock(Mutex* self)
+{
+    if (--self->recursionCount > 0)
+    {
+        return;
+    }
+
+    __atomic_store_n(&self->ownerThreadId, 0, __ATOMIC_RELAXED);
+    if (__atomic_fetch_sub(&self->state, 1, __ATOMIC_RELEASE) != 1)
+    {
+        __atomic_store_n(&self->state, 0, __ATOMIC_RELEASE);
+        Futex_WakeOne(&self->state);
+    }
+}
+
+void Semaphore_Free(Semaphore* self)
+{
+    Unused(self);
+}
+
+void Semaphore_Signal(Semaphore* self)
+{
+    __atomic_add_fetch(&self->count, 1, __ATOMIC_SEQ_CST);
+    // a waiter that hasn't registered yet sees the new count when it tries to sleep on it.
+    if (__atomic_load_n(&self->waiterCount, __ATOMIC_SEQ_CST) > 0)
+    {
+        Futex_WakeOne(&self->count);
+    }
+}
+
+void Semaphore_Wait(Semaphore* self)
+{
+    for (;;)
+    {
+        uint32 count = __atomic_load_n(&self->count, __ATOMIC_ACQUIRE);
+        if (count > 0)
+        {
+            if (__atomic_compare_exchange_n(&self->count, &count, count-1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            {
+                return;
+            }
+            continue;
+        }
+
+        __atomic_add_fetch(&self->waiterCount, 1, __ATOMIC_SEQ_CST);
+        Futex_Wait(&self->count, 0);
+        __atomic_sub_fetch(&self->waiterCount, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void* ThreadEntry(void* parameter)
+{
+    Thread* self = (Thread*)parameter;
+    self->function(self->userData);
+    return null;
+}
+
+void Thread_Start(Thread* self, ThreadFunction function, void* userData)
+{
+    self->function = function;
+    self->userData = userData;
+    pthread_t thread;
+    int result = pthread_create(&thread, null, ThreadEntry, self);
+    if (result != 0)
+    {
+        ErrorF("failed to create thread: %d", result);
+    }
+    self->internalHandle = (void*)(uintptr_t)thread;
+}
+
+void Thread_Join(Thread* self)
+{
+    if (self->internalHandle)
+    {
+        pthread_join((pthread_t)(uintptr_t)self->internalHandle, null);
+        self->internalHandle = null;
+    }
+}
+
+uint32 Thread_GetCurrentId()
+{
+    // gettid is a syscall, cache it since every mutex lock asks for it.
+    if (currentThreadId == 0)
+    {
+        currentThreadId = (uint32)syscall(SYS_gettid);
+    }
+    return currentThreadId;
+}
+
+void Thread_Yield()
+{
+    sched_yield();
+}
+
+// the destructor of a thread specific key runs on thread exit, __thread variables don't have one.
+static pthread_key_t exitKey;
+static pthread_once_t exitKeyOnce = PTHREAD_ONCE_INIT;
+static int exitKeyResult;
+
+static void ExitKeyDestructor(void* value)
+{
+    Unused(value);
+    RunExitEntries();
+}
+
+static void CreateExitKey()
+{
+    exitKeyResult = pthread_key_create(&exitKey, ExitKeyDestructor);
+}
+
+void Thread_AtExit(ThreadExitFunction function, void* userData)
+{
+    pthread_once(&exitKeyOnce, CreateExitKey);
+    if (exitKeyResult != 0)
+    {
+        ErrorF("failed to create thread key: %d", exitKeyResult);
+    }
+    AddExitEntry(function, userData);
+    // the destructor only runs for threads with a value set.
+    pthread_setspecific(exitKey, (void*)1);
+}
+
+static int32 GetAffinityCount()
+{
+    // the set has to be big enough for every cpu the kernel knows about, grow it until it is.
+    for (int32 cpuCount = 1024; cpuCount <= 64*1024; cpuCount *= 2)
+    {
+        cpu_set_t* set = CPU_ALLOC(cpuCount);
+        size_t setSize = CPU_ALLOC_SIZE(cpuCount);
+        CPU_ZERO_S(setSize, set);
+        if (sched_getaffinity(0, setSize, set) == 0)
+        {
+            int32 count = CPU_COUNT_S(setSize, set);
+            CPU_FREE(set);
+            return count;
+        }
+        CPU_FREE(set);
+        if (errno != EINVAL)
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+// whole cpus worth of cfs quota of the process's cgroup, 0 when there's no limit.
+static int32 GetCgroupCpuLimit()
+{
+    double quota = 0;
+    double period = 0;
+
+    // cgroup v2. the process's own cgroup is listed as "0::<path>".
+    char path[512] = "/";
+    FILE* file = fopen("/proc/self/cgroup", "r");
+    if (file)
+    {
+        char line[512];
+        while (fgets(line, sizeof(line), file))
+        {
+            if (line[0] == '0' && line[1] == ':' && line[2] == ':')
+            {
+                SScanF(line+3, "%511s", path);
+                break;
+            }
+        }
+        fclose(file);
+    }
+
+    char cpuMaxPath[600];
+    SPrintF(cpuMaxPath, sizeof(cpuMaxPath), "/sys/fs/cgroup%s/cpu.max", StrCmp(path, "/", true) == 0 ? "" : path);
+    file = fopen(cpuMaxPath, "r");
+    if (!file)
+    {
+        // inside a cgroup namespace the path can be relative to a root that isn't mounted, try the mounted root.
+        file = fopen("/sys/fs/cgroup/cpu.max", "r");
+    }
+    if (file)
+    {
+        char quotaString[32];
+        if (fscanf(file, "%31s %lf", quotaString, &period) == 2 && StrCmp(quotaString, "max", true) != 0)
+        {
+            quota = strtod(quotaString, null);
+        }
+        fclose(file);
+    }
+    else
+    {
+        // cgroup v1, -1 means no limit.
+        file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r");
+        if (file)
+        {
+            if (fscanf(file, "%lf", &quota) != 1)
+            {
+                quota = 0;
+            }
+            fclose(file);
+        }
+        file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r");
+        if (file)
+        {
+            if (fscanf(file, "%lf", &period) != 1)
+            {
+                period = 0;
+            }
+            fclose(file);
+        }
+    }
+
+    if (quota <= 0 || period <= 0)
+    {
+        return 0;
+    }
+    // a quota of 1.5 cpus still keeps 2 threads busy part of the time, round up.
+    return (int32)ceil(quota/period);
+}
+
+int32 Thread_GetHardwareThreadCount()
+{
+    // reads procfs and sysfs, cache it.
+    static uint32 cachedCount = 0;
+    int32 result = (int32)Atomic_LoadAcquire32(&cachedCount);
+    if (result == 0)
+    {
+        result = GetAffinityCount();
+        if (result <= 0)
+        {
+            long count = sysconf(_SC_NPROCESSORS_ONLN);
+            result = count > 0 ? (int32)count : 1;
+        }
+        int32 cgroupLimit = GetCgroupCpuLimit();
+        if (cgroupLimit > 0 && cgroupLimit < result)
+        {
+            result = cgroupLimit;
+        }
+        Atomic_StoreRelease32(&cachedCount, (uint32)result);
+    }
+    return result;
+}
+#endif
+
+typedef struct ParallelForChunk
+{
+    ParallelForFunction function;
+    void* userData;
+    int64 start;
+    int64 count;
+    int32 index;
+} ParallelForChunk;
+
+static void ParallelForChunk_Run(void* userData)
+{
+    ParallelForChunk* chunk = (ParallelForChunk*)userData;
+    chunk->function(chunk->userData, chunk->start, chunk->count, chunk->index);
+}
+
+int32 Thread_ParallelFor(int64 count, int32 threadCount, int64 minCountPerThread, int64 granularity, ParallelForFunction function, void* userData)
+{
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    if (threadCount <= 0)
+    {
+        threadCount = Thread_GetHardwareThreadCount();
+    }
+    int64 usefulThreads = minCountPerThread > 0 ? count/minCountPerThread : count;
+    if (usefulThreads < threadCount)
+    {
+        threadCount = usefulThreads > 1 ? (int32)usefulThreads : 1;
+    }
+    if (threadCount > Thread_MaxParallelForChunks)
+    {
+        threadCount = Thread_MaxParallelForChunks;
+    }
+    if (granularity < 1)
+    {
+        granularity = 1;
+    }
+
+    if (threadCount == 1)
+    {
+        function(userData, 0, count, 0);
+        return 1;
+    }
+
+    int64 chunkSize = (count+threadCount-1)/threadCount;
+    chunkSize = (chunkSize+granularity-1)/granularity*granularity;
+
+    ParallelForChunk chunks[Thread_MaxParallelForChunks];
+    Thread threads[Thread_MaxParallelForChunks];
+    int32 chunkCount = 0;
+    for (int64 start = 0; start < count; start += chunkSize)
+    {
+        ParallelForChunk* chunk = &chunks[chunkCount];
+        chunk->function = function;
+        chunk->userData = userData;
+        chunk->start = start;
+        chunk->count = count-start < chunkSize ? count-start : chunkSize;
+        chunk->index = chunkCount;
+        chunkCount++;
+    }
+
+    for (int32 i = 1; i < chunkCount; i++)
+    {
+        Thread_Start(&threads[i], ParallelForChunk_Run, &chunks[i]);
+    }
+    ParallelForChunk_Run(&chunks[0]);
+    for (int32 i = 1; i < chunkCount; i++)
+    {
+        Thread_Join(&threads[i]);
+    }
+    return chunkCount;
+}
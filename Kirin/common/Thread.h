@@ -2,21 +2,156 @@
 
 #include "common/Standard.h"
 
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#endif
+
 #if PLATFORM_WINDOWS
 #if BITNESS_64
 __forceinline void KMemoryBarrier() { __faststorefence(); }
 #else
 __forceinline void KMemoryBarrier() { long barrier; _InterlockedOr(&barrier, 0); }
 #endif
+#elif PLATFORM_LINUX
+static inline void KMemoryBarrier() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
 #else
 #error KMemoryBarrier not implemented on this platform.
 #endif
 
+// recursive. zero initialized is unlocked, no setup needed.
 typedef struct Mutex
 {
+#if PLATFORM_WINDOWS
     void* internalHandle;
+#else
+    // 0 unlocked, 1 locked, 2 locked and maybe contended.
+    volatile uint32 state;
+    volatile uint32 ownerThreadId;
+    uint32 recursionCount;
+#endif
 } Mutex;
 
 void Mutex_Free(Mutex* self);
 void Mutex_Lock(volatile Mutex* self);
 void Mutex_Unlock(Mutex* self);
+
+// counting. zero initialized has a count of 0, no setup needed.
+typedef struct Semaphore
+{
+#if PLATFORM_WINDOWS
+    void* internalHandle;
+#else
+    volatile uint32 count;
+    volatile uint32 waiterCount;
+#endif
+} Semaphore;
+
+void Semaphore_Free(Semaphore* self);
+// adds one to the count, waking a waiter if there is one.
+void Semaphore_Signal(Semaphore* self);
+// waits until the count is above 0 and takes one from it.
+void Semaphore_Wait(Semaphore* self);
+
+typedef void (*ThreadFunction)(void* userData);
+
+typedef struct Thread
+{
+	void* internalHandle;
+	ThreadFunction function;
+	void* userData;
+} Thread;
+
+// self must stay valid until Thread_Join returns.
+void Thread_Start(Thread* self, ThreadFunction function, void* userData);
+void Thread_Join(Thread* self);
+uint32 Thread_GetCurrentId();
+void Thread_Yield();
+
+typedef void (*ThreadExitFunction)(void* userData);
+
+#define Thread_MaxExitFunctions 4
+
+// runs function with userData on the calling thread when it exits, latest first. works for any thread, not only ones
+// Thread_Start made, but may not run for the thread that ends the process. up to Thread_MaxExitFunctions per thread.
+void Thread_AtExit(ThreadExitFunction function, void* userData);
+// logical processors available to the process: the ones in its affinity mask, on linux also limited by a cgroup cpu
+// quota rounded up. read on the first call and cached.
+int32 Thread_GetHardwareThreadCount();
+
+#define Thread_MaxParallelForChunks 64
+
+// processes [start, start+count). chunkIndex is below Thread_MaxParallelForChunks and increases with start.
+typedef void (*ParallelForFunction)(void* userData, int64 start, int64 count, int32 chunkIndex);
+
+// splits [0, count) into one contiguous chunk per thread and waits for all of them. returns the number of chunks.
+// chunks start at multiples of granularity. threadCount <= 0 uses every hardware thread, fewer are used so each gets at least minCountPerThread.
+// threads are started per call and the first chunk runs on the calling thread, this only pays off for big batches.
+int32 Thread_ParallelFor(int64 count, int32 threadCount, int64 minCountPerThread, int64 granularity, ParallelForFunction function, void* userData);
+
+#if PLATFORM_WINDOWS
+#define ThreadLocal __declspec(thread)
+
+// x86 and x64 loads and stores are already ordered, the compiler just has to be kept from moving them.
+static inline uint32 Atomic_LoadAcquire32(volatile uint32* value)
+{
+	uint32 result = *value;
+	_ReadWriteBarrier();
+	return result;
+}
+
+static inline void Atomic_StoreRelease32(volatile uint32* value, uint32 newValue)
+{
+	_ReadWriteBarrier();
+	*value = newValue;
+}
+
+// returns the incremented value.
+static inline int32 Atomic_Increment32(volatile int32* value)
+{
+	return _InterlockedIncrement((volatile long*)value);
+}
+
+// returns the decremented value.
+static inline int32 Atomic_Decrement32(volatile int32* value)
+{
+	return _InterlockedDecrement((volatile long*)value);
+}
+
+// returns the previous value.
+static inline int32 Atomic_Exchange32(volatile int32* value, int32 newValue)
+{
+	return _InterlockedExchange((volatile long*)value, newValue);
+}
+#elif PLATFORM_LINUX
+#define ThreadLocal __thread
+
+static inline uint32 Atomic_LoadAcquire32(volatile uint32* value)
+{
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void Atomic_StoreRelease32(volatile uint32* value, uint32 newValue)
+{
+	__atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+// returns the incremented value.
+static inline int32 Atomic_Increment32(volatile int32* value)
+{
+	return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+// returns the decremented value.
+static inline int32 Atomic_Decrement32(volatile int32* value)
+{
+	return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+// returns the previous value.
+static inline int32 Atomic_Exchange32(volatile int32* value, int32 newValue)
+{
+	return __atomic_exchange_n(value, newValue, __ATOMIC_SEQ_CST);
+}
+#else
+#error atomics not implemented on this platform.
+#endif
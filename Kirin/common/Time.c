@@ -1,47 +1,205 @@
-
 #include "common/Time.h"
 
+#if PLATFORM_WINDOWS
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#elif PLATFORM_LINUX
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#if ARCH_X86
+#include <cpuid.h>
+#endif
+#endif
 
-static double invTickFrequency = 1.0;
-static bool needsFrequencyScale;
-void InitTime()
+#define TicksPerSecond 10000000ull
+// how long InitTime spins to measure the tsc against the os clock.
+#define TSCCalibrationTicks 200000ull
+
+// fixed point multiplier so counter to tick conversion is an integer multiply and shift instead of a double multiply.
+typedef struct TimeScale
 {
-	LARGE_INTEGER freq;
-	if (!QueryPerformanceFrequency(&freq))
+	uint64 mul;
+	int32 shift;
+} TimeScale;
+
+bool gTimeUseTSC;
+static bool hasInvariantTSC;
+static uint64 osFrequency;
+static uint64 cycleFrequency;
+static TimeScale osToTicks;
+static TimeScale cyclesToTicks;
+
+static TimeScale TimeScale_New(uint64 frequency)
+{
+	// keep mul below 2^32 so the low half multiply in TimeScale_Apply can't overflow.
+	double ticksPerUnit = (double)TicksPerSecond/(double)frequency;
+	TimeScale result = { 0, 32 };
+	while (result.shift > 0 && ticksPerUnit*(double)(1ull << result.shift) >= 4294967296.0)
 	{
-		Error("QueryPerformanceFrequency failed.");
+		result.shift--;
 	}
-	if (freq.QuadPart == 10000000)
+	result.mul = (uint64)(ticksPerUnit*(double)(1ull << result.shift)+0.5);
+	return result;
+}
+
+static inline uint64 TimeScale_Apply(TimeScale scale, uint64 value)
+{
+	uint64 high = value >> scale.shift;
+	uint64 low = value & ((1ull << scale.shift)-1);
+	return high*scale.mul+((low*scale.mul) >> scale.shift);
+}
+
+#if ARCH_X86
+static bool CurrentCoreHasInvariantTSC()
+{
+	uint32 regs[4];
+#if PLATFORM_WINDOWS
+	__cpuid((int*)regs, 0x80000000);
+	if (regs[0] < 0x80000007)
 	{
-		invTickFrequency = 1.0;
-		needsFrequencyScale = false;
+		return false;
 	}
-	else
+	__cpuid((int*)regs, 0x80000007);
+#else
+	if (!__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3]))
 	{
-		invTickFrequency = 1.0/((double)freq.QuadPart/10000000.0);
-		needsFrequencyScale = true;
+		return false;
 	}
+#endif
+	// edx bit 8: tsc runs at a constant rate across p-states and c-states.
+	return (regs[3] & (1 << 8)) != 0;
 }
 
-uint64 GetTicks()
+// the invariant tsc bit is reported per core, so pin the thread to each allowed core in turn and check them all.
+static bool DetectInvariantTSC()
 {
+	bool result = true;
+#if PLATFORM_WINDOWS
+	DWORD_PTR processMask;
+	DWORD_PTR systemMask;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+	{
+		return CurrentCoreHasInvariantTSC();
+	}
+	HANDLE thread = GetCurrentThread();
+	DWORD_PTR previousMask = SetThreadAffinityMask(thread, processMask);
+	for (int32 i = 0; i < (int32)sizeof(DWORD_PTR)*8 && result; i++)
+	{
+		DWORD_PTR coreMask = (DWORD_PTR)1 << i;
+		if ((processMask & coreMask) && SetThreadAffinityMask(thread, coreMask))
+		{
+			result = CurrentCoreHasInvariantTSC();
+		}
+	}
+	SetThreadAffinityMask(thread, previousMask ? previousMask : processMask);
+#else
+	cpu_set_t previousSet;
+	if (sched_getaffinity(0, sizeof(cpu_set_t), &previousSet) != 0)
+	{
+		return CurrentCoreHasInvariantTSC();
+	}
+	for (int32 i = 0; i < CPU_SETSIZE && result; i++)
+	{
+		if (!CPU_ISSET(i, &previousSet))
+		{
+			continue;
+		}
+		cpu_set_t coreSet;
+		CPU_ZERO(&coreSet);
+		CPU_SET(i, &coreSet);
+		if (sched_setaffinity(0, sizeof(cpu_set_t), &coreSet) == 0)
+		{
+			result = CurrentCoreHasInvariantTSC();
+		}
+	}
+	sched_setaffinity(0, sizeof(cpu_set_t), &previousSet);
+#endif
+	return result;
+}
+#endif
+
+uint64 GetCyclesOS()
+{
+#if PLATFORM_WINDOWS
 	LARGE_INTEGER query;
-	if (!QueryPerformanceCounter(&query))
+	QueryPerformanceCounter(&query);
+	return (uint64)query.QuadPart;
+#elif PLATFORM_LINUX
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (uint64)ts.tv_sec*1000000000ull+(uint64)ts.tv_nsec;
+#endif
+}
+
+void InitTime()
+{
+#if PLATFORM_WINDOWS
+	LARGE_INTEGER freq;
+	if (!QueryPerformanceFrequency(&freq))
+	{
+		Error("QueryPerformanceFrequency failed.");
+	}
+	osFrequency = (uint64)freq.QuadPart;
+#elif PLATFORM_LINUX
+	struct timespec res;
+	if (clock_getres(CLOCK_MONOTONIC_RAW, &res) != 0)
 	{
-		Error("QueryPerformanceCounter failed.");
+		Error("CLOCK_MONOTONIC_RAW is not supported.");
 	}
-	uint64 ticks = query.QuadPart;
-	if (needsFrequencyScale)
+	osFrequency = 1000000000ull;
+#endif
+	osToTicks = TimeScale_New(osFrequency);
+
+	gTimeUseTSC = false;
+	hasInvariantTSC = false;
+	cycleFrequency = osFrequency;
+
+#if ARCH_X86
+	hasInvariantTSC = DetectInvariantTSC();
+	if (hasInvariantTSC)
 	{
-		ticks = (uint64)((double)ticks*invTickFrequency);
+		// measure the tsc rate against the os clock. this only happens once so a short spin is fine.
+		uint64 osStart = GetCyclesOS();
+		uint64 tscStart = __rdtsc();
+		uint64 osEnd;
+		uint64 tscEnd;
+		do
+		{
+			osEnd = GetCyclesOS();
+			tscEnd = __rdtsc();
+		} while (TimeScale_Apply(osToTicks, osEnd-osStart) < TSCCalibrationTicks);
+
+		cycleFrequency = (uint64)((double)(tscEnd-tscStart)*(double)osFrequency/(double)(osEnd-osStart));
+		gTimeUseTSC = true;
 	}
-	return ticks;
+#endif
+	cyclesToTicks = TimeScale_New(cycleFrequency);
+}
+
+uint64 GetTicks()
+{
+	return TimeScale_Apply(osToTicks, GetCyclesOS());
+}
+
+uint64 GetCycleFrequency()
+{
+	return cycleFrequency;
+}
+
+uint64 CyclesToTicks(uint64 cycles)
+{
+	return TimeScale_Apply(cyclesToTicks, cycles);
+}
+
+bool Time_HasInvariantTSC()
+{
+	return hasInvariantTSC;
 }
 
 void SleepTicks(int64 ticks)
 {
+#if PLATFORM_WINDOWS
 	__declspec(thread) static HANDLE timer;
 	__declspec(thread) static bool timerCreated = false;
 
@@ -61,4 +219,17 @@ void SleepTicks(int64 ticks)
 	}
 
 	WaitForSingleObject(timer, INFINITE);
+#elif PLATFORM_LINUX
+	if (ticks <= 0)
+	{
+		return;
+	}
+	struct timespec ts;
+	ts.tv_sec = (time_t)(ticks/TicksPerSecond);
+	ts.tv_nsec = (long)(ticks%TicksPerSecond)*100;
+	// clock_nanosleep writes the remaining time back into ts when interrupted.
+	while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR)
+	{
+	}
+#endif
 }
@@ -2,6 +2,14 @@
 
 #include "common/Standard.h"
 
+#if ARCH_X86
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
 void InitTime();
 
 // get tick counter. there are 10000 ticks in 1 milisecond.
@@ -9,3 +17,31 @@ uint64 GetTicks();
 
 // sleep for a number of ticks. there are 10000 ticks in 1 milisecond.
 void SleepTicks(int64 ticks);
+
+// true when GetCycles reads the tsc directly. set by InitTime.
+extern bool gTimeUseTSC;
+
+// raw os counter used by GetCycles when the tsc can't be trusted.
+uint64 GetCyclesOS();
+
+// get the raw cycle counter. this is the cheapest timestamp available and is meant for profiling.
+// the value has no fixed unit, convert deltas with CyclesToTicks when reporting them.
+static inline uint64 GetCycles()
+{
+#if ARCH_X86
+	if (gTimeUseTSC)
+	{
+		return __rdtsc();
+	}
+#endif
+	return GetCyclesOS();
+}
+
+// number of cycles per second, as calibrated by InitTime.
+uint64 GetCycleFrequency();
+
+// convert a cycle count (usually a delta) into ticks. there are 10000 ticks in 1 milisecond.
+uint64 CyclesToTicks(uint64 cycles);
+
+// true if every core the process can run on reports an invariant tsc.
+bool Time_HasInvariantTSC();
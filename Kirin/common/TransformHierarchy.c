@@ -0,0 +1,428 @@
+#include "common/TransformHierarchy.h"
+
+#include "common/Math.h"
+#include "common/RadixSort.h"
+#include "common/Thread.h"
+
+// pieces of the parallel update are at most the changed node count over this, so threads that finish early can pick up more.
+#define TransformHierarchy_PiecesPerThread 8
+#define TransformHierarchy_MinNodesPerPiece 1024
+
+// grows an array to hold at least needed elements, doubling so repeated growth stays linear.
+static void* Reserve(void* array, int32* capacity, int32 needed, size_t elementSize)
+{
+	if (needed <= *capacity)
+	{
+		return array;
+	}
+	int32 newCapacity = MaxI(MaxI(*capacity*2, needed), 16);
+	*capacity = newCapacity;
+	return MRealloc(array, newCapacity*elementSize);
+}
+
+static void ReserveNodes(TransformHierarchy* self, int32 needed)
+{
+	if (needed <= self->nodeCapacity)
+	{
+		return;
+	}
+	int32 capacity = MaxI(MaxI(self->nodeCapacity*2, needed), 16);
+	self->parents = MRealloc(self->parents, capacity*sizeof(int32));
+	self->subtreeSizes = MRealloc(self->subtreeSizes, capacity*sizeof(int32));
+	self->handles = MRealloc(self->handles, capacity*sizeof(int32));
+	self->locals = MRealloc(self->locals, capacity*sizeof(Transformer));
+	self->worlds = MRealloc(self->worlds, capacity*sizeof(Transformer));
+	self->worldMatrices = MRealloc(self->worldMatrices, capacity*sizeof(Matrix4));
+	self->dirty = MRealloc(self->dirty, capacity*sizeof(uint8));
+	self->nodeCapacity = capacity;
+}
+
+static void MarkDirty(TransformHierarchy* self, int32 index)
+{
+	if (self->dirty[index])
+	{
+		return;
+	}
+	self->dirty[index] = 1;
+	self->dirtyNodes = Reserve(self->dirtyNodes, &self->dirtyNodeCapacity, self->dirtyNodeCount+1, sizeof(int32));
+	self->dirtyNodes[self->dirtyNodeCount++] = index;
+}
+
+// puts the nodes back in depth first order. siblings keep their order, added nodes come after their older siblings.
+static void SortNodes(TransformHierarchy* self)
+{
+	self->needsSort = false;
+	int32 count = self->nodeCount;
+	// children come after their parents, so going backwards every subtree is complete before it's added to its parent.
+	for (int32 i = 0; i < count; i++)
+	{
+		self->subtreeSizes[i] = 1;
+	}
+	for (int32 i = count-1; i >= 0; i--)
+	{
+		if (self->parents[i] >= 0)
+		{
+			self->subtreeSizes[self->parents[i]] += self->subtreeSizes[i];
+		}
+	}
+
+	// a node goes where its parent's next child goes, right after the previous sibling's subtree.
+	int32* newIndices = MAlloc(MaxI(count, 1)*sizeof(int32));
+	int32* nextChild = MAlloc(MaxI(count, 1)*sizeof(int32));
+	int32 nextRoot = 0;
+	bool inOrder = true;
+	for (int32 i = 0; i < count; i++)
+	{
+		int32 parent = self->parents[i];
+		int32* next = parent < 0 ? &nextRoot : &nextChild[parent];
+		newIndices[i] = *next;
+		*next += self->subtreeSizes[i];
+		nextChild[i] = newIndices[i]+1;
+		inOrder &= newIndices[i] == i;
+	}
+	MFree(nextChild);
+	if (inOrder)
+	{
+		MFree(newIndices);
+		return;
+	}
+
+	int32* parents = MAlloc(self->nodeCapacity*sizeof(int32));
+	int32* subtreeSizes = MAlloc(self->nodeCapacity*sizeof(int32));
+	int32* handles = MAlloc(self->nodeCapacity*sizeof(int32));
+	Transformer* locals = MAlloc(self->nodeCapacity*sizeof(Transformer));
+	Transformer* worlds = MAlloc(self->nodeCapacity*sizeof(Transformer));
+	Matrix4* worldMatrices = MAlloc(self->nodeCapacity*sizeof(Matrix4));
+	uint8* dirty = MAlloc(self->nodeCapacity*sizeof(uint8));
+	for (int32 i = 0; i < count; i++)
+	{
+		int32 index = newIndices[i];
+		int32 parent = self->parents[i];
+		parents[index] = parent < 0 ? -1 : newIndices[parent];
+		subtreeSizes[index] = self->subtreeSizes[i];
+		handles[index] = self->handles[i];
+		locals[index] = self->locals[i];
+		worlds[index] = self->worlds[i];
+		worldMatrices[index] = self->worldMatrices[i];
+		dirty[index] = self->dirty[i];
+		self->handleSlots[self->handles[i]].index = index;
+	}
+	for (int32 i = 0; i < self->dirtyNodeCount; i++)
+	{
+		self->dirtyNodes[i] = newIndices[self->dirtyNodes[i]];
+	}
+
+	MFree(self->parents);
+	MFree(self->subtreeSizes);
+	MFree(self->handles);
+	MFree(self->locals);
+	MFree(self->worlds);
+	MFree(self->worldMatrices);
+	MFree(self->dirty);
+	self->parents = parents;
+	self->subtreeSizes = subtreeSizes;
+	self->handles = handles;
+	self->locals = locals;
+	self->worlds = worlds;
+	self->worldMatrices = worldMatrices;
+	self->dirty = dirty;
+	MFree(newIndices);
+}
+
+void TransformHierarchy_Init(TransformHierarchy* self)
+{
+	MemSet(self, 0, sizeof(TransformHierarchy));
+	self->firstFreeHandle = -1;
+}
+
+void TransformHierarchy_Free(TransformHierarchy* self)
+{
+	MFree(self->parents);
+	MFree(self->subtreeSizes);
+	MFree(self->handles);
+	MFree(self->locals);
+	MFree(self->worlds);
+	MFree(self->worldMatrices);
+	MFree(self->dirty);
+	MFree(self->dirtyNodes);
+	MFree(self->updatedRanges);
+	MFree(self->handleSlots);
+	MemSet(self, 0, sizeof(TransformHierarchy));
+}
+
+int32 TransformHierarchy_Add(TransformHierarchy* self, int32 parent, const Transformer* local)
+{
+	int32 handle = self->firstFreeHandle;
+	if (handle >= 0)
+	{
+		self->firstFreeHandle = self->handleSlots[handle].nextFree;
+	}
+	else
+	{
+		handle = self->handleCount++;
+		self->handleSlots = Reserve(self->handleSlots, &self->handleCapacity, self->handleCount, sizeof(TransformHierarchyHandle));
+	}
+
+	int32 index = self->nodeCount++;
+	ReserveNodes(self, self->nodeCount);
+	int32 parentIndex = -1;
+	if (parent >= 0)
+	{
+		parentIndex = self->handleSlots[parent].index;
+		DevAssert(parentIndex >= 0);
+	}
+	self->handleSlots[handle] = (TransformHierarchyHandle){ index, -1 };
+	self->parents[index] = parentIndex;
+	self->subtreeSizes[index] = 1;
+	self->handles[index] = handle;
+	self->locals[index] = *local;
+	self->worlds[index] = *local;
+	self->worldMatrices[index] = Transformer_ToMatrix4(local);
+	self->dirty[index] = 0;
+	MarkDirty(self, index);
+
+	// when the parent's subtree already ends at the end of the array, so does every ancestor's, and the new node just extends them.
+	// building a hierarchy depth first never needs a sort.
+	if (parentIndex >= 0 && !self->needsSort)
+	{
+		if (parentIndex+self->subtreeSizes[parentIndex] == index)
+		{
+			for (int32 p = parentIndex; p >= 0; p = self->parents[p])
+			{
+				self->subtreeSizes[p]++;
+			}
+		}
+		else
+		{
+			self->needsSort = true;
+		}
+	}
+	return handle;
+}
+
+void TransformHierarchy_Remove(TransformHierarchy* self, int32 handle)
+{
+	if (self->needsSort)
+	{
+		SortNodes(self);
+	}
+
+	int32 start = self->handleSlots[handle].index;
+	DevAssert(start >= 0);
+	int32 removedCount = self->subtreeSizes[start];
+	int32 end = start+removedCount;
+	for (int32 i = start; i < end; i++)
+	{
+		int32 removedHandle = self->handles[i];
+		self->handleSlots[removedHandle] = (TransformHierarchyHandle){ -1, self->firstFreeHandle };
+		self->firstFreeHandle = removedHandle;
+	}
+	for (int32 p = self->parents[start]; p >= 0; p = self->parents[p])
+	{
+		self->subtreeSizes[p] -= removedCount;
+	}
+
+	int32 movedCount = self->nodeCount-end;
+	MemMove(self->parents+start, self->parents+end, movedCount*sizeof(int32));
+	MemMove(self->subtreeSizes+start, self->subtreeSizes+end, movedCount*sizeof(int32));
+	MemMove(self->handles+start, self->handles+end, movedCount*sizeof(int32));
+	MemMove(self->locals+start, self->locals+end, movedCount*sizeof(Transformer));
+	MemMove(self->worlds+start, self->worlds+end, movedCount*sizeof(Transformer));
+	MemMove(self->worldMatrices+start, self->worldMatrices+end, movedCount*sizeof(Matrix4));
+	MemMove(self->dirty+start, self->dirty+end, movedCount*sizeof(uint8));
+	self->nodeCount -= removedCount;
+	for (int32 i = start; i < self->nodeCount; i++)
+	{
+		// parents before start didn't move.
+		if (self->parents[i] >= end)
+		{
+			self->parents[i] -= removedCount;
+		}
+		self->handleSlots[self->handles[i]].index = i;
+	}
+
+	int32 dirtyNodeCount = 0;
+	for (int32 i = 0; i < self->dirtyNodeCount; i++)
+	{
+		int32 index = self->dirtyNodes[i];
+		if (index < start)
+		{
+			self->dirtyNodes[dirtyNodeCount++] = index;
+		}
+		else if (index >= end)
+		{
+			self->dirtyNodes[dirtyNodeCount++] = index-removedCount;
+		}
+	}
+	self->dirtyNodeCount = dirtyNodeCount;
+}
+
+void TransformHierarchy_SetLocal(TransformHierarchy* self, int32 handle, const Transformer* local)
+{
+	int32 index = self->handleSlots[handle].index;
+	DevAssert(index >= 0);
+	self->locals[index] = *local;
+	MarkDirty(self, index);
+}
+
+// the parent of start has to be up to date, or start has to be a root.
+static void UpdateNodes(TransformHierarchy* self, int32 start, int32 count)
+{
+	const int32* parents = self->parents;
+	const Transformer* locals = self->locals;
+	Transformer* worlds = self->worlds;
+	for (int32 i = start; i < start+count; i++)
+	{
+		int32 parent = parents[i];
+		worlds[i] = parent < 0 ? locals[i] : Transformer_Multiply(&locals[i], &worlds[parent]);
+		self->worldMatrices[i] = Transformer_ToMatrix4(&worlds[i]);
+		self->dirty[i] = 0;
+	}
+}
+
+// turns the dirty nodes into the subtree ranges that need updating, and returns how many nodes they cover.
+static int32 CollectUpdatedRanges(TransformHierarchy* self)
+{
+	if (self->needsSort)
+	{
+		SortNodes(self);
+	}
+
+	// ascending, so a node's dirty ancestors come before it and it can be skipped when their range covers it.
+	RadixSort_U32((uint32*)self->dirtyNodes, null, self->dirtyNodeCount, null);
+	self->updatedRangeCount = 0;
+	int32 updatedNodeCount = 0;
+	int32 end = 0;
+	for (int32 i = 0; i < self->dirtyNodeCount; i++)
+	{
+		int32 start = self->dirtyNodes[i];
+		if (start < end)
+		{
+			continue;
+		}
+		int32 count = self->subtreeSizes[start];
+		updatedNodeCount += count;
+		end = start+count;
+		if (self->updatedRangeCount > 0 && self->updatedRanges[self->updatedRangeCount-1].start+self->updatedRanges[self->updatedRangeCount-1].count == start)
+		{
+			self->updatedRanges[self->updatedRangeCount-1].count += count;
+			continue;
+		}
+		self->updatedRanges = Reserve(self->updatedRanges, &self->updatedRangeCapacity, self->updatedRangeCount+1, sizeof(TransformHierarchyRange));
+		self->updatedRanges[self->updatedRangeCount++] = (TransformHierarchyRange){ start, count };
+	}
+	self->dirtyNodeCount = 0;
+	return updatedNodeCount;
+}
+
+void TransformHierarchy_Update(TransformHierarchy* self)
+{
+	CollectUpdatedRanges(self);
+	for (int32 i = 0; i < self->updatedRangeCount; i++)
+	{
+		UpdateNodes(self, self->updatedRanges[i].start, self->updatedRanges[i].count);
+	}
+}
+
+typedef struct ParallelUpdate
+{
+	TransformHierarchy* hierarchy;
+	// independent subtrees, or runs of them, whose parents are already up to date.
+	TransformHierarchyRange* pieces;
+	// where each piece starts when they are laid out one after another, with the total at the end.
+	int64* pieceStarts;
+	int32 pieceCount;
+} ParallelUpdate;
+
+// a chunk updates the pieces that start inside it.
+static void ParallelUpdate_Run(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	Unused(chunkIndex);
+	ParallelUpdate* update = (ParallelUpdate*)userData;
+	int32 low = 0;
+	int32 high = update->pieceCount;
+	while (low < high)
+	{
+		int32 middle = (low+high)/2;
+		if (update->pieceStarts[middle] < start)
+		{
+			low = middle+1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	for (int32 i = low; i < update->pieceCount && update->pieceStarts[i] < start+count; i++)
+	{
+		UpdateNodes(update->hierarchy, update->pieces[i].start, update->pieces[i].count);
+	}
+}
+
+void TransformHierarchy_UpdateParallel(TransformHierarchy* self, int32 threadCount)
+{
+	int32 updatedNodeCount = CollectUpdatedRanges(self);
+	if (threadCount <= 0)
+	{
+		threadCount = Thread_GetHardwareThreadCount();
+	}
+	if (threadCount <= 1 || updatedNodeCount < 2*TransformHierarchy_MinNodesPerThread)
+	{
+		for (int32 i = 0; i < self->updatedRangeCount; i++)
+		{
+			UpdateNodes(self, self->updatedRanges[i].start, self->updatedRanges[i].count);
+		}
+		return;
+	}
+
+	// ranges too big to balance are split on this thread, by updating their root and going on with each child's subtree.
+	// a long chain of single children can't be split and ends up as one piece.
+	int32 maxPieceSize = MaxI(updatedNodeCount/(threadCount*TransformHierarchy_PiecesPerThread), TransformHierarchy_MinNodesPerPiece);
+	ParallelUpdate update = { self, null, null, 0 };
+	int32 pieceCapacity = 0;
+	TransformHierarchyRange* stack = null;
+	int32 stackCount = 0;
+	int32 stackCapacity = 0;
+	for (int32 r = 0; r < self->updatedRangeCount; r++)
+	{
+		stack = Reserve(stack, &stackCapacity, stackCount+1, sizeof(TransformHierarchyRange));
+		stack[stackCount++] = self->updatedRanges[r];
+		while (stackCount > 0)
+		{
+			TransformHierarchyRange range = stack[--stackCount];
+			if (range.count <= maxPieceSize)
+			{
+				update.pieces = Reserve(update.pieces, &pieceCapacity, update.pieceCount+1, sizeof(TransformHierarchyRange));
+				update.pieces[update.pieceCount++] = range;
+				continue;
+			}
+
+			// a merged range is a run of sibling subtrees rather than one subtree.
+			int32 end = range.start+range.count;
+			int32 child = range.start;
+			if (self->subtreeSizes[range.start] == range.count)
+			{
+				UpdateNodes(self, range.start, 1);
+				child++;
+			}
+			for (; child < end; child += self->subtreeSizes[child])
+			{
+				stack = Reserve(stack, &stackCapacity, stackCount+1, sizeof(TransformHierarchyRange));
+				stack[stackCount++] = (TransformHierarchyRange){ child, self->subtreeSizes[child] };
+			}
+		}
+	}
+	MFree(stack);
+
+	update.pieceStarts = MAlloc((update.pieceCount+1)*sizeof(int64));
+	int64 pieceStart = 0;
+	for (int32 i = 0; i < update.pieceCount; i++)
+	{
+		update.pieceStarts[i] = pieceStart;
+		pieceStart += update.pieces[i].count;
+	}
+	update.pieceStarts[update.pieceCount] = pieceStart;
+	Thread_ParallelFor(pieceStart, threadCount, TransformHierarchy_MinNodesPerThread, 1, ParallelUpdate_Run, &update);
+	MFree(update.pieces);
+	MFree(update.pieceStarts);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Space.h"
+
+// scene graph transforms. every node has a local transformer relative to its parent, the update turns them into world transformers.
+// nodes are kept in depth first order as structure of arrays, so a parent always comes before its children
+// and a subtree is the contiguous range of subtreeSizes[i] nodes starting at its root i.
+// nodes are referred to by handles, their indices change when nodes are added or removed.
+
+typedef struct TransformHierarchyHandle
+{
+	// -1 for free handles.
+	int32 index;
+	int32 nextFree;
+} TransformHierarchyHandle;
+
+// nodes [start, start+count) got new world transforms.
+typedef struct TransformHierarchyRange
+{
+	int32 start;
+	int32 count;
+} TransformHierarchyRange;
+
+typedef struct TransformHierarchy
+{
+	// indexed by node index.
+	// -1 for roots.
+	int32* parents;
+	// the node and all of its descendants.
+	int32* subtreeSizes;
+	int32* handles;
+	Transformer* locals;
+	Transformer* worlds;
+	// worlds as Matrix4. row major with row vectors is the memory layout of a column major mat4 in glsl,
+	// so the array can be copied to a constant or vertex buffer as is.
+	Matrix4* worldMatrices;
+	// set on nodes whose local changed since the last update.
+	uint8* dirty;
+	int32 nodeCount;
+	int32 nodeCapacity;
+	// nodes added since the last update sit at the end, outside of their parent's range, until they are sorted in.
+	bool needsSort;
+
+	// indices of dirty nodes, unsorted.
+	int32* dirtyNodes;
+	int32 dirtyNodeCount;
+	int32 dirtyNodeCapacity;
+
+	// what the last update rewrote, ascending and not touching each other. for uploading only the changed matrices.
+	TransformHierarchyRange* updatedRanges;
+	int32 updatedRangeCount;
+	int32 updatedRangeCapacity;
+
+	TransformHierarchyHandle* handleSlots;
+	int32 handleCount;
+	int32 handleCapacity;
+	int32 firstFreeHandle;
+} TransformHierarchy;
+
+// below this many changed nodes per thread the parallel update doesn't bother with threads.
+#define TransformHierarchy_MinNodesPerThread (16*1024)
+
+void TransformHierarchy_Init(TransformHierarchy* self);
+void TransformHierarchy_Free(TransformHierarchy* self);
+// parent is a handle, or -1 for a root. returns the new node's handle, freed handles are reused.
+// the world transform is valid after the next update.
+int32 TransformHierarchy_Add(TransformHierarchy* self, int32 parent, const Transformer* local);
+// removes the node with all of its descendants. costs a move of every node after the subtree.
+void TransformHierarchy_Remove(TransformHierarchy* self, int32 handle);
+void TransformHierarchy_SetLocal(TransformHierarchy* self, int32 handle, const Transformer* local);
+// recomputes the worlds of every changed node and everything below it, nothing else.
+// sorts nodes added since the last update into place first.
+void TransformHierarchy_Update(TransformHierarchy* self);
+// changed subtrees are split into independent pieces, which are spread over the threads.
+// threadCount <= 0 uses every hardware thread. threads are started per call, this only pays off for big updates.
+void TransformHierarchy_UpdateParallel(TransformHierarchy* self, int32 threadCount);
+
+static inline int32 TransformHierarchy_GetIndex(const TransformHierarchy* self, int32 handle)
+{
+	return self->handleSlots[handle].index;
+}
+
+static inline const Transformer* TransformHierarchy_GetLocal(const TransformHierarchy* self, int32 handle)
+{
+	return &self->locals[self->handleSlots[handle].index];
+}
+
+// as of the last update.
+static inline const Transformer* TransformHierarchy_GetWorld(const TransformHierarchy* self, int32 handle)
+{
+	return &self->worlds[self->handleSlots[handle].index];
+}
@@ -0,0 +1,218 @@
+#include "draw/CommandList.h"
+
+#include "common/Math.h"
+#include "draw/Draw.h"
+
+void CommandList_Init(CommandList* self)
+{
+	*self = (CommandList){ 0 };
+}
+
+void CommandList_Free(CommandList* self)
+{
+	MFree(self->commands);
+	MFree(self->data);
+	*self = (CommandList){ 0 };
+}
+
+void CommandList_Clear(CommandList* self)
+{
+	self->commandCount = 0;
+	self->dataSize = 0;
+	self->shader = null;
+	self->hasDrawState = false;
+	self->immediateVertexStride = 0;
+}
+
+static CommandListCommand* AddCommand(CommandList* self, CommandListCommandType type)
+{
+	if (self->commandCount == self->commandCapacity)
+	{
+		self->commandCapacity = MaxI(self->commandCapacity*2, 256);
+		self->commands = MRealloc(self->commands, self->commandCapacity*sizeof(CommandListCommand));
+	}
+	CommandListCommand* command = &self->commands[self->commandCount++];
+	command->type = type;
+	return command;
+}
+
+// copies size bytes into the list's data and returns their offset, aligned for the vertex format items stored there too.
+static int32 AddData(CommandList* self, const void* source, int32 size)
+{
+	int32 offset = (self->dataSize+7) & ~7;
+	int32 needed = offset+size;
+	if (needed > self->dataCapacity)
+	{
+		self->dataCapacity = MaxI(MaxI(self->dataCapacity*2, needed), 4096);
+		self->data = MRealloc(self->data, self->dataCapacity);
+	}
+	MemCpy(self->data+offset, source, size);
+	self->dataSize = needed;
+	return offset;
+}
+
+void CommandList_SetShader(CommandList* self, Shader* shader)
+{
+	if (shader == self->shader)
+	{
+		return;
+	}
+	AddCommand(self, CommandListCommandType_SetShader)->shader = shader;
+	self->shader = shader;
+}
+
+void CommandList_SetDrawState(CommandList* self, const DrawState* drawState)
+{
+	if (self->hasDrawState && MemCmp(&self->drawState, drawState, sizeof(DrawState)) == 0)
+	{
+		return;
+	}
+	AddCommand(self, CommandListCommandType_SetDrawState)->drawState = *drawState;
+	self->drawState = *drawState;
+	self->hasDrawState = true;
+}
+
+void CommandList_SetUniformInt(CommandList* self, Shader* shader, ShaderUniform* uniform, int32 arrayIndex, int32 value)
+{
+	CommandListCommand* command = AddCommand(self, CommandListCommandType_SetUniformInt);
+	command->uniform.shader = shader;
+	command->uniform.uniform = uniform;
+	command->uniform.arrayIndex = arrayIndex;
+	command->uniform.intValue = value;
+}
+
+void CommandList_SetUniformFloat(CommandList* self, Shader* shader, ShaderUniform* uniform, int32 arrayIndex, float value)
+{
+	CommandListCommand* command = AddCommand(self, CommandListCommandType_SetUniformFloat);
+	command->uniform.shader = shader;
+	command->uniform.uniform = uniform;
+	command->uniform.arrayIndex = arrayIndex;
+	command->uniform.floatValue = value;
+}
+
+void CommandList_SetUniformTexture(CommandList* self, Shader* shader, ShaderUniform* uniform, int32 arrayIndex, Texture* value)
+{
+	CommandListCommand* command = AddCommand(self, CommandListCommandType_SetUniformTexture);
+	command->uniform.shader = shader;
+	command->uniform.uniform = uniform;
+	command->uniform.arrayIndex = arrayIndex;
+	command->uniform.texture = value;
+}
+
+void CommandList_SetImmediateVertexFormat(CommandList* self, VertexFormatItem* format, int32 count)
+{
+	if (count <= 0 || count > Mesh_MaxVertexFormatItems)
+	{
+		ErrorF("unsupported vertex format item count: %d", count);
+	}
+
+	int32 offset = AddData(self, format, count*sizeof(VertexFormatItem));
+	CommandListCommand* command = AddCommand(self, CommandListCommandType_SetImmediateVertexFormat);
+	command->data.offset = offset;
+	command->data.count = count;
+	self->immediateVertexStride = format[0].stride;
+}
+
+void CommandList_SubmitImmediatePoly(CommandList* self, const void* vertices, int32 vertexCount)
+{
+#if CONFIG_DEBUG
+	if (!self->immediateVertexStride)
+	{
+		Error("the command list's immediate vertex format has not been set.");
+	}
+#endif
+
+	int32 offset = AddData(self, vertices, vertexCount*self->immediateVertexStride);
+	CommandListCommand* command = AddCommand(self, CommandListCommandType_ImmediatePoly);
+	command->data.offset = offset;
+	command->data.count = vertexCount;
+}
+
+static void AddMeshCommand(CommandList* self, CommandListCommandType type, Mesh* mesh, int32 first, int32 count, int32 baseVertex, int32 instanceCount, int32 baseInstance)
+{
+	CommandListCommand* command = AddCommand(self, type);
+	command->mesh.mesh = mesh;
+	command->mesh.first = first;
+	command->mesh.count = count;
+	command->mesh.baseVertex = baseVertex;
+	command->mesh.instanceCount = instanceCount;
+	command->mesh.baseInstance = baseInstance;
+}
+
+void CommandList_DrawMesh(CommandList* self, Mesh* mesh, int32 vertexOffset, int32 vertexCount)
+{
+	AddMeshCommand(self, CommandListCommandType_DrawMesh, mesh, vertexOffset, vertexCount, 0, 1, 0);
+}
+
+void CommandList_DrawMeshIndexed(CommandList* self, Mesh* mesh, int32 indexOffset, int32 indexCount, int32 baseVertex)
+{
+	AddMeshCommand(self, CommandListCommandType_DrawMeshIndexed, mesh, indexOffset, indexCount, baseVertex, 1, 0);
+}
+
+void CommandList_DrawMeshInstanced(CommandList* self, Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance)
+{
+	AddMeshCommand(self, CommandListCommandType_DrawMeshInstanced, mesh, vertexOffset, vertexCount, 0, instanceCount, baseInstance);
+}
+
+void CommandList_Call(CommandList* self, CommandListFunction function, void* userData)
+{
+	CommandListCommand* command = AddCommand(self, CommandListCommandType_Call);
+	command->call.function = function;
+	command->call.userData = userData;
+}
+
+static void ExecuteList(CommandList* self)
+{
+	for (int32 i = 0; i < self->commandCount; i++)
+	{
+		CommandListCommand* command = &self->commands[i];
+		switch (command->type) {
+		case CommandListCommandType_SetShader:
+			Draw_SetShader(command->shader);
+			break;
+		case CommandListCommandType_SetDrawState:
+			Draw_SetDrawState(&command->drawState);
+			break;
+		case CommandListCommandType_SetUniformInt:
+			Shader_SetUniformInt(command->uniform.shader, command->uniform.uniform, command->uniform.arrayIndex, command->uniform.intValue);
+			break;
+		case CommandListCommandType_SetUniformFloat:
+			Shader_SetUniformFloat(command->uniform.shader, command->uniform.uniform, command->uniform.arrayIndex, command->uniform.floatValue);
+			break;
+		case CommandListCommandType_SetUniformTexture:
+			Shader_SetUniformTexture(command->uniform.shader, command->uniform.uniform, command->uniform.arrayIndex, command->uniform.texture);
+			break;
+		case CommandListCommandType_SetImmediateVertexFormat:
+			Draw_SetImmediateVertexFormat((VertexFormatItem*)(self->data+command->data.offset), command->data.count);
+			break;
+		case CommandListCommandType_ImmediatePoly:
+			Draw_SubmitImmediatePoly(self->data+command->data.offset, command->data.count);
+			break;
+		case CommandListCommandType_DrawMesh:
+			Mesh_Draw(command->mesh.mesh, command->mesh.first, command->mesh.count);
+			break;
+		case CommandListCommandType_DrawMeshIndexed:
+			Mesh_DrawIndexed(command->mesh.mesh, command->mesh.first, command->mesh.count, command->mesh.baseVertex);
+			break;
+		case CommandListCommandType_DrawMeshInstanced:
+			Mesh_DrawInstanced(command->mesh.mesh, command->mesh.first, command->mesh.count, command->mesh.instanceCount, command->mesh.baseInstance);
+			break;
+		case CommandListCommandType_Call:
+			command->call.function(command->call.userData);
+			break;
+		default:
+			ErrorF("unknown command type: %s", CommandListCommandType_ToString(command->type));
+			break;
+		}
+		static_assert(CommandListCommandType_Count == 11, "enum has changed.");
+	}
+}
+
+void CommandList_Execute(CommandList* lists, int32 count)
+{
+	for (int32 i = 0; i < count; i++)
+	{
+		ExecuteList(&lists[i]);
+		CommandList_Clear(&lists[i]);
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+// draw commands recorded without touching the backend or Draw's globals, so any thread can build one.
+// a list belongs to one thread while it's recorded. CommandList_Execute replays lists through Draw_* on the thread that
+// owns the backend, in the order they're passed in, so the frame comes out the same whichever thread finished first.
+// immediate vertices and vertex formats are copied into the list's own data.
+
+typedef enum CommandListCommandType
+{
+	CommandListCommandType_SetShader,
+	CommandListCommandType_SetDrawState,
+	CommandListCommandType_SetUniformInt,
+	CommandListCommandType_SetUniformFloat,
+	CommandListCommandType_SetUniformTexture,
+	CommandListCommandType_SetImmediateVertexFormat,
+	CommandListCommandType_ImmediatePoly,
+	CommandListCommandType_DrawMesh,
+	CommandListCommandType_DrawMeshIndexed,
+	CommandListCommandType_DrawMeshInstanced,
+	CommandListCommandType_Call,
+	CommandListCommandType_Count,
+} CommandListCommandType;
+
+static const char* CommandListCommandType_ToString(CommandListCommandType value)
+{
+	switch (value) {
+	case CommandListCommandType_SetShader: return "CommandListCommandType_SetShader"; break;
+	case CommandListCommandType_SetDrawState: return "CommandListCommandType_SetDrawState"; break;
+	case CommandListCommandType_SetUniformInt: return "CommandListCommandType_SetUniformInt"; break;
+	case CommandListCommandType_SetUniformFloat: return "CommandListCommandType_SetUniformFloat"; break;
+	case CommandListCommandType_SetUniformTexture: return "CommandListCommandType_SetUniformTexture"; break;
+	case CommandListCommandType_SetImmediateVertexFormat: return "CommandListCommandType_SetImmediateVertexFormat"; break;
+	case CommandListCommandType_ImmediatePoly: return "CommandListCommandType_ImmediatePoly"; break;
+	case CommandListCommandType_DrawMesh: return "CommandListCommandType_DrawMesh"; break;
+	case CommandListCommandType_DrawMeshIndexed: return "CommandListCommandType_DrawMeshIndexed"; break;
+	case CommandListCommandType_DrawMeshInstanced: return "CommandListCommandType_DrawMeshInstanced"; break;
+	case CommandListCommandType_Call: return "CommandListCommandType_Call"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(CommandListCommandType_Count == 11, "enum has changed.");
+}
+
+typedef void (*CommandListFunction)(void* userData);
+
+typedef struct CommandListCommand
+{
+	CommandListCommandType type;
+	union
+	{
+		Shader* shader;
+		DrawState drawState;
+		struct
+		{
+			Shader* shader;
+			ShaderUniform* uniform;
+			int32 arrayIndex;
+			union
+			{
+				int32 intValue;
+				float floatValue;
+				Texture* texture;
+			};
+		} uniform;
+		// vertex format items or immediate vertices at byte offset of CommandList.data.
+		struct
+		{
+			int32 offset;
+			int32 count;
+		} data;
+		// first and count are vertices, or indices for indexed draws.
+		struct
+		{
+			Mesh* mesh;
+			int32 first;
+			int32 count;
+			int32 baseVertex;
+			int32 instanceCount;
+			int32 baseInstance;
+		} mesh;
+		struct
+		{
+			CommandListFunction function;
+			void* userData;
+		} call;
+	};
+} CommandListCommand;
+
+typedef struct CommandList
+{
+	CommandListCommand* commands;
+	int32 commandCount;
+	int32 commandCapacity;
+	uint8* data;
+	int32 dataSize;
+	int32 dataCapacity;
+
+	// what the list last recorded, so repeats aren't recorded again.
+	Shader* shader;
+	DrawState drawState;
+	bool hasDrawState;
+	int32 immediateVertexStride;
+} CommandList;
+
+void CommandList_Init(CommandList* self);
+void CommandList_Free(CommandList* self);
+// drops the recorded commands and keeps the memory, so lists reused every frame stop allocating.
+void CommandList_Clear(CommandList* self);
+void CommandList_SetShader(CommandList* self, Shader* shader);
+void CommandList_SetDrawState(CommandList* self, const DrawState* drawState);
+void CommandList_SetUniformInt(CommandList* self, Shader* shader, ShaderUniform* uniform, int32 arrayIndex, int32 value);
+void CommandList_SetUniformFloat(CommandList* self, Shader* shader, ShaderUniform* uniform, int32 arrayIndex, float value);
+void CommandList_SetUniformTexture(CommandList* self, Shader* shader, ShaderUniform* uniform, int32 arrayIndex, Texture* value);
+void CommandList_SetImmediateVertexFormat(CommandList* self, VertexFormatItem* format, int32 count);
+void CommandList_SubmitImmediatePoly(CommandList* self, const void* vertices, int32 vertexCount);
+void CommandList_DrawMesh(CommandList* self, Mesh* mesh, int32 vertexOffset, int32 vertexCount);
+void CommandList_DrawMeshIndexed(CommandList* self, Mesh* mesh, int32 indexOffset, int32 indexCount, int32 baseVertex);
+void CommandList_DrawMeshInstanced(CommandList* self, Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance);
+// runs function at this point of the replay, on the backend's thread. for work that needs the backend, like creating
+// or updating textures and meshes.
+void CommandList_Call(CommandList* self, CommandListFunction function, void* userData);
+// replays lists[0] to lists[count-1] through Draw_* and clears them. must run on the backend's thread.
+// the draw state and shader a list ends with carry over to the next list, like consecutive Draw_* calls.
+void CommandList_Execute(CommandList* lists, int32 count);
@@ -1,8 +1,13 @@
 #include "draw/Draw.h"
 
+#include "common/Math.h"
+#include "common/Thread.h"
+
 DrawStatCounters gDrawStatCounters;
 
 DrawBackend* currentBackend;
+// the thread backend calls are made on, see Draw_BindToCurrentThread.
+static uint32 ownerThreadId;
 
 DrawState currentDrawState;
 DrawState previousDrawState;
@@ -11,40 +16,88 @@ static bool forceFullStateDirty;
 
 static Shader* currentShader;
 
-static int32 immediateVertexOffset;
-static int32 immediateVertexStride;
+// immediate polys are written straight into stream buffers. a batch reserves room for Draw_ImmediateBatchSize bytes of vertices
+// and Draw_ImmediateIndexBatchCount indices when its first poly comes in, and gives back what it didn't use when it's drawn.
 #define Draw_ImmediateBatchSize 65536
-static uint8 immediateVertexBuffer[Draw_ImmediateBatchSize] = { 0 };
+// polys are stored once per vertex and split into triangles through indices.
+// a batch can't hold more than 65536 vertices, so 16 bit indices reach all of them.
+#define Draw_ImmediateIndexBatchCount 32768
+#define Draw_ImmediateVertexStreamSize (4*1024*1024)
+#define Draw_ImmediateIndexStreamSize (1024*1024)
+#define Draw_StreamRegionCount 3
+static StreamBuffer immediateVertexStream;
+static StreamBuffer immediateIndexStream;
+static int32 immediateVertexStride;
+// null while no batch is open.
+static uint8* immediateVertices;
+static uint16* immediateIndices;
+static int32 immediateVertexStart;
+static int32 immediateIndexStart;
+static int32 immediateVertexOffset;
+static int32 immediateIndexCount;
 static Mesh immediateMesh;
 
+// per instance data, like transforms, written each frame. a region holds 65k Matrix4s.
+#define Draw_InstanceStreamSize (12*1024*1024)
+static StreamBuffer instanceStream;
+
+// commands of multi draw indirect calls. a region holds 52k commands.
+#define Draw_IndirectStreamSize (3*1024*1024)
+static StreamBuffer indirectStream;
+
 void Draw_Init(DrawBackend* backend)
 {
 	currentBackend = backend;
+	ownerThreadId = Thread_GetCurrentId();
 
 	currentDrawState = (DrawState){ 0 };
 	previousDrawState = currentDrawState;
 	currentDrawStateDirty = true;
 	forceFullStateDirty = true;
+	// a new backend has no shader set, even when the last one freed had this one.
+	currentShader = null;
 
 	currentBackend->init();
 
+	StreamBuffer_Init(&immediateVertexStream, Draw_ImmediateVertexStreamSize, Draw_StreamRegionCount);
+	StreamBuffer_Init(&immediateIndexStream, Draw_ImmediateIndexStreamSize, Draw_StreamRegionCount);
 	Mesh_Init(&immediateMesh);
+	// the mesh only borrows the stream buffers, orphaning keeps their names the same.
 	immediateMesh.vertexBufferCount = 1;
-	VertexBuffer_Init(&immediateMesh.vertexBuffers[0], Draw_ImmediateBatchSize, VertexBufferUsage_Dynamic);
+	immediateMesh.vertexBuffers[0] = (VertexBuffer){ immediateVertexStream.internalHandle, Draw_ImmediateVertexStreamSize };
+	immediateMesh.indexBuffer = (IndexBuffer){ immediateIndexStream.internalHandle, Draw_ImmediateIndexStreamSize, IndexFormat_U16 };
+	StreamBuffer_Init(&instanceStream, Draw_InstanceStreamSize, Draw_StreamRegionCount);
+	StreamBuffer_Init(&indirectStream, Draw_IndirectStreamSize, Draw_StreamRegionCount);
 
 	Draw_Flush();
 }
 
 void Draw_Free()
 {
-	Mesh_Free(&immediateMesh);
+	Draw_Flush();
+	currentBackend->meshFree(&immediateMesh);
+	StreamBuffer_Free(&immediateVertexStream);
+	StreamBuffer_Free(&immediateIndexStream);
+	StreamBuffer_Free(&instanceStream);
+	StreamBuffer_Free(&indirectStream);
 
 	currentBackend->free();
 	currentBackend = null;
 }
 
+void Draw_BindToCurrentThread()
+{
+	ownerThreadId = Thread_GetCurrentId();
+}
+
 DrawBackend* Draw_GetBackend()
 {
+#if CONFIG_DEBUG
+	if (currentBackend && Thread_GetCurrentId() != ownerThreadId)
+	{
+		Error("the draw backend was used from a thread that doesn't own it. record a CommandList or use RenderThread_Call instead.");
+	}
+#endif
 	return currentBackend;
 }
 
@@ -167,63 +220,68 @@ void Draw_SubmitImmediatePoly(const void* vertices, int32 vertexCount)
 	{
 		ErrorF("unsupported vertex count: %d", vertexCount);
 	}
-	int32 actualVertexCount = 3;
-
-	if (vertexCount > 3)
-	{
-		actualVertexCount += (vertexCount-3)*3;
-	}
-
-	int32 actualVertexCountSize = actualVertexCount*immediateVertexStride;
+	int32 vertexSize = vertexCount*immediateVertexStride;
+	int32 indexCount = (vertexCount-2)*3;
 
-	if (actualVertexCountSize > Draw_ImmediateBatchSize)
+	if (vertexSize > Draw_ImmediateBatchSize || indexCount > Draw_ImmediateIndexBatchCount)
 	{
 #if CONFIG_DEBUG
-		ErrorF("poly would require too many vertices: %d*%d (%d) > %d", actualVertexCount, immediateVertexStride, actualVertexCountSize, Draw_ImmediateBatchSize);
+		ErrorF("poly has too many vertices: %d*%d (%d) > %d", vertexCount, immediateVertexStride, vertexSize, Draw_ImmediateBatchSize);
 #else
 		return;
 #endif
 	}
 
 	// if the state is dirty the immediate geometry must be flushed now.
-	if (currentDrawStateDirty || immediateVertexOffset+actualVertexCountSize >= Draw_ImmediateBatchSize)
+	if (currentDrawStateDirty || immediateVertexOffset+vertexSize > Draw_ImmediateBatchSize || immediateIndexCount+indexCount > Draw_ImmediateIndexBatchCount)
 	{
 		Draw_Flush();
 	}
 
-	MemCpy(&immediateVertexBuffer[immediateVertexOffset], vertices, immediateVertexStride*3);
-	immediateMesh.vertexCount += 3;
-	immediateVertexOffset += immediateVertexStride*3;
-	if (vertexCount > 3)
+	if (!immediateVertices)
 	{
-		for (int32 i = 3; i < vertexCount; i++)
-		{
-			int32 vertByteOffset = immediateVertexStride*i;
-			const void* prevVertex = &((uint8*)vertices)[vertByteOffset-immediateVertexStride];
-			
-			uint8* dest = &immediateVertexBuffer[immediateVertexOffset];
-			MemCpy(dest, prevVertex, immediateVertexStride);
-			dest += immediateVertexStride;
-			MemCpy(dest, &((uint8*)vertices)[vertByteOffset], immediateVertexStride);
-			dest += immediateVertexStride;
-			MemCpy(dest, &((uint8*)vertices)[0], immediateVertexStride);
-
-			immediateMesh.vertexCount += 3;
-			immediateVertexOffset += immediateVertexStride*3;
-		}
+		// vertices are drawn with a base vertex, so the batch has to start on a whole vertex.
+		immediateVertices = StreamBuffer_BeginWrite(&immediateVertexStream, Draw_ImmediateBatchSize, immediateVertexStride, &immediateVertexStart);
+		immediateIndices = StreamBuffer_BeginWrite(&immediateIndexStream, Draw_ImmediateIndexBatchCount*(int32)sizeof(uint16), sizeof(uint16), &immediateIndexStart);
 	}
+
+	MemCpy(&immediateVertices[immediateVertexOffset], vertices, vertexSize);
+	immediateVertexOffset += vertexSize;
+
+	// same triangle fan as before the indices: (0 1 2) followed by (i-1 i 0).
+	int32 first = immediateMesh.vertexCount;
+	uint16* indices = &immediateIndices[immediateIndexCount];
+	indices[0] = (uint16)first;
+	indices[1] = (uint16)(first+1);
+	indices[2] = (uint16)(first+2);
+	indices += 3;
+	for (int32 i = 3; i < vertexCount; i++)
+	{
+		indices[0] = (uint16)(first+i-1);
+		indices[1] = (uint16)(first+i);
+		indices[2] = (uint16)first;
+		indices += 3;
+	}
+	immediateIndexCount += indexCount;
+	immediateMesh.vertexCount += vertexCount;
 }
 
 void Draw_Flush()
 {
 	// draw immediate geometry before applying new state because it must be drawn with the state state from when the geometry was submitted.
-	if (immediateVertexOffset > 0)
+	if (immediateVertices)
 	{
-		VertexBuffer_SetData(&immediateMesh.vertexBuffers[0], 0, immediateVertexOffset, immediateVertexBuffer);
+		int32 indexSize = immediateIndexCount*(int32)sizeof(uint16);
+		StreamBuffer_EndWrite(&immediateVertexStream, immediateVertexOffset);
+		StreamBuffer_EndWrite(&immediateIndexStream, indexSize);
 		// not using Mesh_Draw here because that calls Draw_Flush.
-		currentBackend->meshDraw(&immediateMesh, 0, immediateMesh.vertexCount);
+		currentBackend->meshDrawIndexed(&immediateMesh, immediateIndexStart/(int32)sizeof(uint16), immediateIndexCount, immediateVertexStart/immediateVertexStride);
+		gDrawStatCounters.immediateBytesUploaded += immediateVertexOffset+indexSize;
+		immediateVertices = null;
+		immediateIndices = null;
 		immediateMesh.vertexCount = 0;
 		immediateVertexOffset = 0;
+		immediateIndexCount = 0;
 		gDrawStatCounters.immediateDraws++;
 		gDrawStatCounters.meshDraws++;
 	}
@@ -231,6 +289,118 @@ void Draw_Flush()
 	CommitDrawState();
 }
 
+VertexBuffer Draw_GetInstanceVertexBuffer()
+{
+	return (VertexBuffer){ instanceStream.internalHandle, Draw_InstanceStreamSize };
+}
+
+void Draw_AddInstanceTransformFormat(Mesh* mesh, int32 inputIndex)
+{
+	if (mesh->vertexBufferCount >= Mesh_MaxVertexBuffers || mesh->vertexFormatCount+4 > Mesh_MaxVertexFormatItems)
+	{
+		Error("mesh has no room for instance transforms.");
+	}
+
+	int32 bufferIndex = mesh->vertexBufferCount++;
+	mesh->vertexBuffers[bufferIndex] = Draw_GetInstanceVertexBuffer();
+	for (int32 i = 0; i < 4; i++)
+	{
+		mesh->vertexFormat[mesh->vertexFormatCount++] = (VertexFormatItem){
+			inputIndex+i, bufferIndex, i*(int32)sizeof(Vec4), (int32)sizeof(Matrix4), VertexFormatType_Float, 4, 1
+		};
+	}
+}
+
+// the most elements of elementSize bytes that fit one write, BeginWrite needs room for the alignment too.
+static int32 GetMaxElementsPerWrite(int32 streamSize, int32 elementSize)
+{
+	return (streamSize/Draw_StreamRegionCount-elementSize)/elementSize;
+}
+
+int32 Draw_GetMaxStreamedInstances(int32 instanceSize)
+{
+	return GetMaxElementsPerWrite(Draw_InstanceStreamSize, instanceSize);
+}
+
+int32 Draw_StreamInstances(const void* instances, int32 instanceSize, int32 instanceCount)
+{
+	int32 offset;
+	// aligned to the instance size so the offset is a whole number of instances.
+	void* data = StreamBuffer_BeginWrite(&instanceStream, instanceCount*instanceSize, instanceSize, &offset);
+	MemCpy(data, instances, instanceCount*instanceSize);
+	StreamBuffer_EndWrite(&instanceStream, instanceCount*instanceSize);
+	return offset/instanceSize;
+}
+
+void Draw_MeshInstanced(Mesh* mesh, int32 vertexOffset, int32 vertexCount, const void* instances, int32 instanceSize, int32 instanceCount)
+{
+	int32 maxCount = Draw_GetMaxStreamedInstances(instanceSize);
+	const uint8* source = instances;
+	while (instanceCount > 0)
+	{
+		int32 count = MinI(instanceCount, maxCount);
+		int32 firstInstance = Draw_StreamInstances(source, instanceSize, count);
+		Mesh_DrawInstanced(mesh, vertexOffset, vertexCount, count, firstInstance);
+
+		source += count*instanceSize;
+		instanceCount -= count;
+	}
+}
+
+void Draw_MeshInstancedTransformers(Mesh* mesh, int32 vertexOffset, int32 vertexCount, const Transformer* transformers, int32 instanceCount)
+{
+	int32 maxCount = Draw_GetMaxStreamedInstances(sizeof(Matrix4));
+	while (instanceCount > 0)
+	{
+		int32 count = MinI(instanceCount, maxCount);
+		int32 offset;
+		Matrix4* matrices = StreamBuffer_BeginWrite(&instanceStream, count*(int32)sizeof(Matrix4), sizeof(Matrix4), &offset);
+		// same as Transformer_ToMatrix4, inlined and written whole rows at a time in order, since the memory can be write combined.
+		for (int32 i = 0; i < count; i++)
+		{
+			const Transformer* transformer = &transformers[i];
+			Matrix4* matrix = &matrices[i];
+			matrix->x = (Vec4){ transformer->mat.x.x, transformer->mat.x.y, transformer->mat.x.z, 0 };
+			matrix->y = (Vec4){ transformer->mat.y.x, transformer->mat.y.y, transformer->mat.y.z, 0 };
+			matrix->z = (Vec4){ transformer->mat.z.x, transformer->mat.z.y, transformer->mat.z.z, 0 };
+			matrix->w = (Vec4){ transformer->pos.x, transformer->pos.y, transformer->pos.z, 1 };
+		}
+		StreamBuffer_EndWrite(&instanceStream, count*(int32)sizeof(Matrix4));
+		Mesh_DrawInstanced(mesh, vertexOffset, vertexCount, count, offset/(int32)sizeof(Matrix4));
+
+		transformers += count;
+		instanceCount -= count;
+	}
+}
+
+void Draw_MeshIndexedIndirect(Mesh* mesh, const DrawIndexedIndirectCommand* commands, int32 commandCount)
+{
+	int32 commandSize = sizeof(DrawIndexedIndirectCommand);
+	int32 maxCount = GetMaxElementsPerWrite(Draw_IndirectStreamSize, commandSize);
+	while (commandCount > 0)
+	{
+		int32 count = MinI(commandCount, maxCount);
+		int32 offset;
+		void* data = StreamBuffer_BeginWrite(&indirectStream, count*commandSize, 4, &offset);
+		MemCpy(data, commands, count*commandSize);
+		StreamBuffer_EndWrite(&indirectStream, count*commandSize);
+		Mesh_DrawIndexedIndirect(mesh, indirectStream.internalHandle, offset, count);
+
+		commands += count;
+		commandCount -= count;
+	}
+}
+
+void Draw_EndFrame()
+{
+	Draw_Flush();
+	StreamBuffer_EndFrame(&immediateVertexStream);
+	StreamBuffer_EndFrame(&immediateIndexStream);
+	StreamBuffer_EndFrame(&instanceStream);
+	StreamBuffer_EndFrame(&indirectStream);
+	currentBackend->endFrame();
+}
+
 void Draw_SetViewport(int32 x, int32 y, int32 width, int32 height)
 {
 	Draw_Flush();
@@ -9,11 +9,18 @@ typedef struct DrawStatCounters
 	uint64 meshDraws;
 	uint64 shaderChanges;
 	uint64 granularStateChanges;
+	// vertices and indices sent by immediate flushes.
+	uint64 immediateBytesUploaded;
+	// instances drawn by instanced draws, each of which also counts once in meshDraws.
+	uint64 meshInstances;
 } DrawStatCounters;
 extern DrawStatCounters gDrawStatCounters;
 
 void Draw_Init(DrawBackend* backend);
 void Draw_Free();
+// draw calls have to come from the thread that owns the backend's context, the one that called Draw_Init until this moves it.
+// checked in debug builds.
+void Draw_BindToCurrentThread();
 DrawBackend* Draw_GetBackend();
 DrawState* Draw_GetDrawState();
 bool Draw_IsDrawStateDirty();
@@ -24,6 +31,25 @@ void Draw_SetShader(Shader* shader);
 void Draw_SetImmediateVertexFormat(VertexFormatItem* format, int32 count);
 void Draw_SubmitImmediatePoly(const void* vertices, int32 vertexCount);
 void Draw_Flush();
+// the stream per instance data is written to. put it in a mesh's vertex buffers to read instances from it,
+// its name stays the same for the life of the backend.
+VertexBuffer Draw_GetInstanceVertexBuffer();
+// adds the instance stream to mesh and four float4 items from inputIndex on, each instance reading a row of a Matrix4.
+// call Mesh_ApplyStructure afterwards.
+void Draw_AddInstanceTransformFormat(Mesh* mesh, int32 inputIndex);
+// how many instances of instanceSize bytes Draw_StreamInstances takes at once.
+int32 Draw_GetMaxStreamedInstances(int32 instanceSize);
+// copies instances to the instance stream, valid until the end of the frame. returns the base instance that reads the first of them.
+int32 Draw_StreamInstances(const void* instances, int32 instanceSize, int32 instanceCount);
+// copies instanceCount elements of instanceSize bytes to the instance stream and draws an instance for each.
+// instanceSize must be the stride of the mesh's instance items. takes more than one draw only when the data doesn't fit a stream region.
+void Draw_MeshInstanced(Mesh* mesh, int32 vertexOffset, int32 vertexCount, const void* instances, int32 instanceSize, int32 instanceCount);
+// the same with one Matrix4 per instance converted from each transformer, for meshes set up with Draw_AddInstanceTransformFormat.
+void Draw_MeshInstancedTransformers(Mesh* mesh, int32 vertexOffset, int32 vertexCount, const Transformer* transformers, int32 instanceCount);
+// copies the commands to the indirect stream and draws them with as few multi draw calls as fit a stream region.
+void Draw_MeshIndexedIndirect(Mesh* mesh, const DrawIndexedIndirectCommand* commands, int32 commandCount);
+// flushes and hands the frame's streamed data to the gpu. called by Window_Present.
+void Draw_EndFrame();
 void Draw_SetViewport(int32 x, int32 y, int32 width, int32 height);
 void Draw_ClearColor(float r, float g, float b, float a);
 void Draw_ClearDepth(float value);
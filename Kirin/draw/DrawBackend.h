@@ -5,6 +5,7 @@
 #include "draw/Mesh.h"
 #include "draw/Shader.h"
 #include "draw/ConstantBuffer.h"
+#include "draw/StreamBuffer.h"
 #include "draw/Texture.h"
 
 typedef enum DrawGeoType {
@@ -144,6 +145,28 @@ static const char* StencilOpMode_ToString(StencilOpMode value)
 	static_assert(StencilOpMode_Count == 8, "enum has changed.");
 }
 
+typedef enum GpuQueryType
+{
+	// the gpu's clock once the commands before it have finished, in nanoseconds.
+	GpuQueryType_Timestamp,
+	// primitives that reached the rasterizer between begin and end.
+	GpuQueryType_PrimitivesGenerated,
+	// samples that passed the depth and stencil tests between begin and end.
+	GpuQueryType_SamplesPassed,
+	GpuQueryType_Count,
+} GpuQueryType;
+
+static const char* GpuQueryType_ToString(GpuQueryType value)
+{
+	switch (value) {
+	case GpuQueryType_Timestamp: return "GpuQueryType_Timestamp"; break;
+	case GpuQueryType_PrimitivesGenerated: return "GpuQueryType_PrimitivesGenerated"; break;
+	case GpuQueryType_SamplesPassed: return "GpuQueryType_SamplesPassed"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(GpuQueryType_Count == 3, "enum has changed.");
+}
+
 #pragma push_macro("DrawStatePackEnum")
 #undef DrawStatePackEnum
 #define DrawStatePackEnum(type, bits) : bits; static_assert(type##_Count <= 1 << bits, "bitfield cannot fit enum.")
@@ -168,9 +191,22 @@ typedef struct DrawBackend
 {
 	void (*init)();
 	void (*free)();
+	// called by Draw_EndFrame once the frame's draws and streamed data are all in.
+	void (*endFrame)();
 	void (*vertexBufferInit)(VertexBuffer* vertexBuffer, VertexBufferUsage usage);
 	void (*vertexBufferUpdateData)(VertexBuffer* vertexBuffer, int32 offset, int32 size, void* data);
 	void (*vertexBufferFree)(VertexBuffer* vertexBuffer);
+	void (*indexBufferInit)(IndexBuffer* indexBuffer, VertexBufferUsage usage);
+	void (*indexBufferUpdateData)(IndexBuffer* indexBuffer, int32 offset, int32 size, void* data);
+	void (*indexBufferFree)(IndexBuffer* indexBuffer);
+	// sets persistentData if the buffer can stay mapped, the other entries are only used by one of the two modes.
+	void (*streamBufferInit)(StreamBuffer* streamBuffer);
+	void (*streamBufferFree)(StreamBuffer* streamBuffer);
+	void (*streamBufferFence)(StreamBuffer* streamBuffer, int32 region);
+	void (*streamBufferWait)(StreamBuffer* streamBuffer, int32 region);
+	void (*streamBufferOrphan)(StreamBuffer* streamBuffer);
+	void* (*streamBufferMap)(StreamBuffer* streamBuffer, int32 offset, int32 size);
+	void (*streamBufferUnmap)(StreamBuffer* streamBuffer, int32 usedSize);
 	void (*drawStateUpdate)(DrawState* previousState, DrawState* state, bool forceUpdate);
 	void (*setViewport)(int32 x, int32 y, int32 width, int32 height);
 	void (*clearColor)(float r, float g, float b, float a);
@@ -193,5 +229,129 @@ typedef struct DrawBackend
 	void (*meshInit)(Mesh* mesh);
 	void (*meshApplyStructure)(Mesh* mesh);
 	void (*meshDraw)(Mesh* mesh, int32 vertexOffset, int32 vertexCount);
+	// indexOffset counts indices of the index buffer's format. baseVertex is added to every index.
+	void (*meshDrawIndexed)(Mesh* mesh, int32 indexOffset, int32 indexCount, int32 baseVertex);
+	void (*meshDrawInstanced)(Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance);
+	// commandBuffer holds DrawIndexedIndirectCommands, commandOffset is in bytes.
+	void (*meshDrawIndexedIndirect)(Mesh* mesh, int32 commandBuffer, int32 commandOffset, int32 commandCount);
 	void (*meshFree)(Mesh* mesh);
+	// queries are backend names. a query keeps the type it was first used with.
+	void (*queriesInit)(uint32* queries, int32 count);
+	void (*queriesFree)(uint32* queries, int32 count);
+	void (*queryTimestamp)(uint32 query);
+	// one query of each counting type can run at a time.
+	void (*queryBegin)(uint32 query, GpuQueryType type);
+	void (*queryEnd)(GpuQueryType type);
+	// false without waiting when the gpu hasn't got to the query yet.
+	bool (*queryGetResult)(uint32 query, uint64* result);
 } DrawBackend;
+
+// one per DrawBackend entry, in the same order.
+typedef enum DrawBackendCall
+{
+	DrawBackendCall_Init,
+	DrawBackendCall_Free,
+	DrawBackendCall_EndFrame,
+	DrawBackendCall_VertexBufferInit,
+	DrawBackendCall_VertexBufferUpdateData,
+	DrawBackendCall_VertexBufferFree,
+	DrawBackendCall_IndexBufferInit,
+	DrawBackendCall_IndexBufferUpdateData,
+	DrawBackendCall_IndexBufferFree,
+	DrawBackendCall_StreamBufferInit,
+	DrawBackendCall_StreamBufferFree,
+	DrawBackendCall_StreamBufferFence,
+	DrawBackendCall_StreamBufferWait,
+	DrawBackendCall_StreamBufferOrphan,
+	DrawBackendCall_StreamBufferMap,
+	DrawBackendCall_StreamBufferUnmap,
+	DrawBackendCall_DrawStateUpdate,
+	DrawBackendCall_SetViewport,
+	DrawBackendCall_ClearColor,
+	DrawBackendCall_ClearDepth,
+	DrawBackendCall_ClearStencil,
+	DrawBackendCall_ShaderLoad,
+	DrawBackendCall_ShaderFree,
+	DrawBackendCall_ShaderSet,
+	DrawBackendCall_ShaderSetUniformInt,
+	DrawBackendCall_ShaderSetUniformFloat,
+	DrawBackendCall_ShaderSetUniformTexture,
+	DrawBackendCall_ConstantBufferInit,
+	DrawBackendCall_ConstantBufferAttachToShader,
+	DrawBackendCall_ConstantBufferSetData,
+	DrawBackendCall_ConstantBufferFree,
+	DrawBackendCall_TextureInit,
+	DrawBackendCall_TextureFree,
+	DrawBackendCall_TextureSetData,
+	DrawBackendCall_GenerateMipmaps,
+	DrawBackendCall_MeshInit,
+	DrawBackendCall_MeshApplyStructure,
+	DrawBackendCall_MeshDraw,
+	DrawBackendCall_MeshDrawIndexed,
+	DrawBackendCall_MeshDrawInstanced,
+	DrawBackendCall_MeshDrawIndexedIndirect,
+	DrawBackendCall_MeshFree,
+	DrawBackendCall_QueriesInit,
+	DrawBackendCall_QueriesFree,
+	DrawBackendCall_QueryTimestamp,
+	DrawBackendCall_QueryBegin,
+	DrawBackendCall_QueryEnd,
+	DrawBackendCall_QueryGetResult,
+	DrawBackendCall_Count,
+} DrawBackendCall;
+
+static const char* DrawBackendCall_ToString(DrawBackendCall value)
+{
+	switch (value) {
+	case DrawBackendCall_Init: return "DrawBackendCall_Init"; break;
+	case DrawBackendCall_Free: return "DrawBackendCall_Free"; break;
+	case DrawBackendCall_EndFrame: return "DrawBackendCall_EndFrame"; break;
+	case DrawBackendCall_VertexBufferInit: return "DrawBackendCall_VertexBufferInit"; break;
+	case DrawBackendCall_VertexBufferUpdateData: return "DrawBackendCall_VertexBufferUpdateData"; break;
+	case DrawBackendCall_VertexBufferFree: return "DrawBackendCall_VertexBufferFree"; break;
+	case DrawBackendCall_IndexBufferInit: return "DrawBackendCall_IndexBufferInit"; break;
+	case DrawBackendCall_IndexBufferUpdateData: return "DrawBackendCall_IndexBufferUpdateData"; break;
+	case DrawBackendCall_IndexBufferFree: return "DrawBackendCall_IndexBufferFree"; break;
+	case DrawBackendCall_StreamBufferInit: return "DrawBackendCall_StreamBufferInit"; break;
+	case DrawBackendCall_StreamBufferFree: return "DrawBackendCall_StreamBufferFree"; break;
+	case DrawBackendCall_StreamBufferFence: return "DrawBackendCall_StreamBufferFence"; break;
+	case DrawBackendCall_StreamBufferWait: return "DrawBackendCall_StreamBufferWait"; break;
+	case DrawBackendCall_StreamBufferOrphan: return "DrawBackendCall_StreamBufferOrphan"; break;
+	case DrawBackendCall_StreamBufferMap: return "DrawBackendCall_StreamBufferMap"; break;
+	case DrawBackendCall_StreamBufferUnmap: return "DrawBackendCall_StreamBufferUnmap"; break;
+	case DrawBackendCall_DrawStateUpdate: return "DrawBackendCall_DrawStateUpdate"; break;
+	case DrawBackendCall_SetViewport: return "DrawBackendCall_SetViewport"; break;
+	case DrawBackendCall_ClearColor: return "DrawBackendCall_ClearColor"; break;
+	case DrawBackendCall_ClearDepth: return "DrawBackendCall_ClearDepth"; break;
+	case DrawBackendCall_ClearStencil: return "DrawBackendCall_ClearStencil"; break;
+	case DrawBackendCall_ShaderLoad: return "DrawBackendCall_ShaderLoad"; break;
+	case DrawBackendCall_ShaderFree: return "DrawBackendCall_ShaderFree"; break;
+	case DrawBackendCall_ShaderSet: return "DrawBackendCall_ShaderSet"; break;
+	case DrawBackendCall_ShaderSetUniformInt: return "DrawBackendCall_ShaderSetUniformInt"; break;
+	case DrawBackendCall_ShaderSetUniformFloat: return "DrawBackendCall_ShaderSetUniformFloat"; break;
+	case DrawBackendCall_ShaderSetUniformTexture: return "DrawBackendCall_ShaderSetUniformTexture"; break;
+	case DrawBackendCall_ConstantBufferInit: return "DrawBackendCall_ConstantBufferInit"; break;
+	case DrawBackendCall_ConstantBufferAttachToShader: return "DrawBackendCall_ConstantBufferAttachToShader"; break;
+	case DrawBackendCall_ConstantBufferSetData: return "DrawBackendCall_ConstantBufferSetData"; break;
+	case DrawBackendCall_ConstantBufferFree: return "DrawBackendCall_ConstantBufferFree"; break;
+	case DrawBackendCall_TextureInit: return "DrawBackendCall_TextureInit"; break;
+	case DrawBackendCall_TextureFree: return "DrawBackendCall_TextureFree"; break;
+	case DrawBackendCall_TextureSetData: return "DrawBackendCall_TextureSetData"; break;
+	case DrawBackendCall_GenerateMipmaps: return "DrawBackendCall_GenerateMipmaps"; break;
+	case DrawBackendCall_MeshInit: return "DrawBackendCall_MeshInit"; break;
+	case DrawBackendCall_MeshApplyStructure: return "DrawBackendCall_MeshApplyStructure"; break;
+	case DrawBackendCall_MeshDraw: return "DrawBackendCall_MeshDraw"; break;
+	case DrawBackendCall_MeshDrawIndexed: return "DrawBackendCall_MeshDrawIndexed"; break;
+	case DrawBackendCall_MeshDrawInstanced: return "DrawBackendCall_MeshDrawInstanced"; break;
+	case DrawBackendCall_MeshDrawIndexedIndirect: return "DrawBackendCall_MeshDrawIndexedIndirect"; break;
+	case DrawBackendCall_MeshFree: return "DrawBackendCall_MeshFree"; break;
+	case DrawBackendCall_QueriesInit: return "DrawBackendCall_QueriesInit"; break;
+	case DrawBackendCall_QueriesFree: return "DrawBackendCall_QueriesFree"; break;
+	case DrawBackendCall_QueryTimestamp: return "DrawBackendCall_QueryTimestamp"; break;
+	case DrawBackendCall_QueryBegin: return "DrawBackendCall_QueryBegin"; break;
+	case DrawBackendCall_QueryEnd: return "DrawBackendCall_QueryEnd"; break;
+	case DrawBackendCall_QueryGetResult: return "DrawBackendCall_QueryGetResult"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(DrawBackendCall_Count == 48, "enum has changed.");
+}
@@ -0,0 +1,308 @@
+#include "draw/DrawQueue.h"
+
+#include "common/Math.h"
+#include "common/RadixSort.h"
+#include "draw/Draw.h"
+
+#define DrawQueue_LayerBits 8
+#define DrawQueue_ShaderBits 10
+#define DrawQueue_DrawStateBits 10
+#define DrawQueue_TextureBits 12
+#define DrawQueue_VertexFormatBits 4
+#define DrawQueue_DepthBits 20
+static_assert(DrawQueue_LayerBits+DrawQueue_ShaderBits+DrawQueue_DrawStateBits+DrawQueue_TextureBits+DrawQueue_VertexFormatBits+DrawQueue_DepthBits == 64, "key fields must fill 64 bits.");
+static_assert(DrawQueue_MaxLayers == 1 << DrawQueue_LayerBits, "layer field must hold every layer.");
+static_assert(DrawQueue_MaxVertexFormats < 1 << DrawQueue_VertexFormatBits, "vertex format field must hold every format and meshes.");
+
+// grows an array to hold at least needed elements, doubling so repeated growth stays linear.
+static void* Reserve(void* array, int32* capacity, int32 needed, size_t elementSize)
+{
+	if (needed <= *capacity)
+	{
+		return array;
+	}
+	int32 newCapacity = MaxI(MaxI(*capacity*2, needed), 16);
+	*capacity = newCapacity;
+	return MRealloc(array, newCapacity*elementSize);
+}
+
+static inline uint64 HashKey(uint64 key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	return key;
+}
+
+static void IdTable_Insert(DrawQueueIdTable* self, uint64 key, int32 id)
+{
+	uint32 mask = (uint32)self->size-1;
+	uint32 i = (uint32)HashKey(key) & mask;
+	while (self->ids[i] >= 0)
+	{
+		i = (i+1) & mask;
+	}
+	self->keys[i] = key;
+	self->ids[i] = id;
+}
+
+static void IdTable_Resize(DrawQueueIdTable* self, int32 size)
+{
+	uint64* keys = self->keys;
+	int32* ids = self->ids;
+	int32 oldSize = self->size;
+	self->keys = MAlloc(size*sizeof(uint64));
+	self->ids = MAlloc(size*sizeof(int32));
+	MemSet(self->ids, 0xff, size*sizeof(int32));
+	self->size = size;
+	for (int32 i = 0; i < oldSize; i++)
+	{
+		if (ids[i] >= 0)
+		{
+			IdTable_Insert(self, keys[i], ids[i]);
+		}
+	}
+	MFree(keys);
+	MFree(ids);
+}
+
+// ids count up from 0 in the order keys are first seen.
+static int32 IdTable_GetId(DrawQueueIdTable* self, uint64 key)
+{
+	uint32 mask = (uint32)self->size-1;
+	for (uint32 i = (uint32)HashKey(key) & mask; self->ids[i] >= 0; i = (i+1) & mask)
+	{
+		if (self->keys[i] == key)
+		{
+			return self->ids[i];
+		}
+	}
+
+	int32 id = self->count++;
+	// kept at most half full so probes stay short.
+	if (self->count*2 > self->size)
+	{
+		IdTable_Resize(self, self->size*2);
+	}
+	IdTable_Insert(self, key, id);
+	return id;
+}
+
+static void IdTable_Clear(DrawQueueIdTable* self)
+{
+	MemSet(self->ids, 0xff, self->size*sizeof(int32));
+	self->count = 0;
+}
+
+static uint64 HashDrawState(const DrawState* state)
+{
+	// fnv-1a over the bytes, the same bytes Draw_SetDrawState compares. a collision only merges two groups in the sort.
+	const uint8* bytes = (const uint8*)state;
+	uint64 hash = 0xcbf29ce484222325ull;
+	for (int32 i = 0; i < (int32)sizeof(DrawState); i++)
+	{
+		hash = (hash ^ bytes[i])*0x100000001b3ull;
+	}
+	return hash;
+}
+
+void DrawQueue_Init(DrawQueue* self)
+{
+	MemSet(self, 0, sizeof(DrawQueue));
+	IdTable_Resize(&self->shaderIds, 64);
+	IdTable_Resize(&self->drawStateIds, 64);
+	IdTable_Resize(&self->textureIds, 64);
+	self->currentVertexFormat = -1;
+}
+
+void DrawQueue_Free(DrawQueue* self)
+{
+	MFree(self->items);
+	MFree(self->keys);
+	MFree(self->vertexData);
+	MFree(self->order);
+	MFree(self->sortScratch);
+	MFree(self->shaderIds.keys);
+	MFree(self->shaderIds.ids);
+	MFree(self->drawStateIds.keys);
+	MFree(self->drawStateIds.ids);
+	MFree(self->textureIds.keys);
+	MFree(self->textureIds.ids);
+	MemSet(self, 0, sizeof(DrawQueue));
+}
+
+void DrawQueue_Clear(DrawQueue* self)
+{
+	self->itemCount = 0;
+	self->vertexDataSize = 0;
+	self->vertexFormatCount = 0;
+	self->currentVertexFormat = -1;
+	IdTable_Clear(&self->shaderIds);
+	IdTable_Clear(&self->drawStateIds);
+	IdTable_Clear(&self->textureIds);
+}
+
+void DrawQueue_SetLayerBackToFront(DrawQueue* self, int32 layer, bool backToFront)
+{
+	DevAssert(layer >= 0 && layer < DrawQueue_MaxLayers);
+	uint32 bit = 1u << (layer & 31);
+	if (backToFront)
+	{
+		self->backToFrontLayers[layer >> 5] |= bit;
+	}
+	else
+	{
+		self->backToFrontLayers[layer >> 5] &= ~bit;
+	}
+}
+
+void DrawQueue_SetImmediateVertexFormat(DrawQueue* self, VertexFormatItem* format, int32 count)
+{
+	if (count <= 0 || count > Mesh_MaxVertexFormatItems)
+	{
+		ErrorF("unsupported vertex format item count: %d", count);
+	}
+
+	for (int32 i = 0; i < self->vertexFormatCount; i++)
+	{
+		DrawQueueVertexFormat* existing = &self->vertexFormats[i];
+		if (existing->count == count && MemCmp(existing->items, format, count*sizeof(VertexFormatItem)) == 0)
+		{
+			self->currentVertexFormat = i;
+			return;
+		}
+	}
+
+	if (self->vertexFormatCount >= DrawQueue_MaxVertexFormats)
+	{
+		Error("too many immediate vertex formats in one draw queue.");
+	}
+	DrawQueueVertexFormat* added = &self->vertexFormats[self->vertexFormatCount];
+	added->count = count;
+	MemCpy(added->items, format, count*sizeof(VertexFormatItem));
+	self->currentVertexFormat = self->vertexFormatCount++;
+}
+
+static inline uint64 ClampId(int32 id, int32 bits)
+{
+	return (uint64)MinI(id, (1 << bits)-1);
+}
+
+static uint64 MakeKey(DrawQueue* self, const DrawQueueMaterial* material, int32 vertexFormat, int32 layer, float depth)
+{
+	DevAssert(layer >= 0 && layer < DrawQueue_MaxLayers);
+	uint64 shader = ClampId(IdTable_GetId(&self->shaderIds, (uint64)(size_t)material->shader), DrawQueue_ShaderBits);
+	uint64 drawState = ClampId(IdTable_GetId(&self->drawStateIds, HashDrawState(&material->drawState)), DrawQueue_DrawStateBits);
+	uint64 texture = ClampId(IdTable_GetId(&self->textureIds, (uint64)(size_t)material->texture), DrawQueue_TextureBits);
+	uint64 depthBits = RadixSort_FloatToKey(depth) >> (32-DrawQueue_DepthBits);
+
+	uint64 state = shader;
+	state = (state << DrawQueue_DrawStateBits) | drawState;
+	state = (state << DrawQueue_TextureBits) | texture;
+	// meshes get 0 and immediate formats start at 1, so meshes don't split up runs of immediate polys that batch together.
+	state = (state << DrawQueue_VertexFormatBits) | (uint64)(vertexFormat+1);
+	const int32 stateBits = DrawQueue_ShaderBits+DrawQueue_DrawStateBits+DrawQueue_TextureBits+DrawQueue_VertexFormatBits;
+
+	uint64 key = (uint64)layer << (64-DrawQueue_LayerBits);
+	if (self->backToFrontLayers[layer >> 5] & (1u << (layer & 31)))
+	{
+		uint64 farFirst = ~depthBits & ((1 << DrawQueue_DepthBits)-1);
+		key |= (farFirst << stateBits) | state;
+	}
+	else
+	{
+		key |= (state << DrawQueue_DepthBits) | depthBits;
+	}
+	return key;
+}
+
+static DrawQueueItem* AddItem(DrawQueue* self, uint64 key)
+{
+	int32 index = self->itemCount++;
+	if (self->itemCount > self->itemCapacity)
+	{
+		int32 capacity = MaxI(self->itemCapacity*2, 256);
+		self->items = MRealloc(self->items, capacity*sizeof(DrawQueueItem));
+		self->keys = MRealloc(self->keys, capacity*sizeof(uint64));
+		self->order = MRealloc(self->order, capacity*sizeof(int32));
+		self->itemCapacity = capacity;
+	}
+	self->keys[index] = key;
+	return &self->items[index];
+}
+
+void DrawQueue_SubmitMesh(DrawQueue* self, const DrawQueueMaterial* material, Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 layer, float depth)
+{
+	DrawQueueItem* item = AddItem(self, MakeKey(self, material, -1, layer, depth));
+	*item = (DrawQueueItem){ DrawQueueItemType_Mesh, *material, mesh, vertexOffset, vertexCount, -1 };
+}
+
+void DrawQueue_SubmitImmediatePoly(DrawQueue* self, const DrawQueueMaterial* material, const void* vertices, int32 vertexCount, int32 layer, float depth)
+{
+	if (self->currentVertexFormat < 0)
+	{
+		Error("the draw queue's immediate vertex format has not been set.");
+	}
+	int32 size = vertexCount*self->vertexFormats[self->currentVertexFormat].items[0].stride;
+	int32 offset = self->vertexDataSize;
+	self->vertexDataSize += size;
+	self->vertexData = Reserve(self->vertexData, &self->vertexDataCapacity, self->vertexDataSize, sizeof(uint8));
+	MemCpy(self->vertexData+offset, vertices, size);
+
+	DrawQueueItem* item = AddItem(self, MakeKey(self, material, self->currentVertexFormat, layer, depth));
+	*item = (DrawQueueItem){ DrawQueueItemType_ImmediatePoly, *material, null, offset, vertexCount, self->currentVertexFormat };
+}
+
+void DrawQueue_Execute(DrawQueue* self)
+{
+	for (int32 i = 0; i < self->itemCount; i++)
+	{
+		self->order[i] = i;
+	}
+	int32 scratchSize = (int32)RadixSort_GetScratchSize(self->itemCount, sizeof(uint64), true);
+	self->sortScratch = Reserve(self->sortScratch, &self->sortScratchCapacity, scratchSize, sizeof(uint8));
+	RadixSort_U64(self->keys, self->order, self->itemCount, self->sortScratch);
+
+	// Draw_SetShader and Draw_SetDrawState skip unchanged values, textures are tracked here.
+	Shader* shader = null;
+	ShaderUniform* textureUniform = null;
+	Texture* texture = null;
+	int32 vertexFormat = -1;
+	for (int32 i = 0; i < self->itemCount; i++)
+	{
+		const DrawQueueItem* item = &self->items[self->order[i]];
+		const DrawQueueMaterial* material = &item->material;
+		if (material->shader != shader)
+		{
+			Draw_SetShader(material->shader);
+			shader = material->shader;
+			// texture units are per shader uniform location, so they are set again for the new shader.
+			textureUniform = null;
+			texture = null;
+		}
+		Draw_SetDrawState(&material->drawState);
+		if (material->textureUniform && (material->textureUniform != textureUniform || material->texture != texture))
+		{
+			Shader_SetUniformTexture(material->shader, material->textureUniform, 0, material->texture);
+			textureUniform = material->textureUniform;
+			texture = material->texture;
+		}
+
+		if (item->type == DrawQueueItemType_Mesh)
+		{
+			Mesh_Draw(item->mesh, item->first, item->count);
+		}
+		else
+		{
+			if (item->vertexFormat != vertexFormat)
+			{
+				DrawQueueVertexFormat* format = &self->vertexFormats[item->vertexFormat];
+				Draw_SetImmediateVertexFormat(format->items, format->count);
+				vertexFormat = item->vertexFormat;
+			}
+			Draw_SubmitImmediatePoly(self->vertexData+item->first, item->count);
+		}
+	}
+
+	DrawQueue_Clear(self);
+}
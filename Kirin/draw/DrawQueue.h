@@ -0,0 +1,113 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+// deferred draws. submits only record, execute sorts everything by a 64 bit key and replays it through Draw_*,
+// so draws sharing a shader, draw state and texture end up next to each other and state changes once per group.
+//
+// key layout, most significant bits first:
+//   layer 8 | shader 10 | draw state 10 | texture 12 | vertex format 4 | depth 20
+// back to front layers move the depth up, for blending:
+//   layer 8 | depth 20 | shader 10 | draw state 10 | texture 12 | vertex format 4
+// shaders, draw states, textures and formats get ids in the order they are first submitted after a clear.
+// ids past a field's range share its last value, which only costs grouping, the replay compares the real state.
+// equal keys keep their submission order.
+
+#define DrawQueue_MaxLayers 256
+#define DrawQueue_MaxVertexFormats 15
+
+// everything a draw needs besides its geometry.
+typedef struct DrawQueueMaterial
+{
+	Shader* shader;
+	DrawState drawState;
+	// optional, set with Shader_SetUniformTexture before the draw.
+	ShaderUniform* textureUniform;
+	Texture* texture;
+} DrawQueueMaterial;
+
+typedef enum DrawQueueItemType
+{
+	DrawQueueItemType_Mesh,
+	DrawQueueItemType_ImmediatePoly,
+	DrawQueueItemType_Count,
+} DrawQueueItemType;
+
+static const char* DrawQueueItemType_ToString(DrawQueueItemType value)
+{
+	switch (value) {
+	case DrawQueueItemType_Mesh: return "DrawQueueItemType_Mesh"; break;
+	case DrawQueueItemType_ImmediatePoly: return "DrawQueueItemType_ImmediatePoly"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(DrawQueueItemType_Count == 2, "enum has changed.");
+}
+
+typedef struct DrawQueueItem
+{
+	DrawQueueItemType type;
+	DrawQueueMaterial material;
+	// meshes draw vertices [first, first+count).
+	// immediate polys have count vertices at byte first of DrawQueue.vertexData, in format vertexFormat.
+	Mesh* mesh;
+	int32 first;
+	int32 count;
+	int32 vertexFormat;
+} DrawQueueItem;
+
+typedef struct DrawQueueVertexFormat
+{
+	int32 count;
+	VertexFormatItem items[Mesh_MaxVertexFormatItems];
+} DrawQueueVertexFormat;
+
+// pointer or hash to id, open addressing.
+typedef struct DrawQueueIdTable
+{
+	uint64* keys;
+	int32* ids;
+	int32 size;
+	int32 count;
+} DrawQueueIdTable;
+
+typedef struct DrawQueue
+{
+	DrawQueueItem* items;
+	uint64* keys;
+	int32 itemCount;
+	int32 itemCapacity;
+	uint8* vertexData;
+	int32 vertexDataSize;
+	int32 vertexDataCapacity;
+	// item indices, sorted by key in execute.
+	int32* order;
+	void* sortScratch;
+	int32 sortScratchCapacity;
+
+	DrawQueueVertexFormat vertexFormats[DrawQueue_MaxVertexFormats];
+	int32 vertexFormatCount;
+	int32 currentVertexFormat;
+
+	DrawQueueIdTable shaderIds;
+	DrawQueueIdTable drawStateIds;
+	DrawQueueIdTable textureIds;
+
+	// one bit per layer.
+	uint32 backToFrontLayers[DrawQueue_MaxLayers/32];
+} DrawQueue;
+
+void DrawQueue_Init(DrawQueue* self);
+void DrawQueue_Free(DrawQueue* self);
+// drops everything recorded, including the ids.
+void DrawQueue_Clear(DrawQueue* self);
+// draws in back to front layers are ordered far to near before anything else. other layers go near to far inside each state group.
+void DrawQueue_SetLayerBackToFront(DrawQueue* self, int32 layer, bool backToFront);
+// applies to the immediate polys submitted after it.
+void DrawQueue_SetImmediateVertexFormat(DrawQueue* self, VertexFormatItem* format, int32 count);
+// depth is any float that grows away from the camera, like view space distance.
+void DrawQueue_SubmitMesh(DrawQueue* self, const DrawQueueMaterial* material, Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 layer, float depth);
+// vertices are copied.
+void DrawQueue_SubmitImmediatePoly(DrawQueue* self, const DrawQueueMaterial* material, const void* vertices, int32 vertexCount, int32 layer, float depth);
+// sorts and draws everything, then clears. leaves the last material's shader and draw state set.
+void DrawQueue_Execute(DrawQueue* self);
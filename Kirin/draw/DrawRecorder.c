@@ -0,0 +1,1558 @@
+#include "draw/DrawRecorder.h"
+
+#include "common/BinWriter.h"
+#include "common/CString.h"
+#include "common/File.h"
+#include "draw/null/DrawBackendNull.h"
+
+// "KDRC" read as a little endian uint32.
+#define DrawRecorder_Magic 0x4352444b
+#define DrawRecorder_Version 1
+// commands are a byte each, DrawBackendCall values for backend calls and these after them.
+// StreamData: bytes written to a persistently mapped stream buffer since it was last recorded.
+#define DrawRecorder_StreamDataCommand DrawBackendCall_Count
+#define DrawRecorder_CommandCount (DrawBackendCall_Count+1)
+static_assert(DrawRecorder_CommandCount <= 256, "commands must fit a byte.");
+#define DrawRecorder_MaxStreamBuffers 16
+
+typedef struct RecordedStreamBuffer
+{
+	StreamBuffer* streamBuffer;
+	// how far the stream buffer's data has been recorded.
+	int32 region;
+	int32 offset;
+	// the open write of a stream buffer that isn't persistently mapped.
+	uint8* mappedData;
+} RecordedStreamBuffer;
+
+static BinWriter writer;
+static DrawBackend* nullBackend;
+static RecordedStreamBuffer streamBuffers[DrawRecorder_MaxStreamBuffers];
+static int32 streamBufferCount;
+
+static void WriteBytes(const void* source, int64 size)
+{
+	BinWriter_WriteBytes(&writer, (void*)source, size);
+}
+
+// 7 bits a byte, low bits first. most arguments are small handles, counts and offsets.
+static void WriteUInt(uint64 value)
+{
+	uint8 bytes[10];
+	int32 count = 0;
+	do
+	{
+		bytes[count] = value & 0x7f;
+		value >>= 7;
+		if (value)
+		{
+			bytes[count] |= 0x80;
+		}
+		count++;
+	} while (value);
+	WriteBytes(bytes, count);
+}
+
+// zigzag, so small negative values stay small.
+static void WriteInt(int64 value)
+{
+	WriteUInt(((uint64)value << 1) ^ (uint64)(value >> 63));
+}
+
+static void WriteFloat(float value)
+{
+	WriteBytes(&value, sizeof(float));
+}
+
+static void WriteCommand(int32 command)
+{
+	uint8 byte = (uint8)command;
+	WriteBytes(&byte, 1);
+}
+
+static void WriteData(const void* data, int64 size)
+{
+	WriteUInt(size);
+	WriteBytes(data, size);
+}
+
+static RecordedStreamBuffer* FindStreamBuffer(StreamBuffer* streamBuffer)
+{
+	for (int32 i = 0; i < streamBufferCount; i++)
+	{
+		if (streamBuffers[i].streamBuffer == streamBuffer)
+		{
+			return &streamBuffers[i];
+		}
+	}
+	Error("stream buffer wasn't created through the recorder.");
+	return null;
+}
+
+// writes are appended within a region, so everything new lies between the recorded offset and the stream buffer's.
+static void RecordStreamBufferData()
+{
+	for (int32 i = 0; i < streamBufferCount; i++)
+	{
+		RecordedStreamBuffer* recorded = &streamBuffers[i];
+		StreamBuffer* streamBuffer = recorded->streamBuffer;
+		if (!streamBuffer->persistentData)
+		{
+			continue;
+		}
+
+		if (streamBuffer->region != recorded->region)
+		{
+			recorded->region = streamBuffer->region;
+			recorded->offset = streamBuffer->region*(streamBuffer->sizeInBytes/streamBuffer->regionCount);
+		}
+		if (streamBuffer->offset > recorded->offset)
+		{
+			WriteCommand(DrawRecorder_StreamDataCommand);
+			WriteInt(streamBuffer->internalHandle);
+			WriteInt(recorded->offset);
+			WriteData(streamBuffer->persistentData+recorded->offset, streamBuffer->offset-recorded->offset);
+			recorded->offset = streamBuffer->offset;
+		}
+	}
+}
+
+static int64 GetTextureDataSize(Texture* texture, int32 width, int32 height)
+{
+	width = width >= 0 ? width : texture->width;
+	height = height >= 0 ? height : texture->height;
+	if (width == 0 || height == 0)
+	{
+		return 0;
+	}
+	// rows are read 4 byte aligned, gl's default unpack alignment.
+	int64 pixelSize = texture->format == TextureFormat_RGB8 ? 3 : 4;
+	int64 rowSize = (width*pixelSize+3)/4*4;
+	return rowSize*(height-1)+width*pixelSize;
+}
+
+static void Init()
+{
+	nullBackend->init();
+	WriteCommand(DrawBackendCall_Init);
+}
+
+static void Free()
+{
+	nullBackend->free();
+	WriteCommand(DrawBackendCall_Free);
+}
+
+static void EndFrame()
+{
+	RecordStreamBufferData();
+	nullBackend->endFrame();
+	WriteCommand(DrawBackendCall_EndFrame);
+}
+
+static void VertexBufferInit(VertexBuffer* vertexBuffer, VertexBufferUsage usage)
+{
+	nullBackend->vertexBufferInit(vertexBuffer, usage);
+	WriteCommand(DrawBackendCall_VertexBufferInit);
+	WriteInt(vertexBuffer->internalHandle);
+	WriteInt(vertexBuffer->sizeInBytes);
+	WriteInt(usage);
+}
+
+static void VertexBufferUpdateData(VertexBuffer* vertexBuffer, int32 offset, int32 size, void* data)
+{
+	nullBackend->vertexBufferUpdateData(vertexBuffer, offset, size, data);
+	WriteCommand(DrawBackendCall_VertexBufferUpdateData);
+	WriteInt(vertexBuffer->internalHandle);
+	WriteInt(offset);
+	WriteData(data, size);
+}
+
+static void VertexBufferFree(VertexBuffer* vertexBuffer)
+{
+	WriteCommand(DrawBackendCall_VertexBufferFree);
+	WriteInt(vertexBuffer->internalHandle);
+	nullBackend->vertexBufferFree(vertexBuffer);
+}
+
+static void IndexBufferInit(IndexBuffer* indexBuffer, VertexBufferUsage usage)
+{
+	nullBackend->indexBufferInit(indexBuffer, usage);
+	WriteCommand(DrawBackendCall_IndexBufferInit);
+	WriteInt(indexBuffer->internalHandle);
+	WriteInt(indexBuffer->sizeInBytes);
+	WriteInt(indexBuffer->format);
+	WriteInt(usage);
+}
+
+static void IndexBufferUpdateData(IndexBuffer* indexBuffer, int32 offset, int32 size, void* data)
+{
+	nullBackend->indexBufferUpdateData(indexBuffer, offset, size, data);
+	WriteCommand(DrawBackendCall_IndexBufferUpdateData);
+	WriteInt(indexBuffer->internalHandle);
+	WriteInt(offset);
+	WriteData(data, size);
+}
+
+static void IndexBufferFree(IndexBuffer* indexBuffer)
+{
+	WriteCommand(DrawBackendCall_IndexBufferFree);
+	WriteInt(indexBuffer->internalHandle);
+	nullBackend->indexBufferFree(indexBuffer);
+}
+
+static void StreamBufferInit(StreamBuffer* streamBuffer)
+{
+	if (streamBufferCount == DrawRecorder_MaxStreamBuffers)
+	{
+		ErrorF("the recorder can't keep track of more than %d stream buffers.", DrawRecorder_MaxStreamBuffers);
+	}
+
+	nullBackend->streamBufferInit(streamBuffer);
+	streamBuffers[streamBufferCount++] = (RecordedStreamBuffer){ streamBuffer, streamBuffer->region, streamBuffer->offset, null };
+	WriteCommand(DrawBackendCall_StreamBufferInit);
+	WriteInt(streamBuffer->internalHandle);
+	WriteInt(streamBuffer->sizeInBytes);
+	WriteInt(streamBuffer->regionCount);
+}
+
+static void StreamBufferFree(StreamBuffer* streamBuffer)
+{
+	RecordedStreamBuffer* recorded = FindStreamBuffer(streamBuffer);
+	*recorded = streamBuffers[--streamBufferCount];
+
+	WriteCommand(DrawBackendCall_StreamBufferFree);
+	WriteInt(streamBuffer->internalHandle);
+	nullBackend->streamBufferFree(streamBuffer);
+}
+
+static void StreamBufferFence(StreamBuffer* streamBuffer, int32 region)
+{
+	RecordStreamBufferData();
+	nullBackend->streamBufferFence(streamBuffer, region);
+	WriteCommand(DrawBackendCall_StreamBufferFence);
+	WriteInt(streamBuffer->internalHandle);
+	WriteInt(region);
+}
+
+static void StreamBufferWait(StreamBuffer* streamBuffer, int32 region)
+{
+	nullBackend->streamBufferWait(streamBuffer, region);
+	WriteCommand(DrawBackendCall_StreamBufferWait);
+	WriteInt(streamBuffer->internalHandle);
+	WriteInt(region);
+}
+
+static void StreamBufferOrphan(StreamBuffer* streamBuffer)
+{
+	nullBackend->streamBufferOrphan(streamBuffer);
+	WriteCommand(DrawBackendCall_StreamBufferOrphan);
+	WriteInt(streamBuffer->internalHandle);
+}
+
+static void* StreamBufferMap(StreamBuffer* streamBuffer, int32 offset, int32 size)
+{
+	RecordedStreamBuffer* recorded = FindStreamBuffer(streamBuffer);
+	recorded->mappedData = nullBackend->streamBufferMap(streamBuffer, offset, size);
+	WriteCommand(DrawBackendCall_StreamBufferMap);
+	WriteInt(streamBuffer->internalHandle);
+	WriteInt(offset);
+	WriteInt(size);
+	return recorded->mappedData;
+}
+
+static void StreamBufferUnmap(StreamBuffer* streamBuffer, int32 usedSize)
+{
+	RecordedStreamBuffer* recorded = FindStreamBuffer(streamBuffer);
+	WriteCommand(DrawBackendCall_StreamBufferUnmap);
+	WriteInt(streamBuffer->internalHandle);
+	WriteData(recorded->mappedData, usedSize);
+	recorded->mappedData = null;
+	nullBackend->streamBufferUnmap(streamBuffer, usedSize);
+}
+
+static void DrawStateUpdate(DrawState* previousState, DrawState* state, bool forceUpdate)
+{
+	nullBackend->drawStateUpdate(previousState, state, forceUpdate);
+	WriteCommand(DrawBackendCall_DrawStateUpdate);
+	WriteBytes(state, sizeof(DrawState));
+	WriteInt(forceUpdate);
+}
+
+static void SetViewport(int32 x, int32 y, int32 width, int32 height)
+{
+	nullBackend->setViewport(x, y, width, height);
+	WriteCommand(DrawBackendCall_SetViewport);
+	WriteInt(x);
+	WriteInt(y);
+	WriteInt(width);
+	WriteInt(height);
+}
+
+static void ClearColor(float r, float g, float b, float a)
+{
+	nullBackend->clearColor(r, g, b, a);
+	WriteCommand(DrawBackendCall_ClearColor);
+	WriteFloat(r);
+	WriteFloat(g);
+	WriteFloat(b);
+	WriteFloat(a);
+}
+
+static void ClearDepth(float value)
+{
+	nullBackend->clearDepth(value);
+	WriteCommand(DrawBackendCall_ClearDepth);
+	WriteFloat(value);
+}
+
+static void ClearStencil(int32 value)
+{
+	nullBackend->clearStencil(value);
+	WriteCommand(DrawBackendCall_ClearStencil);
+	WriteInt(value);
+}
+
+static bool ShaderLoad(const char* path, Shader* shader)
+{
+	bool result = nullBackend->shaderLoad(path, shader);
+	WriteCommand(DrawBackendCall_ShaderLoad);
+	WriteInt(shader->program);
+	WriteData(path, StrLen(path)+1);
+	return result;
+}
+
+static void ShaderFree(Shader* shader)
+{
+	WriteCommand(DrawBackendCall_ShaderFree);
+	WriteInt(shader->program);
+	nullBackend->shaderFree(shader);
+}
+
+static void ShaderSet(Shader* shader)
+{
+	nullBackend->shaderSet(shader);
+	WriteCommand(DrawBackendCall_ShaderSet);
+	WriteInt(shader ? shader->program : 0);
+}
+
+// uniforms and constant buffers are recorded as their index in the shader, which the target backend's load fills in
+// the same way.
+static void WriteUniform(DrawBackendCall call, Shader* shader, ShaderUniform* uniform, int32 arrayIndex)
+{
+	WriteCommand(call);
+	WriteInt(shader->program);
+	WriteInt(uniform-shader->uniforms);
+	WriteInt(arrayIndex);
+}
+
+static void ShaderSetUniformInt(Shader* self, ShaderUniform* uniform, int32 arrayIndex, int32 value)
+{
+	nullBackend->shaderSetUniformInt(self, uniform, arrayIndex, value);
+	WriteUniform(DrawBackendCall_ShaderSetUniformInt, self, uniform, arrayIndex);
+	WriteInt(value);
+}
+
+static void ShaderSetUniformFloat(Shader* self, ShaderUniform* uniform, int32 arrayIndex, float value)
+{
+	nullBackend->shaderSetUniformFloat(self, uniform, arrayIndex, value);
+	WriteUniform(DrawBackendCall_ShaderSetUniformFloat, self, uniform, arrayIndex);
+	WriteFloat(value);
+}
+
+static void ShaderSetUniformTexture(Shader* self, ShaderUniform* uniform, int32 arrayIndex, Texture* value)
+{
+	nullBackend->shaderSetUniformTexture(self, uniform, arrayIndex, value);
+	WriteUniform(DrawBackendCall_ShaderSetUniformTexture, self, uniform, arrayIndex);
+	WriteInt(value ? value->internalHandle[0] : 0);
+}
+
+static void ConstantBufferInit(ConstantBuffer* self, int64 size)
+{
+	nullBackend->constantBufferInit(self, size);
+	WriteCommand(DrawBackendCall_ConstantBufferInit);
+	WriteInt(self->internalHandle);
+	WriteInt(size);
+}
+
+static void ConstantBufferAttachToShader(ConstantBuffer* self, Shader* shader, ShaderConstantBuffer* constantBuffer)
+{
+	nullBackend->constantBufferAttachToShader(self, shader, constantBuffer);
+	WriteCommand(DrawBackendCall_ConstantBufferAttachToShader);
+	WriteInt(self->internalHandle);
+	WriteInt(shader->program);
+	WriteInt(constantBuffer-shader->constantBuffers);
+}
+
+static void ConstantBufferSetData(ConstantBuffer* self, int64 offset, int64 length, void* data)
+{
+	nullBackend->constantBufferSetData(self, offset, length, data);
+	WriteCommand(DrawBackendCall_ConstantBufferSetData);
+	WriteInt(self->internalHandle);
+	WriteInt(offset);
+	WriteData(data, length);
+}
+
+static void ConstantBufferFree(ConstantBuffer* self)
+{
+	WriteCommand(DrawBackendCall_ConstantBufferFree);
+	WriteInt(self->internalHandle);
+	nullBackend->constantBufferFree(self);
+}
+
+static void TextureInit(Texture* self, TextureInitSettings* initSettings)
+{
+	nullBackend->textureInit(self, initSettings);
+	WriteCommand(DrawBackendCall_TextureInit);
+	WriteInt(self->internalHandle[0]);
+	WriteBytes(initSettings, sizeof(TextureInitSettings));
+}
+
+static void TextureFree(Texture* self)
+{
+	WriteCommand(DrawBackendCall_TextureFree);
+	WriteInt(self->internalHandle[0]);
+	nullBackend->textureFree(self);
+}
+
+static void TextureSetData(Texture* self, int32 x, int32 y, int32 width, int32 height, void* data)
+{
+	nullBackend->textureSetData(self, x, y, width, height, data);
+	WriteCommand(DrawBackendCall_TextureSetData);
+	WriteInt(self->internalHandle[0]);
+	WriteInt(x);
+	WriteInt(y);
+	WriteInt(width);
+	WriteInt(height);
+	WriteInt(data != null);
+	if (data)
+	{
+		WriteData(data, GetTextureDataSize(self, width, height));
+	}
+}
+
+static void GenerateMipmaps(Texture* self)
+{
+	nullBackend->generateMipmaps(self);
+	WriteCommand(DrawBackendCall_GenerateMipmaps);
+	WriteInt(self->internalHandle[0]);
+}
+
+static void MeshInit(Mesh* mesh)
+{
+	nullBackend->meshInit(mesh);
+	WriteCommand(DrawBackendCall_MeshInit);
+	WriteInt(mesh->internalHandle);
+}
+
+static void MeshApplyStructure(Mesh* mesh)
+{
+	nullBackend->meshApplyStructure(mesh);
+	WriteCommand(DrawBackendCall_MeshApplyStructure);
+	WriteInt(mesh->internalHandle);
+	WriteInt(mesh->vertexCount);
+	WriteInt(mesh->vertexFormatCount);
+	WriteBytes(mesh->vertexFormat, mesh->vertexFormatCount*sizeof(VertexFormatItem));
+	WriteInt(mesh->vertexBufferCount);
+	for (int32 i = 0; i < mesh->vertexBufferCount; i++)
+	{
+		WriteInt(mesh->vertexBuffers[i].internalHandle);
+		WriteInt(mesh->vertexBuffers[i].sizeInBytes);
+	}
+	WriteInt(mesh->indexBuffer.internalHandle);
+	WriteInt(mesh->indexBuffer.sizeInBytes);
+	WriteInt(mesh->indexBuffer.format);
+}
+
+static void MeshDraw(Mesh* mesh, int32 vertexOffset, int32 vertexCount)
+{
+	RecordStreamBufferData();
+	nullBackend->meshDraw(mesh, vertexOffset, vertexCount);
+	WriteCommand(DrawBackendCall_MeshDraw);
+	WriteInt(mesh->internalHandle);
+	WriteInt(vertexOffset);
+	WriteInt(vertexCount);
+}
+
+static void MeshDrawIndexed(Mesh* mesh, int32 indexOffset, int32 indexCount, int32 baseVertex)
+{
+	RecordStreamBufferData();
+	nullBackend->meshDrawIndexed(mesh, indexOffset, indexCount, baseVertex);
+	WriteCommand(DrawBackendCall_MeshDrawIndexed);
+	WriteInt(mesh->internalHandle);
+	WriteInt(indexOffset);
+	WriteInt(indexCount);
+	WriteInt(baseVertex);
+}
+
+static void MeshDrawInstanced(Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance)
+{
+	RecordStreamBufferData();
+	nullBackend->meshDrawInstanced(mesh, vertexOffset, vertexCount, instanceCount, baseInstance);
+	WriteCommand(DrawBackendCall_MeshDrawInstanced);
+	WriteInt(mesh->internalHandle);
+	WriteInt(vertexOffset);
+	WriteInt(vertexCount);
+	WriteInt(instanceCount);
+	WriteInt(baseInstance);
+}
+
+static void MeshDrawIndexedIndirect(Mesh* mesh, int32 commandBuffer, int32 commandOffset, int32 commandCount)
+{
+	RecordStreamBufferData();
+	nullBackend->meshDrawIndexedIndirect(mesh, commandBuffer, commandOffset, commandCount);
+	WriteCommand(DrawBackendCall_MeshDrawIndexedIndirect);
+	WriteInt(mesh->internalHandle);
+	WriteInt(commandBuffer);
+	WriteInt(commandOffset);
+	WriteInt(commandCount);
+}
+
+static void MeshFree(Mesh* mesh)
+{
+	WriteCommand(DrawBackendCall_MeshFree);
+	WriteInt(mesh->internalHandle);
+	nullBackend->meshFree(mesh);
+}
+
+static void QueriesInit(uint32* queries, int32 count)
+{
+	nullBackend->queriesInit(queries, count);
+	WriteCommand(DrawBackendCall_QueriesInit);
+	WriteInt(count);
+	for (int32 i = 0; i < count; i++)
+	{
+		WriteInt(queries[i]);
+	}
+}
+
+static void QueriesFree(uint32* queries, int32 count)
+{
+	WriteCommand(DrawBackendCall_QueriesFree);
+	WriteInt(count);
+	for (int32 i = 0; i < count; i++)
+	{
+		WriteInt(queries[i]);
+	}
+	nullBackend->queriesFree(queries, count);
+}
+
+static void QueryTimestamp(uint32 query)
+{
+	nullBackend->queryTimestamp(query);
+	WriteCommand(DrawBackendCall_QueryTimestamp);
+	WriteInt(query);
+}
+
+static void QueryBegin(uint32 query, GpuQueryType type)
+{
+	nullBackend->queryBegin(query, type);
+	WriteCommand(DrawBackendCall_QueryBegin);
+	WriteInt(query);
+	WriteInt(type);
+}
+
+static void QueryEnd(GpuQueryType type)
+{
+	nullBackend->queryEnd(type);
+	WriteCommand(DrawBackendCall_QueryEnd);
+	WriteInt(type);
+}
+
+static bool QueryGetResult(uint32 query, uint64* result)
+{
+	bool available = nullBackend->queryGetResult(query, result);
+	WriteCommand(DrawBackendCall_QueryGetResult);
+	WriteInt(query);
+	return available;
+}
+
+DrawBackend drawBackendRecorder = {
+	.init = Init,
+	.free = Free,
+	.endFrame = EndFrame,
+	.vertexBufferInit = VertexBufferInit,
+	.vertexBufferUpdateData = VertexBufferUpdateData,
+	.vertexBufferFree = VertexBufferFree,
+	.indexBufferInit = IndexBufferInit,
+	.indexBufferUpdateData = IndexBufferUpdateData,
+	.indexBufferFree = IndexBufferFree,
+	.streamBufferInit = StreamBufferInit,
+	.streamBufferFree = StreamBufferFree,
+	.streamBufferFence = StreamBufferFence,
+	.streamBufferWait = StreamBufferWait,
+	.streamBufferOrphan = StreamBufferOrphan,
+	.streamBufferMap = StreamBufferMap,
+	.streamBufferUnmap = StreamBufferUnmap,
+	.drawStateUpdate = DrawStateUpdate,
+	.setViewport = SetViewport,
+	.clearColor = ClearColor,
+	.clearDepth = ClearDepth,
+	.clearStencil = ClearStencil,
+	.shaderLoad = ShaderLoad,
+	.shaderFree = ShaderFree,
+	.shaderSet = ShaderSet,
+	.shaderSetUniformInt = ShaderSetUniformInt,
+	.shaderSetUniformFloat = ShaderSetUniformFloat,
+	.shaderSetUniformTexture = ShaderSetUniformTexture,
+	.constantBufferInit = ConstantBufferInit,
+	.constantBufferAttachToShader = ConstantBufferAttachToShader,
+	.constantBufferSetData = ConstantBufferSetData,
+	.constantBufferFree = ConstantBufferFree,
+	.textureInit = TextureInit,
+	.textureFree = TextureFree,
+	.textureSetData = TextureSetData,
+	.generateMipmaps = GenerateMipmaps,
+	.meshInit = MeshInit,
+	.meshApplyStructure = MeshApplyStructure,
+	.meshDraw = MeshDraw,
+	.meshDrawIndexed = MeshDrawIndexed,
+	.meshDrawInstanced = MeshDrawInstanced,
+	.meshDrawIndexedIndirect = MeshDrawIndexedIndirect,
+	.meshFree = MeshFree,
+	.queriesInit = QueriesInit,
+	.queriesFree = QueriesFree,
+	.queryTimestamp = QueryTimestamp,
+	.queryBegin = QueryBegin,
+	.queryEnd = QueryEnd,
+	.queryGetResult = QueryGetResult,
+};
+
+DrawBackend* DrawRecorder_Init()
+{
+	nullBackend = DrawBackendNull_Get();
+	streamBufferCount = 0;
+	BinWriter_Init(&writer, 1024*1024);
+
+	uint32 magic = DrawRecorder_Magic;
+	WriteBytes(&magic, sizeof(uint32));
+	WriteUInt(DrawRecorder_Version);
+	WriteUInt(sizeof(DrawState));
+	WriteUInt(sizeof(TextureInitSettings));
+	WriteUInt(sizeof(VertexFormatItem));
+	return &drawBackendRecorder;
+}
+
+void DrawRecorder_Free()
+{
+	BinWriter_Free(&writer);
+	writer = (BinWriter){ 0 };
+}
+
+const uint8* DrawRecorder_GetData(int64* outSize)
+{
+	*outSize = writer.length;
+	return writer.data;
+}
+
+bool DrawRecorder_WriteFile(const char* path)
+{
+	return File_WriteBinaryFile(path, writer.data, writer.length);
+}
+
+typedef struct ReplayObject
+{
+	// the call that made the object, DrawBackendCall_Count for free slots.
+	DrawBackendCall createdBy;
+	// the target's handle, for objects referred to by handle like buffers and queries.
+	int32 handle;
+	// the target's object for everything else.
+	void* object;
+	uint8* mappedData;
+	int32 mappedSize;
+} ReplayObject;
+
+typedef struct Replay
+{
+	const uint8* data;
+	int64 size;
+	int64 offset;
+	bool failed;
+	DrawBackend* backend;
+	// indexed by recorded handle.
+	ReplayObject* objects;
+	int32 objectCapacity;
+	DrawState previousState;
+} Replay;
+
+static uint64 ReadUInt(Replay* self)
+{
+	uint64 value = 0;
+	for (int32 shift = 0; shift < 64; shift += 7)
+	{
+		if (self->offset >= self->size)
+		{
+			self->failed = true;
+			return 0;
+		}
+		uint8 byte = self->data[self->offset++];
+		value |= (uint64)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			return value;
+		}
+	}
+	self->failed = true;
+	return 0;
+}
+
+static int64 ReadInt(Replay* self)
+{
+	uint64 value = ReadUInt(self);
+	return (int64)(value >> 1) ^ -(int64)(value & 1);
+}
+
+// returns size bytes in place, or null past the end of the stream.
+static const uint8* ReadBytes(Replay* self, int64 size)
+{
+	if (size < 0 || size > self->size-self->offset)
+	{
+		self->failed = true;
+		return null;
+	}
+	const uint8* bytes = self->data+self->offset;
+	self->offset += size;
+	return bytes;
+}
+
+static float ReadFloat(Replay* self)
+{
+	float value = 0;
+	const uint8* bytes = ReadBytes(self, sizeof(float));
+	if (bytes)
+	{
+		MemCpy(&value, bytes, sizeof(float));
+	}
+	return value;
+}
+
+static const uint8* ReadData(Replay* self, int64* outSize)
+{
+	*outSize = (int64)ReadUInt(self);
+	return ReadBytes(self, *outSize);
+}
+
+// recorded handles count up from 1, anything near this is a corrupt stream.
+#define DrawRecorder_MaxHandle (1 << 30)
+
+// an empty slot for handle, the caller sets createdBy once the object exists so a failed init leaves nothing to free.
+// recordings never reuse a handle that's still alive.
+static ReplayObject* AddObject(Replay* self, int64 handle)
+{
+	if (handle <= 0 || handle >= DrawRecorder_MaxHandle || (handle < self->objectCapacity && self->objects[handle].createdBy != DrawBackendCall_Count))
+	{
+		self->failed = true;
+		return null;
+	}
+	if (handle >= self->objectCapacity)
+	{
+		int32 capacity = MaxI(self->objectCapacity*2, (int32)handle+1);
+		self->objects = MRealloc(self->objects, capacity*sizeof(ReplayObject));
+		for (int32 i = self->objectCapacity; i < capacity; i++)
+		{
+			self->objects[i] = (ReplayObject){ DrawBackendCall_Count };
+		}
+		self->objectCapacity = capacity;
+	}
+	return &self->objects[handle];
+}
+
+static ReplayObject* GetObject(Replay* self, int64 handle, DrawBackendCall createdBy)
+{
+	if (handle <= 0 || handle >= self->objectCapacity || self->objects[handle].createdBy != createdBy)
+	{
+		self->failed = true;
+		return null;
+	}
+	return &self->objects[handle];
+}
+
+static void* ReadObject(Replay* self, DrawBackendCall createdBy)
+{
+	ReplayObject* object = GetObject(self, ReadInt(self), createdBy);
+	return object ? object->object : null;
+}
+
+// the same for arguments that can be null, recorded as handle 0.
+static void* ReadOptionalObject(Replay* self, DrawBackendCall createdBy)
+{
+	int64 handle = ReadInt(self);
+	if (handle == 0)
+	{
+		return null;
+	}
+	ReplayObject* object = GetObject(self, handle, createdBy);
+	return object ? object->object : null;
+}
+
+// backends index tables with the usage.
+static bool IsBufferValid(int64 size, int64 usage)
+{
+	return size >= 0 && size <= Int32Max && usage >= 0 && usage < VertexBufferUsage_Count;
+}
+
+// buffers of every kind share the name space the mesh and indirect draws refer to them in.
+static int32 ReadBufferHandle(Replay* self)
+{
+	int64 handle = ReadInt(self);
+	if (handle == 0)
+	{
+		return 0;
+	}
+	if (handle < 0 || handle >= self->objectCapacity)
+	{
+		self->failed = true;
+		return 0;
+	}
+	ReplayObject* object = &self->objects[handle];
+	if (object->createdBy != DrawBackendCall_VertexBufferInit && object->createdBy != DrawBackendCall_IndexBufferInit &&
+		object->createdBy != DrawBackendCall_StreamBufferInit)
+	{
+		self->failed = true;
+		return 0;
+	}
+	return object->handle;
+}
+
+static void FreeObject(Replay* self, ReplayObject* object)
+{
+	DrawBackend* backend = self->backend;
+	switch (object->createdBy) {
+	case DrawBackendCall_VertexBufferInit: backend->vertexBufferFree(object->object); break;
+	case DrawBackendCall_IndexBufferInit: backend->indexBufferFree(object->object); break;
+	case DrawBackendCall_StreamBufferInit: backend->streamBufferFree(object->object); break;
+	case DrawBackendCall_ShaderLoad: backend->shaderFree(object->object); break;
+	case DrawBackendCall_ConstantBufferInit: backend->constantBufferFree(object->object); break;
+	case DrawBackendCall_TextureInit: backend->textureFree(object->object); break;
+	case DrawBackendCall_MeshInit: backend->meshFree(object->object); break;
+	case DrawBackendCall_QueriesInit: backend->queriesFree((uint32*)&object->handle, 1); break;
+	default: break;
+	}
+	MFree(object->object);
+	*object = (ReplayObject){ DrawBackendCall_Count };
+}
+
+static void ReplayStreamBufferData(Replay* self)
+{
+	ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_StreamBufferInit);
+	int32 offset = (int32)ReadInt(self);
+	int64 size;
+	const uint8* data = ReadData(self, &size);
+	if (!object || !data)
+	{
+		return;
+	}
+	StreamBuffer* streamBuffer = object->object;
+	if (offset < 0 || offset+size > streamBuffer->sizeInBytes)
+	{
+		self->failed = true;
+		return;
+	}
+
+	// the target might not map stream buffers persistently, the fences recorded around the data still keep it safe.
+	if (streamBuffer->persistentData)
+	{
+		MemCpy(streamBuffer->persistentData+offset, data, size);
+	}
+	else
+	{
+		void* mapped = self->backend->streamBufferMap(streamBuffer, offset, (int32)size);
+		if (!mapped)
+		{
+			self->failed = true;
+			return;
+		}
+		MemCpy(mapped, data, size);
+		self->backend->streamBufferUnmap(streamBuffer, (int32)size);
+	}
+}
+
+// everything the backends index with, MeshGL_ApplyStructure only checks bufferIndex in debug builds.
+// each item has its own input, so more inputs than items are never needed.
+static bool IsVertexFormatItemValid(const VertexFormatItem* item, int64 vertexBufferCount)
+{
+	return item->bufferIndex >= 0 && item->bufferIndex < vertexBufferCount &&
+		item->inputIndex >= 0 && item->inputIndex < Mesh_MaxVertexFormatItems &&
+		item->type > VertexFormatType_None && item->type < VertexFormatType_Count &&
+		item->componentCount >= 1 && item->componentCount <= 4 &&
+		item->offset >= 0 && item->stride >= 0 && item->instanceStepRate >= 0;
+}
+
+static void ReplayMeshStructure(Replay* self)
+{
+	Mesh* mesh = ReadObject(self, DrawBackendCall_MeshInit);
+	int32 vertexCount = (int32)ReadInt(self);
+	int64 vertexFormatCount = ReadInt(self);
+	if (vertexFormatCount < 0 || vertexFormatCount > Mesh_MaxVertexFormatItems)
+	{
+		self->failed = true;
+		return;
+	}
+	const uint8* vertexFormat = ReadBytes(self, vertexFormatCount*sizeof(VertexFormatItem));
+	int64 vertexBufferCount = ReadInt(self);
+	if (!mesh || !vertexFormat || vertexBufferCount < 0 || vertexBufferCount > Mesh_MaxVertexBuffers)
+	{
+		self->failed = true;
+		return;
+	}
+
+	VertexFormatItem items[Mesh_MaxVertexFormatItems];
+	MemCpy(items, vertexFormat, vertexFormatCount*sizeof(VertexFormatItem));
+	for (int32 i = 0; i < vertexFormatCount; i++)
+	{
+		if (!IsVertexFormatItemValid(&items[i], vertexBufferCount))
+		{
+			self->failed = true;
+			return;
+		}
+	}
+
+	mesh->vertexCount = vertexCount;
+	mesh->vertexFormatCount = (int32)vertexFormatCount;
+	MemCpy(mesh->vertexFormat, items, vertexFormatCount*sizeof(VertexFormatItem));
+	mesh->vertexBufferCount = (int32)vertexBufferCount;
+	for (int32 i = 0; i < vertexBufferCount; i++)
+	{
+		mesh->vertexBuffers[i].internalHandle = ReadBufferHandle(self);
+		mesh->vertexBuffers[i].sizeInBytes = (int32)ReadInt(self);
+	}
+	mesh->indexBuffer.internalHandle = ReadBufferHandle(self);
+	mesh->indexBuffer.sizeInBytes = (int32)ReadInt(self);
+	int64 indexFormat = ReadInt(self);
+	if (indexFormat < 0 || indexFormat >= IndexFormat_Count)
+	{
+		self->failed = true;
+	}
+	mesh->indexBuffer.format = (IndexFormat)indexFormat;
+	if (!self->failed)
+	{
+		self->backend->meshApplyStructure(mesh);
+	}
+}
+
+static void ReplayUniform(Replay* self, DrawBackendCall call)
+{
+	Shader* shader = ReadObject(self, DrawBackendCall_ShaderLoad);
+	int64 uniformIndex = ReadInt(self);
+	int32 arrayIndex = (int32)ReadInt(self);
+	if (!shader || uniformIndex < 0 || uniformIndex >= shader->uniformCount)
+	{
+		self->failed = true;
+		return;
+	}
+	ShaderUniform* uniform = &shader->uniforms[uniformIndex];
+
+	if (call == DrawBackendCall_ShaderSetUniformInt)
+	{
+		self->backend->shaderSetUniformInt(shader, uniform, arrayIndex, (int32)ReadInt(self));
+	}
+	else if (call == DrawBackendCall_ShaderSetUniformFloat)
+	{
+		self->backend->shaderSetUniformFloat(shader, uniform, arrayIndex, ReadFloat(self));
+	}
+	else
+	{
+		Texture* texture = ReadOptionalObject(self, DrawBackendCall_TextureInit);
+		self->backend->shaderSetUniformTexture(shader, uniform, arrayIndex, texture);
+	}
+}
+
+// runs one command, the stream is checked as it's read and a bad one sets failed.
+static void ReplayCommand(Replay* self, int32 command, DrawRecorderFrameFunction onEndFrame, void* userData)
+{
+	DrawBackend* backend = self->backend;
+	switch (command) {
+	case DrawBackendCall_Init:
+		backend->init();
+		break;
+	case DrawBackendCall_Free:
+		backend->free();
+		break;
+	case DrawBackendCall_EndFrame:
+		backend->endFrame();
+		if (onEndFrame)
+		{
+			onEndFrame(userData);
+		}
+		break;
+	case DrawBackendCall_VertexBufferInit:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		int64 size = ReadInt(self);
+		int64 usage = ReadInt(self);
+		if (object && !IsBufferValid(size, usage))
+		{
+			self->failed = true;
+		}
+		else if (object)
+		{
+			VertexBuffer* vertexBuffer = MAlloc(sizeof(VertexBuffer));
+			*vertexBuffer = (VertexBuffer){ 0, (int32)size };
+			backend->vertexBufferInit(vertexBuffer, (VertexBufferUsage)usage);
+			object->object = vertexBuffer;
+			object->createdBy = DrawBackendCall_VertexBufferInit;
+			object->handle = vertexBuffer->internalHandle;
+		}
+		break;
+	}
+	case DrawBackendCall_VertexBufferUpdateData:
+	{
+		VertexBuffer* vertexBuffer = ReadObject(self, DrawBackendCall_VertexBufferInit);
+		int64 offset = ReadInt(self);
+		int64 size;
+		const uint8* data = ReadData(self, &size);
+		if (vertexBuffer && data && (offset < 0 || offset+size > vertexBuffer->sizeInBytes))
+		{
+			self->failed = true;
+		}
+		else if (vertexBuffer && data)
+		{
+			backend->vertexBufferUpdateData(vertexBuffer, (int32)offset, (int32)size, (void*)data);
+		}
+		break;
+	}
+	case DrawBackendCall_VertexBufferFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_VertexBufferInit);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_IndexBufferInit:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		int64 size = ReadInt(self);
+		int64 format = ReadInt(self);
+		int64 usage = ReadInt(self);
+		if (object && (!IsBufferValid(size, usage) || format < 0 || format >= IndexFormat_Count))
+		{
+			self->failed = true;
+		}
+		else if (object)
+		{
+			IndexBuffer* indexBuffer = MAlloc(sizeof(IndexBuffer));
+			*indexBuffer = (IndexBuffer){ 0, (int32)size, (IndexFormat)format };
+			backend->indexBufferInit(indexBuffer, (VertexBufferUsage)usage);
+			object->object = indexBuffer;
+			object->createdBy = DrawBackendCall_IndexBufferInit;
+			object->handle = indexBuffer->internalHandle;
+		}
+		break;
+	}
+	case DrawBackendCall_IndexBufferUpdateData:
+	{
+		IndexBuffer* indexBuffer = ReadObject(self, DrawBackendCall_IndexBufferInit);
+		int64 offset = ReadInt(self);
+		int64 size;
+		const uint8* data = ReadData(self, &size);
+		if (indexBuffer && data && (offset < 0 || offset+size > indexBuffer->sizeInBytes))
+		{
+			self->failed = true;
+		}
+		else if (indexBuffer && data)
+		{
+			backend->indexBufferUpdateData(indexBuffer, (int32)offset, (int32)size, (void*)data);
+		}
+		break;
+	}
+	case DrawBackendCall_IndexBufferFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_IndexBufferInit);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_StreamBufferInit:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		int32 size = (int32)ReadInt(self);
+		int32 regionCount = (int32)ReadInt(self);
+		if (object && regionCount >= 1 && regionCount <= StreamBuffer_MaxRegions && size > 0)
+		{
+			StreamBuffer* streamBuffer = MAlloc(sizeof(StreamBuffer));
+			*streamBuffer = (StreamBuffer){ 0 };
+			streamBuffer->sizeInBytes = size;
+			streamBuffer->regionCount = regionCount;
+			streamBuffer->writeOffset = -1;
+			backend->streamBufferInit(streamBuffer);
+			object->object = streamBuffer;
+			object->createdBy = DrawBackendCall_StreamBufferInit;
+			object->handle = streamBuffer->internalHandle;
+		}
+		else
+		{
+			self->failed = true;
+		}
+		break;
+	}
+	case DrawBackendCall_StreamBufferFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_StreamBufferInit);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_StreamBufferFence:
+	case DrawBackendCall_StreamBufferWait:
+	{
+		StreamBuffer* streamBuffer = ReadObject(self, DrawBackendCall_StreamBufferInit);
+		int64 region = ReadInt(self);
+		if (!streamBuffer || region < 0 || region >= streamBuffer->regionCount)
+		{
+			self->failed = true;
+		}
+		else if (command == DrawBackendCall_StreamBufferFence)
+		{
+			backend->streamBufferFence(streamBuffer, (int32)region);
+		}
+		else if (streamBuffer->regionFences[region])
+		{
+			backend->streamBufferWait(streamBuffer, (int32)region);
+		}
+		break;
+	}
+	case DrawBackendCall_StreamBufferOrphan:
+	{
+		StreamBuffer* streamBuffer = ReadObject(self, DrawBackendCall_StreamBufferInit);
+		if (streamBuffer)
+		{
+			backend->streamBufferOrphan(streamBuffer);
+		}
+		break;
+	}
+	case DrawBackendCall_StreamBufferMap:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_StreamBufferInit);
+		int64 offset = ReadInt(self);
+		int64 size = ReadInt(self);
+		if (!object)
+		{
+			break;
+		}
+		StreamBuffer* streamBuffer = object->object;
+		if (offset < 0 || size < 0 || offset+size > streamBuffer->sizeInBytes)
+		{
+			self->failed = true;
+			break;
+		}
+		object->mappedData = backend->streamBufferMap(streamBuffer, (int32)offset, (int32)size);
+		object->mappedSize = (int32)size;
+		if (!object->mappedData)
+		{
+			self->failed = true;
+		}
+		break;
+	}
+	case DrawBackendCall_StreamBufferUnmap:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_StreamBufferInit);
+		int64 size;
+		const uint8* data = ReadData(self, &size);
+		if (object && data && object->mappedData && size <= object->mappedSize)
+		{
+			MemCpy(object->mappedData, data, size);
+			backend->streamBufferUnmap(object->object, (int32)size);
+			object->mappedData = null;
+		}
+		else
+		{
+			self->failed = true;
+		}
+		break;
+	}
+	case DrawBackendCall_DrawStateUpdate:
+	{
+		const uint8* bytes = ReadBytes(self, sizeof(DrawState));
+		bool forceUpdate = ReadInt(self) != 0;
+		if (bytes)
+		{
+			DrawState state;
+			MemCpy(&state, bytes, sizeof(DrawState));
+			backend->drawStateUpdate(&self->previousState, &state, forceUpdate);
+		}
+		break;
+	}
+	case DrawBackendCall_SetViewport:
+	{
+		int32 x = (int32)ReadInt(self);
+		int32 y = (int32)ReadInt(self);
+		int32 width = (int32)ReadInt(self);
+		int32 height = (int32)ReadInt(self);
+		backend->setViewport(x, y, width, height);
+		break;
+	}
+	case DrawBackendCall_ClearColor:
+	{
+		float r = ReadFloat(self);
+		float g = ReadFloat(self);
+		float b = ReadFloat(self);
+		float a = ReadFloat(self);
+		backend->clearColor(r, g, b, a);
+		break;
+	}
+	case DrawBackendCall_ClearDepth:
+		backend->clearDepth(ReadFloat(self));
+		break;
+	case DrawBackendCall_ClearStencil:
+		backend->clearStencil((int32)ReadInt(self));
+		break;
+	case DrawBackendCall_ShaderLoad:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		int64 pathSize;
+		const char* path = (const char*)ReadData(self, &pathSize);
+		if (!object || !path || pathSize == 0 || path[pathSize-1] != '\0')
+		{
+			self->failed = true;
+			break;
+		}
+		Shader* shader = MAlloc(sizeof(Shader));
+		*shader = (Shader){ 0 };
+		object->object = shader;
+		object->createdBy = DrawBackendCall_ShaderLoad;
+		if (!backend->shaderLoad(path, shader))
+		{
+			PrintF("replay couldn't load shader \"%s\".\n", path);
+			self->failed = true;
+		}
+		break;
+	}
+	case DrawBackendCall_ShaderFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_ShaderLoad);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_ShaderSet:
+		backend->shaderSet(ReadOptionalObject(self, DrawBackendCall_ShaderLoad));
+		break;
+	case DrawBackendCall_ShaderSetUniformInt:
+	case DrawBackendCall_ShaderSetUniformFloat:
+	case DrawBackendCall_ShaderSetUniformTexture:
+		ReplayUniform(self, command);
+		break;
+	case DrawBackendCall_ConstantBufferInit:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		int64 size = ReadInt(self);
+		if (object)
+		{
+			ConstantBuffer* constantBuffer = MAlloc(sizeof(ConstantBuffer));
+			*constantBuffer = (ConstantBuffer){ 0 };
+			backend->constantBufferInit(constantBuffer, size);
+			object->object = constantBuffer;
+			object->createdBy = DrawBackendCall_ConstantBufferInit;
+		}
+		break;
+	}
+	case DrawBackendCall_ConstantBufferAttachToShader:
+	{
+		ConstantBuffer* constantBuffer = ReadObject(self, DrawBackendCall_ConstantBufferInit);
+		Shader* shader = ReadObject(self, DrawBackendCall_ShaderLoad);
+		int64 index = ReadInt(self);
+		if (!constantBuffer || !shader || index < 0 || index >= shader->constantBufferCount)
+		{
+			self->failed = true;
+			break;
+		}
+		backend->constantBufferAttachToShader(constantBuffer, shader, &shader->constantBuffers[index]);
+		break;
+	}
+	case DrawBackendCall_ConstantBufferSetData:
+	{
+		ConstantBuffer* constantBuffer = ReadObject(self, DrawBackendCall_ConstantBufferInit);
+		int64 offset = ReadInt(self);
+		int64 size;
+		const uint8* data = ReadData(self, &size);
+		if (constantBuffer && data)
+		{
+			backend->constantBufferSetData(constantBuffer, offset, size, (void*)data);
+		}
+		break;
+	}
+	case DrawBackendCall_ConstantBufferFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_ConstantBufferInit);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_TextureInit:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		const uint8* bytes = ReadBytes(self, sizeof(TextureInitSettings));
+		if (object && bytes)
+		{
+			TextureInitSettings settings;
+			MemCpy(&settings, bytes, sizeof(TextureInitSettings));
+			Texture* texture = MAlloc(sizeof(Texture));
+			MemSet(texture, 0, sizeof(Texture));
+			backend->textureInit(texture, &settings);
+			object->object = texture;
+			object->createdBy = DrawBackendCall_TextureInit;
+		}
+		break;
+	}
+	case DrawBackendCall_TextureFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_TextureInit);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_TextureSetData:
+	{
+		Texture* texture = ReadObject(self, DrawBackendCall_TextureInit);
+		int32 x = (int32)ReadInt(self);
+		int32 y = (int32)ReadInt(self);
+		int32 width = (int32)ReadInt(self);
+		int32 height = (int32)ReadInt(self);
+		const uint8* data = null;
+		if (ReadInt(self))
+		{
+			int64 size;
+			data = ReadData(self, &size);
+			if (!data || !texture || size != GetTextureDataSize(texture, width, height))
+			{
+				self->failed = true;
+				break;
+			}
+		}
+		if (texture)
+		{
+			backend->textureSetData(texture, x, y, width, height, (void*)data);
+		}
+		break;
+	}
+	case DrawBackendCall_GenerateMipmaps:
+	{
+		Texture* texture = ReadObject(self, DrawBackendCall_TextureInit);
+		if (texture)
+		{
+			backend->generateMipmaps(texture);
+		}
+		break;
+	}
+	case DrawBackendCall_MeshInit:
+	{
+		ReplayObject* object = AddObject(self, ReadInt(self));
+		if (object)
+		{
+			Mesh* mesh = MAlloc(sizeof(Mesh));
+			MemSet(mesh, 0, sizeof(Mesh));
+			backend->meshInit(mesh);
+			object->object = mesh;
+			object->createdBy = DrawBackendCall_MeshInit;
+		}
+		break;
+	}
+	case DrawBackendCall_MeshApplyStructure:
+		ReplayMeshStructure(self);
+		break;
+	case DrawBackendCall_MeshDraw:
+	{
+		Mesh* mesh = ReadObject(self, DrawBackendCall_MeshInit);
+		int32 vertexOffset = (int32)ReadInt(self);
+		int32 vertexCount = (int32)ReadInt(self);
+		if (mesh)
+		{
+			backend->meshDraw(mesh, vertexOffset, vertexCount);
+		}
+		break;
+	}
+	case DrawBackendCall_MeshDrawIndexed:
+	{
+		Mesh* mesh = ReadObject(self, DrawBackendCall_MeshInit);
+		int32 indexOffset = (int32)ReadInt(self);
+		int32 indexCount = (int32)ReadInt(self);
+		int32 baseVertex = (int32)ReadInt(self);
+		if (mesh)
+		{
+			backend->meshDrawIndexed(mesh, indexOffset, indexCount, baseVertex);
+		}
+		break;
+	}
+	case DrawBackendCall_MeshDrawInstanced:
+	{
+		Mesh* mesh = ReadObject(self, DrawBackendCall_MeshInit);
+		int32 vertexOffset = (int32)ReadInt(self);
+		int32 vertexCount = (int32)ReadInt(self);
+		int32 instanceCount = (int32)ReadInt(self);
+		int32 baseInstance = (int32)ReadInt(self);
+		if (mesh)
+		{
+			backend->meshDrawInstanced(mesh, vertexOffset, vertexCount, instanceCount, baseInstance);
+		}
+		break;
+	}
+	case DrawBackendCall_MeshDrawIndexedIndirect:
+	{
+		Mesh* mesh = ReadObject(self, DrawBackendCall_MeshInit);
+		int32 commandBuffer = ReadBufferHandle(self);
+		int32 commandOffset = (int32)ReadInt(self);
+		int32 commandCount = (int32)ReadInt(self);
+		if (mesh && commandBuffer)
+		{
+			backend->meshDrawIndexedIndirect(mesh, commandBuffer, commandOffset, commandCount);
+		}
+		break;
+	}
+	case DrawBackendCall_MeshFree:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_MeshInit);
+		if (object)
+		{
+			FreeObject(self, object);
+		}
+		break;
+	}
+	case DrawBackendCall_QueriesInit:
+	{
+		int64 count = ReadInt(self);
+		for (int64 i = 0; i < count && !self->failed; i++)
+		{
+			ReplayObject* object = AddObject(self, ReadInt(self));
+			if (object)
+			{
+				backend->queriesInit((uint32*)&object->handle, 1);
+				object->createdBy = DrawBackendCall_QueriesInit;
+			}
+		}
+		break;
+	}
+	case DrawBackendCall_QueriesFree:
+	{
+		int64 count = ReadInt(self);
+		for (int64 i = 0; i < count && !self->failed; i++)
+		{
+			ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_QueriesInit);
+			if (object)
+			{
+				FreeObject(self, object);
+			}
+		}
+		break;
+	}
+	case DrawBackendCall_QueryTimestamp:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_QueriesInit);
+		if (object)
+		{
+			backend->queryTimestamp(object->handle);
+		}
+		break;
+	}
+	case DrawBackendCall_QueryBegin:
+	{
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_QueriesInit);
+		int64 type = ReadInt(self);
+		if (object && type > GpuQueryType_Timestamp && type < GpuQueryType_Count)
+		{
+			backend->queryBegin(object->handle, (GpuQueryType)type);
+		}
+		else
+		{
+			self->failed = true;
+		}
+		break;
+	}
+	case DrawBackendCall_QueryEnd:
+	{
+		int64 type = ReadInt(self);
+		if (type > GpuQueryType_Timestamp && type < GpuQueryType_Count)
+		{
+			backend->queryEnd((GpuQueryType)type);
+		}
+		else
+		{
+			self->failed = true;
+		}
+		break;
+	}
+	case DrawBackendCall_QueryGetResult:
+	{
+		// the result isn't used, asking keeps the target's work the same as the recorded one's.
+		ReplayObject* object = GetObject(self, ReadInt(self), DrawBackendCall_QueriesInit);
+		uint64 result;
+		if (object)
+		{
+			backend->queryGetResult(object->handle, &result);
+		}
+		break;
+	}
+	case DrawRecorder_StreamDataCommand:
+		ReplayStreamBufferData(self);
+		break;
+	default:
+		self->failed = true;
+		break;
+	}
+	static_assert(DrawBackendCall_Count == 48, "enum has changed.");
+}
+
+bool DrawRecorder_Replay(const uint8* data, int64 size, DrawBackend* backend, DrawRecorderFrameFunction onEndFrame, void* userData)
+{
+	Replay replay = { 0 };
+	replay.data = data;
+	replay.size = size;
+	replay.backend = backend;
+
+	uint32 magic = 0;
+	const uint8* magicBytes = ReadBytes(&replay, sizeof(uint32));
+	if (magicBytes)
+	{
+		MemCpy(&magic, magicBytes, sizeof(uint32));
+	}
+	if (magic != DrawRecorder_Magic || ReadUInt(&replay) != DrawRecorder_Version || ReadUInt(&replay) != sizeof(DrawState) ||
+		ReadUInt(&replay) != sizeof(TextureInitSettings) || ReadUInt(&replay) != sizeof(VertexFormatItem))
+	{
+		PrintF("not a draw recording, or one from a different version.\n");
+		return false;
+	}
+
+	while (replay.offset < replay.size && !replay.failed)
+	{
+		int32 command = replay.data[replay.offset++];
+		ReplayCommand(&replay, command, onEndFrame, userData);
+	}
+	if (replay.failed)
+	{
+		PrintF("draw recording is corrupt at byte %lld.\n", replay.offset);
+	}
+
+	for (int32 i = 0; i < replay.objectCapacity; i++)
+	{
+		if (replay.objects[i].createdBy != DrawBackendCall_Count)
+		{
+			FreeObject(&replay, &replay.objects[i]);
+		}
+	}
+	MFree(replay.objects);
+	return !replay.failed;
+}
+
+bool DrawRecorder_ReplayFile(const char* path, DrawBackend* backend, DrawRecorderFrameFunction onEndFrame, void* userData)
+{
+	int64 size;
+	uint8* data = File_ReadBinaryFileAlloc(path, &size);
+	if (!data)
+	{
+		return false;
+	}
+	bool result = DrawRecorder_Replay(data, size, backend, onEndFrame, userData);
+	MFree(data);
+	return result;
+}
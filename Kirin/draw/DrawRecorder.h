@@ -0,0 +1,27 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+// a backend that writes every call it gets, with its arguments, to a compact binary stream and then hands the call to
+// the null backend. it needs no window or gpu, so a capture can be made anywhere and replayed later against the gl
+// backend, or against the null one to benchmark Draw_* on the same calls.
+//
+// data written to persistently mapped stream buffers never passes through the backend. the recorder writes out what
+// was added to each stream buffer before every draw and fence, so replay puts it in place before the draws that read it.
+// handles in the stream are the null backend's, replay maps them to the objects it creates on the target backend.
+// streams only replay in a build with the same struct layouts, which the header checks.
+
+typedef void (*DrawRecorderFrameFunction)(void* userData);
+
+// starts a new recording. pass the returned backend to Draw_Init.
+DrawBackend* DrawRecorder_Init();
+void DrawRecorder_Free();
+// the calls recorded so far.
+const uint8* DrawRecorder_GetData(int64* outSize);
+bool DrawRecorder_WriteFile(const char* path);
+// makes the recorded calls on backend, which must be able to run them right now, like Draw_Init's backend.
+// onEndFrame runs after each recorded endFrame and can be null, it's where a window would present.
+// objects the recording didn't free are freed at the end. returns false if data isn't a valid stream.
+bool DrawRecorder_Replay(const uint8* data, int64 size, DrawBackend* backend, DrawRecorderFrameFunction onEndFrame, void* userData);
+bool DrawRecorder_ReplayFile(const char* path, DrawBackend* backend, DrawRecorderFrameFunction onEndFrame, void* userData);
@@ -0,0 +1,303 @@
+#include "draw/FrameStats.h"
+
+#include "common/Math.h"
+#include "common/CString.h"
+#include "common/File.h"
+
+#include <stdlib.h>
+
+int32 FrameStatsHistogram_GetBucketIndex(uint64 ticks)
+{
+	if (ticks < FrameStatsHistogram_SubBucketCount)
+	{
+		return (int32)ticks;
+	}
+
+	int32 shift = FloorLog2UI64(ticks)-FrameStatsHistogram_SubBucketBits;
+	int32 subBucket = (int32)(ticks >> shift)-FrameStatsHistogram_SubBucketCount;
+	int32 index = (shift+1)*FrameStatsHistogram_SubBucketCount+subBucket;
+	return MinI(index, FrameStatsHistogram_BucketCount-1);
+}
+
+uint64 FrameStatsHistogram_GetBucketMin(int32 bucketIndex)
+{
+	if (bucketIndex < FrameStatsHistogram_SubBucketCount)
+	{
+		return (uint64)bucketIndex;
+	}
+
+	int32 shift = bucketIndex/FrameStatsHistogram_SubBucketCount-1;
+	uint64 subBucket = (uint64)(bucketIndex%FrameStatsHistogram_SubBucketCount);
+	return (FrameStatsHistogram_SubBucketCount+subBucket) << shift;
+}
+
+static void FrameStatsHistogram_Record(FrameStatsHistogram* self, uint64 ticks)
+{
+	self->counts[FrameStatsHistogram_GetBucketIndex(ticks)]++;
+	self->totalCount++;
+}
+
+void FrameStats_Init(FrameStats* self)
+{
+	MemSet(self, 0, sizeof(FrameStats));
+}
+
+void FrameStats_Reset(FrameStats* self)
+{
+	// keep the thresholds and the present timeline, drop everything measured.
+	uint64 lastPresentEndTicks = self->lastPresentEndTicks;
+	uint64 frameNumber = self->frameNumber;
+	int32 hitchThresholdCount = self->hitchThresholdCount;
+	uint64 hitchThresholdTicks[FrameStats_MaxHitchThresholds];
+	MemCpy(hitchThresholdTicks, self->hitchThresholdTicks, sizeof(hitchThresholdTicks));
+
+	MemSet(self, 0, sizeof(FrameStats));
+
+	self->lastPresentEndTicks = lastPresentEndTicks;
+	self->frameNumber = frameNumber;
+	self->hitchThresholdCount = hitchThresholdCount;
+	MemCpy(self->hitchThresholdTicks, hitchThresholdTicks, sizeof(hitchThresholdTicks));
+}
+
+void FrameStats_SetHitchThresholds(FrameStats* self, const uint64* thresholdTicks, int32 count)
+{
+	if (count < 0 || count > FrameStats_MaxHitchThresholds)
+	{
+		ErrorF("count must be between 0 and %d.", FrameStats_MaxHitchThresholds);
+	}
+
+	self->hitchThresholdCount = count;
+	MemSet(self->hitchCounts, 0, sizeof(self->hitchCounts));
+	for (int32 i = 0; i < count; i++)
+	{
+		self->hitchThresholdTicks[i] = thresholdTicks[i];
+	}
+}
+
+void FrameStats_OnPresent(FrameStats* self, uint64 presentStartTicks, uint64 presentEndTicks)
+{
+	if (self->lastPresentEndTicks == 0)
+	{
+		// no previous frame to measure against yet.
+		self->lastPresentEndTicks = presentEndTicks;
+		gDrawStatCounters = (DrawStatCounters){ 0 };
+		return;
+	}
+
+	FrameStatsSample* sample = &self->samples[self->nextSampleIndex];
+	*sample = (FrameStatsSample){ 0 };
+	sample->frameNumber = self->frameNumber++;
+	sample->ticks[FrameStatsChannel_Frame] = presentEndTicks-self->lastPresentEndTicks;
+	// everything between the end of the last present and the start of this one is cpu work for this frame.
+	sample->ticks[FrameStatsChannel_Cpu] = presentStartTicks-self->lastPresentEndTicks;
+	sample->drawCounters = gDrawStatCounters;
+	gDrawStatCounters = (DrawStatCounters){ 0 };
+
+	self->lastPresentEndTicks = presentEndTicks;
+	self->nextSampleIndex = (self->nextSampleIndex+1)%FrameStats_WindowSize;
+	self->sampleCount = MinI(self->sampleCount+1, FrameStats_WindowSize);
+
+	FrameStatsHistogram_Record(&self->histograms[FrameStatsChannel_Frame], sample->ticks[FrameStatsChannel_Frame]);
+	FrameStatsHistogram_Record(&self->histograms[FrameStatsChannel_Cpu], sample->ticks[FrameStatsChannel_Cpu]);
+
+	for (int32 i = 0; i < self->hitchThresholdCount; i++)
+	{
+		if (sample->ticks[FrameStatsChannel_Frame] > self->hitchThresholdTicks[i])
+		{
+			self->hitchCounts[i]++;
+		}
+	}
+}
+
+void FrameStats_SetGpuTicks(FrameStats* self, uint64 frameNumber, uint64 gpuTicks)
+{
+	for (int32 age = 0; age < self->sampleCount; age++)
+	{
+		FrameStatsSample* sample = (FrameStatsSample*)FrameStats_GetSample(self, age);
+		if (sample->frameNumber == frameNumber)
+		{
+			// the first result wins, so a frame is only counted once in the histogram.
+			if (sample->ticks[FrameStatsChannel_Gpu] == 0)
+			{
+				// 0 means not available, a frame faster than a tick still has a result.
+				gpuTicks = MaxUI64(gpuTicks, 1);
+				sample->ticks[FrameStatsChannel_Gpu] = gpuTicks;
+				FrameStatsHistogram_Record(&self->histograms[FrameStatsChannel_Gpu], gpuTicks);
+			}
+			return;
+		}
+		if (sample->frameNumber < frameNumber)
+		{
+			// frame hasn't been presented yet.
+			return;
+		}
+	}
+}
+
+const FrameStatsSample* FrameStats_GetSample(const FrameStats* self, int32 age)
+{
+	if (age < 0 || age >= self->sampleCount)
+	{
+		return null;
+	}
+	int32 index = (self->nextSampleIndex-1-age+FrameStats_WindowSize)%FrameStats_WindowSize;
+	return &self->samples[index];
+}
+
+static int CompareUInt64(const void* a, const void* b)
+{
+	uint64 va = *(const uint64*)a;
+	uint64 vb = *(const uint64*)b;
+	return va < vb ? -1 : va > vb ? 1 : 0;
+}
+
+static uint64 GetPercentile(const uint64* sorted, int32 count, int32 percent)
+{
+	// nearest rank.
+	int32 rank = (count*percent+99)/100;
+	return sorted[ClampI(rank-1, 0, count-1)];
+}
+
+FrameStatsSummary FrameStats_GetSummary(const FrameStats* self, FrameStatsChannel channel)
+{
+	FrameStatsSummary result = { 0 };
+
+	uint64 values[FrameStats_WindowSize];
+	int32 count = 0;
+	double sum = 0;
+	for (int32 i = 0; i < self->sampleCount; i++)
+	{
+		uint64 value = self->samples[i].ticks[channel];
+		if (value != 0)
+		{
+			values[count++] = value;
+			sum += (double)value;
+		}
+	}
+
+	if (count == 0)
+	{
+		return result;
+	}
+
+	// PERF: fine for a window this size, queries aren't per frame.
+	qsort(values, count, sizeof(uint64), CompareUInt64);
+
+	result.sampleCount = count;
+	result.p50 = GetPercentile(values, count, 50);
+	result.p95 = GetPercentile(values, count, 95);
+	result.p99 = GetPercentile(values, count, 99);
+	result.max = values[count-1];
+	result.mean = sum/(double)count;
+	return result;
+}
+
+static double TicksToMS(uint64 ticks)
+{
+	return (double)ticks/10000.0;
+}
+
+static void WriteLine(File* file, const char* line)
+{
+	File_WriteBinary(file, (const uint8*)line, StrLen(line));
+}
+
+bool FrameStats_WriteCSV(const FrameStats* self, const char* path)
+{
+	File file;
+	if (!File_Open(&file, path, FileMode_Write))
+	{
+		return false;
+	}
+
+	char line[512];
+	WriteLine(&file, "frame,frame_ms,cpu_ms,gpu_ms,immediate_draws,mesh_draws,shader_changes,granular_state_changes,immediate_bytes_uploaded,mesh_instances\n");
+	for (int32 age = self->sampleCount-1; age >= 0; age--)
+	{
+		const FrameStatsSample* sample = FrameStats_GetSample(self, age);
+		SPrintF(line, sizeof(line), "%llu,%.4f,%.4f,%.4f,%llu,%llu,%llu,%llu,%llu,%llu\n",
+			sample->frameNumber,
+			TicksToMS(sample->ticks[FrameStatsChannel_Frame]),
+			TicksToMS(sample->ticks[FrameStatsChannel_Cpu]),
+			TicksToMS(sample->ticks[FrameStatsChannel_Gpu]),
+			sample->drawCounters.immediateDraws,
+			sample->drawCounters.meshDraws,
+			sample->drawCounters.shaderChanges,
+			sample->drawCounters.granularStateChanges,
+			sample->drawCounters.immediateBytesUploaded,
+			sample->drawCounters.meshInstances);
+		WriteLine(&file, line);
+	}
+
+	File_Close(&file);
+	return true;
+}
+
+bool FrameStats_WriteSummaryCSV(const FrameStats* self, const char* path)
+{
+	static const char* channelNames[] = {
+		[FrameStatsChannel_Frame] = "frame",
+		[FrameStatsChannel_Cpu] = "cpu",
+		[FrameStatsChannel_Gpu] = "gpu",
+	};
+	static_assert(FrameStatsChannel_Count == 3, "enum has changed.");
+
+	File file;
+	if (!File_Open(&file, path, FileMode_Write))
+	{
+		return false;
+	}
+
+	char line[512];
+	WriteLine(&file, "channel,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+	for (int32 i = 0; i < FrameStatsChannel_Count; i++)
+	{
+		FrameStatsSummary summary = FrameStats_GetSummary(self, (FrameStatsChannel)i);
+		SPrintF(line, sizeof(line), "%s,%d,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+			channelNames[i],
+			summary.sampleCount,
+			summary.mean/10000.0,
+			TicksToMS(summary.p50),
+			TicksToMS(summary.p95),
+			TicksToMS(summary.p99),
+			TicksToMS(summary.max));
+		WriteLine(&file, line);
+	}
+
+	WriteLine(&file, "hitch_threshold_ms,count\n");
+	for (int32 i = 0; i < self->hitchThresholdCount; i++)
+	{
+		SPrintF(line, sizeof(line), "%.4f,%llu\n", TicksToMS(self->hitchThresholdTicks[i]), self->hitchCounts[i]);
+		WriteLine(&file, line);
+	}
+
+	File_Close(&file);
+	return true;
+}
+
+bool FrameStats_WriteHistogramCSV(const FrameStats* self, const char* path)
+{
+	File file;
+	if (!File_Open(&file, path, FileMode_Write))
+	{
+		return false;
+	}
+
+	char line[256];
+	WriteLine(&file, "bucket_min_ms,frame,cpu,gpu\n");
+	for (int32 i = 0; i < FrameStatsHistogram_BucketCount; i++)
+	{
+		uint64 frameCount = self->histograms[FrameStatsChannel_Frame].counts[i];
+		uint64 cpuCount = self->histograms[FrameStatsChannel_Cpu].counts[i];
+		uint64 gpuCount = self->histograms[FrameStatsChannel_Gpu].counts[i];
+		if (frameCount == 0 && cpuCount == 0 && gpuCount == 0)
+		{
+			continue;
+		}
+		SPrintF(line, sizeof(line), "%.4f,%llu,%llu,%llu\n", TicksToMS(FrameStatsHistogram_GetBucketMin(i)), frameCount, cpuCount, gpuCount);
+		WriteLine(&file, line);
+	}
+
+	File_Close(&file);
+	return true;
+}
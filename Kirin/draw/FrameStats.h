@@ -0,0 +1,96 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/Draw.h"
+
+typedef enum FrameStatsChannel
+{
+	FrameStatsChannel_Frame,
+	FrameStatsChannel_Cpu,
+	FrameStatsChannel_Gpu,
+	FrameStatsChannel_Count,
+} FrameStatsChannel;
+
+static const char* FrameStatsChannel_ToString(FrameStatsChannel value)
+{
+	switch (value) {
+	case FrameStatsChannel_Frame: return "FrameStatsChannel_Frame"; break;
+	case FrameStatsChannel_Cpu: return "FrameStatsChannel_Cpu"; break;
+	case FrameStatsChannel_Gpu: return "FrameStatsChannel_Gpu"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(FrameStatsChannel_Count == 3, "enum has changed.");
+}
+
+typedef struct FrameStatsSample
+{
+	uint64 frameNumber;
+	// indexed by FrameStatsChannel. 0 means the value isn't available (yet), which is normal for gpu time.
+	uint64 ticks[FrameStatsChannel_Count];
+	DrawStatCounters drawCounters;
+} FrameStatsSample;
+
+// log bucketed histogram in the style of hdr histogram.
+// values below FrameStatsHistogram_SubBucketCount get their own bucket, above that every power of 2 is split into FrameStatsHistogram_SubBucketCount linear buckets.
+#define FrameStatsHistogram_SubBucketBits 3
+#define FrameStatsHistogram_SubBucketCount (1 << FrameStatsHistogram_SubBucketBits)
+// covers up to 2^36 ticks (about 1.9 hours). larger values land in the last bucket.
+#define FrameStatsHistogram_MaxValueBits 36
+#define FrameStatsHistogram_BucketCount ((FrameStatsHistogram_MaxValueBits-FrameStatsHistogram_SubBucketBits+1)*FrameStatsHistogram_SubBucketCount)
+typedef struct FrameStatsHistogram
+{
+	uint64 totalCount;
+	uint64 counts[FrameStatsHistogram_BucketCount];
+} FrameStatsHistogram;
+
+int32 FrameStatsHistogram_GetBucketIndex(uint64 ticks);
+// smallest value that maps to bucketIndex.
+uint64 FrameStatsHistogram_GetBucketMin(int32 bucketIndex);
+
+typedef struct FrameStatsSummary
+{
+	int32 sampleCount;
+	uint64 p50;
+	uint64 p95;
+	uint64 p99;
+	uint64 max;
+	double mean;
+} FrameStatsSummary;
+
+// number of frames kept for percentile queries and csv dumps.
+#define FrameStats_WindowSize 1024
+#define FrameStats_MaxHitchThresholds 4
+typedef struct FrameStats
+{
+	uint64 frameNumber;
+	uint64 lastPresentEndTicks;
+	int32 sampleCount;
+	int32 nextSampleIndex;
+	FrameStatsSample samples[FrameStats_WindowSize];
+	// histograms and hitch counts cover everything since the last reset, not just the window.
+	FrameStatsHistogram histograms[FrameStatsChannel_Count];
+	int32 hitchThresholdCount;
+	uint64 hitchThresholdTicks[FrameStats_MaxHitchThresholds];
+	// frames whose frame time exceeded the matching threshold.
+	uint64 hitchCounts[FrameStats_MaxHitchThresholds];
+} FrameStats;
+
+void FrameStats_Init(FrameStats* self);
+void FrameStats_Reset(FrameStats* self);
+// thresholds are in ticks. there are 10000 ticks in 1 milisecond.
+void FrameStats_SetHitchThresholds(FrameStats* self, const uint64* thresholdTicks, int32 count);
+// called by Window_Present when the window has frameStats set.
+// records a frame, snapshots gDrawStatCounters into it and resets them.
+void FrameStats_OnPresent(FrameStats* self, uint64 presentStartTicks, uint64 presentEndTicks);
+// fills in gpu time for a frame that's still in the window. gpu results usually arrive a few frames late.
+// a frame that already has gpu time keeps it.
+void FrameStats_SetGpuTicks(FrameStats* self, uint64 frameNumber, uint64 gpuTicks);
+// age 0 is the most recent frame. returns null if age is outside the window.
+const FrameStatsSample* FrameStats_GetSample(const FrameStats* self, int32 age);
+FrameStatsSummary FrameStats_GetSummary(const FrameStats* self, FrameStatsChannel channel);
+// one row per frame in the window.
+bool FrameStats_WriteCSV(const FrameStats* self, const char* path);
+// one row per channel with percentiles, followed by hitch counts.
+bool FrameStats_WriteSummaryCSV(const FrameStats* self, const char* path);
+// one row per non empty histogram bucket with the count for each channel.
+bool FrameStats_WriteHistogramCSV(const FrameStats* self, const char* path);
@@ -0,0 +1,238 @@
+#include "draw/GpuProfiler.h"
+
+#include "draw/Draw.h"
+#include "draw/FrameStats.h"
+
+// timestamps come back in nanoseconds, ticks are 100 nanoseconds.
+#define GpuProfiler_NanosecondsPerTick 100
+
+void GpuProfiler_Init(GpuProfiler* self, bool pipelineStatistics)
+{
+	*self = (GpuProfiler){ 0 };
+	self->pipelineStatistics = pipelineStatistics;
+	self->lastFrame.frameNumber = -1;
+
+	DrawBackend* backend = Draw_GetBackend();
+	for (int32 i = 0; i < GpuProfiler_MaxFramesInFlight; i++)
+	{
+		GpuProfilerFrameQueries* frame = &self->frames[i];
+		backend->queriesInit(frame->timestamps, GpuProfiler_TimestampsPerFrame);
+		if (pipelineStatistics)
+		{
+			backend->queriesInit(frame->primitivesGenerated, GpuProfiler_MaxScopes);
+			backend->queriesInit(frame->samplesPassed, GpuProfiler_MaxScopes);
+		}
+	}
+
+	GpuProfiler_BeginFrame(self, null);
+}
+
+void GpuProfiler_Free(GpuProfiler* self)
+{
+	if (self->recording)
+	{
+		GpuProfiler_EndFrame(self, null);
+	}
+
+	DrawBackend* backend = Draw_GetBackend();
+	for (int32 i = 0; i < GpuProfiler_MaxFramesInFlight; i++)
+	{
+		GpuProfilerFrameQueries* frame = &self->frames[i];
+		backend->queriesFree(frame->timestamps, GpuProfiler_TimestampsPerFrame);
+		if (self->pipelineStatistics)
+		{
+			backend->queriesFree(frame->primitivesGenerated, GpuProfiler_MaxScopes);
+			backend->queriesFree(frame->samplesPassed, GpuProfiler_MaxScopes);
+		}
+	}
+	*self = (GpuProfiler){ 0 };
+}
+
+static bool HasStatistics(GpuProfiler* self, GpuProfilerScope* scope)
+{
+	return self->pipelineStatistics && scope->depth == 0;
+}
+
+void GpuProfiler_BeginScope(GpuProfiler* self, const char* name)
+{
+	if (self->depth == GpuProfiler_MaxDepth)
+	{
+		ErrorF("gpu profiler scopes can't be nested more than %d deep.", GpuProfiler_MaxDepth);
+	}
+
+	GpuProfilerFrameQueries* recording = self->recording;
+	if (!recording || recording->frame.scopeCount == GpuProfiler_MaxScopes)
+	{
+		if (recording)
+		{
+			self->droppedScopes++;
+		}
+		self->openScopes[self->depth++] = -1;
+		return;
+	}
+
+	// draws batched so far belong before the scope.
+	Draw_Flush();
+	DrawBackend* backend = Draw_GetBackend();
+
+	int32 index = recording->frame.scopeCount++;
+	GpuProfilerScope* scope = &recording->frame.scopes[index];
+	*scope = (GpuProfilerScope){ 0 };
+	scope->name = name;
+	scope->depth = self->depth;
+	self->openScopes[self->depth++] = index;
+
+	backend->queryTimestamp(recording->timestamps[2+index*2]);
+	if (HasStatistics(self, scope))
+	{
+		backend->queryBegin(recording->primitivesGenerated[index], GpuQueryType_PrimitivesGenerated);
+		backend->queryBegin(recording->samplesPassed[index], GpuQueryType_SamplesPassed);
+	}
+}
+
+void GpuProfiler_EndScope(GpuProfiler* self)
+{
+	if (self->depth == 0)
+	{
+		Error("GpuProfiler_EndScope called without GpuProfiler_BeginScope.");
+	}
+
+	int32 index = self->openScopes[--self->depth];
+	if (index < 0)
+	{
+		return;
+	}
+
+	Draw_Flush();
+	DrawBackend* backend = Draw_GetBackend();
+
+	GpuProfilerFrameQueries* recording = self->recording;
+	if (HasStatistics(self, &recording->frame.scopes[index]))
+	{
+		backend->queryEnd(GpuQueryType_PrimitivesGenerated);
+		backend->queryEnd(GpuQueryType_SamplesPassed);
+	}
+	backend->queryTimestamp(recording->timestamps[3+index*2]);
+}
+
+static uint64 GetTicksBetween(uint64 beginNanoseconds, uint64 endNanoseconds)
+{
+	// the clock only goes forward, but don't turn a driver hiccup into a huge unsigned value.
+	return endNanoseconds > beginNanoseconds ? (endNanoseconds-beginNanoseconds)/GpuProfiler_NanosecondsPerTick : 0;
+}
+
+// fills in the frame's results, false if the gpu hasn't finished it.
+static bool ReadFrame(GpuProfiler* self, GpuProfilerFrameQueries* queries)
+{
+	DrawBackend* backend = Draw_GetBackend();
+	GpuProfilerFrame* frame = &queries->frame;
+
+	// the gpu gets to the frame's last timestamp after everything else in it.
+	uint64 frameBegin;
+	uint64 frameEnd;
+	if (!backend->queryGetResult(queries->timestamps[1], &frameEnd) || !backend->queryGetResult(queries->timestamps[0], &frameBegin))
+	{
+		return false;
+	}
+	frame->ticks = GetTicksBetween(frameBegin, frameEnd);
+	frame->primitivesGenerated = 0;
+	frame->samplesPassed = 0;
+
+	for (int32 i = 0; i < frame->scopeCount; i++)
+	{
+		GpuProfilerScope* scope = &frame->scopes[i];
+		uint64 begin;
+		uint64 end;
+		if (!backend->queryGetResult(queries->timestamps[2+i*2], &begin) || !backend->queryGetResult(queries->timestamps[3+i*2], &end))
+		{
+			return false;
+		}
+		scope->ticks = GetTicksBetween(begin, end);
+
+		if (HasStatistics(self, scope))
+		{
+			if (!backend->queryGetResult(queries->primitivesGenerated[i], &scope->primitivesGenerated) ||
+				!backend->queryGetResult(queries->samplesPassed[i], &scope->samplesPassed))
+			{
+				return false;
+			}
+			frame->primitivesGenerated += scope->primitivesGenerated;
+			frame->samplesPassed += scope->samplesPassed;
+		}
+	}
+	return true;
+}
+
+void GpuProfiler_BeginFrame(GpuProfiler* self, struct FrameStats* frameStats)
+{
+#if CONFIG_DEBUG
+	if (self->recording)
+	{
+		Error("GpuProfiler_BeginFrame called twice without GpuProfiler_EndFrame.");
+	}
+#endif
+
+	// frames finish in order, stop at the first one that isn't done.
+	while (self->readFrames != self->recordedFrames)
+	{
+		GpuProfilerFrameQueries* queries = &self->frames[self->readFrames%GpuProfiler_MaxFramesInFlight];
+		if (!ReadFrame(self, queries))
+		{
+			break;
+		}
+		self->lastFrame = queries->frame;
+		if (frameStats && queries->frame.frameNumber >= 0)
+		{
+			FrameStats_SetGpuTicks(frameStats, (uint64)queries->frame.frameNumber, queries->frame.ticks);
+		}
+		self->readFrames++;
+	}
+
+	if (self->recordedFrames-self->readFrames == GpuProfiler_MaxFramesInFlight)
+	{
+		// the gpu is further behind than there are queries for, skip this frame instead of waiting.
+		self->droppedFrames++;
+		return;
+	}
+
+	GpuProfilerFrameQueries* recording = &self->frames[self->recordedFrames%GpuProfiler_MaxFramesInFlight];
+	recording->frame.frameNumber = -1;
+	recording->frame.scopeCount = 0;
+	self->recording = recording;
+	Draw_GetBackend()->queryTimestamp(recording->timestamps[0]);
+}
+
+void GpuProfiler_EndFrame(GpuProfiler* self, struct FrameStats* frameStats)
+{
+	if (self->depth != 0)
+	{
+#if CONFIG_DEBUG
+		Error("the frame ended with gpu profiler scopes still open.");
+#endif
+		while (self->depth != 0)
+		{
+			GpuProfiler_EndScope(self);
+		}
+	}
+
+	GpuProfilerFrameQueries* recording = self->recording;
+	if (!recording)
+	{
+		return;
+	}
+
+	Draw_Flush();
+	Draw_GetBackend()->queryTimestamp(recording->timestamps[1]);
+	// FrameStats doesn't record the first present, and numbers the others from 0.
+	if (frameStats && frameStats->lastPresentEndTicks != 0)
+	{
+		recording->frame.frameNumber = (int64)frameStats->frameNumber;
+	}
+	self->recording = null;
+	self->recordedFrames++;
+}
+
+const GpuProfilerFrame* GpuProfiler_GetLastFrame(const GpuProfiler* self)
+{
+	return &self->lastFrame;
+}
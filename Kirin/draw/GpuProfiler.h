@@ -0,0 +1,91 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+struct FrameStats;
+
+// gpu time of named scopes, like passes, measured with timestamp queries.
+// queries of a frame are read back a few frames later, once the gpu has got to them, so nothing waits on the gpu.
+// each frame in flight has its own set of queries, a frame that finds none free isn't measured.
+// times are spans between two points of the gpu's timeline, so they include any time the gpu sat waiting for commands.
+// all calls must come from the thread that owns the draw backend.
+//
+// with pipeline statistics each outermost scope also counts the primitives it generated and the samples that passed the
+// depth and stencil tests. the gpu counts one query of a kind at a time, so nested scopes only get timed.
+
+#define GpuProfiler_MaxFramesInFlight 4
+#define GpuProfiler_MaxScopes 64
+#define GpuProfiler_MaxDepth 16
+// frame begin and end, then begin and end of every scope.
+#define GpuProfiler_TimestampsPerFrame (2+GpuProfiler_MaxScopes*2)
+
+typedef struct GpuProfilerScope
+{
+	// not copied, it has to stay valid until the frame's results are read.
+	const char* name;
+	// 0 for outermost scopes.
+	int32 depth;
+	// gpu time between the scope's begin and end, in ticks.
+	uint64 ticks;
+	// only counted for outermost scopes with pipeline statistics on, 0 otherwise.
+	uint64 primitivesGenerated;
+	uint64 samplesPassed;
+} GpuProfilerScope;
+
+typedef struct GpuProfilerFrame
+{
+	// FrameStats frame number of the frame, or -1 when it isn't one FrameStats records.
+	int64 frameNumber;
+	// from the first command after the previous frame's present to the last one before this frame's present.
+	uint64 ticks;
+	// sums of the outermost scopes.
+	uint64 primitivesGenerated;
+	uint64 samplesPassed;
+	// in the order the scopes began.
+	int32 scopeCount;
+	GpuProfilerScope scopes[GpuProfiler_MaxScopes];
+} GpuProfilerFrame;
+
+typedef struct GpuProfilerFrameQueries
+{
+	uint32 timestamps[GpuProfiler_TimestampsPerFrame];
+	uint32 primitivesGenerated[GpuProfiler_MaxScopes];
+	uint32 samplesPassed[GpuProfiler_MaxScopes];
+	GpuProfilerFrame frame;
+} GpuProfilerFrameQueries;
+
+typedef struct GpuProfiler
+{
+	bool pipelineStatistics;
+	GpuProfilerFrameQueries frames[GpuProfiler_MaxFramesInFlight];
+	// frames recorded and frames read back. frame i uses frames[i%GpuProfiler_MaxFramesInFlight].
+	uint64 recordedFrames;
+	uint64 readFrames;
+	// the frame being recorded, null when no queries were free for it.
+	GpuProfilerFrameQueries* recording;
+	// scope indices of the open scopes, -1 for scopes that aren't measured.
+	int32 openScopes[GpuProfiler_MaxDepth];
+	int32 depth;
+	// frames that went unmeasured because all queries were still in flight, or that ran out of scopes.
+	uint64 droppedFrames;
+	uint64 droppedScopes;
+	// the most recent frame read back, frameNumber is -1 and the rest 0 until there is one.
+	GpuProfilerFrame lastFrame;
+} GpuProfiler;
+
+// Draw_Init must have run. starts measuring the first frame right away.
+void GpuProfiler_Init(GpuProfiler* self, bool pipelineStatistics);
+void GpuProfiler_Free(GpuProfiler* self);
+// name must outlive the frame's read back, a string literal is the usual choice.
+void GpuProfiler_BeginScope(GpuProfiler* self, const char* name);
+void GpuProfiler_EndScope(GpuProfiler* self);
+// called by Window_Present when the window has gpuProfiler set, after the present.
+// reads back every frame the gpu has finished and starts measuring the next one. gpu time of the frames read back goes to
+// frameStats when it's not null.
+void GpuProfiler_BeginFrame(GpuProfiler* self, struct FrameStats* frameStats);
+// called by Window_Present when the window has gpuProfiler set, after the frame's draws and before the present.
+// closes scopes left open.
+void GpuProfiler_EndFrame(GpuProfiler* self, struct FrameStats* frameStats);
+// the most recent frame with results, usually a few frames old.
+const GpuProfilerFrame* GpuProfiler_GetLastFrame(const GpuProfiler* self);
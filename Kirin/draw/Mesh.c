@@ -20,6 +20,25 @@ void VertexBuffer_Free(VertexBuffer* self)
 	Draw_GetBackend()->vertexBufferFree(self);
 }
 
+void IndexBuffer_Init(IndexBuffer* self, int32 sizeInBytes, IndexFormat format, VertexBufferUsage usage)
+{
+	*self = (IndexBuffer){ 0 };
+	self->sizeInBytes = sizeInBytes;
+	self->format = format;
+
+	Draw_GetBackend()->indexBufferInit(self, usage);
+}
+
+void IndexBuffer_SetData(IndexBuffer* self, int32 offset, int32 size, void* data)
+{
+	Draw_GetBackend()->indexBufferUpdateData(self, offset, size, data);
+}
+
+void IndexBuffer_Free(IndexBuffer* self)
+{
+	Draw_GetBackend()->indexBufferFree(self);
+}
+
 void Mesh_Init(Mesh* self)
 {
 	*self = (Mesh){ 0 };
@@ -39,11 +58,69 @@ void Mesh_Draw(Mesh* self, int32 vertexOffset, int32 vertexCount)
 	gDrawStatCounters.meshDraws++;
 }
 
+void Mesh_DrawIndexed(Mesh* self, int32 indexOffset, int32 indexCount, int32 baseVertex)
+{
+#if CONFIG_DEBUG
+	if (self->indexBuffer.internalHandle == 0)
+	{
+		Error("mesh has no index buffer.");
+	}
+	if (indexOffset < 0 || (indexOffset+indexCount)*IndexFormat_ToSize(self->indexBuffer.format) > self->indexBuffer.sizeInBytes)
+	{
+		ErrorF("index range is out of the index buffer. indexOffset: %d indexCount: %d sizeInBytes: %d", indexOffset, indexCount, self->indexBuffer.sizeInBytes);
+	}
+#endif
+
+	Draw_Flush();
+	Draw_GetBackend()->meshDrawIndexed(self, indexOffset, indexCount, baseVertex);
+	gDrawStatCounters.meshDraws++;
+}
+
+void Mesh_DrawInstanced(Mesh* self, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance)
+{
+	if (instanceCount <= 0)
+	{
+		return;
+	}
+
+	Draw_Flush();
+	Draw_GetBackend()->meshDrawInstanced(self, vertexOffset, vertexCount, instanceCount, baseInstance);
+	gDrawStatCounters.meshDraws++;
+	gDrawStatCounters.meshInstances += instanceCount;
+}
+
+void Mesh_DrawIndexedIndirect(Mesh* self, int32 commandBuffer, int32 commandOffset, int32 commandCount)
+{
+#if CONFIG_DEBUG
+	if (self->indexBuffer.internalHandle == 0)
+	{
+		Error("mesh has no index buffer.");
+	}
+#endif
+	if (commandCount <= 0)
+	{
+		return;
+	}
+
+	Draw_Flush();
+	Draw_GetBackend()->meshDrawIndexedIndirect(self, commandBuffer, commandOffset, commandCount);
+	gDrawStatCounters.meshDraws++;
+}
+
 void Mesh_Free(Mesh* self)
 {
+	int32 instanceBuffer = Draw_GetInstanceVertexBuffer().internalHandle;
 	for (int32 i = 0; i < self->vertexBufferCount; i++)
 	{
-		VertexBuffer_Free(&self->vertexBuffers[i]);
+		// the instance stream is only borrowed.
+		if (self->vertexBuffers[i].internalHandle != instanceBuffer)
+		{
+			VertexBuffer_Free(&self->vertexBuffers[i]);
+		}
+	}
+	if (self->indexBuffer.internalHandle)
+	{
+		IndexBuffer_Free(&self->indexBuffer);
 	}
 	Draw_GetBackend()->meshFree(self);
 }
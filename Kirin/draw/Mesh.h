@@ -57,6 +57,8 @@ typedef struct VertexFormatItem
 	int32 stride;
 	VertexFormatType type;
 	int32 componentCount;
+	// 0 for per vertex data, otherwise the item moves to the next element once every instanceStepRate instances.
+	int32 instanceStepRate;
 } VertexFormatItem;
 
 typedef struct VertexBuffer {
@@ -64,6 +66,51 @@ typedef struct VertexBuffer {
 	int32 sizeInBytes;
 } VertexBuffer;
 
+typedef enum IndexFormat {
+	IndexFormat_None,
+	IndexFormat_U16,
+	IndexFormat_U32,
+	IndexFormat_Count,
+} IndexFormat;
+
+static const char* IndexFormat_ToString(IndexFormat value)
+{
+	switch (value) {
+	case IndexFormat_None: return "IndexFormat_None"; break;
+	case IndexFormat_U16: return "IndexFormat_U16"; break;
+	case IndexFormat_U32: return "IndexFormat_U32"; break;
+	default: return "INVALID"; break;
+	}
+	static_assert(IndexFormat_Count == 3, "enum has changed.");
+}
+
+static const int32 IndexFormat_ToSize(IndexFormat value)
+{
+	switch (value) {
+	case IndexFormat_U16: return 2; break;
+	case IndexFormat_U32: return 4; break;
+	default: ErrorF("cannot get size of IndexFormat \"%s\".", IndexFormat_ToString(value)); break;
+	}
+	static_assert(IndexFormat_Count == 3, "enum has changed.");
+	return 0;
+}
+
+// triangle list indices.
+typedef struct IndexBuffer {
+	int32 internalHandle;
+	int32 sizeInBytes;
+	IndexFormat format;
+} IndexBuffer;
+
+// one draw of a multi draw indirect call, laid out the way the gpu reads it.
+typedef struct DrawIndexedIndirectCommand {
+	uint32 indexCount;
+	uint32 instanceCount;
+	uint32 firstIndex;
+	int32 baseVertex;
+	uint32 baseInstance;
+} DrawIndexedIndirectCommand;
+
 #define Mesh_MaxVertexFormatItems 32
 #define Mesh_MaxVertexBuffers 16
 typedef struct Mesh {
@@ -73,12 +120,24 @@ typedef struct Mesh {
 	VertexFormatItem vertexFormat[Mesh_MaxVertexFormatItems];
 	int32 vertexBufferCount;
 	VertexBuffer vertexBuffers[Mesh_MaxVertexBuffers];
+	// optional, internalHandle 0 means the mesh isn't indexed. bound to the mesh by Mesh_ApplyStructure.
+	IndexBuffer indexBuffer;
 } Mesh;
 
 void VertexBuffer_Init(VertexBuffer* self, int32 sizeInBytes, VertexBufferUsage usage);
 void VertexBuffer_SetData(VertexBuffer* self, int32 offset, int32 size, void* data);
 void VertexBuffer_Free(VertexBuffer* self);
+void IndexBuffer_Init(IndexBuffer* self, int32 sizeInBytes, IndexFormat format, VertexBufferUsage usage);
+void IndexBuffer_SetData(IndexBuffer* self, int32 offset, int32 size, void* data);
+void IndexBuffer_Free(IndexBuffer* self);
 void Mesh_Init(Mesh* self);
 void Mesh_ApplyStructure(Mesh* self);
 void Mesh_Draw(Mesh* self, int32 vertexOffset, int32 vertexCount);
+// draws instanceCount copies in one call. per instance items start at element baseInstance, per vertex items aren't offset by it.
+// draws indices [indexOffset, indexOffset+indexCount) of the mesh's index buffer. baseVertex is added to every index,
+// so one buffer can hold the indices of several meshes packed in the same vertex buffers.
+void Mesh_DrawIndexed(Mesh* self, int32 indexOffset, int32 indexCount, int32 baseVertex);
+void Mesh_DrawInstanced(Mesh* self, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance);
+// draws commandCount indexed draws read from commandBuffer, a backend buffer handle, starting at byte commandOffset.
+void Mesh_DrawIndexedIndirect(Mesh* self, int32 commandBuffer, int32 commandOffset, int32 commandCount);
 void Mesh_Free(Mesh* self);
@@ -0,0 +1,155 @@
+#include "draw/MeshPool.h"
+
+#include "common/Math.h"
+#include "draw/Draw.h"
+
+void MeshPool_Init(MeshPool* self, VertexFormatItem* vertexFormat, int32 vertexFormatCount, VertexFormatItem* drawDataFormat, int32 drawDataFormatCount, int32 vertexCapacity, int32 indexCapacity)
+{
+	if (vertexFormatCount <= 0 || vertexFormatCount+drawDataFormatCount > Mesh_MaxVertexFormatItems)
+	{
+		ErrorF("unsupported vertex format item count: %d+%d", vertexFormatCount, drawDataFormatCount);
+	}
+
+	*self = (MeshPool){ 0 };
+	self->vertexStride = vertexFormat[0].stride;
+	self->vertexCapacity = vertexCapacity;
+	self->indexCapacity = indexCapacity;
+	self->drawDataSize = drawDataFormatCount > 0 ? drawDataFormat[0].stride : 0;
+
+	Mesh_Init(&self->mesh);
+	self->mesh.vertexBufferCount = 1;
+	VertexBuffer_Init(&self->mesh.vertexBuffers[0], vertexCapacity*self->vertexStride, VertexBufferUsage_Static);
+	IndexBuffer_Init(&self->mesh.indexBuffer, indexCapacity*(int32)sizeof(uint32), IndexFormat_U32, VertexBufferUsage_Static);
+
+	MemCpy(self->mesh.vertexFormat, vertexFormat, vertexFormatCount*sizeof(VertexFormatItem));
+	self->mesh.vertexFormatCount = vertexFormatCount;
+	if (drawDataFormatCount > 0)
+	{
+		self->mesh.vertexBuffers[self->mesh.vertexBufferCount++] = Draw_GetInstanceVertexBuffer();
+		for (int32 i = 0; i < drawDataFormatCount; i++)
+		{
+			VertexFormatItem* item = &self->mesh.vertexFormat[self->mesh.vertexFormatCount++];
+			*item = drawDataFormat[i];
+			item->bufferIndex = 1;
+			item->stride = self->drawDataSize;
+			item->instanceStepRate = 1;
+		}
+	}
+	Mesh_ApplyStructure(&self->mesh);
+}
+
+void MeshPool_Free(MeshPool* self)
+{
+	Mesh_Free(&self->mesh);
+	for (int32 i = 0; i < self->bucketCount; i++)
+	{
+		MFree(self->buckets[i].commands);
+	}
+	MFree(self->buckets);
+	MFree(self->drawData);
+	*self = (MeshPool){ 0 };
+}
+
+MeshPoolRange MeshPool_Add(MeshPool* self, const void* vertices, int32 vertexCount, const uint32* indices, int32 indexCount)
+{
+	if (self->vertexCount+vertexCount > self->vertexCapacity || self->indexCount+indexCount > self->indexCapacity)
+	{
+		ErrorF("mesh pool is full. vertices: %d+%d/%d indices: %d+%d/%d", self->vertexCount, vertexCount, self->vertexCapacity, self->indexCount, indexCount, self->indexCapacity);
+	}
+
+	MeshPoolRange range = { self->indexCount, indexCount, self->vertexCount };
+	VertexBuffer_SetData(&self->mesh.vertexBuffers[0], self->vertexCount*self->vertexStride, vertexCount*self->vertexStride, (void*)vertices);
+	IndexBuffer_SetData(&self->mesh.indexBuffer, self->indexCount*(int32)sizeof(uint32), indexCount*(int32)sizeof(uint32), (void*)indices);
+	self->vertexCount += vertexCount;
+	self->indexCount += indexCount;
+	return range;
+}
+
+static inline bool BucketMatches(const MeshPoolBucket* bucket, Shader* shader, const DrawState* drawState)
+{
+	return bucket->shader == shader && MemCmp(&bucket->drawState, drawState, sizeof(DrawState)) == 0;
+}
+
+static MeshPoolBucket* GetBucket(MeshPool* self, Shader* shader, const DrawState* drawState)
+{
+	if (self->lastBucket < self->bucketCount && BucketMatches(&self->buckets[self->lastBucket], shader, drawState))
+	{
+		return &self->buckets[self->lastBucket];
+	}
+
+	// bucket counts are small, a linear search is fine.
+	for (int32 i = 0; i < self->bucketCount; i++)
+	{
+		if (BucketMatches(&self->buckets[i], shader, drawState))
+		{
+			self->lastBucket = i;
+			return &self->buckets[i];
+		}
+	}
+
+	if (self->bucketCount == self->bucketCapacity)
+	{
+		self->bucketCapacity = MaxI(self->bucketCapacity*2, 8);
+		self->buckets = MRealloc(self->buckets, self->bucketCapacity*sizeof(MeshPoolBucket));
+	}
+	self->lastBucket = self->bucketCount++;
+	MeshPoolBucket* bucket = &self->buckets[self->lastBucket];
+	*bucket = (MeshPoolBucket){ 0 };
+	bucket->shader = shader;
+	bucket->drawState = *drawState;
+	return bucket;
+}
+
+void MeshPool_Draw(MeshPool* self, Shader* shader, const DrawState* drawState, MeshPoolRange range, const void* drawData)
+{
+	if (self->drawDataSize)
+	{
+		if (self->drawCount == Draw_GetMaxStreamedInstances(self->drawDataSize))
+		{
+			MeshPool_Submit(self);
+		}
+		if (self->drawCount == self->drawCapacity)
+		{
+			self->drawCapacity = MaxI(self->drawCapacity*2, 1024);
+			self->drawData = MRealloc(self->drawData, self->drawCapacity*self->drawDataSize);
+		}
+		MemCpy(self->drawData+self->drawCount*self->drawDataSize, drawData, self->drawDataSize);
+	}
+
+	MeshPoolBucket* bucket = GetBucket(self, shader, drawState);
+	if (bucket->count == bucket->capacity)
+	{
+		bucket->capacity = MaxI(bucket->capacity*2, 256);
+		bucket->commands = MRealloc(bucket->commands, bucket->capacity*sizeof(DrawIndexedIndirectCommand));
+	}
+	bucket->commands[bucket->count++] = (DrawIndexedIndirectCommand){ range.indexCount, 1, range.firstIndex, range.baseVertex, self->drawCount };
+	self->drawCount++;
+}
+
+void MeshPool_Submit(MeshPool* self)
+{
+	int32 firstInstance = 0;
+	if (self->drawDataSize && self->drawCount > 0)
+	{
+		firstInstance = Draw_StreamInstances(self->drawData, self->drawDataSize, self->drawCount);
+	}
+
+	for (int32 i = 0; i < self->bucketCount; i++)
+	{
+		MeshPoolBucket* bucket = &self->buckets[i];
+		if (bucket->count == 0)
+		{
+			continue;
+		}
+
+		for (int32 j = 0; j < bucket->count; j++)
+		{
+			bucket->commands[j].baseInstance += firstInstance;
+		}
+		Draw_SetShader(bucket->shader);
+		Draw_SetDrawState(&bucket->drawState);
+		Draw_MeshIndexedIndirect(&self->mesh, bucket->commands, bucket->count);
+		bucket->count = 0;
+	}
+	self->drawCount = 0;
+}
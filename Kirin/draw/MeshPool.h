@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+// static meshes sharing one vertex format packed into one vertex and index buffer, so their draws can go out together.
+// draws are gathered into buckets by shader and draw state, and submit issues one multi draw indirect call per bucket.
+//
+// per draw data, like a transform or material index, is kept in recording order and streamed once on submit.
+// each command's baseInstance points at its draw's data, which the shader reads through the pool's per instance items.
+// that only needs gl 4.3. gl_DrawID, where the shader has it (gl 4.6 or ARB_shader_draw_parameters), is the index of
+// the command inside its multi draw call, not the index of the data.
+
+// where a mesh added to the pool lives, for MeshPool_Draw.
+typedef struct MeshPoolRange
+{
+	int32 firstIndex;
+	int32 indexCount;
+	int32 baseVertex;
+} MeshPoolRange;
+
+typedef struct MeshPoolBucket
+{
+	Shader* shader;
+	DrawState drawState;
+	// baseInstance holds the draw's index until submit.
+	DrawIndexedIndirectCommand* commands;
+	int32 count;
+	int32 capacity;
+} MeshPoolBucket;
+
+typedef struct MeshPool
+{
+	// vertex buffer 0 holds the vertices, vertex buffer 1 is the instance stream when there is per draw data.
+	Mesh mesh;
+	int32 vertexStride;
+	int32 vertexCount;
+	int32 vertexCapacity;
+	int32 indexCount;
+	int32 indexCapacity;
+	int32 drawDataSize;
+	// per draw data of every recorded draw.
+	uint8* drawData;
+	int32 drawCount;
+	int32 drawCapacity;
+
+	MeshPoolBucket* buckets;
+	int32 bucketCount;
+	int32 bucketCapacity;
+	// draws tend to come in runs with the same material.
+	int32 lastBucket;
+} MeshPool;
+
+// vertexFormat items all read buffer 0. drawDataFormat items describe the per draw data, their buffer index and step rate
+// are set here and their stride is the size of a draw's data. drawDataFormatCount can be 0.
+// indices are 32 bit.
+void MeshPool_Init(MeshPool* self, VertexFormatItem* vertexFormat, int32 vertexFormatCount, VertexFormatItem* drawDataFormat, int32 drawDataFormatCount, int32 vertexCapacity, int32 indexCapacity);
+void MeshPool_Free(MeshPool* self);
+// uploads a mesh into the pool. indices are relative to the mesh's own vertices.
+MeshPoolRange MeshPool_Add(MeshPool* self, const void* vertices, int32 vertexCount, const uint32* indices, int32 indexCount);
+// records a draw, drawData is copied and can be null without per draw data.
+// submits on its own when there is more draw data than the instance stream can take at once.
+void MeshPool_Draw(MeshPool* self, Shader* shader, const DrawState* drawState, MeshPoolRange range, const void* drawData);
+// draws everything recorded since the last submit, bucket by bucket in the order buckets were first used.
+void MeshPool_Submit(MeshPool* self);
@@ -0,0 +1,112 @@
+#include "draw/StreamBuffer.h"
+
+#include "draw/Draw.h"
+
+static inline int32 AlignUp(int32 value, int32 alignment)
+{
+	return (value+alignment-1)/alignment*alignment;
+}
+
+static inline int32 GetRegionSize(const StreamBuffer* self)
+{
+	return self->sizeInBytes/self->regionCount;
+}
+
+// fences the current region and waits until the gpu is done with the next one.
+static void NextRegion(StreamBuffer* self)
+{
+	DrawBackend* backend = Draw_GetBackend();
+	backend->streamBufferFence(self, self->region);
+	self->region = (self->region+1)%self->regionCount;
+	if (self->regionFences[self->region])
+	{
+		backend->streamBufferWait(self, self->region);
+	}
+	self->offset = self->region*GetRegionSize(self);
+}
+
+void StreamBuffer_Init(StreamBuffer* self, int32 sizeInBytes, int32 regionCount)
+{
+	if (regionCount < 1 || regionCount > StreamBuffer_MaxRegions)
+	{
+		ErrorF("regionCount must be between 1 and %d.", StreamBuffer_MaxRegions);
+	}
+
+	*self = (StreamBuffer){ 0 };
+	self->sizeInBytes = sizeInBytes;
+	self->regionCount = regionCount;
+	self->writeOffset = -1;
+
+	Draw_GetBackend()->streamBufferInit(self);
+}
+
+void StreamBuffer_Free(StreamBuffer* self)
+{
+	Draw_GetBackend()->streamBufferFree(self);
+}
+
+void* StreamBuffer_BeginWrite(StreamBuffer* self, int32 maxSize, int32 alignment, int32* outOffset)
+{
+#if CONFIG_DEBUG
+	if (self->writeOffset >= 0)
+	{
+		Error("stream buffer already has an open write.");
+	}
+	if (maxSize+alignment > GetRegionSize(self))
+	{
+		ErrorF("write of %d bytes doesn't fit in a %d byte region.", maxSize, GetRegionSize(self));
+	}
+#endif
+
+	int32 offset = AlignUp(self->offset, alignment);
+	if (self->persistentData)
+	{
+		int32 regionEnd = (self->region+1)*GetRegionSize(self);
+		if (offset+maxSize > regionEnd)
+		{
+			NextRegion(self);
+			offset = AlignUp(self->offset, alignment);
+		}
+	}
+	else if (offset+maxSize > self->sizeInBytes)
+	{
+		// the driver hands out new storage for the buffer and frees the old one once the gpu is done with it.
+		Draw_GetBackend()->streamBufferOrphan(self);
+		offset = 0;
+	}
+
+	self->writeOffset = offset;
+	self->writeMaxSize = maxSize;
+	*outOffset = offset;
+	if (self->persistentData)
+	{
+		return self->persistentData+offset;
+	}
+	return Draw_GetBackend()->streamBufferMap(self, offset, maxSize);
+}
+
+void StreamBuffer_EndWrite(StreamBuffer* self, int32 usedSize)
+{
+#if CONFIG_DEBUG
+	if (self->writeOffset < 0 || usedSize > self->writeMaxSize)
+	{
+		Error("stream buffer write was not started or overflowed.");
+	}
+#endif
+
+	if (!self->persistentData)
+	{
+		Draw_GetBackend()->streamBufferUnmap(self, usedSize);
+	}
+	self->offset = self->writeOffset+usedSize;
+	self->writeOffset = -1;
+}
+
+void StreamBuffer_EndFrame(StreamBuffer* self)
+{
+	// the orphaning fallback leaves synchronization to the driver.
+	if (self->persistentData && self->offset > self->region*GetRegionSize(self))
+	{
+		NextRegion(self);
+	}
+}
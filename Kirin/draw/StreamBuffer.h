@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common/Standard.h"
+
+// ring buffer for data written every frame, like immediate vertices. writes go straight into gpu visible memory.
+// with buffer storage the buffer stays mapped and is split into regions, each fenced when the ring moves past it
+// and waited on before it's written again. without it every write maps a fresh range and a full ring is orphaned instead.
+
+#define StreamBuffer_MaxRegions 4
+
+typedef struct StreamBuffer
+{
+	int32 internalHandle;
+	int32 sizeInBytes;
+	int32 regionCount;
+	// set by the backend when the buffer is persistently mapped. null for the orphaning fallback.
+	uint8* persistentData;
+	// backend fence objects of regions the gpu might still be reading, null otherwise.
+	void* regionFences[StreamBuffer_MaxRegions];
+	int32 region;
+	// where the next write can start.
+	int32 offset;
+	// the open write, -1 when there is none.
+	int32 writeOffset;
+	int32 writeMaxSize;
+} StreamBuffer;
+
+// regionCount is how many frames the gpu can be behind, 3 is the usual choice.
+void StreamBuffer_Init(StreamBuffer* self, int32 sizeInBytes, int32 regionCount);
+void StreamBuffer_Free(StreamBuffer* self);
+// returns memory for up to maxSize bytes and their offset in the buffer, which is a multiple of alignment.
+// maxSize must fit in a region. the memory is write only, it can be write combined.
+void* StreamBuffer_BeginWrite(StreamBuffer* self, int32 maxSize, int32 alignment, int32* outOffset);
+// the first usedSize bytes can be drawn from now, the rest goes back to the ring.
+void StreamBuffer_EndWrite(StreamBuffer* self, int32 usedSize);
+// lets the gpu have this frame's region and moves on to the next.
+void StreamBuffer_EndFrame(StreamBuffer* self);
@@ -15,6 +15,7 @@ void ConstantBufferGL_Init(ConstantBuffer* self, int64 size)
 
 void ConstantBufferGL_AttachToShader(ConstantBuffer* self, Shader* shader, ShaderConstantBuffer* constantBuffer)
 {
+	Unused(shader);
 	// we don't actually need to bind to a specific shader in opengl.
 	// just bind to the binding point that the shader uniform buffer is assigned to.
 	glBindBufferBase(GL_UNIFORM_BUFFER, constantBuffer->bindingPoint, self->internalHandle);
@@ -7,6 +7,8 @@
 #include "draw/gl/ShaderGL.h"
 #include "draw/gl/MeshGL.h"
 #include "draw/gl/ConstantBufferGL.h"
+#include "draw/gl/StreamBufferGL.h"
+#include "draw/gl/QueryGL.h"
 #include "draw/gl/TextureGL.h"
 #include "platform/gl/WindowBackendGL.h"
 
@@ -28,6 +30,11 @@ static void Free()
 
 }
 
+static void EndFrame()
+{
+
+}
+
 static bool LoadShader(const char* path, Shader* shader)
 {
 	char vertPath[MaxPathLength];
@@ -70,7 +77,7 @@ static void SetShader(Shader* shader)
 
 static void SetGeoType(DrawState* drawState)
 {
-
+	Unused(drawState);
 }
 
 static void SetPolygonFillMode(DrawState* drawState)
@@ -363,6 +370,7 @@ static void ClearStencil(int32 value)
 DrawBackend drawBackendGL = {
 	.init = Init,
 	.free = Free,
+	.endFrame = EndFrame,
 	.drawStateUpdate = DrawStateUpdate,
 	.setViewport = SetViewport,
 	.clearColor = ClearColor,
@@ -385,10 +393,29 @@ DrawBackend drawBackendGL = {
 	.vertexBufferInit = VertexBufferGL_Init,
 	.vertexBufferUpdateData = VertexBufferGL_UpdateData,
 	.vertexBufferFree = VertexBufferGL_Free,
+	.indexBufferInit = IndexBufferGL_Init,
+	.indexBufferUpdateData = IndexBufferGL_UpdateData,
+	.indexBufferFree = IndexBufferGL_Free,
+	.streamBufferInit = StreamBufferGL_Init,
+	.streamBufferFree = StreamBufferGL_Free,
+	.streamBufferFence = StreamBufferGL_Fence,
+	.streamBufferWait = StreamBufferGL_Wait,
+	.streamBufferOrphan = StreamBufferGL_Orphan,
+	.streamBufferMap = StreamBufferGL_Map,
+	.streamBufferUnmap = StreamBufferGL_Unmap,
 	.meshInit = MeshGL_Init,
 	.meshApplyStructure = MeshGL_ApplyStructure,
 	.meshDraw = MeshGL_Draw,
+	.meshDrawIndexed = MeshGL_DrawIndexed,
+	.meshDrawInstanced = MeshGL_DrawInstanced,
+	.meshDrawIndexedIndirect = MeshGL_DrawIndexedIndirect,
 	.meshFree = MeshGL_Free,
+	.queriesInit = QueryGL_Init,
+	.queriesFree = QueryGL_Free,
+	.queryTimestamp = QueryGL_Timestamp,
+	.queryBegin = QueryGL_Begin,
+	.queryEnd = QueryGL_End,
+	.queryGetResult = QueryGL_GetResult,
 };
 
 DrawBackend* DrawBackendGL_Get()
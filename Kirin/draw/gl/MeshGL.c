@@ -35,6 +35,38 @@ void VertexBufferGL_Free(VertexBuffer* self)
 	}
 }
 
+void IndexBufferGL_Init(IndexBuffer* self, VertexBufferUsage usage)
+{
+	static int32 usageToGLUsage[] = {
+		[VertexBufferUsage_Static] = GL_STATIC_DRAW,
+		[VertexBufferUsage_Dynamic] = GL_DYNAMIC_DRAW,
+	};
+
+	// GL_ELEMENT_ARRAY_BUFFER is part of the bound vertex array's state, so the data goes through GL_COPY_WRITE_BUFFER instead.
+	glGenBuffers(1, &self->internalHandle);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+	glBufferData(GL_COPY_WRITE_BUFFER, self->sizeInBytes, null, usageToGLUsage[usage]);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	CheckGLError();
+}
+
+void IndexBufferGL_UpdateData(IndexBuffer* self, int32 offset, int32 size, void* data)
+{
+	glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	CheckGLError();
+}
+
+void IndexBufferGL_Free(IndexBuffer* self)
+{
+	if (self->internalHandle)
+	{
+		glDeleteBuffers(1, &self->internalHandle);
+		self->internalHandle = 0;
+	}
+}
+
 void MeshGL_Init(Mesh* self)
 {
 	glGenVertexArrays(1, &self->internalHandle);
@@ -91,8 +123,16 @@ void MeshGL_ApplyStructure(Mesh* self)
 		// enable vertex attribute layout location.
 		glEnableVertexAttribArray(item->inputIndex);
 		CheckGLError();
+
+		// the divisor is vertex array state too, so it's set every time in case the item changed from per instance to per vertex.
+		glVertexAttribDivisor(item->inputIndex, item->instanceStepRate);
+		CheckGLError();
 	}
 
+	// the element array binding is stored in the vertex array, draws don't have to bind it again.
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, self->indexBuffer.internalHandle);
+	CheckGLError();
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 	CheckGLError();
@@ -112,6 +152,55 @@ void MeshGL_Draw(Mesh* self, int32 vertexOffset, int32 vertexCount)
 	CheckGLError();
 }
 
+static int32 IndexFormatToGLType(IndexFormat format)
+{
+	static int32 formatToGLType[] = {
+		[IndexFormat_U16] = GL_UNSIGNED_SHORT,
+		[IndexFormat_U32] = GL_UNSIGNED_INT,
+	};
+	static_assert(IndexFormat_Count == 3, "enum has changed.");
+	return formatToGLType[format];
+}
+
+void MeshGL_DrawIndexed(Mesh* self, int32 indexOffset, int32 indexCount, int32 baseVertex)
+{
+#if CONFIG_DEBUG
+	if (self->indexBuffer.internalHandle == 0)
+	{
+		Error("mesh has no index buffer.");
+	}
+#endif
+
+	glBindVertexArray(self->internalHandle);
+	CheckGLError();
+
+	int32 offset = indexOffset*IndexFormat_ToSize(self->indexBuffer.format);
+	glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, IndexFormatToGLType(self->indexBuffer.format), (void*)(size_t)offset, baseVertex);
+	CheckGLError();
+}
+
+void MeshGL_DrawInstanced(Mesh* self, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance)
+{
+	glBindVertexArray(self->internalHandle);
+	CheckGLError();
+
+	// base instance is core since gl 4.2, older contexts aren't created.
+	glDrawArraysInstancedBaseInstance(GL_TRIANGLES, vertexOffset, vertexCount, instanceCount, baseInstance);
+	CheckGLError();
+}
+
+void MeshGL_DrawIndexedIndirect(Mesh* self, int32 commandBuffer, int32 commandOffset, int32 commandCount)
+{
+	glBindVertexArray(self->internalHandle);
+	CheckGLError();
+
+	// multi draw indirect is core since gl 4.3, the oldest context the window creates.
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, IndexFormatToGLType(self->indexBuffer.format), (void*)(size_t)commandOffset, commandCount, sizeof(DrawIndexedIndirectCommand));
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	CheckGLError();
+}
+
 void MeshGL_Free(Mesh* self)
 {
 	if (self->internalHandle)
@@ -7,7 +7,14 @@ void VertexBufferGL_Init(VertexBuffer* self, VertexBufferUsage usage);
 void VertexBufferGL_UpdateData(VertexBuffer* self, int32 offset, int32 size, void* data);
 void VertexBufferGL_Free(VertexBuffer* self);
 
+void IndexBufferGL_Init(IndexBuffer* self, VertexBufferUsage usage);
+void IndexBufferGL_UpdateData(IndexBuffer* self, int32 offset, int32 size, void* data);
+void IndexBufferGL_Free(IndexBuffer* self);
+
 void MeshGL_Init(Mesh* mesh);
 void MeshGL_ApplyStructure(Mesh* mesh);
 void MeshGL_Draw(Mesh* self, int32 vertexOffset, int32 vertexCount);
+void MeshGL_DrawIndexed(Mesh* self, int32 indexOffset, int32 indexCount, int32 baseVertex);
+void MeshGL_DrawInstanced(Mesh* self, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance);
+void MeshGL_DrawIndexedIndirect(Mesh* self, int32 commandBuffer, int32 commandOffset, int32 commandCount);
 void MeshGL_Free(Mesh* mesh);
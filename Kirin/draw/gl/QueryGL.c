@@ -0,0 +1,61 @@
+#include "draw/gl/QueryGL.h"
+
+#include "draw/gl/CommonGL.h"
+
+#include "thirdparty/glad/glad.h"
+
+// timer queries are core in gl 3.3, the counting queries are older. mesa's software drivers have all of them.
+
+static GLenum GpuQueryTypeToGLTarget(GpuQueryType type)
+{
+	static GLenum typeToGLTarget[] = {
+		[GpuQueryType_PrimitivesGenerated] = GL_PRIMITIVES_GENERATED,
+		[GpuQueryType_SamplesPassed] = GL_SAMPLES_PASSED,
+	};
+	static_assert(GpuQueryType_Count == 3, "enum has changed.");
+	return typeToGLTarget[type];
+}
+
+void QueryGL_Init(uint32* queries, int32 count)
+{
+	glGenQueries(count, queries);
+	CheckGLError();
+}
+
+void QueryGL_Free(uint32* queries, int32 count)
+{
+	glDeleteQueries(count, queries);
+	MemSet(queries, 0, count*sizeof(uint32));
+	CheckGLError();
+}
+
+void QueryGL_Timestamp(uint32 query)
+{
+	glQueryCounter(query, GL_TIMESTAMP);
+	CheckGLError();
+}
+
+void QueryGL_Begin(uint32 query, GpuQueryType type)
+{
+	glBeginQuery(GpuQueryTypeToGLTarget(type), query);
+	CheckGLError();
+}
+
+void QueryGL_End(GpuQueryType type)
+{
+	glEndQuery(GpuQueryTypeToGLTarget(type));
+	CheckGLError();
+}
+
+bool QueryGL_GetResult(uint32 query, uint64* result)
+{
+	// asking for availability flushes, so a query that's asked about every frame comes in without anything else flushing.
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available)
+	{
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, result);
+	}
+	CheckGLError();
+	return available != GL_FALSE;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+void QueryGL_Init(uint32* queries, int32 count);
+void QueryGL_Free(uint32* queries, int32 count);
+void QueryGL_Timestamp(uint32 query);
+void QueryGL_Begin(uint32 query, GpuQueryType type);
+void QueryGL_End(GpuQueryType type);
+bool QueryGL_GetResult(uint32 query, uint64* result);
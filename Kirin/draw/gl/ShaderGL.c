@@ -2,6 +2,7 @@
 
 #include "common/File.h"
 #include "common/CString.h"
+#include "common/Log.h"
 #include "draw/gl/CommonGL.h"
 #include "draw/gl/DrawBackendGL.h"
 #include "draw/gl/TextureGL.h"
@@ -107,7 +108,7 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 {
 	// Compile vertex shader
 
-	PrintF("    compiling vertex shader \"%s\"\n", vertName);
+	LogF(LogLevel_Debug, LogCategory_Draw, "    compiling vertex shader \"%s\"\n", vertName);
 	GLuint vertShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertShader, 1, &vertStr, NULL);
 	glCompileShader(vertShader);
@@ -122,7 +123,7 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 
 	// Compile fragment shader
 
-	PrintF("    compiling fragment shader \"%s\"\n", fragName);
+	LogF(LogLevel_Debug, LogCategory_Draw, "    compiling fragment shader \"%s\"\n", fragName);
 	GLuint fragShader = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragShader, 1, &fragStr, NULL);
 	glCompileShader(fragShader);
@@ -157,7 +158,7 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 	shader->program = program;
 
 	{
-		PrintF("    attributes:\n");
+		LogF(LogLevel_Debug, LogCategory_Draw, "    attributes:\n");
 
 		int32 attributeCount;
 		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attributeCount);
@@ -188,13 +189,13 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 			attribute.location = glGetAttribLocation(program, attribute.name);
 			CheckGLError();
 
-			PrintF("        layout(location = %d) attribute (%d) %s;\n", attribute.location, attribute.type, attribute.name);
+			LogF(LogLevel_Debug, LogCategory_Draw, "        layout(location = %d) attribute (%d) %s;\n", attribute.location, attribute.type, attribute.name);
 
 			shader->attributes[shader->attributeCount] = attribute;
 			shader->attributeCount++;
 		}
 
-		PrintF("    uniforms:\n");
+		LogF(LogLevel_Debug, LogCategory_Draw, "    uniforms:\n");
 
 		int32 uniformCount;
 		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
@@ -233,11 +234,11 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 
 			if (uniform.isArray)
 			{
-				PrintF("        layout(location = %d) uniform (%d) %s[%d];\n", uniform.location, uniform.type, uniform.name, uniform.arrayCount);
+				LogF(LogLevel_Debug, LogCategory_Draw, "        layout(location = %d) uniform (%d) %s[%d];\n", uniform.location, uniform.type, uniform.name, uniform.arrayCount);
 			}
 			else
 			{
-				PrintF("        layout(location = %d) uniform (%d) %s;\n", uniform.location, uniform.type, uniform.name);
+				LogF(LogLevel_Debug, LogCategory_Draw, "        layout(location = %d) uniform (%d) %s;\n", uniform.location, uniform.type, uniform.name);
 			}
 			
 
@@ -245,7 +246,7 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 			shader->uniformCount++;
 		}
 
-		PrintF("    uniform buffers:\n");
+		LogF(LogLevel_Debug, LogCategory_Draw, "    uniform buffers:\n");
 
 		int32 uniformBufferCount;
 		glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &uniformBufferCount);
@@ -278,7 +279,7 @@ bool ShaderGL_Compile(const char* vertStr, const char* fragStr, const char* vert
 			glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_BINDING, &constantBuffer.bindingPoint);
 			CheckGLError();
 
-			PrintF("        layout(binding = %d) uniform buffer %s;\n", constantBuffer.bindingPoint, constantBuffer.name);
+			LogF(LogLevel_Debug, LogCategory_Draw, "        layout(binding = %d) uniform buffer %s;\n", constantBuffer.bindingPoint, constantBuffer.name);
 
 			shader->constantBuffers[shader->constantBufferCount] = constantBuffer;
 			shader->constantBufferCount++;
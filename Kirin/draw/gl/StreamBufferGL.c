@@ -0,0 +1,113 @@
+#include "draw/gl/StreamBufferGL.h"
+
+#include "draw/gl/CommonGL.h"
+#include "platform/gl/WindowBackendGL.h"
+
+#include "thirdparty/glad/glad.h"
+
+// the buffer is only ever bound to GL_COPY_WRITE_BUFFER here, GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER belong to the vertex arrays.
+
+void StreamBufferGL_Init(StreamBuffer* self)
+{
+	glGenBuffers(1, &self->internalHandle);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+	// buffer storage is core in gl 4.4.
+	if (WindowBackendGL_CompareGLVersion(4, 4) <= 0 && glBufferStorage)
+	{
+		// coherent, so writes are visible to draws issued after them without flushing.
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, self->sizeInBytes, null, flags);
+		self->persistentData = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, self->sizeInBytes, flags);
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, self->sizeInBytes, null, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	CheckGLError();
+}
+
+void StreamBufferGL_Free(StreamBuffer* self)
+{
+	for (int32 i = 0; i < self->regionCount; i++)
+	{
+		if (self->regionFences[i])
+		{
+			glDeleteSync(self->regionFences[i]);
+			self->regionFences[i] = null;
+		}
+	}
+	if (self->internalHandle)
+	{
+		if (self->persistentData)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			self->persistentData = null;
+		}
+		glDeleteBuffers(1, &self->internalHandle);
+		self->internalHandle = 0;
+	}
+	CheckGLError();
+}
+
+void StreamBufferGL_Fence(StreamBuffer* self, int32 region)
+{
+	if (self->regionFences[region])
+	{
+		glDeleteSync(self->regionFences[region]);
+	}
+	self->regionFences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	CheckGLError();
+}
+
+void StreamBufferGL_Wait(StreamBuffer* self, int32 region)
+{
+	GLsync fence = self->regionFences[region];
+	// the first wait flushes the fence to the gpu, later ones only poll.
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	for (;;)
+	{
+		GLenum result = glClientWaitSync(fence, flags, 1000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+		{
+			break;
+		}
+		flags = 0;
+	}
+	glDeleteSync(fence);
+	self->regionFences[region] = null;
+	CheckGLError();
+}
+
+void StreamBufferGL_Orphan(StreamBuffer* self)
+{
+	glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+	glBufferData(GL_COPY_WRITE_BUFFER, self->sizeInBytes, null, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	CheckGLError();
+}
+
+void* StreamBufferGL_Map(StreamBuffer* self, int32 offset, int32 size)
+{
+	// nothing the gpu still reads lies past the write position since the last orphan, so the range needs no synchronization.
+	glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+	void* data = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	CheckGLError();
+	return data;
+}
+
+void StreamBufferGL_Unmap(StreamBuffer* self, int32 usedSize)
+{
+	glBindBuffer(GL_COPY_WRITE_BUFFER, self->internalHandle);
+	if (usedSize > 0)
+	{
+		glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, usedSize);
+	}
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	CheckGLError();
+}
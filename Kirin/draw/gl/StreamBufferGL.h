@@ -0,0 +1,12 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/StreamBuffer.h"
+
+void StreamBufferGL_Init(StreamBuffer* self);
+void StreamBufferGL_Free(StreamBuffer* self);
+void StreamBufferGL_Fence(StreamBuffer* self, int32 region);
+void StreamBufferGL_Wait(StreamBuffer* self, int32 region);
+void StreamBufferGL_Orphan(StreamBuffer* self);
+void* StreamBufferGL_Map(StreamBuffer* self, int32 offset, int32 size);
+void StreamBufferGL_Unmap(StreamBuffer* self, int32 usedSize);
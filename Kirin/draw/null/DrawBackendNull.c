@@ -0,0 +1,427 @@
+#include "draw/null/DrawBackendNull.h"
+
+DrawBackendNullCounters gDrawBackendNullCounters;
+
+// handles are never reused, and unique across object types.
+static int32 lastHandle;
+
+static int32 NewHandle()
+{
+	return ++lastHandle;
+}
+
+static void CountCall(DrawBackendCall call)
+{
+	gDrawBackendNullCounters.calls[call]++;
+}
+
+static void Init()
+{
+	CountCall(DrawBackendCall_Init);
+}
+
+static void Free()
+{
+	CountCall(DrawBackendCall_Free);
+}
+
+static void EndFrame()
+{
+	CountCall(DrawBackendCall_EndFrame);
+}
+
+static void VertexBufferInit(VertexBuffer* vertexBuffer, VertexBufferUsage usage)
+{
+	Unused(usage);
+	CountCall(DrawBackendCall_VertexBufferInit);
+	vertexBuffer->internalHandle = NewHandle();
+}
+
+static void VertexBufferUpdateData(VertexBuffer* vertexBuffer, int32 offset, int32 size, void* data)
+{
+	Unused(vertexBuffer);
+	Unused(offset);
+	Unused(data);
+	CountCall(DrawBackendCall_VertexBufferUpdateData);
+	gDrawBackendNullCounters.bytesUploaded += size;
+}
+
+static void VertexBufferFree(VertexBuffer* vertexBuffer)
+{
+	CountCall(DrawBackendCall_VertexBufferFree);
+	vertexBuffer->internalHandle = 0;
+}
+
+static void IndexBufferInit(IndexBuffer* indexBuffer, VertexBufferUsage usage)
+{
+	Unused(usage);
+	CountCall(DrawBackendCall_IndexBufferInit);
+	indexBuffer->internalHandle = NewHandle();
+}
+
+static void IndexBufferUpdateData(IndexBuffer* indexBuffer, int32 offset, int32 size, void* data)
+{
+	Unused(indexBuffer);
+	Unused(offset);
+	Unused(data);
+	CountCall(DrawBackendCall_IndexBufferUpdateData);
+	gDrawBackendNullCounters.bytesUploaded += size;
+}
+
+static void IndexBufferFree(IndexBuffer* indexBuffer)
+{
+	CountCall(DrawBackendCall_IndexBufferFree);
+	indexBuffer->internalHandle = 0;
+}
+
+static void StreamBufferInit(StreamBuffer* streamBuffer)
+{
+	CountCall(DrawBackendCall_StreamBufferInit);
+	streamBuffer->internalHandle = NewHandle();
+	streamBuffer->persistentData = MAlloc(streamBuffer->sizeInBytes);
+}
+
+static void StreamBufferFree(StreamBuffer* streamBuffer)
+{
+	CountCall(DrawBackendCall_StreamBufferFree);
+	MFree(streamBuffer->persistentData);
+	streamBuffer->persistentData = null;
+	streamBuffer->internalHandle = 0;
+}
+
+static void StreamBufferFence(StreamBuffer* streamBuffer, int32 region)
+{
+	CountCall(DrawBackendCall_StreamBufferFence);
+	// any non null value marks the region as fenced, there's nothing to wait for.
+	streamBuffer->regionFences[region] = streamBuffer;
+}
+
+static void StreamBufferWait(StreamBuffer* streamBuffer, int32 region)
+{
+	CountCall(DrawBackendCall_StreamBufferWait);
+	streamBuffer->regionFences[region] = null;
+}
+
+static void StreamBufferOrphan(StreamBuffer* streamBuffer)
+{
+	Unused(streamBuffer);
+	CountCall(DrawBackendCall_StreamBufferOrphan);
+}
+
+static void* StreamBufferMap(StreamBuffer* streamBuffer, int32 offset, int32 size)
+{
+	Unused(size);
+	CountCall(DrawBackendCall_StreamBufferMap);
+	return streamBuffer->persistentData+offset;
+}
+
+static void StreamBufferUnmap(StreamBuffer* streamBuffer, int32 usedSize)
+{
+	Unused(streamBuffer);
+	Unused(usedSize);
+	CountCall(DrawBackendCall_StreamBufferUnmap);
+}
+
+static void DrawStateUpdate(DrawState* previousState, DrawState* state, bool forceUpdate)
+{
+	Unused(forceUpdate);
+	CountCall(DrawBackendCall_DrawStateUpdate);
+	*previousState = *state;
+}
+
+static void SetViewport(int32 x, int32 y, int32 width, int32 height)
+{
+	Unused(x);
+	Unused(y);
+	Unused(width);
+	Unused(height);
+	CountCall(DrawBackendCall_SetViewport);
+}
+
+static void ClearColor(float r, float g, float b, float a)
+{
+	Unused(r);
+	Unused(g);
+	Unused(b);
+	Unused(a);
+	CountCall(DrawBackendCall_ClearColor);
+}
+
+static void ClearDepth(float value)
+{
+	Unused(value);
+	CountCall(DrawBackendCall_ClearDepth);
+}
+
+static void ClearStencil(int32 value)
+{
+	Unused(value);
+	CountCall(DrawBackendCall_ClearStencil);
+}
+
+static bool ShaderLoad(const char* path, Shader* shader)
+{
+	Unused(path);
+	CountCall(DrawBackendCall_ShaderLoad);
+	shader->program = NewHandle();
+	return true;
+}
+
+static void ShaderFree(Shader* shader)
+{
+	CountCall(DrawBackendCall_ShaderFree);
+	shader->program = 0;
+}
+
+static void ShaderSet(Shader* shader)
+{
+	Unused(shader);
+	CountCall(DrawBackendCall_ShaderSet);
+}
+
+static void ShaderSetUniformInt(Shader* self, ShaderUniform* uniform, int32 arrayIndex, int32 value)
+{
+	Unused(self);
+	Unused(uniform);
+	Unused(arrayIndex);
+	Unused(value);
+	CountCall(DrawBackendCall_ShaderSetUniformInt);
+}
+
+static void ShaderSetUniformFloat(Shader* self, ShaderUniform* uniform, int32 arrayIndex, float value)
+{
+	Unused(self);
+	Unused(uniform);
+	Unused(arrayIndex);
+	Unused(value);
+	CountCall(DrawBackendCall_ShaderSetUniformFloat);
+}
+
+static void ShaderSetUniformTexture(Shader* self, ShaderUniform* uniform, int32 arrayIndex, Texture* value)
+{
+	Unused(self);
+	Unused(uniform);
+	Unused(arrayIndex);
+	Unused(value);
+	CountCall(DrawBackendCall_ShaderSetUniformTexture);
+}
+
+static void ConstantBufferInit(ConstantBuffer* self, int64 size)
+{
+	Unused(size);
+	CountCall(DrawBackendCall_ConstantBufferInit);
+	self->internalHandle = NewHandle();
+}
+
+static void ConstantBufferAttachToShader(ConstantBuffer* self, Shader* shader, ShaderConstantBuffer* constantBuffer)
+{
+	Unused(self);
+	Unused(shader);
+	Unused(constantBuffer);
+	CountCall(DrawBackendCall_ConstantBufferAttachToShader);
+}
+
+static void ConstantBufferSetData(ConstantBuffer* self, int64 offset, int64 length, void* data)
+{
+	Unused(self);
+	Unused(offset);
+	Unused(data);
+	CountCall(DrawBackendCall_ConstantBufferSetData);
+	gDrawBackendNullCounters.bytesUploaded += length;
+}
+
+static void ConstantBufferFree(ConstantBuffer* self)
+{
+	CountCall(DrawBackendCall_ConstantBufferFree);
+	self->internalHandle = 0;
+}
+
+static void TextureInit(Texture* self, TextureInitSettings* initSettings)
+{
+	CountCall(DrawBackendCall_TextureInit);
+	self->type = initSettings->type;
+	self->format = initSettings->format;
+	self->wrapMode = initSettings->wrapMode;
+	self->filterMode = initSettings->filterMode;
+	self->mipFilterMode = initSettings->mipFilterMode;
+	self->anisotropy = initSettings->anisotropy;
+	self->width = initSettings->width;
+	self->height = initSettings->height;
+	self->depth = initSettings->depth;
+	self->internalHandle[0] = NewHandle();
+}
+
+static void TextureFree(Texture* self)
+{
+	CountCall(DrawBackendCall_TextureFree);
+	self->internalHandle[0] = 0;
+}
+
+static void TextureSetData(Texture* self, int32 x, int32 y, int32 width, int32 height, void* data)
+{
+	Unused(x);
+	Unused(y);
+	Unused(data);
+	CountCall(DrawBackendCall_TextureSetData);
+	width = width >= 0 ? width : self->width;
+	height = height >= 0 ? height : self->height;
+	gDrawBackendNullCounters.bytesUploaded += (uint64)width*height*(self->format == TextureFormat_RGB8 ? 3 : 4);
+}
+
+static void GenerateMipmaps(Texture* self)
+{
+	CountCall(DrawBackendCall_GenerateMipmaps);
+	self->hasMipmaps = true;
+}
+
+static void MeshInit(Mesh* mesh)
+{
+	CountCall(DrawBackendCall_MeshInit);
+	mesh->internalHandle = NewHandle();
+}
+
+static void MeshApplyStructure(Mesh* mesh)
+{
+	Unused(mesh);
+	CountCall(DrawBackendCall_MeshApplyStructure);
+}
+
+static void MeshDraw(Mesh* mesh, int32 vertexOffset, int32 vertexCount)
+{
+	Unused(mesh);
+	Unused(vertexOffset);
+	Unused(vertexCount);
+	CountCall(DrawBackendCall_MeshDraw);
+}
+
+static void MeshDrawIndexed(Mesh* mesh, int32 indexOffset, int32 indexCount, int32 baseVertex)
+{
+	Unused(mesh);
+	Unused(indexOffset);
+	Unused(indexCount);
+	Unused(baseVertex);
+	CountCall(DrawBackendCall_MeshDrawIndexed);
+}
+
+static void MeshDrawInstanced(Mesh* mesh, int32 vertexOffset, int32 vertexCount, int32 instanceCount, int32 baseInstance)
+{
+	Unused(mesh);
+	Unused(vertexOffset);
+	Unused(vertexCount);
+	Unused(instanceCount);
+	Unused(baseInstance);
+	CountCall(DrawBackendCall_MeshDrawInstanced);
+}
+
+static void MeshDrawIndexedIndirect(Mesh* mesh, int32 commandBuffer, int32 commandOffset, int32 commandCount)
+{
+	Unused(mesh);
+	Unused(commandBuffer);
+	Unused(commandOffset);
+	Unused(commandCount);
+	CountCall(DrawBackendCall_MeshDrawIndexedIndirect);
+}
+
+static void MeshFree(Mesh* mesh)
+{
+	CountCall(DrawBackendCall_MeshFree);
+	mesh->internalHandle = 0;
+}
+
+static void QueriesInit(uint32* queries, int32 count)
+{
+	CountCall(DrawBackendCall_QueriesInit);
+	for (int32 i = 0; i < count; i++)
+	{
+		queries[i] = NewHandle();
+	}
+}
+
+static void QueriesFree(uint32* queries, int32 count)
+{
+	CountCall(DrawBackendCall_QueriesFree);
+	MemSet(queries, 0, count*sizeof(uint32));
+}
+
+static void QueryTimestamp(uint32 query)
+{
+	Unused(query);
+	CountCall(DrawBackendCall_QueryTimestamp);
+}
+
+static void QueryBegin(uint32 query, GpuQueryType type)
+{
+	Unused(query);
+	Unused(type);
+	CountCall(DrawBackendCall_QueryBegin);
+}
+
+static void QueryEnd(GpuQueryType type)
+{
+	Unused(type);
+	CountCall(DrawBackendCall_QueryEnd);
+}
+
+static bool QueryGetResult(uint32 query, uint64* result)
+{
+	Unused(query);
+	CountCall(DrawBackendCall_QueryGetResult);
+	*result = 0;
+	return true;
+}
+
+DrawBackend drawBackendNull = {
+	.init = Init,
+	.free = Free,
+	.endFrame = EndFrame,
+	.vertexBufferInit = VertexBufferInit,
+	.vertexBufferUpdateData = VertexBufferUpdateData,
+	.vertexBufferFree = VertexBufferFree,
+	.indexBufferInit = IndexBufferInit,
+	.indexBufferUpdateData = IndexBufferUpdateData,
+	.indexBufferFree = IndexBufferFree,
+	.streamBufferInit = StreamBufferInit,
+	.streamBufferFree = StreamBufferFree,
+	.streamBufferFence = StreamBufferFence,
+	.streamBufferWait = StreamBufferWait,
+	.streamBufferOrphan = StreamBufferOrphan,
+	.streamBufferMap = StreamBufferMap,
+	.streamBufferUnmap = StreamBufferUnmap,
+	.drawStateUpdate = DrawStateUpdate,
+	.setViewport = SetViewport,
+	.clearColor = ClearColor,
+	.clearDepth = ClearDepth,
+	.clearStencil = ClearStencil,
+	.shaderLoad = ShaderLoad,
+	.shaderFree = ShaderFree,
+	.shaderSet = ShaderSet,
+	.shaderSetUniformInt = ShaderSetUniformInt,
+	.shaderSetUniformFloat = ShaderSetUniformFloat,
+	.shaderSetUniformTexture = ShaderSetUniformTexture,
+	.constantBufferInit = ConstantBufferInit,
+	.constantBufferAttachToShader = ConstantBufferAttachToShader,
+	.constantBufferSetData = ConstantBufferSetData,
+	.constantBufferFree = ConstantBufferFree,
+	.textureInit = TextureInit,
+	.textureFree = TextureFree,
+	.textureSetData = TextureSetData,
+	.generateMipmaps = GenerateMipmaps,
+	.meshInit = MeshInit,
+	.meshApplyStructure = MeshApplyStructure,
+	.meshDraw = MeshDraw,
+	.meshDrawIndexed = MeshDrawIndexed,
+	.meshDrawInstanced = MeshDrawInstanced,
+	.meshDrawIndexedIndirect = MeshDrawIndexedIndirect,
+	.meshFree = MeshFree,
+	.queriesInit = QueriesInit,
+	.queriesFree = QueriesFree,
+	.queryTimestamp = QueryTimestamp,
+	.queryBegin = QueryBegin,
+	.queryEnd = QueryEnd,
+	.queryGetResult = QueryGetResult,
+};
+
+DrawBackend* DrawBackendNull_Get()
+{
+	return &drawBackendNull;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "draw/DrawBackend.h"
+
+// a backend that needs no window or gpu. every entry only counts its call, so what's left of a frame's time is the
+// cpu cost of Draw_* and everything above it. objects get unique handles and stream buffers are plain memory that
+// stays mapped, which keeps Draw on the same path it takes with gl 4.4.
+// shaders load without reading their files and have no attributes or uniforms, query results are all 0.
+
+typedef struct DrawBackendNullCounters
+{
+	// indexed by DrawBackendCall.
+	uint64 calls[DrawBackendCall_Count];
+	// bytes passed to vertex, index, constant buffer and texture updates.
+	uint64 bytesUploaded;
+} DrawBackendNullCounters;
+extern DrawBackendNullCounters gDrawBackendNullCounters;
+
+DrawBackend* DrawBackendNull_Get();
@@ -0,0 +1,131 @@
+#include "platform/RenderThread.h"
+
+#include "common/Time.h"
+#include "draw/Draw.h"
+#include "platform/Window.h"
+
+static void RenderThread_Run(void* userData)
+{
+	RenderThread* self = userData;
+	Window_SetDeviceCurrent(self->window, true);
+	Draw_BindToCurrentThread();
+
+	for (;;)
+	{
+		Semaphore_Wait(&self->work);
+
+		// each count of work is one frame, one call or the stop request. frames go first, so a call runs after every frame
+		// submitted before it and can free what those frames draw.
+		uint32 presented = self->presentedFrames;
+		if (presented != Atomic_LoadAcquire32(&self->submittedFrames))
+		{
+			int32 frame = presented%self->frameCount;
+			CommandList_Execute(&self->frames[frame], 1);
+			Window_Present(self->window);
+			self->lastLatencyTicks = GetTicks()-self->frameBeginTicks[frame];
+			Atomic_StoreRelease32(&self->presentedFrames, presented+1);
+			Semaphore_Signal(&self->freeFrames);
+		}
+		else if (self->callFunction)
+		{
+			self->callFunction(self->callUserData);
+			self->callFunction = null;
+			Semaphore_Signal(&self->callDone);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	Window_SetDeviceCurrent(self->window, false);
+}
+
+void RenderThread_Init(RenderThread* self, Window* window, int32 frameCount)
+{
+	if (frameCount < 2 || frameCount > RenderThread_MaxFrames)
+	{
+		ErrorF("frameCount must be between 2 and %d.", RenderThread_MaxFrames);
+	}
+
+	*self = (RenderThread){ 0 };
+	self->window = window;
+	self->frameCount = frameCount;
+	for (int32 i = 0; i < frameCount; i++)
+	{
+		CommandList_Init(&self->frames[i]);
+		Semaphore_Signal(&self->freeFrames);
+	}
+
+	Window_SetDeviceCurrent(window, false);
+	Thread_Start(&self->thread, RenderThread_Run, self);
+}
+
+void RenderThread_Free(RenderThread* self)
+{
+	if (self->recording)
+	{
+		RenderThread_EndFrame(self);
+	}
+	// a count of work without a call or frame behind it stops the thread once it's through the queue.
+	Semaphore_Signal(&self->work);
+	Thread_Join(&self->thread);
+
+	Window_SetDeviceCurrent(self->window, true);
+	Draw_BindToCurrentThread();
+
+	for (int32 i = 0; i < self->frameCount; i++)
+	{
+		CommandList_Free(&self->frames[i]);
+	}
+	Semaphore_Free(&self->freeFrames);
+	Semaphore_Free(&self->work);
+	Semaphore_Free(&self->callDone);
+	Mutex_Free(&self->callMutex);
+}
+
+CommandList* RenderThread_BeginFrame(RenderThread* self)
+{
+#if CONFIG_DEBUG
+	if (self->recording)
+	{
+		Error("RenderThread_BeginFrame called twice without RenderThread_EndFrame.");
+	}
+#endif
+
+	Semaphore_Wait(&self->freeFrames);
+	self->recording = true;
+	int32 frame = self->submittedFrames%self->frameCount;
+	self->frameBeginTicks[frame] = GetTicks();
+	return &self->frames[frame];
+}
+
+void RenderThread_EndFrame(RenderThread* self)
+{
+#if CONFIG_DEBUG
+	if (!self->recording)
+	{
+		Error("RenderThread_EndFrame called without RenderThread_BeginFrame.");
+	}
+#endif
+
+	self->recording = false;
+	Atomic_StoreRelease32(&self->submittedFrames, self->submittedFrames+1);
+	Semaphore_Signal(&self->work);
+}
+
+void RenderThread_Call(RenderThread* self, RenderThreadFunction function, void* userData)
+{
+	// one call at a time, from any thread.
+	Mutex_Lock(&self->callMutex);
+	self->callFunction = function;
+	self->callUserData = userData;
+	Semaphore_Signal(&self->work);
+	Semaphore_Wait(&self->callDone);
+	Mutex_Unlock(&self->callMutex);
+}
+
+uint64 RenderThread_GetLastLatencyTicks(RenderThread* self)
+{
+	return self->lastLatencyTicks;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Thread.h"
+#include "draw/CommandList.h"
+
+struct Window;
+
+// optional thread that owns the window's device and does all backend work, so driver calls and blocking presents
+// overlap with the next frame's game logic. the game thread records each frame into a CommandList and hands it over.
+// frames are double or triple buffered, RenderThread_BeginFrame waits while every one is still queued or being drawn.
+//
+// once the render thread runs, Draw_*, Mesh_*, Texture_* and Shader_* calls that reach the backend must happen on it:
+// recorded with CommandList_Call to run in frame order, or through RenderThread_Call when the result is needed right away.
+
+#define RenderThread_MaxFrames 3
+
+typedef void (*RenderThreadFunction)(void* userData);
+
+typedef struct RenderThread
+{
+	Thread thread;
+	struct Window* window;
+	int32 frameCount;
+	CommandList frames[RenderThread_MaxFrames];
+	// when each frame's recording started, for latency.
+	uint64 frameBeginTicks[RenderThread_MaxFrames];
+	// frames handed over by the game thread and frames the render thread presented.
+	volatile uint32 submittedFrames;
+	volatile uint32 presentedFrames;
+	// one count per frame the game thread can record into.
+	Semaphore freeFrames;
+	// one count per submitted frame, call and the request to stop.
+	Semaphore work;
+	bool recording;
+
+	Mutex callMutex;
+	RenderThreadFunction callFunction;
+	void* callUserData;
+	Semaphore callDone;
+
+	// from the start of recording a frame to the end of its present, written by the render thread.
+	volatile uint64 lastLatencyTicks;
+} RenderThread;
+
+// Draw_Init must have run. moves the window's device and Draw to a new thread. frameCount is 2 or 3.
+void RenderThread_Init(RenderThread* self, struct Window* window, int32 frameCount);
+// draws everything submitted, stops the thread and moves the device and Draw back to the calling thread.
+void RenderThread_Free(RenderThread* self);
+// returns the list to record the next frame into, waiting if all frames are in flight.
+CommandList* RenderThread_BeginFrame(RenderThread* self);
+// hands the recorded frame to the render thread, which executes it and presents the window.
+void RenderThread_EndFrame(RenderThread* self);
+// runs function on the render thread and waits for it, after the frames submitted so far.
+void RenderThread_Call(RenderThread* self, RenderThreadFunction function, void* userData);
+uint64 RenderThread_GetLastLatencyTicks(RenderThread* self);
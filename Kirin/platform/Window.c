@@ -1,5 +1,10 @@
 #include "platform/Window.h"
 
+#include "common/Log.h"
+#include "common/Time.h"
+#include "draw/Draw.h"
+#include "draw/FrameStats.h"
+#include "draw/GpuProfiler.h"
 #include "platform/SDL2Input.h"
 
 // currently SDL specific but should be abstracted later.
@@ -43,7 +48,7 @@ void Window_Init(Window* self, WindowBackend* backend, const char* title, int32
 			{
 				return;
 			}
-			PrintF("mode %d: %dx%d @%dhz\n", i, mode.w, mode.h, mode.refresh_rate);
+			LogF(LogLevel_Info, LogCategory_Platform, "mode %d: %dx%d @%dhz\n", i, mode.w, mode.h, mode.refresh_rate);
 		}
 	}
 #endif
@@ -82,7 +87,29 @@ void Window_Free(Window* self)
 
 void Window_Present(Window* self)
 {
+	if (Draw_GetBackend())
+	{
+		Draw_EndFrame();
+	}
+	if (self->gpuProfiler)
+	{
+		GpuProfiler_EndFrame(self->gpuProfiler, self->frameStats);
+	}
+	uint64 presentStartTicks = self->frameStats ? GetTicks() : 0;
 	self->backend->present(self);
+	if (self->frameStats)
+	{
+		FrameStats_OnPresent(self->frameStats, presentStartTicks, GetTicks());
+	}
+	if (self->gpuProfiler)
+	{
+		GpuProfiler_BeginFrame(self->gpuProfiler, self->frameStats);
+	}
+}
+
+void Window_SetDeviceCurrent(Window* self, bool current)
+{
+	self->backend->setDeviceCurrent(self, current);
 }
 
 void Window_ProcessEvents(Window* self, InputState* inputState)
@@ -116,7 +143,7 @@ void Window_ProcessEvents(Window* self, InputState* inputState)
 			case SDL_WINDOWEVENT_SIZE_CHANGED:
 			{
 				IVec2 pixelSize = Window_GetSizeInPixels(self);
-				PrintF("window size changed: %dx%d (%dx%d)\n", event.window.data1, event.window.data2, pixelSize.x, pixelSize.y);
+				LogF(LogLevel_Info, LogCategory_Platform, "window size changed: %dx%d (%dx%d)\n", event.window.data1, event.window.data2, pixelSize.x, pixelSize.y);
 				if (Window_GetWindowMode(self) == WindowMode_Window)
 				{
 					IVec2 windowSize = Window_GetSizeInScreenUnits(self);
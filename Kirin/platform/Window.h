@@ -59,12 +59,18 @@ typedef struct Window
 	void* internalHandle;
 	void* nativeHandle;
 	void* nativeDevice;
+	// optional. fed with present timestamps every Window_Present.
+	struct FrameStats* frameStats;
+	// optional. its frames end and begin around every present.
+	struct GpuProfiler* gpuProfiler;
 } Window;
 extern Window gWindow;
 
 void Window_Init(Window* self, WindowBackend* backend, const char* title, int32 width, int32 height);
 void Window_Free(Window* self);
 void Window_Present(Window* self);
+// the device is current on the thread that called Window_Init. release it there before making it current on another thread.
+void Window_SetDeviceCurrent(Window* self, bool current);
 void Window_ProcessEvents(Window* self, InputState* inputState);
 VSyncMode Window_GetVSyncMode(Window* self);
 void Window_SetVSyncMode(Window* self, VSyncMode value);
@@ -2,6 +2,8 @@
 
 #include "common/Standard.h"
 
+struct Window;
+
 typedef struct WindowBackend
 {
 	void (*init)(struct Window* window);
@@ -9,4 +11,6 @@ typedef struct WindowBackend
 	void (*createDevice)(struct Window* window);
 	void (*present)(struct Window* window);
 	void (*vsyncModeChanged)(struct Window* window);
+	// binds the device to the calling thread, or releases it from the calling thread.
+	void (*setDeviceCurrent)(struct Window* window, bool current);
 } WindowBackend;
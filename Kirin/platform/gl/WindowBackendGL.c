@@ -180,12 +180,23 @@ static void VSyncModeChanged(Window* window)
 	// vsync gets applied in Present now.
 }
 
+static void SetDeviceCurrent(Window* window, bool current)
+{
+	SDL_Window* sdlWindow = (SDL_Window*)window->internalHandle;
+	// a gl context can only be current on one thread at a time.
+	if (SDL_GL_MakeCurrent(sdlWindow, current ? (SDL_GLContext)window->nativeDevice : null) != 0)
+	{
+		ErrorF("failed to change the current OpenGL context: %s", SDL_GetError());
+	}
+}
+
 WindowBackend windowBackendGL = {
 	.init = Init,
 	.updateWindowFlags = UpdateWindowFlags,
 	.createDevice = CreateDevice,
 	.present = Present,
 	.vsyncModeChanged = VSyncModeChanged,
+	.setDeviceCurrent = SetDeviceCurrent,
 };
 
 WindowBackend* WindowBackendGL_Get()
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// each benchmark is its own executable that prints one line per measurement. they're built with the tests but ctest
+// doesn't run them, the bench target does. a run is timed a few times and the fastest one is reported, it's the one
+// least disturbed by whatever else the machine was doing.
+
+// results are accumulated here so the optimizer can't drop the work being timed.
+static volatile uint64 gBenchSink;
+
+typedef struct BenchTimer
+{
+	double* bestNanoseconds;
+	int32 remaining;
+	bool started;
+	uint64 startCycles;
+} BenchTimer;
+
+static inline BenchTimer Bench_Begin(double* bestNanoseconds, int32 repetitions)
+{
+	*bestNanoseconds = 1e300;
+	return (BenchTimer){ .bestNanoseconds = bestNanoseconds, .remaining = repetitions };
+}
+
+static inline bool Bench_Next(BenchTimer* self)
+{
+	uint64 endCycles = GetCycles();
+	if (self->started)
+	{
+		double nanoseconds = (double)(endCycles-self->startCycles)*1e9/(double)GetCycleFrequency();
+		if (nanoseconds < *self->bestNanoseconds)
+		{
+			*self->bestNanoseconds = nanoseconds;
+		}
+	}
+	if (self->remaining-- <= 0)
+	{
+		return false;
+	}
+	self->started = true;
+	self->startCycles = GetCycles();
+	return true;
+}
+
+// runs the statement that follows repetitions times, bestNanoseconds gets the fastest run.
+#define Bench_Repeat(bestNanoseconds, repetitions) for (BenchTimer benchTimer = Bench_Begin(&(bestNanoseconds), repetitions); Bench_Next(&benchTimer);)
+
+static inline void Bench_Init()
+{
+	InitTime();
+	printf("%-56s %12s %12s\n", "benchmark", "ms", "ns/op");
+}
+
+// opCount is the number of operations one run did.
+static inline void Bench_Report(const char* name, double nanoseconds, int64 opCount)
+{
+	printf("%-56s %12.3f %12.3f\n", name, nanoseconds*1e-6, nanoseconds/(double)opCount);
+	fflush(stdout);
+}
+
+// integer command line argument index, or defaultValue when it isn't there.
+static inline int64 Bench_GetArg(int argc, char** argv, int32 index, int64 defaultValue)
+{
+	return index < argc ? strtoll(argv[index], null, 10) : defaultValue;
+}
+
+// deterministic random numbers so runs are comparable.
+static inline uint32 Bench_Random(uint32* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// in [min, max).
+static inline float Bench_RandomFloat(uint32* state, float min, float max)
+{
+	return min+(max-min)*(float)(Bench_Random(state) >> 8)*(1.0f/16777216.0f);
+}
@@ -0,0 +1,129 @@
+#include "Bench.h"
+
+#include "common/Bvh.h"
+#include "common/Math.h"
+#include "common/Thread.h"
+
+// builds a bvh over a 1M triangle scene, a bumpy heightfield with triangles floating above it, and casts 1M rays into
+// it. coherent rays fan out from a camera like primary rays, incoherent ones start and point anywhere like bounces. the
+// triangle count can be passed as the first argument and the ray count as the second.
+
+#define BenchBvh_GridSize 672
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 count = (int32)Bench_GetArg(argc, argv, 1, 1000000);
+	int32 rayCount = (int32)Bench_GetArg(argc, argv, 2, 1000000);
+
+	int32 gridSize = MinI(BenchBvh_GridSize, (int32)sqrtf((float)count*0.5f)+1);
+	int32 clutterCount = MaxI(count-(gridSize-1)*(gridSize-1)*2, 0);
+	count = (gridSize-1)*(gridSize-1)*2+clutterCount;
+	Vec3* vertices = (Vec3*)MAlloc((size_t)count*3*sizeof(Vec3));
+	int32 k = 0;
+	for (int32 y = 0; y < gridSize-1; y++)
+	{
+		for (int32 x = 0; x < gridSize-1; x++)
+		{
+			Vec3 corners[4];
+			for (int32 i = 0; i < 4; i++)
+			{
+				float px = (float)(x+(i & 1)), py = (float)(y+(i >> 1));
+				corners[i] = Vec3_New(px, py, 3*sinf(px*0.05f)*cosf(py*0.07f));
+			}
+			vertices[k++] = corners[0]; vertices[k++] = corners[1]; vertices[k++] = corners[2];
+			vertices[k++] = corners[1]; vertices[k++] = corners[3]; vertices[k++] = corners[2];
+		}
+	}
+	uint32 random = 1;
+	for (int32 i = 0; i < clutterCount; i++)
+	{
+		Vec3 center = Vec3_New(Bench_RandomFloat(&random, 0, (float)gridSize), Bench_RandomFloat(&random, 0, (float)gridSize), Bench_RandomFloat(&random, 0, 20));
+		for (int32 j = 0; j < 3; j++)
+		{
+			vertices[k++] = Vec3_Add(center, Vec3_New(Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1)));
+		}
+	}
+	BvhTriangles triangles = { vertices, null };
+	Aabb* bounds = (Aabb*)MAlloc(count*sizeof(Aabb));
+	BvhTriangles_GetBounds(&triangles, count, bounds);
+
+	char name[96];
+	double nanoseconds;
+	Bvh bvh;
+	int32 threadCounts[] = { 1, Thread_GetHardwareThreadCount() };
+	for (int32 t = 0; t < ArrayCountOf(threadCounts); t++)
+	{
+		if (t > 0 && threadCounts[t] == threadCounts[0])
+		{
+			break;
+		}
+		Bench_Repeat(nanoseconds, 3)
+		{
+			Bvh_Build(&bvh, bounds, count, threadCounts[t]);
+			gBenchSink += bvh.nodeCount;
+			Bvh_Free(&bvh);
+		}
+		SPrintF(name, sizeof(name), "%d triangles, Bvh_Build %d threads", count, threadCounts[t]);
+		Bench_Report(name, nanoseconds, count);
+	}
+	Bvh_Build(&bvh, bounds, count, 0);
+	Bench_Repeat(nanoseconds, 5)
+	{
+		Bvh_Refit(&bvh, bounds);
+	}
+	SPrintF(name, sizeof(name), "%d triangles, Bvh_Refit (%d nodes)", count, bvh.nodeCount);
+	Bench_Report(name, nanoseconds, count);
+
+	Vec3* origins = (Vec3*)MAlloc(rayCount*sizeof(Vec3));
+	Vec3* dirs = (Vec3*)MAlloc(rayCount*sizeof(Vec3));
+	const char* passNames[] = { "coherent", "incoherent" };
+	for (int32 pass = 0; pass < 2; pass++)
+	{
+		for (int32 i = 0; i < rayCount; i++)
+		{
+			if (pass == 0)
+			{
+				int32 px = i%1000, py = i/1000%1000;
+				origins[i] = Vec3_New(-10, gridSize*0.5f, 25);
+				dirs[i] = Vec3_New(1, (px-500)*0.0015f, -0.2f-py*0.0008f);
+			}
+			else
+			{
+				origins[i] = Vec3_New(Bench_RandomFloat(&random, 0, (float)gridSize), Bench_RandomFloat(&random, 0, (float)gridSize), Bench_RandomFloat(&random, 0, 25));
+				dirs[i] = Vec3_New(Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1));
+			}
+		}
+
+		int32 hitCount = 0;
+		Bench_Repeat(nanoseconds, 3)
+		{
+			hitCount = 0;
+			for (int32 i = 0; i < rayCount; i++)
+			{
+				BvhHit hit;
+				hitCount += Bvh_RayCastClosest(&bvh, origins[i], dirs[i], 1e4f, BvhTriangles_RayHit, &triangles, &hit);
+			}
+		}
+		SPrintF(name, sizeof(name), "%d %s rays, Bvh_RayCastClosest (%d hits)", rayCount, passNames[pass], hitCount);
+		Bench_Report(name, nanoseconds, rayCount);
+
+		Bench_Repeat(nanoseconds, 3)
+		{
+			hitCount = 0;
+			for (int32 i = 0; i < rayCount; i++)
+			{
+				hitCount += Bvh_RayCastAny(&bvh, origins[i], dirs[i], 1e4f, BvhTriangles_RayHit, &triangles);
+			}
+		}
+		SPrintF(name, sizeof(name), "%d %s rays, Bvh_RayCastAny (%d hits)", rayCount, passNames[pass], hitCount);
+		Bench_Report(name, nanoseconds, rayCount);
+	}
+
+	Bvh_Free(&bvh);
+	MFree(dirs);
+	MFree(origins);
+	MFree(bounds);
+	MFree(vertices);
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include "Bench.h"
+
+#include "common/Thread.h"
+#include "draw/CommandList.h"
+#include "draw/Draw.h"
+#include "draw/Mesh.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// builds a frame of 100k indexed draws on the null backend, changing shader every 16 draws and blend mode every 4, the
+// way a sorted scene would. the draws are made directly through Draw_*, or recorded into command lists on 1 to 16
+// threads and executed on this one. the draw count can be passed as the first argument.
+
+#define BenchCommandList_ShaderCount 8
+#define BenchCommandList_MaxThreads 16
+
+typedef struct BenchScene
+{
+	Shader shaders[BenchCommandList_ShaderCount];
+	Mesh mesh;
+	CommandList lists[Thread_MaxParallelForChunks];
+} BenchScene;
+
+static BenchScene scene;
+
+static Shader* GetDrawShader(int64 draw)
+{
+	return &scene.shaders[(draw/16)%BenchCommandList_ShaderCount];
+}
+
+static DrawState GetDrawState(int64 draw)
+{
+	DrawState result = { 0 };
+	result.blendMode = (draw/4)%2 ? BlendMode_Alpha : BlendMode_None;
+	result.depthWrite = true;
+	return result;
+}
+
+static void DrawDirect(int64 count)
+{
+	for (int64 i = 0; i < count; i++)
+	{
+		DrawState drawState = GetDrawState(i);
+		Draw_SetShader(GetDrawShader(i));
+		Draw_SetDrawState(&drawState);
+		Mesh_DrawIndexed(&scene.mesh, (int32)(i%64)*36, 36, 0);
+	}
+}
+
+static void RecordDraws(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	Unused(userData);
+	CommandList* list = &scene.lists[chunkIndex];
+	for (int64 i = start; i < start+count; i++)
+	{
+		DrawState drawState = GetDrawState(i);
+		CommandList_SetShader(list, GetDrawShader(i));
+		CommandList_SetDrawState(list, &drawState);
+		CommandList_DrawMeshIndexed(list, &scene.mesh, (int32)(i%64)*36, 36, 0);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int64 drawCount = Bench_GetArg(argc, argv, 1, 100000);
+	Draw_Init(DrawBackendNull_Get());
+	for (int32 i = 0; i < BenchCommandList_ShaderCount; i++)
+	{
+		Shader_Load("bench", &scene.shaders[i]);
+	}
+	Mesh_Init(&scene.mesh);
+	scene.mesh.vertexBufferCount = 1;
+	VertexBuffer_Init(&scene.mesh.vertexBuffers[0], 64*1024, VertexBufferUsage_Static);
+	IndexBuffer_Init(&scene.mesh.indexBuffer, 64*36*sizeof(uint16), IndexFormat_U16, VertexBufferUsage_Static);
+	scene.mesh.vertexFormatCount = 1;
+	scene.mesh.vertexFormat[0] = (VertexFormatItem){ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 };
+	Mesh_ApplyStructure(&scene.mesh);
+	for (int32 i = 0; i < Thread_MaxParallelForChunks; i++)
+	{
+		CommandList_Init(&scene.lists[i]);
+	}
+	char name[96];
+	double nanoseconds;
+
+	Bench_Repeat(nanoseconds, 20)
+	{
+		DrawDirect(drawCount);
+		Draw_EndFrame();
+	}
+	SPrintF(name, sizeof(name), "%lld draws, Draw_* directly", (long long)drawCount);
+	Bench_Report(name, nanoseconds, drawCount);
+
+	for (int32 threadCount = 1; threadCount <= BenchCommandList_MaxThreads; threadCount *= 2)
+	{
+		int32 listCount = 0;
+		Bench_Repeat(nanoseconds, 20)
+		{
+			listCount = Thread_ParallelFor(drawCount, threadCount, 1, 16, RecordDraws, null);
+			for (int32 i = 0; i < listCount; i++)
+			{
+				CommandList_Clear(&scene.lists[i]);
+			}
+		}
+		SPrintF(name, sizeof(name), "%lld draws, recording on %d threads", (long long)drawCount, listCount);
+		Bench_Report(name, nanoseconds, drawCount);
+
+		Bench_Repeat(nanoseconds, 20)
+		{
+			listCount = Thread_ParallelFor(drawCount, threadCount, 1, 16, RecordDraws, null);
+			CommandList_Execute(scene.lists, listCount);
+			Draw_EndFrame();
+		}
+		SPrintF(name, sizeof(name), "%lld draws, recording on %d threads and executing", (long long)drawCount, listCount);
+		Bench_Report(name, nanoseconds, drawCount);
+	}
+	gBenchSink += gDrawBackendNullCounters.calls[DrawBackendCall_MeshDrawIndexed];
+
+	for (int32 i = 0; i < Thread_MaxParallelForChunks; i++)
+	{
+		CommandList_Free(&scene.lists[i]);
+	}
+	Mesh_Free(&scene.mesh);
+	for (int32 i = 0; i < BenchCommandList_ShaderCount; i++)
+	{
+		Shader_Free(&scene.shaders[i]);
+	}
+	Draw_Free();
+	return 0;
+}
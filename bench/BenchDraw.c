@@ -0,0 +1,179 @@
+#include "Bench.h"
+
+#include "common/Space.h"
+#include "draw/Draw.h"
+#include "draw/DrawRecorder.h"
+#include "draw/Mesh.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// the cpu cost of a frame of Draw_* on the null backend, for three kinds of frames: immediate quads, indexed draws that
+// each change shader and draw state, and one instanced draw of many transformers. the same frames are then made with
+// the recorder as backend, which shows its overhead and stream size, and the recording is replayed on the null backend.
+// the quad, draw and instance counts can be passed as the first three arguments.
+
+#define BenchDraw_SceneCount 3
+
+typedef struct BenchDrawVertex
+{
+	float x, y;
+	float r, g, b, a;
+} BenchDrawVertex;
+
+typedef struct BenchDrawCounts
+{
+	int32 quads;
+	int32 draws;
+	int32 instances;
+} BenchDrawCounts;
+
+static VertexFormatItem immediateFormat[] =
+{
+	{ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = sizeof(BenchDrawVertex), .type = VertexFormatType_Float, .componentCount = 2 },
+	{ .inputIndex = 1, .bufferIndex = 0, .offset = 8, .stride = sizeof(BenchDrawVertex), .type = VertexFormatType_Float, .componentCount = 4 },
+};
+
+static Shader shaders[2];
+static Mesh mesh;
+
+static void InitScene()
+{
+	Shader_Load("bench_a", &shaders[0]);
+	Shader_Load("bench_b", &shaders[1]);
+	Mesh_Init(&mesh);
+	mesh.vertexBufferCount = 1;
+	VertexBuffer_Init(&mesh.vertexBuffers[0], 1024, VertexBufferUsage_Static);
+	IndexBuffer_Init(&mesh.indexBuffer, 36*sizeof(uint16), IndexFormat_U16, VertexBufferUsage_Static);
+	mesh.vertexFormatCount = 1;
+	mesh.vertexFormat[0] = (VertexFormatItem){ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 };
+	Draw_AddInstanceTransformFormat(&mesh, 1);
+	Mesh_ApplyStructure(&mesh);
+}
+
+static void FreeScene()
+{
+	Mesh_Free(&mesh);
+	Shader_Free(&shaders[1]);
+	Shader_Free(&shaders[0]);
+}
+
+static void DrawFrame(int32 sceneIndex, const BenchDrawCounts* counts, const Transformer* transformers)
+{
+	if (sceneIndex == 0)
+	{
+		Draw_SetShader(&shaders[0]);
+		Draw_SetImmediateVertexFormat(immediateFormat, ArrayCountOf(immediateFormat));
+		for (int32 i = 0; i < counts->quads; i++)
+		{
+			float x = (float)(i%300)*0.01f;
+			BenchDrawVertex quad[4] =
+			{
+				{ x, 0, 1, 1, 1, 1 },
+				{ x, 1, 1, 1, 1, 1 },
+				{ x+1, 1, 1, 1, 1, 1 },
+				{ x+1, 0, 1, 1, 1, 1 },
+			};
+			Draw_SubmitImmediatePoly(quad, 4);
+		}
+	}
+	else if (sceneIndex == 1)
+	{
+		DrawState drawState = { 0 };
+		drawState.depthWrite = true;
+		for (int32 i = 0; i < counts->draws; i++)
+		{
+			Draw_SetShader(&shaders[i & 1]);
+			drawState.blendMode = (i >> 1) & 1 ? BlendMode_Alpha : BlendMode_None;
+			Draw_SetDrawState(&drawState);
+			Mesh_DrawIndexed(&mesh, 0, 36, 0);
+		}
+	}
+	else
+	{
+		Draw_SetShader(&shaders[0]);
+		Draw_MeshInstancedTransformers(&mesh, 0, 36, transformers, counts->instances);
+	}
+	Draw_EndFrame();
+}
+
+// times each scene's frame and returns how many frames were made.
+static int32 RunScenes(const BenchDrawCounts* counts, const Transformer* transformers, bool recording)
+{
+	const char* sceneNames[BenchDraw_SceneCount] = { "immediate quads", "indexed draws", "instanced transformers" };
+	int32 opCounts[BenchDraw_SceneCount] = { counts->quads, counts->draws, counts->instances };
+	int32 repetitions = recording ? 5 : 20;
+	int32 frameCount = 0;
+	char name[96];
+	double nanoseconds;
+	for (int32 s = 0; s < BenchDraw_SceneCount; s++)
+	{
+		int64 sizeBefore = 0, sizeAfter = 0;
+		if (recording)
+		{
+			DrawRecorder_GetData(&sizeBefore);
+		}
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			DrawFrame(s, counts, transformers);
+		}
+		frameCount += repetitions;
+		if (recording)
+		{
+			DrawRecorder_GetData(&sizeAfter);
+			SPrintF(name, sizeof(name), "%d %s, recorder (%.0f KB/frame)", opCounts[s], sceneNames[s], (double)(sizeAfter-sizeBefore)/1024.0/repetitions);
+		}
+		else
+		{
+			SPrintF(name, sizeof(name), "%d %s, null backend", opCounts[s], sceneNames[s]);
+		}
+		Bench_Report(name, nanoseconds, opCounts[s]);
+	}
+	gBenchSink += gDrawBackendNullCounters.calls[DrawBackendCall_EndFrame];
+	return frameCount;
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	BenchDrawCounts counts;
+	counts.quads = (int32)Bench_GetArg(argc, argv, 1, 100000);
+	counts.draws = (int32)Bench_GetArg(argc, argv, 2, 10000);
+	counts.instances = (int32)Bench_GetArg(argc, argv, 3, 100000);
+	Transformer* transformers = (Transformer*)MAlloc(counts.instances*sizeof(Transformer));
+	for (int32 i = 0; i < counts.instances; i++)
+	{
+		transformers[i] = Transformer_identity;
+		transformers[i].pos = Vec3_New((float)(i%1000), (float)(i/1000), 0);
+	}
+
+	Draw_Init(DrawBackendNull_Get());
+	InitScene();
+	RunScenes(&counts, transformers, false);
+	FreeScene();
+	Draw_Free();
+
+	Draw_Init(DrawRecorder_Init());
+	InitScene();
+	int32 frameCount = RunScenes(&counts, transformers, true);
+	FreeScene();
+	Draw_Free();
+	int64 size;
+	const uint8* recorded = DrawRecorder_GetData(&size);
+	uint8* data = (uint8*)MAlloc(size);
+	MemCpy(data, recorded, size);
+	DrawRecorder_Free();
+
+	char name[96];
+	double nanoseconds;
+	bool replayed = true;
+	Bench_Repeat(nanoseconds, 3)
+	{
+		replayed &= DrawRecorder_Replay(data, size, DrawBackendNull_Get(), null, null);
+	}
+	SPrintF(name, sizeof(name), "%d recorded frames, %.1f MB, replay%s", frameCount, (double)size/(1024.0*1024.0), replayed ? "" : " failed");
+	Bench_Report(name, nanoseconds, frameCount);
+
+	MFree(data);
+	MFree(transformers);
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include "Bench.h"
+
+#include "draw/Draw.h"
+#include "draw/DrawQueue.h"
+#include "draw/Mesh.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// a frame of mixed draws on the null backend, drawn in submission order straight through Draw_* and through a
+// DrawQueue. a quarter are immediate quads, one in 20 is blended in a back to front layer, and materials are picked at
+// random from 16 shaders, 4 draw states and 8 textures. the counts of shader changes, draw state updates and draw calls
+// per frame are part of each line, the queue trades its cpu time for fewer of them. the draw count can be passed as the
+// first argument.
+
+#define BenchDrawQueue_ShaderCount 16
+#define BenchDrawQueue_DrawStateCount 4
+#define BenchDrawQueue_TextureCount 8
+
+typedef struct BenchDrawQueueDraw
+{
+	DrawQueueMaterial material;
+	bool immediate;
+	int32 layer;
+	float depth;
+} BenchDrawQueueDraw;
+
+static Shader shaders[BenchDrawQueue_ShaderCount];
+// the null backend never looks inside textures or uniforms, they only need distinct addresses.
+static Texture textures[BenchDrawQueue_TextureCount];
+static ShaderUniform textureUniform;
+static Mesh mesh;
+static VertexFormatItem immediateFormat[] =
+{
+	{ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 },
+};
+static float quad[12] = { 0, 0, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0 };
+
+static void DrawDirect(const BenchDrawQueueDraw* draws, int32 drawCount)
+{
+	Draw_SetImmediateVertexFormat(immediateFormat, 1);
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		const DrawQueueMaterial* material = &draws[i].material;
+		Draw_SetShader(material->shader);
+		Draw_SetDrawState(&material->drawState);
+		Shader_SetUniformTexture(material->shader, material->textureUniform, 0, material->texture);
+		if (draws[i].immediate)
+		{
+			Draw_SubmitImmediatePoly(quad, 4);
+		}
+		else
+		{
+			Mesh_Draw(&mesh, 0, 36);
+		}
+	}
+	Draw_EndFrame();
+}
+
+static void DrawQueued(DrawQueue* queue, const BenchDrawQueueDraw* draws, int32 drawCount)
+{
+	DrawQueue_SetImmediateVertexFormat(queue, immediateFormat, 1);
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		const BenchDrawQueueDraw* draw = &draws[i];
+		if (draw->immediate)
+		{
+			DrawQueue_SubmitImmediatePoly(queue, &draw->material, quad, 4, draw->layer, draw->depth);
+		}
+		else
+		{
+			DrawQueue_SubmitMesh(queue, &draw->material, &mesh, 0, 36, draw->layer, draw->depth);
+		}
+	}
+	DrawQueue_Execute(queue);
+	Draw_EndFrame();
+}
+
+static void ReportFrame(const char* how, int32 drawCount, double nanoseconds, int32 repetitions, const DrawBackendNullCounters* before)
+{
+	double frames = repetitions;
+	double shaderSets = (double)(gDrawBackendNullCounters.calls[DrawBackendCall_ShaderSet]-before->calls[DrawBackendCall_ShaderSet])/frames;
+	double stateUpdates = (double)(gDrawBackendNullCounters.calls[DrawBackendCall_DrawStateUpdate]-before->calls[DrawBackendCall_DrawStateUpdate])/frames;
+	uint64 drawCalls = gDrawBackendNullCounters.calls[DrawBackendCall_MeshDraw]+gDrawBackendNullCounters.calls[DrawBackendCall_MeshDrawIndexed];
+	uint64 drawCallsBefore = before->calls[DrawBackendCall_MeshDraw]+before->calls[DrawBackendCall_MeshDrawIndexed];
+	char name[96];
+	SPrintF(name, sizeof(name), "%d draws %s (%.0f shader, %.0f state, %.0f draw calls)", drawCount, how, shaderSets, stateUpdates, (double)(drawCalls-drawCallsBefore)/frames);
+	Bench_Report(name, nanoseconds, drawCount);
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 drawCount = (int32)Bench_GetArg(argc, argv, 1, 10000);
+
+	Draw_Init(DrawBackendNull_Get());
+	for (int32 i = 0; i < BenchDrawQueue_ShaderCount; i++)
+	{
+		char path[32];
+		SPrintF(path, sizeof(path), "bench_%d", i);
+		Shader_Load(path, &shaders[i]);
+	}
+	Mesh_Init(&mesh);
+	mesh.vertexBufferCount = 1;
+	VertexBuffer_Init(&mesh.vertexBuffers[0], 1024, VertexBufferUsage_Static);
+	mesh.vertexFormatCount = 1;
+	mesh.vertexFormat[0] = immediateFormat[0];
+	Mesh_ApplyStructure(&mesh);
+
+	BenchDrawQueueDraw* draws = (BenchDrawQueueDraw*)MAlloc(drawCount*sizeof(BenchDrawQueueDraw));
+	uint32 random = 1;
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		BenchDrawQueueDraw* draw = &draws[i];
+		MemSet(draw, 0, sizeof(BenchDrawQueueDraw));
+		int32 drawState = (int32)(Bench_Random(&random)%BenchDrawQueue_DrawStateCount);
+		draw->material.shader = &shaders[Bench_Random(&random)%BenchDrawQueue_ShaderCount];
+		draw->material.drawState.depthWrite = (drawState & 1) != 0;
+		draw->material.drawState.cullMode = (CullMode)((drawState >> 1) & 1);
+		draw->material.textureUniform = &textureUniform;
+		draw->material.texture = &textures[Bench_Random(&random)%BenchDrawQueue_TextureCount];
+		draw->immediate = Bench_Random(&random)%4 == 0;
+		draw->layer = Bench_Random(&random)%20 == 0;
+		if (draw->layer)
+		{
+			draw->material.drawState.blendMode = BlendMode_Alpha;
+		}
+		draw->depth = Bench_RandomFloat(&random, 1, 1000);
+	}
+
+	DrawQueue queue;
+	DrawQueue_Init(&queue);
+	DrawQueue_SetLayerBackToFront(&queue, 1, true);
+	const int32 repetitions = 20;
+	double nanoseconds;
+
+	DrawBackendNullCounters before = gDrawBackendNullCounters;
+	Bench_Repeat(nanoseconds, repetitions)
+	{
+		DrawDirect(draws, drawCount);
+	}
+	ReportFrame("direct", drawCount, nanoseconds, repetitions, &before);
+
+	before = gDrawBackendNullCounters;
+	Bench_Repeat(nanoseconds, repetitions)
+	{
+		DrawQueued(&queue, draws, drawCount);
+	}
+	ReportFrame("queued", drawCount, nanoseconds, repetitions, &before);
+	gBenchSink += gDrawBackendNullCounters.calls[DrawBackendCall_EndFrame];
+
+	DrawQueue_Free(&queue);
+	MFree(draws);
+	Mesh_Free(&mesh);
+	for (int32 i = 0; i < BenchDrawQueue_ShaderCount; i++)
+	{
+		Shader_Free(&shaders[i]);
+	}
+	Draw_Free();
+	return 0;
+}
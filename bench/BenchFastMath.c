@@ -0,0 +1,71 @@
+#include "Bench.h"
+
+#include "common/FastMath.h"
+#include "common/Math.h"
+
+// throughput of the crt functions, the scalar approximations and the array forms over arrays that stay in cache.
+// the array length can be passed as the first argument.
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 count = (int32)Bench_GetArg(argc, argv, 1, 4096);
+	int32 repetitions = 20;
+	float* angles = (float*)MAlloc(count*sizeof(float));
+	float* positives = (float*)MAlloc(count*sizeof(float));
+	float* exponents = (float*)MAlloc(count*sizeof(float));
+	float* powers = (float*)MAlloc(count*sizeof(float));
+	float* output = (float*)MAlloc(count*sizeof(float));
+	float* output2 = (float*)MAlloc(count*sizeof(float));
+	uint32 random = 1;
+	for (int32 i = 0; i < count; i++)
+	{
+		angles[i] = Bench_RandomFloat(&random, -700, 700);
+		positives[i] = Bench_RandomFloat(&random, 0.5f, 5);
+		exponents[i] = Bench_RandomFloat(&random, -80, 80);
+		powers[i] = Bench_RandomFloat(&random, -0.8f, 0.8f);
+	}
+	double nanoseconds;
+
+#define BenchFastMath_Run(name, statement) \
+	Bench_Repeat(nanoseconds, repetitions) { statement; } \
+	gBenchSink += (uint64)output[count/2]; \
+	Bench_Report(name, nanoseconds, count);
+
+	BenchFastMath_Run("Sin", for (int32 i = 0; i < count; i++) { output[i] = Sin(angles[i]); });
+	BenchFastMath_Run("FastSin", for (int32 i = 0; i < count; i++) { output[i] = FastSin(angles[i]); });
+	BenchFastMath_Run("FastSinArray", FastSinArray(angles, output, count));
+	BenchFastMath_Run("Sin and Cos", for (int32 i = 0; i < count; i++) { output[i] = Sin(angles[i]); output2[i] = Cos(angles[i]); });
+	BenchFastMath_Run("FastSinCos", for (int32 i = 0; i < count; i++) { FastSinCos(angles[i], &output[i], &output2[i]); });
+	BenchFastMath_Run("FastSinCosArray", FastSinCosArray(angles, output, output2, count));
+	BenchFastMath_Run("Tan", for (int32 i = 0; i < count; i++) { output[i] = Tan(powers[i]); });
+	BenchFastMath_Run("FastTan", for (int32 i = 0; i < count; i++) { output[i] = FastTan(powers[i]); });
+	BenchFastMath_Run("FastTanArray", FastTanArray(powers, output, count));
+	BenchFastMath_Run("Atan", for (int32 i = 0; i < count; i++) { output[i] = Atan(angles[i]); });
+	BenchFastMath_Run("FastAtan", for (int32 i = 0; i < count; i++) { output[i] = FastAtan(angles[i]); });
+	BenchFastMath_Run("FastAtanArray", FastAtanArray(angles, output, count));
+	BenchFastMath_Run("Atan2", for (int32 i = 0; i < count; i++) { output[i] = Atan2(angles[i], exponents[i]); });
+	BenchFastMath_Run("FastAtan2", for (int32 i = 0; i < count; i++) { output[i] = FastAtan2(angles[i], exponents[i]); });
+	BenchFastMath_Run("FastAtan2Array", FastAtan2Array(angles, exponents, output, count));
+	BenchFastMath_Run("Exp", for (int32 i = 0; i < count; i++) { output[i] = Exp(exponents[i]); });
+	BenchFastMath_Run("FastExp", for (int32 i = 0; i < count; i++) { output[i] = FastExp(exponents[i]); });
+	BenchFastMath_Run("FastExpArray", FastExpArray(exponents, output, count));
+	BenchFastMath_Run("Log", for (int32 i = 0; i < count; i++) { output[i] = Log(positives[i]); });
+	BenchFastMath_Run("FastLog", for (int32 i = 0; i < count; i++) { output[i] = FastLog(positives[i]); });
+	BenchFastMath_Run("FastLogArray", FastLogArray(positives, output, count));
+	BenchFastMath_Run("Pow", for (int32 i = 0; i < count; i++) { output[i] = Pow(positives[i], exponents[i]*0.1f); });
+	BenchFastMath_Run("FastPow", for (int32 i = 0; i < count; i++) { output[i] = FastPow(positives[i], exponents[i]*0.1f); });
+	for (int32 i = 0; i < count; i++)
+	{
+		output2[i] = exponents[i]*0.1f;
+	}
+	BenchFastMath_Run("FastPowArray", FastPowArray(positives, output2, output, count));
+
+	MFree(output2);
+	MFree(output);
+	MFree(powers);
+	MFree(exponents);
+	MFree(positives);
+	MFree(angles);
+	return 0;
+}
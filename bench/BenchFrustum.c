@@ -0,0 +1,103 @@
+#include "Bench.h"
+
+#include "common/Frustum.h"
+#include "common/Thread.h"
+
+// culls 1M objects scattered around a camera, about 7% of them visible. the object count can be passed as the first
+// argument.
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 count = (int32)Bench_GetArg(argc, argv, 1, 1000000);
+
+	View view;
+	View_InitPerspective(&view, 16.0f/9.0f, DegToRad(70));
+	RigidTransform camera = RigidTransform_New(Quat_Normalize(Quat_New(0.1f, 0.2f, 0.3f, 0.9f)), Vec3_New(5, -3, 2), 1);
+	Transformer cameraToWorld = RigidTransform_ToTransformer(&camera);
+	Frustum frustum = Frustum_FromView(&view, &cameraToWorld, 0.5f, 400);
+
+	float* arrays[7];
+	for (int32 i = 0; i < 7; i++)
+	{
+		arrays[i] = (float*)MAlloc(count*sizeof(float));
+	}
+	SphereSoA spheres = { { arrays[0], arrays[1], arrays[2] }, arrays[3] };
+	AabbSoA aabbs = { { arrays[0], arrays[1], arrays[2] }, { arrays[4], arrays[5], arrays[6] } };
+	uint32 random = 1;
+	for (int32 i = 0; i < count; i++)
+	{
+		for (int32 k = 0; k < 3; k++)
+		{
+			arrays[k][i] = Bench_RandomFloat(&random, -500, 500);
+		}
+		for (int32 k = 3; k < 7; k++)
+		{
+			arrays[k][i] = Bench_RandomFloat(&random, 0.1f, 2);
+		}
+	}
+	int32* indices = (int32*)MAlloc(count*sizeof(int32));
+	char name[96];
+	double nanoseconds;
+	int32 visible = 0;
+
+	Bench_Repeat(nanoseconds, 10)
+	{
+		visible = 0;
+		for (int32 i = 0; i < count; i++)
+		{
+			indices[visible] = i;
+			visible += Frustum_TestSphere(&frustum, Vec3_New(arrays[0][i], arrays[1][i], arrays[2][i]), arrays[3][i]);
+		}
+	}
+	SPrintF(name, sizeof(name), "%d spheres, Frustum_TestSphere loop (%d visible)", count, visible);
+	Bench_Report(name, nanoseconds, count);
+	Bench_Repeat(nanoseconds, 10)
+	{
+		visible = Frustum_CullSpheres(&frustum, &spheres, count, indices);
+	}
+	SPrintF(name, sizeof(name), "%d spheres, Frustum_CullSpheres", count);
+	Bench_Report(name, nanoseconds, count);
+
+	Bench_Repeat(nanoseconds, 10)
+	{
+		visible = 0;
+		for (int32 i = 0; i < count; i++)
+		{
+			indices[visible] = i;
+			visible += Frustum_TestAabb(&frustum, Vec3_New(arrays[0][i], arrays[1][i], arrays[2][i]), Vec3_New(arrays[4][i], arrays[5][i], arrays[6][i]));
+		}
+	}
+	SPrintF(name, sizeof(name), "%d aabbs, Frustum_TestAabb loop (%d visible)", count, visible);
+	Bench_Report(name, nanoseconds, count);
+	Bench_Repeat(nanoseconds, 10)
+	{
+		visible = Frustum_CullAabbs(&frustum, &aabbs, count, indices);
+	}
+	SPrintF(name, sizeof(name), "%d aabbs, Frustum_CullAabbs", count);
+	Bench_Report(name, nanoseconds, count);
+
+	for (int32 threadCount = 2; threadCount <= Thread_GetHardwareThreadCount()*2; threadCount *= 2)
+	{
+		Bench_Repeat(nanoseconds, 10)
+		{
+			visible = Frustum_CullSpheresParallel(&frustum, &spheres, count, indices, threadCount);
+		}
+		SPrintF(name, sizeof(name), "%d spheres, Frustum_CullSpheresParallel, %d threads", count, threadCount);
+		Bench_Report(name, nanoseconds, count);
+		Bench_Repeat(nanoseconds, 10)
+		{
+			visible = Frustum_CullAabbsParallel(&frustum, &aabbs, count, indices, threadCount);
+		}
+		SPrintF(name, sizeof(name), "%d aabbs, Frustum_CullAabbsParallel, %d threads", count, threadCount);
+		Bench_Report(name, nanoseconds, count);
+	}
+	gBenchSink += visible;
+
+	MFree(indices);
+	for (int32 i = 0; i < 7; i++)
+	{
+		MFree(arrays[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include "Bench.h"
+
+#include "common/Log.h"
+
+// what a log call costs the thread that makes it, next to formatting with snprintf and writing with fprintf. the
+// logger writes to a sink that throws the text away, so only the calling side is measured. calls are timed in
+// batches that fit in a thread's ring and the ring is drained between batches, so none are dropped. the batch count
+// can be passed as the first argument.
+
+#define BenchLog_BatchSize 256
+
+static void DiscardWrite(LogSink* self, LogLevel level, LogCategory category, const char* text, int32 length)
+{
+	Unused(level);
+	Unused(category);
+	gBenchSink += length+(uint64)(size_t)self+(uint64)(size_t)text;
+}
+
+static LogSink discardSink = { .write = DiscardWrite };
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 batchCount = (int32)Bench_GetArg(argc, argv, 1, 400);
+	FILE* devNull = fopen("/dev/null", "w");
+	char buffer[256];
+	uint64 fastestCycles;
+	int32 value = 1;
+
+	Log_RemoveSink(Log_GetConsoleSink());
+	Log_AddSink(&discardSink);
+	Log_Init();
+
+	// the fastest batch, like Bench_Repeat. drain runs between batches and isn't timed.
+#define BenchLog_Run(name, drain, statement) \
+	fastestCycles = ~(uint64)0; \
+	for (int32 batch = 0; batch < batchCount; batch++) \
+	{ \
+		uint64 startCycles = GetCycles(); \
+		for (int32 i = 0; i < BenchLog_BatchSize; i++) \
+		{ \
+			statement; \
+			value++; \
+		} \
+		uint64 cycles = GetCycles()-startCycles; \
+		fastestCycles = cycles < fastestCycles ? cycles : fastestCycles; \
+		drain; \
+	} \
+	Bench_Report(name, (double)fastestCycles*1e9/(double)GetCycleFrequency(), BenchLog_BatchSize);
+
+	BenchLog_Run("snprintf", (void)0, gBenchSink += (uint64)snprintf(buffer, sizeof(buffer), "frame %d took %.3f ms in %s\n", value, value*0.01, "update"));
+	BenchLog_Run("fprintf to /dev/null", fflush(devNull), fprintf(devNull, "frame %d took %.3f ms in %s\n", value, value*0.01, "update"));
+	BenchLog_Run("LogF", Log_Flush(), LogF(LogLevel_Info, LogCategory_General, "frame %d took %.3f ms in %s\n", value, value*0.01, "update"));
+	BenchLog_Run("Log_Write", Log_Flush(), Log_Write(LogLevel_Info, LogCategory_General, "frame took too long in update\n"));
+	Log_SetMinLevel(LogLevel_Warning);
+	BenchLog_Run("LogF below the min level", (void)0, LogF(LogLevel_Info, LogCategory_General, "frame %d took %.3f ms in %s\n", value, value*0.01, "update"));
+	Log_SetMinLevel(LogLevel_Debug);
+	// after the log stops calls format and write right away, like the logger wasn't there.
+	Log_Free();
+	BenchLog_Run("LogF synchronous", (void)0, LogF(LogLevel_Info, LogCategory_General, "frame %d took %.3f ms in %s\n", value, value*0.01, "update"));
+
+	Log_RemoveSink(&discardSink);
+	Log_AddSink(Log_GetConsoleSink());
+	fclose(devNull);
+	return 0;
+}
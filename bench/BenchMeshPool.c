@@ -0,0 +1,146 @@
+#include "Bench.h"
+
+#include "draw/Draw.h"
+#include "draw/Mesh.h"
+#include "draw/MeshPool.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// cpu time to submit a frame of draws of pooled meshes on the null backend, through MeshPool_Draw and MeshPool_Submit
+// against one Mesh_DrawIndexed per draw with its shader and draw state set first, like a renderer without the pool
+// would. the pool's meshes are indexed, so the individual draws are indexed too. each draw has a 64 byte transform as
+// per draw data, which the individual draws leave out. the null backend makes backend calls nearly free, so the pool
+// can lose on time here while it saves most of the calls a real driver charges for. materials are picked at random from 8 shaders and 2 draw states.
+// the draw count, 50k by default, can be passed as the first argument.
+
+#define BenchMeshPool_MeshCount 64
+#define BenchMeshPool_ShaderCount 8
+#define BenchMeshPool_DrawStateCount 2
+
+typedef struct BenchMeshPoolDraw
+{
+	Shader* shader;
+	DrawState drawState;
+	MeshPoolRange range;
+	Matrix4 transform;
+} BenchMeshPoolDraw;
+
+static Shader shaders[BenchMeshPool_ShaderCount];
+static VertexFormatItem vertexFormat[] =
+{
+	{ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 },
+};
+static VertexFormatItem drawDataFormat[] =
+{
+	{ .inputIndex = 1, .offset = 0, .stride = sizeof(Matrix4), .type = VertexFormatType_Float, .componentCount = 4 },
+	{ .inputIndex = 2, .offset = 16, .stride = sizeof(Matrix4), .type = VertexFormatType_Float, .componentCount = 4 },
+	{ .inputIndex = 3, .offset = 32, .stride = sizeof(Matrix4), .type = VertexFormatType_Float, .componentCount = 4 },
+	{ .inputIndex = 4, .offset = 48, .stride = sizeof(Matrix4), .type = VertexFormatType_Float, .componentCount = 4 },
+};
+
+static void DrawIndividually(MeshPool* pool, const BenchMeshPoolDraw* draws, int32 drawCount)
+{
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		const BenchMeshPoolDraw* draw = &draws[i];
+		Draw_SetShader(draw->shader);
+		Draw_SetDrawState(&draw->drawState);
+		Mesh_DrawIndexed(&pool->mesh, draw->range.firstIndex, draw->range.indexCount, draw->range.baseVertex);
+	}
+	Draw_EndFrame();
+}
+
+static void DrawPooled(MeshPool* pool, const BenchMeshPoolDraw* draws, int32 drawCount)
+{
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		const BenchMeshPoolDraw* draw = &draws[i];
+		MeshPool_Draw(pool, draw->shader, &draw->drawState, draw->range, &draw->transform);
+	}
+	MeshPool_Submit(pool);
+	Draw_EndFrame();
+}
+
+static void ReportFrame(const char* how, int32 drawCount, double nanoseconds, int32 repetitions, const DrawBackendNullCounters* before)
+{
+	double frames = repetitions;
+	double shaderSets = (double)(gDrawBackendNullCounters.calls[DrawBackendCall_ShaderSet]-before->calls[DrawBackendCall_ShaderSet])/frames;
+	double stateUpdates = (double)(gDrawBackendNullCounters.calls[DrawBackendCall_DrawStateUpdate]-before->calls[DrawBackendCall_DrawStateUpdate])/frames;
+	uint64 drawCalls = gDrawBackendNullCounters.calls[DrawBackendCall_MeshDrawIndexed]+gDrawBackendNullCounters.calls[DrawBackendCall_MeshDrawIndexedIndirect];
+	uint64 drawCallsBefore = before->calls[DrawBackendCall_MeshDrawIndexed]+before->calls[DrawBackendCall_MeshDrawIndexedIndirect];
+	char name[96];
+	SPrintF(name, sizeof(name), "%d draws %s (%.0f shader, %.0f state, %.0f draw calls)", drawCount, how, shaderSets, stateUpdates, (double)(drawCalls-drawCallsBefore)/frames);
+	Bench_Report(name, nanoseconds, drawCount);
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 drawCount = (int32)Bench_GetArg(argc, argv, 1, 50000);
+
+	Draw_Init(DrawBackendNull_Get());
+	for (int32 i = 0; i < BenchMeshPool_ShaderCount; i++)
+	{
+		char path[32];
+		SPrintF(path, sizeof(path), "bench_%d", i);
+		Shader_Load(path, &shaders[i]);
+	}
+
+	// meshes of 24 to 87 vertices and twice as many triangles.
+	MeshPool pool;
+	MeshPool_Init(&pool, vertexFormat, ArrayCountOf(vertexFormat), drawDataFormat, ArrayCountOf(drawDataFormat), 64*1024, 384*1024);
+	float* vertices = (float*)MAlloc(87*3*sizeof(float));
+	uint32* indices = (uint32*)MAlloc(87*6*sizeof(uint32));
+	MemSet(vertices, 0, 87*3*sizeof(float));
+	for (int32 i = 0; i < 87*6; i++)
+	{
+		indices[i] = (uint32)(i%24);
+	}
+	MeshPoolRange ranges[BenchMeshPool_MeshCount];
+	for (int32 i = 0; i < BenchMeshPool_MeshCount; i++)
+	{
+		ranges[i] = MeshPool_Add(&pool, vertices, 24+i, indices, (24+i)*6);
+	}
+
+	BenchMeshPoolDraw* draws = (BenchMeshPoolDraw*)MAlloc(drawCount*sizeof(BenchMeshPoolDraw));
+	uint32 random = 1;
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		BenchMeshPoolDraw* draw = &draws[i];
+		MemSet(draw, 0, sizeof(BenchMeshPoolDraw));
+		draw->shader = &shaders[Bench_Random(&random)%BenchMeshPool_ShaderCount];
+		draw->drawState.cullMode = (CullMode)(Bench_Random(&random)%BenchMeshPool_DrawStateCount);
+		draw->range = ranges[Bench_Random(&random)%BenchMeshPool_MeshCount];
+		draw->transform = Matrix4_identity;
+		draw->transform.values[3][0] = Bench_RandomFloat(&random, -100, 100);
+	}
+
+	const int32 repetitions = 20;
+	double nanoseconds;
+
+	DrawBackendNullCounters before = gDrawBackendNullCounters;
+	Bench_Repeat(nanoseconds, repetitions)
+	{
+		DrawIndividually(&pool, draws, drawCount);
+	}
+	ReportFrame("individually", drawCount, nanoseconds, repetitions, &before);
+
+	before = gDrawBackendNullCounters;
+	Bench_Repeat(nanoseconds, repetitions)
+	{
+		DrawPooled(&pool, draws, drawCount);
+	}
+	ReportFrame("pooled", drawCount, nanoseconds, repetitions, &before);
+	gBenchSink += gDrawBackendNullCounters.calls[DrawBackendCall_EndFrame];
+
+	MFree(draws);
+	MFree(indices);
+	MFree(vertices);
+	MeshPool_Free(&pool);
+	for (int32 i = 0; i < BenchMeshPool_ShaderCount; i++)
+	{
+		Shader_Free(&shaders[i]);
+	}
+	Draw_Free();
+	return 0;
+}
@@ -0,0 +1,223 @@
+#include "Bench.h"
+
+#include "common/File.h"
+#include "common/Thread.h"
+
+#include <unistd.h>
+
+#define BenchPlatform_Iterations 1000000
+
+static void BenchTime()
+{
+	double nanoseconds;
+	Bench_Repeat(nanoseconds, 5)
+	{
+		uint64 sum = 0;
+		for (int32 i = 0; i < BenchPlatform_Iterations; i++)
+		{
+			sum += GetTicks();
+		}
+		gBenchSink += sum;
+	}
+	Bench_Report("GetTicks", nanoseconds, BenchPlatform_Iterations);
+
+	Bench_Repeat(nanoseconds, 5)
+	{
+		uint64 sum = 0;
+		for (int32 i = 0; i < BenchPlatform_Iterations; i++)
+		{
+			sum += GetCycles();
+		}
+		gBenchSink += sum;
+	}
+	Bench_Report(gTimeUseTSC ? "GetCycles (tsc)" : "GetCycles (os)", nanoseconds, BenchPlatform_Iterations);
+}
+
+typedef struct ContendedMutex
+{
+	Mutex mutex;
+	int64 counter;
+	int32 iterations;
+} ContendedMutex;
+
+static void LockLoop(void* userData)
+{
+	ContendedMutex* test = (ContendedMutex*)userData;
+	for (int32 i = 0; i < test->iterations; i++)
+	{
+		Mutex_Lock(&test->mutex);
+		test->counter++;
+		Mutex_Unlock(&test->mutex);
+	}
+}
+
+static void BenchMutex()
+{
+	double nanoseconds;
+	ContendedMutex test = { 0 };
+	test.iterations = BenchPlatform_Iterations;
+	Bench_Repeat(nanoseconds, 5)
+	{
+		LockLoop(&test);
+	}
+	Bench_Report("Mutex lock+unlock, uncontended", nanoseconds, BenchPlatform_Iterations);
+
+	const int32 threadCounts[] = { 2, 4, 8 };
+	for (int32 t = 0; t < (int32)ArrayCountOf(threadCounts); t++)
+	{
+		int32 threadCount = threadCounts[t];
+		test.iterations = BenchPlatform_Iterations/threadCount;
+		Bench_Repeat(nanoseconds, 3)
+		{
+			Thread threads[8];
+			for (int32 i = 0; i < threadCount; i++)
+			{
+				Thread_Start(&threads[i], LockLoop, &test);
+			}
+			for (int32 i = 0; i < threadCount; i++)
+			{
+				Thread_Join(&threads[i]);
+			}
+		}
+		char name[64];
+		SPrintF(name, sizeof(name), "Mutex lock+unlock, %d threads contending", threadCount);
+		Bench_Report(name, nanoseconds, (int64)test.iterations*threadCount);
+	}
+	gBenchSink += test.counter;
+	Mutex_Free(&test.mutex);
+}
+
+typedef struct PingPong
+{
+	Semaphore ping;
+	Semaphore pong;
+	int32 iterations;
+} PingPong;
+
+static void Ponger(void* userData)
+{
+	PingPong* test = (PingPong*)userData;
+	for (int32 i = 0; i < test->iterations; i++)
+	{
+		Semaphore_Wait(&test->ping);
+		Semaphore_Signal(&test->pong);
+	}
+}
+
+static void BenchSemaphore()
+{
+	PingPong test = { 0 };
+	test.iterations = 50000;
+	double nanoseconds;
+	Bench_Repeat(nanoseconds, 3)
+	{
+		Thread thread;
+		Thread_Start(&thread, Ponger, &test);
+		for (int32 i = 0; i < test.iterations; i++)
+		{
+			Semaphore_Signal(&test.ping);
+			Semaphore_Wait(&test.pong);
+		}
+		Thread_Join(&thread);
+	}
+	Bench_Report("Semaphore ping-pong round trip between 2 threads", nanoseconds, test.iterations);
+	Semaphore_Free(&test.ping);
+	Semaphore_Free(&test.pong);
+}
+
+static void SumRange(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	Unused(chunkIndex);
+	const uint32* values = (const uint32*)userData;
+	uint64 sum = 0;
+	for (int64 i = start; i < start+count; i++)
+	{
+		sum += values[i];
+	}
+	gBenchSink += sum;
+}
+
+static void BenchParallelFor()
+{
+	double nanoseconds;
+	uint32 dummy = 0;
+	Bench_Repeat(nanoseconds, 20)
+	{
+		Thread_ParallelFor(Thread_GetHardwareThreadCount(), 0, 1, 1, SumRange, &dummy);
+	}
+	char name[64];
+	SPrintF(name, sizeof(name), "Thread_ParallelFor overhead, %d empty chunks", Thread_GetHardwareThreadCount());
+	Bench_Report(name, nanoseconds, 1);
+
+	const int64 count = 64*1024*1024;
+	uint32* values = (uint32*)MAlloc(count*sizeof(uint32));
+	for (int64 i = 0; i < count; i++)
+	{
+		values[i] = (uint32)i;
+	}
+	Bench_Repeat(nanoseconds, 5)
+	{
+		SumRange(values, 0, count, 0);
+	}
+	Bench_Report("sum 64M uint32, 1 thread", nanoseconds, count);
+	Bench_Repeat(nanoseconds, 5)
+	{
+		Thread_ParallelFor(count, 0, 1024*1024, 1, SumRange, values);
+	}
+	Bench_Report("sum 64M uint32, Thread_ParallelFor", nanoseconds, count);
+	MFree(values);
+}
+
+static void BenchFile()
+{
+	char path[256];
+	SPrintF(path, sizeof(path), "/tmp/kirin_bench_%d.bin", (int)getpid());
+
+	const int64 size = 128*1024*1024;
+	uint8* data = (uint8*)MAlloc(size);
+	MemSet(data, 0x5a, size);
+
+	double nanoseconds;
+	Bench_Repeat(nanoseconds, 3)
+	{
+		File_WriteBinaryFile(path, data, size);
+	}
+	Bench_Report("File_WriteBinaryFile 128MB, ns per KB", nanoseconds, size/1024);
+
+	// the file is in the page cache by now, this measures the copy out of it.
+	Bench_Repeat(nanoseconds, 3)
+	{
+		int64 readSize;
+		uint8* read = File_ReadBinaryFileAlloc(path, &readSize);
+		gBenchSink += read[readSize-1];
+		MFree(read);
+	}
+	Bench_Report("File_ReadBinaryFileAlloc 128MB, cached, ns per KB", nanoseconds, size/1024);
+
+	Bench_Repeat(nanoseconds, 3)
+	{
+		File file;
+		File_Init(&file);
+		File_Open(&file, path, FileMode_Read);
+		while (File_ReadBinary(&file, data, 64*1024) > 0)
+		{
+			gBenchSink += data[0];
+		}
+		File_Close(&file);
+	}
+	Bench_Report("File_ReadBinary 64KB chunks, cached, ns per KB", nanoseconds, size/1024);
+
+	remove(path);
+	MFree(data);
+}
+
+int main()
+{
+	Bench_Init();
+	BenchTime();
+	BenchMutex();
+	BenchSemaphore();
+	BenchParallelFor();
+	BenchFile();
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "Bench.h"
+
+#include "common/Math.h"
+#include "common/RadixSort.h"
+
+// sorts random keys with index values against qsort on key value pairs, from 1k keys up by factors of 10. the biggest
+// count, 10M by default, can be passed as the first argument, 100M needs about 4GB.
+
+typedef struct BenchPair32
+{
+	uint32 key;
+	int32 value;
+} BenchPair32;
+
+typedef struct BenchPair64
+{
+	uint64 key;
+	int32 value;
+} BenchPair64;
+
+static int ComparePairs32(const void* a, const void* b)
+{
+	uint32 x = ((const BenchPair32*)a)->key, y = ((const BenchPair32*)b)->key;
+	return (x > y)-(x < y);
+}
+
+static int ComparePairs64(const void* a, const void* b)
+{
+	uint64 x = ((const BenchPair64*)a)->key, y = ((const BenchPair64*)b)->key;
+	return (x > y)-(x < y);
+}
+
+static uint64 GetRandom64(uint32* state)
+{
+	uint64 high = Bench_Random(state);
+	return high << 32 | Bench_Random(state);
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int64 maxCount = Bench_GetArg(argc, argv, 1, 10000000);
+	uint32 random = 1;
+	char name[96];
+	double nanoseconds;
+	for (int64 count = 1000; count <= maxCount; count *= 10)
+	{
+		// about the same total work per count, at least 2 runs.
+		int32 repetitions = (int32)MaxI64(10000000/count, 2);
+		void* pairs = MAlloc(count*sizeof(BenchPair64));
+		uint64* keys = (uint64*)MAlloc(count*sizeof(uint64));
+		int32* values = (int32*)MAlloc(count*sizeof(int32));
+		void* scratch = MAlloc(RadixSort_GetScratchSize(count, 8, true));
+
+		// the timed runs sort already sorted arrays after the first one, so each run refills its input. that's counted
+		// in every time, the same for each sort.
+		BenchPair32* pairs32 = (BenchPair32*)pairs;
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			for (int64 i = 0; i < count; i++)
+			{
+				pairs32[i] = (BenchPair32){ Bench_Random(&random), (int32)i };
+			}
+			qsort(pairs32, count, sizeof(BenchPair32), ComparePairs32);
+		}
+		SPrintF(name, sizeof(name), "%lld u32 keys, qsort", (long long)count);
+		Bench_Report(name, nanoseconds, count);
+
+		uint32* keys32 = (uint32*)keys;
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			for (int64 i = 0; i < count; i++)
+			{
+				keys32[i] = Bench_Random(&random);
+				values[i] = (int32)i;
+			}
+			RadixSort_U32(keys32, values, count, scratch);
+		}
+		SPrintF(name, sizeof(name), "%lld u32 keys, RadixSort_U32", (long long)count);
+		Bench_Report(name, nanoseconds, count);
+
+		BenchPair64* pairs64 = (BenchPair64*)pairs;
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			for (int64 i = 0; i < count; i++)
+			{
+				pairs64[i] = (BenchPair64){ GetRandom64(&random), (int32)i };
+			}
+			qsort(pairs64, count, sizeof(BenchPair64), ComparePairs64);
+		}
+		SPrintF(name, sizeof(name), "%lld u64 keys, qsort", (long long)count);
+		Bench_Report(name, nanoseconds, count);
+
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			for (int64 i = 0; i < count; i++)
+			{
+				keys[i] = GetRandom64(&random);
+				values[i] = (int32)i;
+			}
+			RadixSort_U64(keys, values, count, scratch);
+		}
+		SPrintF(name, sizeof(name), "%lld u64 keys, RadixSort_U64", (long long)count);
+		Bench_Report(name, nanoseconds, count);
+
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			for (int64 i = 0; i < count; i++)
+			{
+				keys[i] = GetRandom64(&random);
+				values[i] = (int32)i;
+			}
+			RadixSort_U64Parallel(keys, values, count, scratch, 0);
+		}
+		SPrintF(name, sizeof(name), "%lld u64 keys, RadixSort_U64Parallel", (long long)count);
+		Bench_Report(name, nanoseconds, count);
+
+		// just the refill, to subtract from the times above.
+		Bench_Repeat(nanoseconds, repetitions)
+		{
+			for (int64 i = 0; i < count; i++)
+			{
+				keys[i] = GetRandom64(&random);
+				values[i] = (int32)i;
+			}
+		}
+		gBenchSink += keys[count/2];
+		SPrintF(name, sizeof(name), "%lld u64 keys, filling only", (long long)count);
+		Bench_Report(name, nanoseconds, count);
+
+		MFree(scratch);
+		MFree(values);
+		MFree(keys);
+		MFree(pairs);
+	}
+	return 0;
+}
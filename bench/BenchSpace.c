@@ -0,0 +1,161 @@
+#include "Bench.h"
+
+#include "common/Math.h"
+#include "common/Space.h"
+
+// ns per call of the simd kernels and their scalar references, over arrays small enough to stay in l1 so the loop
+// measures the arithmetic and not memory. after them, a hierarchy of rigid nodes, 100k by default or the first
+// argument, is composed into world transforms parent first as Matrix4, Transformer and RigidTransform, and inverted.
+
+#define BenchSpace_InputCount 1024
+#define BenchSpace_Passes 4000
+
+static Matrix4 matrices[BenchSpace_InputCount];
+static Transformer transformers[BenchSpace_InputCount];
+static Vec4 points[BenchSpace_InputCount];
+
+static Matrix4 matrixResults[BenchSpace_InputCount];
+static Transformer transformerResults[BenchSpace_InputCount];
+static Vec4 pointResults[BenchSpace_InputCount];
+
+// call is evaluated for every input index i and written to results[i].
+#define BenchSpace_Kernel(name, results, call) \
+{ \
+	double nanoseconds; \
+	Bench_Repeat(nanoseconds, 5) \
+	{ \
+		for (int32 pass = 0; pass < BenchSpace_Passes; pass++) \
+		{ \
+			for (int32 i = 0; i < BenchSpace_InputCount; i++) \
+			{ \
+				int32 j = (i+pass) & (BenchSpace_InputCount-1); \
+				results[i] = call; \
+			} \
+			uint32 resultBits; \
+			MemCpy(&resultBits, &results[pass & (BenchSpace_InputCount-1)], sizeof(uint32)); \
+			gBenchSink += resultBits; \
+		} \
+	} \
+	Bench_Report(name, nanoseconds, (int64)BenchSpace_Passes*BenchSpace_InputCount); \
+}
+
+// each node's parent comes before it, at most 8 nodes back so the parent is still in cache like in a flattened hierarchy.
+#define BenchSpace_Hierarchy(name, locals, worlds, multiply) \
+{ \
+	double nanoseconds; \
+	Bench_Repeat(nanoseconds, 5) \
+	{ \
+		worlds[0] = locals[0]; \
+		for (int32 i = 1; i < nodeCount; i++) \
+		{ \
+			worlds[i] = multiply(&locals[i], &worlds[parents[i]]); \
+		} \
+	} \
+	uint32 resultBits; \
+	MemCpy(&resultBits, &worlds[nodeCount-1], sizeof(uint32)); \
+	gBenchSink += resultBits; \
+	Bench_Report(name, nanoseconds, nodeCount); \
+}
+
+#define BenchSpace_Inverse(name, worlds, results, inverse) \
+{ \
+	double nanoseconds; \
+	Bench_Repeat(nanoseconds, 5) \
+	{ \
+		for (int32 i = 0; i < nodeCount; i++) \
+		{ \
+			results[i] = inverse(&worlds[i]); \
+		} \
+	} \
+	uint32 resultBits; \
+	MemCpy(&resultBits, &results[nodeCount-1], sizeof(uint32)); \
+	gBenchSink += resultBits; \
+	Bench_Report(name, nanoseconds, nodeCount); \
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	printf("simd: sse2 %d, avx %d, fma %d\n", SIMD_SSE2, SIMD_AVX, SIMD_FMA);
+
+	uint32 random = 1;
+	for (int32 i = 0; i < BenchSpace_InputCount; i++)
+	{
+		for (int32 k = 0; k < 16; k++)
+		{
+			(&matrices[i].values[0][0])[k] = Bench_RandomFloat(&random, -2, 2);
+		}
+		for (int32 k = 0; k < 4; k++)
+		{
+			matrices[i].values[k][k] += 8;
+		}
+		for (int32 k = 0; k < 9; k++)
+		{
+			(&transformers[i].mat.values[0][0])[k] = Bench_RandomFloat(&random, -2, 2);
+		}
+		transformers[i].pos = Vec3_New(Bench_RandomFloat(&random, -2, 2), Bench_RandomFloat(&random, -2, 2), Bench_RandomFloat(&random, -2, 2));
+		points[i] = Vec4_New(Bench_RandomFloat(&random, -2, 2), Bench_RandomFloat(&random, -2, 2), Bench_RandomFloat(&random, -2, 2), 1);
+	}
+
+	BenchSpace_Kernel("Matrix4_Multiply", matrixResults, Matrix4_Multiply(&matrices[i], &matrices[j]));
+	BenchSpace_Kernel("Matrix4_MultiplyScalar", matrixResults, Matrix4_MultiplyScalar(&matrices[i], &matrices[j]));
+	BenchSpace_Kernel("Matrix4_Inverse", matrixResults, Matrix4_Inverse(&matrices[j]));
+	BenchSpace_Kernel("Matrix4_InverseScalar", matrixResults, Matrix4_InverseScalar(&matrices[j]));
+	BenchSpace_Kernel("Matrix4_Transpose", matrixResults, Matrix4_Transpose(&matrices[j]));
+	BenchSpace_Kernel("Matrix4_TransposeScalar", matrixResults, Matrix4_TransposeScalar(&matrices[j]));
+	BenchSpace_Kernel("Matrix4_ApplyPoint4", pointResults, Matrix4_ApplyPoint4(&matrices[j], points[i]));
+	BenchSpace_Kernel("Matrix4_ApplyPoint4Scalar", pointResults, Matrix4_ApplyPoint4Scalar(&matrices[j], points[i]));
+	BenchSpace_Kernel("Transformer_Multiply", transformerResults, Transformer_Multiply(&transformers[i], &transformers[j]));
+	BenchSpace_Kernel("Transformer_MultiplyScalar", transformerResults, Transformer_MultiplyScalar(&transformers[i], &transformers[j]));
+
+	int32 nodeCount = (int32)Bench_GetArg(argc, argv, 1, 100000);
+	int32* parents = (int32*)MAlloc(nodeCount*sizeof(int32));
+	RigidTransform* rigidLocals = (RigidTransform*)MAlloc(nodeCount*sizeof(RigidTransform));
+	RigidTransform* rigidWorlds = (RigidTransform*)MAlloc(nodeCount*sizeof(RigidTransform));
+	Transformer* transformerLocals = (Transformer*)MAlloc(nodeCount*sizeof(Transformer));
+	Transformer* transformerWorlds = (Transformer*)MAlloc(nodeCount*sizeof(Transformer));
+	Matrix4* matrixLocals = (Matrix4*)MAlloc(nodeCount*sizeof(Matrix4));
+	Matrix4* matrixWorlds = (Matrix4*)MAlloc(nodeCount*sizeof(Matrix4));
+	for (int32 i = 0; i < nodeCount; i++)
+	{
+		parents[i] = i > 0 ? i-1-(int32)(Bench_Random(&random)%(uint32)MinI(i, 8)) : -1;
+		Quat rot = Quat_Normalize(Quat_New(Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1)));
+		Vec3 pos = Vec3_New(Bench_RandomFloat(&random, -2, 2), Bench_RandomFloat(&random, -2, 2), Bench_RandomFloat(&random, -2, 2));
+		rigidLocals[i] = RigidTransform_New(rot, pos, 1);
+		transformerLocals[i] = RigidTransform_ToTransformer(&rigidLocals[i]);
+		matrixLocals[i] = Transformer_ToMatrix4(&transformerLocals[i]);
+	}
+
+	char name[96];
+	SPrintF(name, sizeof(name), "%d node hierarchy, Matrix4_Multiply", nodeCount);
+	BenchSpace_Hierarchy(name, matrixLocals, matrixWorlds, Matrix4_Multiply);
+	SPrintF(name, sizeof(name), "%d node hierarchy, Transformer_Multiply", nodeCount);
+	BenchSpace_Hierarchy(name, transformerLocals, transformerWorlds, Transformer_Multiply);
+	SPrintF(name, sizeof(name), "%d node hierarchy, RigidTransform_Multiply", nodeCount);
+	BenchSpace_Hierarchy(name, rigidLocals, rigidWorlds, RigidTransform_Multiply);
+
+	// the locals are rigid, so Transformer_Inverse takes the transpose. deep in the hierarchy the composed worlds have
+	// drifted past the rigid tolerance and take Matrix3_Inverse, the last line. the inverses overwrite the arrays not read.
+	SPrintF(name, sizeof(name), "%d node inverses, Matrix4_Inverse", nodeCount);
+	BenchSpace_Inverse(name, matrixLocals, matrixWorlds, Matrix4_Inverse);
+	SPrintF(name, sizeof(name), "%d node inverses, Transformer_Inverse", nodeCount);
+	BenchSpace_Inverse(name, transformerLocals, transformerWorlds, Transformer_Inverse);
+	SPrintF(name, sizeof(name), "%d node inverses, RigidTransform_Inverse", nodeCount);
+	BenchSpace_Inverse(name, rigidLocals, rigidWorlds, RigidTransform_Inverse);
+	transformerWorlds[0] = transformerLocals[0];
+	for (int32 i = 1; i < nodeCount; i++)
+	{
+		transformerWorlds[i] = Transformer_Multiply(&transformerLocals[i], &transformerWorlds[parents[i]]);
+	}
+	SPrintF(name, sizeof(name), "%d node inverses, Transformer_Inverse of worlds", nodeCount);
+	BenchSpace_Inverse(name, transformerWorlds, transformerLocals, Transformer_Inverse);
+
+	MFree(matrixWorlds);
+	MFree(matrixLocals);
+	MFree(transformerWorlds);
+	MFree(transformerLocals);
+	MFree(rigidWorlds);
+	MFree(rigidLocals);
+	MFree(parents);
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include "Bench.h"
+
+#include "common/SpaceBatch.h"
+
+// points per second of the batch transforms next to a loop of Matrix4_ApplyPoint, for batches from 1k points that
+// stay in l1 up to ones far past the last level cache where the output is streamed. each mode is run as array of
+// structures and structure of arrays, on one thread and split over every hardware thread. the largest count, 10M by
+// default, can be passed as the first argument, 100M needs about 5 GB.
+
+// small batches are repeated until a run covers this many points, so it's long enough to time.
+#define BenchSpaceBatch_MinPointsPerRun (4*1024*1024)
+
+static Vec3 ApplyScalar(const Matrix4* matrix, const Matrix3* normalMatrix, PointTransformMode mode, const Vec3 point)
+{
+	if (mode == PointTransformMode_Affine)
+	{
+		return Matrix4_ApplyPoint(matrix, point);
+	}
+	else if (mode == PointTransformMode_Projective)
+	{
+		Vec4 projected = Matrix4_ApplyPoint4(matrix, Vec4_New(point.x, point.y, point.z, 1));
+		return Vec3_New(projected.x/projected.w, projected.y/projected.w, projected.z/projected.w);
+	}
+	return Vec3_Normalize(Matrix3_ApplyPoint(normalMatrix, point));
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	printf("simd: sse2 %d, avx %d, fma %d\n", SIMD_SSE2, SIMD_AVX, SIMD_FMA);
+	int64 maxCount = Bench_GetArg(argc, argv, 1, 10*1000*1000);
+
+	uint32 random = 1;
+	Matrix4 matrix = Matrix4_identity;
+	for (int32 y = 0; y < 3; y++)
+	{
+		for (int32 x = 0; x < 3; x++)
+		{
+			matrix.values[y][x] = Bench_RandomFloat(&random, -1, 1)+(x == y ? 3 : 0);
+		}
+		matrix.values[3][y] = Bench_RandomFloat(&random, -100, 100);
+	}
+	// a perspective divide by z+0.5.
+	matrix.values[2][3] = 1;
+	matrix.values[3][3] = 0.5f;
+	Transformer transformer = Transformer_FromMatrix4(&matrix);
+	Matrix3 inverse = Matrix3_Inverse(&transformer.mat);
+	Matrix3 normalMatrix = Matrix3_Transpose(&inverse);
+
+	Vec3* points = (Vec3*)MAlloc(maxCount*sizeof(Vec3));
+	Vec3* outPoints = (Vec3*)MAlloc(maxCount*sizeof(Vec3));
+	Vec3SoA pointsSoA, outPointsSoA;
+	float** arrays[6] = { &pointsSoA.x, &pointsSoA.y, &pointsSoA.z, &outPointsSoA.x, &outPointsSoA.y, &outPointsSoA.z };
+	for (int32 i = 0; i < 6; i++)
+	{
+		*arrays[i] = (float*)MAlloc(maxCount*sizeof(float));
+	}
+	for (int64 i = 0; i < maxCount; i++)
+	{
+		points[i] = Vec3_New(Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, -1, 1), Bench_RandomFloat(&random, 1, 10));
+		pointsSoA.x[i] = points[i].x;
+		pointsSoA.y[i] = points[i].y;
+		pointsSoA.z[i] = points[i].z;
+	}
+
+	const char* modeNames[PointTransformMode_Count] = { "affine", "projective", "normal" };
+	char name[96];
+	double nanoseconds;
+	for (int64 count = 1000; count <= maxCount; count *= 10)
+	{
+		int64 passes = MaxI64(1, BenchSpaceBatch_MinPointsPerRun/count);
+		int32 repetitions = count >= 10*1000*1000 ? 3 : 5;
+		for (int32 mode = 0; mode < PointTransformMode_Count; mode++)
+		{
+			Bench_Repeat(nanoseconds, repetitions)
+			{
+				for (int64 pass = 0; pass < passes; pass++)
+				{
+					for (int64 i = 0; i < count; i++)
+					{
+						outPoints[i] = ApplyScalar(&matrix, &normalMatrix, (PointTransformMode)mode, points[i]);
+					}
+				}
+			}
+			SPrintF(name, sizeof(name), "%lld %s, point at a time", (long long)count, modeNames[mode]);
+			Bench_Report(name, nanoseconds, count*passes);
+
+			Bench_Repeat(nanoseconds, repetitions)
+			{
+				for (int64 pass = 0; pass < passes; pass++)
+				{
+					Matrix4_TransformPoints(&matrix, (PointTransformMode)mode, points, outPoints, count);
+				}
+			}
+			SPrintF(name, sizeof(name), "%lld %s, Matrix4_TransformPoints", (long long)count, modeNames[mode]);
+			Bench_Report(name, nanoseconds, count*passes);
+
+			Bench_Repeat(nanoseconds, repetitions)
+			{
+				for (int64 pass = 0; pass < passes; pass++)
+				{
+					Matrix4_TransformPointsSoA(&matrix, (PointTransformMode)mode, &pointsSoA, &outPointsSoA, count);
+				}
+			}
+			SPrintF(name, sizeof(name), "%lld %s, Matrix4_TransformPointsSoA", (long long)count, modeNames[mode]);
+			Bench_Report(name, nanoseconds, count*passes);
+
+			// below SpaceBatch_MinPointsPerThread these are the same as the single thread versions.
+			if (count >= 2*SpaceBatch_MinPointsPerThread)
+			{
+				Bench_Repeat(nanoseconds, repetitions)
+				{
+					for (int64 pass = 0; pass < passes; pass++)
+					{
+						Matrix4_TransformPointsParallel(&matrix, (PointTransformMode)mode, points, outPoints, count, 0);
+					}
+				}
+				SPrintF(name, sizeof(name), "%lld %s, parallel", (long long)count, modeNames[mode]);
+				Bench_Report(name, nanoseconds, count*passes);
+
+				Bench_Repeat(nanoseconds, repetitions)
+				{
+					for (int64 pass = 0; pass < passes; pass++)
+					{
+						Matrix4_TransformPointsSoAParallel(&matrix, (PointTransformMode)mode, &pointsSoA, &outPointsSoA, count, 0);
+					}
+				}
+				SPrintF(name, sizeof(name), "%lld %s, SoA parallel", (long long)count, modeNames[mode]);
+				Bench_Report(name, nanoseconds, count*passes);
+			}
+		}
+		uint32 resultBits;
+		MemCpy(&resultBits, &outPoints[count/2], sizeof(uint32));
+		gBenchSink += resultBits;
+		MemCpy(&resultBits, &outPointsSoA.x[count/2], sizeof(uint32));
+		gBenchSink += resultBits;
+	}
+
+	for (int32 i = 0; i < 6; i++)
+	{
+		MFree(*arrays[i]);
+	}
+	MFree(outPoints);
+	MFree(points);
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include "Bench.h"
+
+#include "common/Math.h"
+#include "common/SpatialGrid.h"
+
+// 100k objects moving through a 1000x1000x50 world at up to 10 units per second, stepped at 60 hz. a frame moves every
+// object, or rebuilds the grid, and then queries a radius of 4 around each object. the object count can be passed as
+// the first argument.
+
+#define BenchSpatialGrid_QueryCapacity 4096
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 count = (int32)Bench_GetArg(argc, argv, 1, 100000);
+	float* arrays[7];
+	for (int32 i = 0; i < 7; i++)
+	{
+		arrays[i] = (float*)MAlloc(count*sizeof(float));
+	}
+	float *x = arrays[0], *y = arrays[1], *z = arrays[2], *vx = arrays[3], *vy = arrays[4], *vz = arrays[5], *radii = arrays[6];
+	uint32 random = 1;
+	for (int32 i = 0; i < count; i++)
+	{
+		x[i] = Bench_RandomFloat(&random, 0, 1000);
+		y[i] = Bench_RandomFloat(&random, 0, 1000);
+		z[i] = Bench_RandomFloat(&random, 0, 50);
+		vx[i] = Bench_RandomFloat(&random, -10, 10)/60;
+		vy[i] = Bench_RandomFloat(&random, -10, 10)/60;
+		vz[i] = Bench_RandomFloat(&random, -2, 2)/60;
+		radii[i] = Bench_RandomFloat(&random, 0.25f, 1);
+	}
+	Vec3SoA positions = { x, y, z };
+	int32* handles = (int32*)MAlloc(BenchSpatialGrid_QueryCapacity*sizeof(int32));
+	char name[96];
+	double nanoseconds;
+
+	float cellSizes[] = { 8, 16, 32 };
+	for (int32 c = 0; c < ArrayCountOf(cellSizes); c++)
+	{
+		SpatialGrid grid;
+		SpatialGrid_Init(&grid, cellSizes[c]);
+		SpatialGrid_Rebuild(&grid, &positions, radii, count);
+
+		Bench_Repeat(nanoseconds, 20)
+		{
+			for (int32 i = 0; i < count; i++)
+			{
+				x[i] += vx[i];
+				y[i] += vy[i];
+				z[i] += vz[i];
+				SpatialGrid_Move(&grid, i, Vec3_New(x[i], y[i], z[i]));
+			}
+		}
+		SPrintF(name, sizeof(name), "cell %g, %d SpatialGrid_Move", cellSizes[c], count);
+		Bench_Report(name, nanoseconds, count);
+
+		Bench_Repeat(nanoseconds, 20)
+		{
+			SpatialGrid_Rebuild(&grid, &positions, radii, count);
+		}
+		SPrintF(name, sizeof(name), "cell %g, SpatialGrid_Rebuild of %d", cellSizes[c], count);
+		Bench_Report(name, nanoseconds, count);
+
+		int64 found = 0;
+		Bench_Repeat(nanoseconds, 5)
+		{
+			found = 0;
+			for (int32 i = 0; i < count; i++)
+			{
+				found += SpatialGrid_QuerySphere(&grid, Vec3_New(x[i], y[i], z[i]), 4, handles, BenchSpatialGrid_QueryCapacity);
+			}
+		}
+		SPrintF(name, sizeof(name), "cell %g, %d QuerySphere r 4 (%.1f found)", cellSizes[c], count, (double)found/count);
+		Bench_Report(name, nanoseconds, count);
+
+		Bench_Repeat(nanoseconds, 5)
+		{
+			found = 0;
+			for (int32 i = 0; i < count; i++)
+			{
+				Aabb box = { Vec3_New(x[i]-4, y[i]-4, z[i]-4), Vec3_New(x[i]+4, y[i]+4, z[i]+4) };
+				found += SpatialGrid_QueryAabb(&grid, box, handles, BenchSpatialGrid_QueryCapacity);
+			}
+		}
+		SPrintF(name, sizeof(name), "cell %g, %d QueryAabb 8^3 (%.1f found)", cellSizes[c], count, (double)found/count);
+		Bench_Report(name, nanoseconds, count);
+		gBenchSink += found;
+		SpatialGrid_Free(&grid);
+	}
+
+	// the same queries tested against every object, for a few of them.
+	int32 bruteForceCount = MinI(count, 200);
+	int64 found = 0;
+	Bench_Repeat(nanoseconds, 3)
+	{
+		found = 0;
+		for (int32 q = 0; q < bruteForceCount; q++)
+		{
+			for (int32 i = 0; i < count; i++)
+			{
+				float dx = x[i]-x[q], dy = y[i]-y[q], dz = z[i]-z[q], reach = 4+radii[i];
+				found += dx*dx+dy*dy+dz*dz <= reach*reach;
+			}
+		}
+	}
+	gBenchSink += found;
+	SPrintF(name, sizeof(name), "%d brute force sphere queries", bruteForceCount);
+	Bench_Report(name, nanoseconds, bruteForceCount);
+
+	MFree(handles);
+	for (int32 i = 0; i < 7; i++)
+	{
+		MFree(arrays[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include "Bench.h"
+
+#include "common/Math.h"
+#include "common/Thread.h"
+#include "common/TransformHierarchy.h"
+
+// 1000 objects of 1000 nodes each, random trees under each object's root. a frame either moves every root, which
+// recomputes every node, or changes the locals of 1% of the nodes picked at random. the node count can be passed as the
+// first argument.
+
+#define BenchTransformHierarchy_NodesPerObject 1000
+
+static Transformer MakeRandomTransformer(uint32* random)
+{
+	Vec3 axis = Vec3_Normalize(Vec3_New(Bench_RandomFloat(random, -1, 1), Bench_RandomFloat(random, -1, 1), Bench_RandomFloat(random, 1, 3)));
+	Transformer result;
+	result.mat = Matrix3_FromAxisAngle(axis, Bench_RandomFloat(random, -1, 1));
+	result.pos = Vec3_New(Bench_RandomFloat(random, -1, 1), Bench_RandomFloat(random, -1, 1), Bench_RandomFloat(random, -1, 1));
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	Bench_Init();
+	int32 objectCount = MaxI((int32)(Bench_GetArg(argc, argv, 1, 1000000)/BenchTransformHierarchy_NodesPerObject), 1);
+	int32 count = objectCount*BenchTransformHierarchy_NodesPerObject;
+	int32* handles = (int32*)MAlloc(count*sizeof(int32));
+	Transformer* locals = (Transformer*)MAlloc(count*sizeof(Transformer));
+	uint32 random = 1;
+	for (int32 i = 0; i < count; i++)
+	{
+		locals[i] = MakeRandomTransformer(&random);
+	}
+	char name[96];
+	double nanoseconds;
+
+	TransformHierarchy hierarchy;
+	TransformHierarchy_Init(&hierarchy);
+	// added breadth first over the objects, so every object's nodes need sorting into place.
+	uint64 startCycles = GetCycles();
+	for (int32 i = 0; i < BenchTransformHierarchy_NodesPerObject; i++)
+	{
+		for (int32 o = 0; o < objectCount; o++)
+		{
+			int32 node = o*BenchTransformHierarchy_NodesPerObject+i;
+			int32 parent = i == 0 ? -1 : handles[o*BenchTransformHierarchy_NodesPerObject+Bench_Random(&random)%i];
+			handles[node] = TransformHierarchy_Add(&hierarchy, parent, &locals[node]);
+		}
+	}
+	Bench_Report("TransformHierarchy_Add", (double)(GetCycles()-startCycles)*1e9/(double)GetCycleFrequency(), count);
+	startCycles = GetCycles();
+	TransformHierarchy_Update(&hierarchy);
+	SPrintF(name, sizeof(name), "%d nodes, sort and first update", count);
+	Bench_Report(name, (double)(GetCycles()-startCycles)*1e9/(double)GetCycleFrequency(), count);
+
+	int32 threadCount = Thread_GetHardwareThreadCount();
+	for (int32 parallel = 0; parallel < 2; parallel++)
+	{
+		Bench_Repeat(nanoseconds, 10)
+		{
+			for (int32 o = 0; o < objectCount; o++)
+			{
+				int32 node = o*BenchTransformHierarchy_NodesPerObject;
+				locals[node].pos.x += 0.01f;
+				TransformHierarchy_SetLocal(&hierarchy, handles[node], &locals[node]);
+			}
+			if (parallel)
+			{
+				TransformHierarchy_UpdateParallel(&hierarchy, threadCount);
+			}
+			else
+			{
+				TransformHierarchy_Update(&hierarchy);
+			}
+		}
+		SPrintF(name, sizeof(name), "%d nodes, every root moved, %s", count, parallel ? "parallel" : "serial");
+		Bench_Report(name, nanoseconds, count);
+
+		int64 updatedCount = 0;
+		Bench_Repeat(nanoseconds, 10)
+		{
+			for (int32 k = 0; k < count/100; k++)
+			{
+				int32 node = (int32)(Bench_Random(&random)%count);
+				TransformHierarchy_SetLocal(&hierarchy, handles[node], &locals[node]);
+			}
+			if (parallel)
+			{
+				TransformHierarchy_UpdateParallel(&hierarchy, threadCount);
+			}
+			else
+			{
+				TransformHierarchy_Update(&hierarchy);
+			}
+			updatedCount = 0;
+			for (int32 r = 0; r < hierarchy.updatedRangeCount; r++)
+			{
+				updatedCount += hierarchy.updatedRanges[r].count;
+			}
+		}
+		SPrintF(name, sizeof(name), "%d nodes, 1%% changed, %s (%.1f%% recomputed)", count, parallel ? "parallel" : "serial", updatedCount*100.0/count);
+		Bench_Report(name, nanoseconds, count);
+	}
+	gBenchSink += (uint64)hierarchy.worlds[count/2].pos.x;
+
+	TransformHierarchy_Free(&hierarchy);
+	MFree(locals);
+	MFree(handles);
+	return 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common/Standard.h"
+#include "common/Time.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// each test is its own executable. main runs the cases with Test_Run and returns Test_Finish, which ctest reads as the
+// result. failed checks print where they failed and the case carries on, so one run shows every failure.
+
+static int32 testFailureCount;
+static const char* testCurrentCase;
+
+static inline void Test_Fail(const char* file, int32 line, const char* message)
+{
+	testFailureCount++;
+	printf("%s:%d: %s failed: %s\n", file, line, testCurrentCase ? testCurrentCase : "", message);
+	fflush(stdout);
+}
+
+#define Test_Check(expression) if (!(expression)) { Test_Fail(__FILE__, __LINE__, #expression); }
+#define Test_CheckMessage(expression, format, ...) if (!(expression)) { char testMessage[512]; snprintf(testMessage, sizeof(testMessage), format, ##__VA_ARGS__); Test_Fail(__FILE__, __LINE__, testMessage); }
+#define Test_CheckNear(a, b, tolerance) Test_CheckMessage(fabs((double)(a)-(double)(b)) <= (double)(tolerance), "%s = %.9g, %s = %.9g, tolerance %.3g", #a, (double)(a), #b, (double)(b), (double)(tolerance))
+
+#define Test_Run(function) { testCurrentCase = #function; int32 failuresBefore = testFailureCount; function(); printf("%s %s\n", failuresBefore == testFailureCount ? "passed" : "FAILED", #function); fflush(stdout); testCurrentCase = null; }
+
+// deterministic random numbers so failures reproduce.
+static inline uint32 Test_Random(uint32* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// in [min, max).
+static inline float Test_RandomFloat(uint32* state, float min, float max)
+{
+	return min+(max-min)*(float)(Test_Random(state) >> 8)*(1.0f/16777216.0f);
+}
+
+static inline void Test_Init()
+{
+	InitTime();
+}
+
+// memory the tests allocated and didn't free counts as a failure in the dev configs.
+static inline int Test_Finish()
+{
+	if (MAlloc_DetectLeaks())
+	{
+		testFailureCount++;
+		printf("memory leaked.\n");
+	}
+	printf("%d failed checks.\n", testFailureCount);
+	return testFailureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+#include "Test.h"
+
+#include "common/Bvh.h"
+
+// a bumpy heightfield on the xy plane with random triangles floating above it.
+static Vec3* MakeScene(int32 gridSize, int32 clutterCount, uint32* random, int32* outTriangleCount)
+{
+	int32 triangleCount = (gridSize-1)*(gridSize-1)*2+clutterCount;
+	Vec3* vertices = (Vec3*)MAlloc(triangleCount*3*sizeof(Vec3));
+	int32 k = 0;
+	for (int32 y = 0; y < gridSize-1; y++)
+	{
+		for (int32 x = 0; x < gridSize-1; x++)
+		{
+			Vec3 corners[4];
+			for (int32 i = 0; i < 4; i++)
+			{
+				float px = (float)(x+(i & 1)), py = (float)(y+(i >> 1));
+				corners[i] = Vec3_New(px, py, 3*sinf(px*0.05f)*cosf(py*0.07f));
+			}
+			vertices[k++] = corners[0]; vertices[k++] = corners[1]; vertices[k++] = corners[2];
+			vertices[k++] = corners[1]; vertices[k++] = corners[3]; vertices[k++] = corners[2];
+		}
+	}
+	for (int32 i = 0; i < clutterCount; i++)
+	{
+		Vec3 center = Vec3_New(Test_RandomFloat(random, 0, (float)gridSize), Test_RandomFloat(random, 0, (float)gridSize), Test_RandomFloat(random, 0, 20));
+		for (int32 j = 0; j < 3; j++)
+		{
+			vertices[k++] = Vec3_Add(center, Vec3_New(Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1)));
+		}
+	}
+	*outTriangleCount = triangleCount;
+	return vertices;
+}
+
+static bool SphereOverlapsAabb(const Aabb* box, Vec3 center, float radius)
+{
+	float dx = Max(Max(box->min.x-center.x, center.x-box->max.x), 0);
+	float dy = Max(Max(box->min.y-center.y, center.y-box->max.y), 0);
+	float dz = Max(Max(box->min.z-center.z, center.z-box->max.z), 0);
+	return dx*dx+dy*dy+dz*dz <= radius*radius;
+}
+
+// every query has to give what testing each primitive on its own gives.
+static void CheckAgainstBruteForce(int32 gridSize, int32 clutterCount, int32 threadCount, int32 rayCount)
+{
+	uint32 random = 7;
+	int32 count;
+	Vec3* vertices = MakeScene(gridSize, clutterCount, &random, &count);
+	BvhTriangles triangles = { vertices, null };
+	Aabb* bounds = (Aabb*)MAlloc(count*sizeof(Aabb));
+	BvhTriangles_GetBounds(&triangles, count, bounds);
+	Bvh bvh;
+	Bvh_Build(&bvh, bounds, count, threadCount);
+
+	char* seen = (char*)MAlloc(count);
+	MemSet(seen, 0, count);
+	for (int32 i = 0; i < bvh.nodeCount; i++)
+	{
+		for (int32 p = 0; p < bvh.nodes[i].primitiveCount; p++)
+		{
+			seen[bvh.primitives[bvh.nodes[i].skipOrFirst+p]]++;
+		}
+	}
+	int32 misplaced = 0;
+	for (int32 i = 0; i < count; i++)
+	{
+		misplaced += seen[i] != 1;
+	}
+	Test_Check(misplaced == 0);
+
+	int32* overlaps = (int32*)MAlloc(count*sizeof(int32));
+	float extent = (float)gridSize;
+	for (int32 pass = 0; pass < 2; pass++)
+	{
+		int32 closestMismatches = 0, anyMismatches = 0, boxMismatches = 0, sphereMismatches = 0;
+		for (int32 r = 0; r < rayCount; r++)
+		{
+			Vec3 origin = Vec3_New(Test_RandomFloat(&random, -5, extent+5), Test_RandomFloat(&random, -5, extent+5), Test_RandomFloat(&random, -5, 25));
+			Vec3 dir = Vec3_New(Test_RandomFloat(&random, -1, 1), Test_RandomFloat(&random, -1, 1), Test_RandomFloat(&random, -1, 1));
+			if (r & 1)
+			{
+				origin.z = 30;
+				dir = Vec3_New(Test_RandomFloat(&random, -0.5f, 0.5f), Test_RandomFloat(&random, -0.5f, 0.5f), -1);
+			}
+			float closest = 1000;
+			int32 closestPrimitive = -1;
+			for (int32 i = 0; i < count; i++)
+			{
+				float dist;
+				if (BvhTriangles_RayHit(&triangles, i, origin, dir, closest, &dist))
+				{
+					closest = dist;
+					closestPrimitive = i;
+				}
+			}
+			BvhHit hit;
+			bool hitFound = Bvh_RayCastClosest(&bvh, origin, dir, 1000, BvhTriangles_RayHit, &triangles, &hit);
+			closestMismatches += hitFound != (closestPrimitive >= 0) || (hitFound && hit.dist != closest);
+			anyMismatches += Bvh_RayCastAny(&bvh, origin, dir, 1000, BvhTriangles_RayHit, &triangles) != hitFound;
+
+			Aabb box = { origin, Vec3_Add(origin, Vec3_New(3, 2, 4)) };
+			int32 boxCount = 0, sphereCount = 0;
+			for (int32 i = 0; i < count; i++)
+			{
+				boxCount += Aabb_Overlaps(bounds[i], box);
+				sphereCount += SphereOverlapsAabb(&bounds[i], origin, 3);
+			}
+			boxMismatches += Bvh_OverlapAabb(&bvh, box, overlaps, count) != boxCount;
+			sphereMismatches += Bvh_OverlapSphere(&bvh, origin, 3, overlaps, count) != sphereCount;
+		}
+		Test_CheckMessage(closestMismatches == 0, "pass %d: %d closest hits differ", pass, closestMismatches);
+		Test_CheckMessage(anyMismatches == 0, "pass %d: %d any hits differ", pass, anyMismatches);
+		Test_CheckMessage(boxMismatches == 0, "pass %d: %d box overlaps differ", pass, boxMismatches);
+		Test_CheckMessage(sphereMismatches == 0, "pass %d: %d sphere overlaps differ", pass, sphereMismatches);
+
+		// the second pass runs on a refitted tree after every vertex moved.
+		for (int32 i = 0; i < count*3; i++)
+		{
+			vertices[i] = Vec3_Add(vertices[i], Vec3_New(sinf(i*0.01f), 0.5f, cosf(i*0.02f)));
+		}
+		BvhTriangles_GetBounds(&triangles, count, bounds);
+		Bvh_Refit(&bvh, bounds);
+	}
+
+	Bvh_Free(&bvh);
+	MFree(overlaps);
+	MFree(seen);
+	MFree(bounds);
+	MFree(vertices);
+}
+
+static void TestSmallScene()
+{
+	CheckAgainstBruteForce(40, 500, 1, 5000);
+}
+
+static void TestParallelBuild()
+{
+	CheckAgainstBruteForce(300, 100000, 4, 300);
+}
+
+// rays running exactly along a face of a box, with a 0 direction component, touch it and hit it.
+static void TestRayAlongFace()
+{
+	Aabb bounds[100];
+	for (int32 i = 0; i < 100; i++)
+	{
+		Vec3 min = Vec3_New((float)(i%10)*10, (float)(i/10)*10, 5);
+		bounds[i] = (Aabb){ min, Vec3_Add(min, Vec3_New(2, 3, 4)) };
+	}
+	Bvh bvh;
+	Bvh_Build(&bvh, bounds, 100, 1);
+	int32 misses = 0, wrongHits = 0;
+	for (int32 i = 0; i < 100; i++)
+	{
+		Vec3 origins[4] =
+		{
+			Vec3_New(bounds[i].min.x+1, bounds[i].min.y, 0),
+			Vec3_New(bounds[i].min.x+1, bounds[i].max.y, 0),
+			Vec3_New(bounds[i].min.x, bounds[i].min.y+1, 0),
+			Vec3_New(bounds[i].max.x, bounds[i].max.y, 0),
+		};
+		for (int32 j = 0; j < 4; j++)
+		{
+			BvhHit hit;
+			if (!Bvh_RayCastClosest(&bvh, origins[j], Vec3_New(0, 0, 1), 100, null, null, &hit))
+			{
+				misses++;
+			}
+			else if (hit.primitive != i || hit.dist != 5)
+			{
+				wrongHits++;
+			}
+			misses += !Bvh_RayCastAny(&bvh, origins[j], Vec3_New(0, 0, 1), 100, null, null);
+			misses += !Bvh_RayCastAny(&bvh, Vec3_New(origins[j].x, origins[j].y, 20), Vec3_New(0, 0, -1), 100, null, null);
+		}
+	}
+	Test_Check(misses == 0);
+	Test_Check(wrongHits == 0);
+	// and next to a face they still miss.
+	Test_Check(!Bvh_RayCastAny(&bvh, Vec3_New(1, -0.001f, 0), Vec3_New(0, 0, 1), 100, null, null));
+	Bvh_Free(&bvh);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestSmallScene);
+	Test_Run(TestParallelBuild);
+	Test_Run(TestRayAlongFace);
+	return Test_Finish();
+}
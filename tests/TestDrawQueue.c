@@ -0,0 +1,365 @@
+#include "Test.h"
+
+#include "common/RadixSort.h"
+#include "draw/Draw.h"
+#include "draw/DrawQueue.h"
+#include "draw/Mesh.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// the queue runs on the null backend with the entries DrawQueue_Execute reaches wrapped, so every draw is logged with
+// the shader, draw state and texture it ran with. mesh draws are told apart by their vertex offset, which is the index
+// of the submit. shaders and textures only need distinct addresses, the null backend never looks inside them.
+
+#define TestDrawQueue_MaxDraws 8192
+// key fields, from DrawQueue.h.
+#define TestDrawQueue_StateBits (10+10+12+4)
+#define TestDrawQueue_DepthBits 20
+
+typedef struct TestDraw
+{
+	Shader* shader;
+	BlendMode blendMode;
+	Texture* texture;
+	// the submit index for meshes, -1 for a batch of immediate polys.
+	int32 first;
+} TestDraw;
+
+static DrawBackend backend;
+static Shader* currentShader;
+static DrawState currentState;
+static Texture* currentTexture;
+static TestDraw draws[TestDrawQueue_MaxDraws];
+static int32 drawCount;
+
+static void LogShaderSet(Shader* shader)
+{
+	currentShader = shader;
+	DrawBackendNull_Get()->shaderSet(shader);
+}
+
+static void LogDrawStateUpdate(DrawState* previousState, DrawState* state, bool forceUpdate)
+{
+	currentState = *state;
+	DrawBackendNull_Get()->drawStateUpdate(previousState, state, forceUpdate);
+}
+
+static void LogShaderSetUniformTexture(Shader* self, ShaderUniform* uniform, int32 arrayIndex, Texture* value)
+{
+	currentTexture = value;
+	DrawBackendNull_Get()->shaderSetUniformTexture(self, uniform, arrayIndex, value);
+}
+
+static void LogDraw(int32 first)
+{
+	if (drawCount < TestDrawQueue_MaxDraws)
+	{
+		draws[drawCount] = (TestDraw){ currentShader, currentState.blendMode, currentTexture, first };
+	}
+	drawCount++;
+}
+
+static void LogMeshDraw(Mesh* mesh, int32 vertexOffset, int32 vertexCount)
+{
+	LogDraw(vertexOffset);
+	DrawBackendNull_Get()->meshDraw(mesh, vertexOffset, vertexCount);
+}
+
+static void LogMeshDrawIndexed(Mesh* mesh, int32 indexOffset, int32 indexCount, int32 baseVertex)
+{
+	LogDraw(-1);
+	DrawBackendNull_Get()->meshDrawIndexed(mesh, indexOffset, indexCount, baseVertex);
+}
+
+static Mesh mesh;
+static Shader shaders[1100];
+static Texture textures[4200];
+static ShaderUniform textureUniform;
+static VertexFormatItem immediateFormat[] =
+{
+	{ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 },
+};
+
+static void Init()
+{
+	backend = *DrawBackendNull_Get();
+	backend.shaderSet = LogShaderSet;
+	backend.drawStateUpdate = LogDrawStateUpdate;
+	backend.shaderSetUniformTexture = LogShaderSetUniformTexture;
+	backend.meshDraw = LogMeshDraw;
+	backend.meshDrawIndexed = LogMeshDrawIndexed;
+	Draw_Init(&backend);
+
+	Mesh_Init(&mesh);
+	mesh.vertexBufferCount = 1;
+	VertexBuffer_Init(&mesh.vertexBuffers[0], 1024, VertexBufferUsage_Static);
+	mesh.vertexFormatCount = 1;
+	mesh.vertexFormat[0] = immediateFormat[0];
+	Mesh_ApplyStructure(&mesh);
+}
+
+static void Free()
+{
+	Mesh_Free(&mesh);
+	Draw_Free();
+}
+
+static void ResetLog()
+{
+	drawCount = 0;
+	MemSet(gDrawBackendNullCounters.calls, 0, sizeof(gDrawBackendNullCounters.calls));
+}
+
+static DrawQueueMaterial Material(int32 shader, BlendMode blendMode, int32 texture)
+{
+	DrawQueueMaterial material = { 0 };
+	material.shader = &shaders[shader];
+	material.drawState.blendMode = blendMode;
+	material.drawState.depthWrite = true;
+	if (texture >= 0)
+	{
+		material.textureUniform = &textureUniform;
+		material.texture = &textures[texture];
+	}
+	return material;
+}
+
+static uint64 GetField(uint64 key, int32 shift, int32 bits)
+{
+	return (key >> shift) & (((uint64)1 << bits)-1);
+}
+
+static void TestKeyPacking()
+{
+	Init();
+	DrawQueue queue;
+	DrawQueue_Init(&queue);
+	DrawQueue_SetImmediateVertexFormat(&queue, immediateFormat, 1);
+	DrawQueueMaterial a = Material(0, BlendMode_None, 0);
+	DrawQueueMaterial b = Material(1, BlendMode_Alpha, 1);
+	DrawQueue_SubmitMesh(&queue, &a, &mesh, 0, 3, 0, 1.0f);
+	DrawQueue_SubmitMesh(&queue, &b, &mesh, 1, 3, 5, 2.0f);
+	// back to front layers take effect on the submits after the change.
+	DrawQueue_SetLayerBackToFront(&queue, 7, true);
+	DrawQueue_SubmitMesh(&queue, &b, &mesh, 2, 3, 7, 2.0f);
+	float triangle[9] = { 0 };
+	DrawQueue_SubmitImmediatePoly(&queue, &a, triangle, 3, 0, -1.0f);
+
+	// layer 8 | shader 10 | draw state 10 | texture 12 | vertex format 4 | depth 20
+	uint64 key = queue.keys[1];
+	Test_Check(GetField(key, 56, 8) == 5);
+	Test_Check(GetField(key, 46, 10) == 1 && GetField(key, 36, 10) == 1 && GetField(key, 24, 12) == 1);
+	// meshes have vertex format 0, immediate formats start at 1.
+	Test_Check(GetField(key, 20, 4) == 0 && GetField(queue.keys[3], 20, 4) == 1);
+	Test_Check(GetField(key, 0, 20) == RadixSort_FloatToKey(2.0f) >> 12);
+	Test_Check(GetField(queue.keys[0], 0, 56) < GetField(key, 0, 56));
+	// negative depths sort before positive ones.
+	Test_Check(GetField(queue.keys[3], 0, 20) < GetField(queue.keys[0], 0, 20));
+
+	// layer 8 | depth 20 | shader 10 | draw state 10 | texture 12 | vertex format 4, with the depth flipped.
+	key = queue.keys[2];
+	Test_Check(GetField(key, 56, 8) == 7);
+	Test_Check(GetField(key, TestDrawQueue_StateBits, TestDrawQueue_DepthBits) == (~(RadixSort_FloatToKey(2.0f) >> 12) & 0xfffff));
+	Test_Check(GetField(key, 0, TestDrawQueue_StateBits) == GetField(queue.keys[1], TestDrawQueue_DepthBits, TestDrawQueue_StateBits));
+
+	// ids start over after a clear, execute clears too.
+	DrawQueue_Clear(&queue);
+	Test_Check(queue.itemCount == 0);
+	DrawQueue_SubmitMesh(&queue, &b, &mesh, 0, 3, 0, 1.0f);
+	Test_Check(GetField(queue.keys[0], 46, 10) == 0 && GetField(queue.keys[0], 24, 12) == 0);
+	DrawQueue_Execute(&queue);
+	Test_Check(queue.itemCount == 0);
+
+	DrawQueue_Free(&queue);
+	Free();
+}
+
+// more shaders and textures than their key fields hold. the ids past the range share its last value, and the draws
+// sharing it still run with their own shader and texture.
+static void TestSaturatingIds()
+{
+	Init();
+	DrawQueue queue;
+	DrawQueue_Init(&queue);
+	int32 count = ArrayCountOf(textures);
+	for (int32 i = 0; i < count; i++)
+	{
+		DrawQueueMaterial material = Material(i%ArrayCountOf(shaders), BlendMode_None, i);
+		DrawQueue_SubmitMesh(&queue, &material, &mesh, i, 3, 0, (float)(count-i));
+	}
+	Test_Check(GetField(queue.keys[1000], 46, 10) == 1000);
+	Test_Check(GetField(queue.keys[1023], 46, 10) == 1023 && GetField(queue.keys[1099], 46, 10) == 1023);
+	Test_Check(GetField(queue.keys[4095], 24, 12) == 4095 && GetField(queue.keys[4199], 24, 12) == 4095);
+
+	ResetLog();
+	DrawQueue_Execute(&queue);
+	int32 wrong = 0;
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		int32 index = draws[i].first;
+		wrong += draws[i].shader != &shaders[index%ArrayCountOf(shaders)] || draws[i].texture != &textures[index];
+	}
+	Test_Check(drawCount == count && wrong == 0);
+
+	DrawQueue_Free(&queue);
+	Free();
+}
+
+// layer 1 is back to front, layer 0 is sorted by state and near to far inside it.
+static void TestLayers()
+{
+	Init();
+	DrawQueue queue;
+	DrawQueue_Init(&queue);
+	DrawQueue_SetLayerBackToFront(&queue, 1, true);
+	float depths[2000];
+	uint32 random = 1;
+	for (int32 i = 0; i < ArrayCountOf(depths); i++)
+	{
+		depths[i] = Test_RandomFloat(&random, 0, 1000);
+		DrawQueueMaterial material = Material(Test_Random(&random)%3, (BlendMode)(Test_Random(&random)%2), -1);
+		DrawQueue_SubmitMesh(&queue, &material, &mesh, i, 3, 1-i%2, depths[i]);
+	}
+
+	ResetLog();
+	DrawQueue_Execute(&queue);
+	Test_Check(drawCount == ArrayCountOf(depths));
+	int32 outOfOrder = 0;
+	for (int32 i = 1; i < drawCount; i++)
+	{
+		int32 previous = draws[i-1].first;
+		int32 current = draws[i].first;
+		bool previousBackToFront = previous%2 == 0;
+		bool backToFront = current%2 == 0;
+		bool sameGroup = draws[i-1].shader == draws[i].shader && draws[i-1].blendMode == draws[i].blendMode;
+		if (previousBackToFront != backToFront)
+		{
+			// layer 0 first, once.
+			outOfOrder += previousBackToFront;
+		}
+		else if (backToFront)
+		{
+			// depths keep 11 bits of mantissa in the key, closer ones can have equal keys.
+			outOfOrder += depths[current] > depths[previous]*(1+1/1024.0f);
+		}
+		else if (sameGroup)
+		{
+			outOfOrder += depths[current] < depths[previous]*(1-1/1024.0f);
+		}
+	}
+	Test_Check(outOfOrder == 0);
+	// layer 0 draws come in 3 shader groups of 2 draw states each.
+	int32 shaderChanges = 0, stateChanges = 0;
+	for (int32 i = 1; i < drawCount && draws[i].first%2 == 1; i++)
+	{
+		shaderChanges += draws[i].shader != draws[i-1].shader;
+		stateChanges += draws[i].shader != draws[i-1].shader || draws[i].blendMode != draws[i-1].blendMode;
+	}
+	Test_Check(shaderChanges == 2 && stateChanges == 5);
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_MeshDraw] == ArrayCountOf(depths));
+
+	DrawQueue_Free(&queue);
+	Free();
+}
+
+// the same draws submitted in a random material order, through the queue and directly.
+static void TestReplayDedup()
+{
+	uint32 random = 2;
+	int32 materialIndices[1000];
+	for (int32 i = 0; i < ArrayCountOf(materialIndices); i++)
+	{
+		materialIndices[i] = Test_Random(&random)%8;
+	}
+	float triangle[9] = { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+
+	// queued, every material is set once and its polys are one batch.
+	Init();
+	DrawQueue queue;
+	DrawQueue_Init(&queue);
+	DrawQueue_SetImmediateVertexFormat(&queue, immediateFormat, 1);
+	ResetLog();
+	for (int32 i = 0; i < ArrayCountOf(materialIndices); i++)
+	{
+		int32 m = materialIndices[i];
+		DrawQueueMaterial material = Material(m & 1, (m >> 1) & 1 ? BlendMode_Alpha : BlendMode_Add, m >> 2);
+		DrawQueue_SubmitImmediatePoly(&queue, &material, triangle, 3, 0, 0);
+	}
+	DrawQueue_Execute(&queue);
+	Draw_Flush();
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_ShaderSet] == 2);
+	// two draw states per shader, set again after the shader changes.
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_DrawStateUpdate] == 4);
+	// textures are set again for each shader too.
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_ShaderSetUniformTexture] == 8);
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_MeshDrawIndexed] == 8);
+	int32 seen = 0;
+	for (int32 i = 0; i < drawCount && i < 8; i++)
+	{
+		int32 m = (int32)(draws[i].shader-shaders) | (draws[i].blendMode == BlendMode_Alpha) << 1 | (int32)(draws[i].texture-textures) << 2;
+		seen |= 1 << m;
+	}
+	Test_Check(drawCount == 8 && seen == 0xff);
+	DrawQueue_Free(&queue);
+	Free();
+
+	// directly, the state changes with almost every draw.
+	Init();
+	ResetLog();
+	Draw_SetImmediateVertexFormat(immediateFormat, 1);
+	for (int32 i = 0; i < ArrayCountOf(materialIndices); i++)
+	{
+		int32 m = materialIndices[i];
+		DrawQueueMaterial material = Material(m & 1, (m >> 1) & 1 ? BlendMode_Alpha : BlendMode_Add, m >> 2);
+		Draw_SetShader(material.shader);
+		Draw_SetDrawState(&material.drawState);
+		Shader_SetUniformTexture(material.shader, material.textureUniform, 0, material.texture);
+		Draw_SubmitImmediatePoly(triangle, 3);
+	}
+	Draw_Flush();
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_ShaderSet] > 100);
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_MeshDrawIndexed] > 500);
+	Free();
+}
+
+// equal keys keep their submission order, over enough draws that the sort runs its radix passes.
+static void TestStability()
+{
+	Init();
+	DrawQueue queue;
+	DrawQueue_Init(&queue);
+	DrawQueueMaterial materials[2] = { Material(0, BlendMode_None, -1), Material(1, BlendMode_None, -1) };
+	for (int32 i = 0; i < 4000; i++)
+	{
+		DrawQueue_SubmitMesh(&queue, &materials[(i/7)%2], &mesh, i, 3, 0, 5.0f);
+	}
+	ResetLog();
+	DrawQueue_Execute(&queue);
+	int32 outOfOrder = 0;
+	for (int32 i = 1; i < drawCount; i++)
+	{
+		if (draws[i].shader == draws[i-1].shader)
+		{
+			outOfOrder += draws[i].first < draws[i-1].first;
+		}
+	}
+	Test_Check(drawCount == 4000 && outOfOrder == 0);
+	// 286 runs of 7 use the first shader.
+	Test_Check(draws[0].shader == &shaders[0] && draws[0].first == 0 && draws[2001].shader == &shaders[0]);
+	Test_Check(draws[2002].shader == &shaders[1] && draws[2002].first == 7);
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_ShaderSet] == 2);
+
+	DrawQueue_Free(&queue);
+	Free();
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestKeyPacking);
+	Test_Run(TestSaturatingIds);
+	Test_Run(TestLayers);
+	Test_Run(TestReplayDedup);
+	Test_Run(TestStability);
+	return Test_Finish();
+}
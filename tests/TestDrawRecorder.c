@@ -0,0 +1,134 @@
+#include "Test.h"
+
+#include "draw/Draw.h"
+#include "draw/DrawRecorder.h"
+#include "draw/Mesh.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// replay of a recording, and of broken copies of it, run under asan to catch reads and writes the checks missed.
+
+typedef struct TestVertex
+{
+	float x, y;
+	float r, g, b, a;
+} TestVertex;
+
+static int32 frameCount;
+
+static void CountFrame(void* userData)
+{
+	Unused(userData);
+	frameCount++;
+}
+
+// two frames of immediate quads, indexed draws and instances, which touches every kind of buffer replay creates.
+static uint8* Record(int64* outSize)
+{
+	Draw_Init(DrawRecorder_Init());
+	Shader shader;
+	Shader_Load("test", &shader);
+	Mesh mesh;
+	Mesh_Init(&mesh);
+	mesh.vertexBufferCount = 1;
+	VertexBuffer_Init(&mesh.vertexBuffers[0], 1024, VertexBufferUsage_Static);
+	IndexBuffer_Init(&mesh.indexBuffer, 36*sizeof(uint16), IndexFormat_U16, VertexBufferUsage_Static);
+	mesh.vertexFormatCount = 1;
+	mesh.vertexFormat[0] = (VertexFormatItem){ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 };
+	Draw_AddInstanceTransformFormat(&mesh, 1);
+	Mesh_ApplyStructure(&mesh);
+	VertexFormatItem immediateFormat[] =
+	{
+		{ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = sizeof(TestVertex), .type = VertexFormatType_Float, .componentCount = 2 },
+		{ .inputIndex = 1, .bufferIndex = 0, .offset = 8, .stride = sizeof(TestVertex), .type = VertexFormatType_Float, .componentCount = 4 },
+	};
+	Transformer transformers[8];
+	for (int32 i = 0; i < 8; i++)
+	{
+		transformers[i] = Transformer_identity;
+	}
+	for (int32 frame = 0; frame < 2; frame++)
+	{
+		Draw_SetShader(&shader);
+		Draw_SetImmediateVertexFormat(immediateFormat, ArrayCountOf(immediateFormat));
+		for (int32 i = 0; i < 10; i++)
+		{
+			TestVertex quad[4] = { { 0, 0, 1, 1, 1, 1 }, { 0, 1, 1, 1, 1, 1 }, { 1, 1, 1, 1, 1, 1 }, { (float)i, 0, 1, 1, 1, 1 } };
+			Draw_SubmitImmediatePoly(quad, 4);
+		}
+		Mesh_DrawIndexed(&mesh, 0, 36, 0);
+		Draw_MeshInstancedTransformers(&mesh, 0, 36, transformers, 8);
+		Draw_EndFrame();
+	}
+	Mesh_Free(&mesh);
+	Shader_Free(&shader);
+	Draw_Free();
+
+	const uint8* recorded = DrawRecorder_GetData(outSize);
+	uint8* data = (uint8*)MAlloc(*outSize);
+	MemCpy(data, recorded, *outSize);
+	DrawRecorder_Free();
+	return data;
+}
+
+static void TestReplay()
+{
+	int64 size;
+	uint8* data = Record(&size);
+	frameCount = 0;
+	Test_Check(DrawRecorder_Replay(data, size, DrawBackendNull_Get(), CountFrame, null));
+	Test_Check(frameCount == 2);
+	MFree(data);
+}
+
+// a recording cut between calls is a valid shorter one, cut anywhere else replay has to stop at the cut.
+static void TestTruncated()
+{
+	int64 size;
+	uint8* data = Record(&size);
+	int32 headerAccepted = 0, accepted = 0;
+	for (int64 length = 0; length < size; length++)
+	{
+		// a copy of exactly length bytes, so asan sees reads past its end.
+		uint8* truncated = (uint8*)MAlloc(MaxI64(length, 1));
+		MemCpy(truncated, data, length);
+		bool result = DrawRecorder_Replay(truncated, length, DrawBackendNull_Get(), null, null);
+		// the magic and version.
+		headerAccepted += result && length < 5;
+		accepted += result;
+		MFree(truncated);
+	}
+	Test_Check(headerAccepted == 0);
+	Test_Check(accepted < size/2);
+	MFree(data);
+}
+
+// random bytes overwritten past the header. the result can go either way, replay just can't crash or leak.
+static void TestCorrupted()
+{
+	int64 size;
+	uint8* data = Record(&size);
+	uint8* corrupted = (uint8*)MAlloc(size);
+	uint32 random = 3;
+	for (int32 trial = 0; trial < 2000; trial++)
+	{
+		MemCpy(corrupted, data, size);
+		int32 changeCount = 1+Test_Random(&random)%4;
+		for (int32 i = 0; i < changeCount; i++)
+		{
+			corrupted[16+Test_Random(&random)%(size-16)] = (uint8)Test_Random(&random);
+		}
+		DrawRecorder_Replay(corrupted, size, DrawBackendNull_Get(), null, null);
+	}
+	MFree(corrupted);
+	MFree(data);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestReplay);
+	Test_Run(TestTruncated);
+	Test_Run(TestCorrupted);
+	return Test_Finish();
+}
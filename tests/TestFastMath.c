@@ -0,0 +1,279 @@
+#include "Test.h"
+
+#include "common/FastMath.h"
+#include "common/Math.h"
+
+#include <float.h>
+
+// measures the error of the scalar and array forms against the crt's double functions, rounded to float, and checks
+// it against the bounds FastMath.h documents.
+
+#define TestFastMath_SampleCount (1 << 20)
+
+typedef double (*ReferenceFunction)(double a, double b);
+typedef float (*ScalarFunction)(float a, float b);
+typedef void (*ArrayFunction)(const float* a, const float* b, float* outValues, int32 count);
+
+static float* inputA;
+static float* inputB;
+static float* output;
+
+// error in units of the float result's last place, measured against the double result before rounding.
+static double GetUlpError(float value, double reference)
+{
+	float rounded = (float)reference;
+	if (isnan(rounded) || isinf(rounded))
+	{
+		return value == rounded || (isnan(value) && isnan(rounded)) ? 0 : 1e9;
+	}
+	if (isnan(value))
+	{
+		return 1e9;
+	}
+	double ulp = (double)nextafterf(fabsf(rounded), INFINITY)-(double)fabsf(rounded);
+	return fabs((double)value-reference)/ulp;
+}
+
+static void FillUniform(float* values, uint32* random, float min, float max)
+{
+	for (int32 i = 0; i < TestFastMath_SampleCount; i++)
+	{
+		values[i] = Test_RandomFloat(random, min, max);
+	}
+}
+
+// uniform in the exponent, so each binade gets about as many samples.
+static void FillLogUniform(float* values, uint32* random, float min, float max, bool randomSign)
+{
+	for (int32 i = 0; i < TestFastMath_SampleCount; i++)
+	{
+		values[i] = expf(Test_RandomFloat(random, logf(min), logf(max)));
+		if (randomSign && (Test_Random(random) & 1))
+		{
+			values[i] = -values[i];
+		}
+	}
+}
+
+static void CheckUlpError(const char* name, ReferenceFunction reference, ScalarFunction scalar, ArrayFunction array, double maxUlp)
+{
+	array(inputA, inputB, output, TestFastMath_SampleCount);
+	double scalarError = 0, arrayError = 0;
+	float scalarWorst = 0, arrayWorst = 0;
+	for (int32 i = 0; i < TestFastMath_SampleCount; i++)
+	{
+		double exact = reference(inputA[i], inputB[i]);
+		double error = GetUlpError(scalar(inputA[i], inputB[i]), exact);
+		if (error > scalarError)
+		{
+			scalarError = error;
+			scalarWorst = inputA[i];
+		}
+		error = GetUlpError(output[i], exact);
+		if (error > arrayError)
+		{
+			arrayError = error;
+			arrayWorst = inputA[i];
+		}
+	}
+	printf("%-32s scalar %6.2f ulp, array %6.2f ulp\n", name, scalarError, arrayError);
+	Test_CheckMessage(scalarError <= maxUlp, "%s scalar: %.2f ulp at %.9g, documented %.1f", name, scalarError, scalarWorst, maxUlp);
+	Test_CheckMessage(arrayError <= maxUlp, "%s array: %.2f ulp at %.9g, documented %.1f", name, arrayError, arrayWorst, maxUlp);
+}
+
+static double ReferenceSin(double a, double b) { Unused(b); return sin(a); }
+static double ReferenceCos(double a, double b) { Unused(b); return cos(a); }
+static double ReferenceTan(double a, double b) { Unused(b); return tan(a); }
+static double ReferenceAtan(double a, double b) { Unused(b); return atan(a); }
+static double ReferenceAtan2(double a, double b) { return atan2(a, b); }
+static double ReferenceExp(double a, double b) { Unused(b); return exp(a); }
+static double ReferenceLog(double a, double b) { Unused(b); return log(a); }
+static double ReferencePow(double a, double b) { return pow(a, b); }
+
+static float ScalarSin(float a, float b) { Unused(b); return FastSin(a); }
+static float ScalarCos(float a, float b) { Unused(b); return FastCos(a); }
+static float ScalarTan(float a, float b) { Unused(b); return FastTan(a); }
+static float ScalarAtan(float a, float b) { Unused(b); return FastAtan(a); }
+static float ScalarAtan2(float a, float b) { return FastAtan2(a, b); }
+static float ScalarExp(float a, float b) { Unused(b); return FastExp(a); }
+static float ScalarLog(float a, float b) { Unused(b); return FastLog(a); }
+static float ScalarPow(float a, float b) { return FastPow(a, b); }
+
+// sin and cos of FastSinCosArray have to match the separate arrays.
+static void ArraySinCos(const float* a, const float* b, float* outValues, int32 count)
+{
+	Unused(b);
+	float* cosValues = (float*)MAlloc(count*sizeof(float));
+	FastSinCosArray(a, outValues, cosValues, count);
+	float* expected = (float*)MAlloc(count*sizeof(float));
+	FastCosArray(a, expected, count);
+	int32 mismatches = 0;
+	for (int32 i = 0; i < count; i++)
+	{
+		mismatches += cosValues[i] != expected[i];
+	}
+	Test_Check(mismatches == 0);
+	MFree(expected);
+	MFree(cosValues);
+}
+
+static void ArraySin(const float* a, const float* b, float* outValues, int32 count) { Unused(b); FastSinArray(a, outValues, count); }
+static void ArrayCos(const float* a, const float* b, float* outValues, int32 count) { Unused(b); FastCosArray(a, outValues, count); }
+static void ArrayTan(const float* a, const float* b, float* outValues, int32 count) { Unused(b); FastTanArray(a, outValues, count); }
+static void ArrayAtan(const float* a, const float* b, float* outValues, int32 count) { Unused(b); FastAtanArray(a, outValues, count); }
+static void ArrayAtan2(const float* a, const float* b, float* outValues, int32 count) { FastAtan2Array(a, b, outValues, count); }
+static void ArrayExp(const float* a, const float* b, float* outValues, int32 count) { Unused(b); FastExpArray(a, outValues, count); }
+static void ArrayLog(const float* a, const float* b, float* outValues, int32 count) { Unused(b); FastLogArray(a, outValues, count); }
+static void ArrayPow(const float* a, const float* b, float* outValues, int32 count) { FastPowArray(a, b, outValues, count); }
+
+static void TestSinCos()
+{
+	uint32 random = 1;
+	FillUniform(inputA, &random, -PI32, PI32);
+	CheckUlpError("sin [-pi, pi]", ReferenceSin, ScalarSin, ArraySin, 1.6);
+	CheckUlpError("cos [-pi, pi]", ReferenceCos, ScalarCos, ArrayCos, 1.6);
+	CheckUlpError("sincos [-pi, pi]", ReferenceSin, ScalarSin, ArraySinCos, 1.6);
+
+	// further out only the absolute error is bounded, near the zeros the ulp error is large.
+	FillUniform(inputA, &random, -8192, 8192);
+	FastSinArray(inputA, output, TestFastMath_SampleCount);
+	double scalarError = 0, arrayError = 0;
+	for (int32 i = 0; i < TestFastMath_SampleCount; i++)
+	{
+		scalarError = fmax(scalarError, fabs(FastSin(inputA[i])-sin(inputA[i])));
+		scalarError = fmax(scalarError, fabs(FastCos(inputA[i])-cos(inputA[i])));
+		arrayError = fmax(arrayError, fabs(output[i]-sin(inputA[i])));
+	}
+	printf("%-32s scalar %.3g, array %.3g\n", "sin cos abs error [-8192, 8192]", scalarError, arrayError);
+	Test_Check(scalarError < 1e-7);
+	Test_Check(arrayError < 1e-7);
+}
+
+static void TestTan()
+{
+	uint32 random = 2;
+	FillUniform(inputA, &random, -PI32/4, PI32/4);
+	CheckUlpError("tan [-pi/4, pi/4]", ReferenceTan, ScalarTan, ArrayTan, 2.8);
+	FillUniform(inputA, &random, -1.5f, 1.5f);
+	CheckUlpError("tan [-1.5, 1.5]", ReferenceTan, ScalarTan, ArrayTan, 3.3);
+}
+
+static void TestAtan()
+{
+	uint32 random = 3;
+	FillLogUniform(inputA, &random, 1e-6f, 1e6f, true);
+	CheckUlpError("atan |v| [1e-6, 1e6]", ReferenceAtan, ScalarAtan, ArrayAtan, 3.3);
+	FillUniform(inputA, &random, -100, 100);
+	FillUniform(inputB, &random, -100, 100);
+	CheckUlpError("atan2 [-100, 100]^2", ReferenceAtan2, ScalarAtan2, ArrayAtan2, 3.6);
+
+	Test_Check(FastAtan2(0, 0) == 0);
+	Test_CheckNear(FastAtan2(0, -1), PI32, 1e-6f);
+	Test_CheckNear(FastAtan2(1, 0), PI32/2, 1e-6f);
+	Test_CheckNear(FastAtan2(-1, 0), -PI32/2, 1e-6f);
+	Test_CheckNear(FastAtan(INFINITY), PI32/2, 1e-6f);
+}
+
+static void TestExp()
+{
+	uint32 random = 4;
+	FillUniform(inputA, &random, -87.3f, 88.7f);
+	CheckUlpError("exp [-87.3, 88.7]", ReferenceExp, ScalarExp, ArrayExp, 1.3);
+	FillUniform(inputA, &random, -103, -87.4f);
+	CheckUlpError("exp denormal results", ReferenceExp, ScalarExp, ArrayExp, 1.3);
+
+	float specials[8] = { 0, -0.0f, INFINITY, -INFINITY, 89.5f, -110, 1000, -1000 };
+	float expected[8] = { 1, 1, INFINITY, 0, INFINITY, 0, INFINITY, 0 };
+	float results[8];
+	FastExpArray(specials, results, 8);
+	for (int32 i = 0; i < 8; i++)
+	{
+		Test_CheckMessage(FastExp(specials[i]) == expected[i], "FastExp(%g) = %g", specials[i], FastExp(specials[i]));
+		Test_CheckMessage(results[i] == expected[i], "FastExpArray(%g) = %g", specials[i], results[i]);
+	}
+}
+
+static void TestLog()
+{
+	uint32 random = 5;
+	FillLogUniform(inputA, &random, FLT_MIN, FLT_MAX, false);
+	CheckUlpError("log normal floats", ReferenceLog, ScalarLog, ArrayLog, 0.9);
+	FillUniform(inputA, &random, 0.5f, 2);
+	CheckUlpError("log [0.5, 2]", ReferenceLog, ScalarLog, ArrayLog, 0.9);
+	FillLogUniform(inputA, &random, 1.4e-45f, FLT_MIN, false);
+	CheckUlpError("log denormals", ReferenceLog, ScalarLog, ArrayLog, 0.9);
+
+	float specials[4] = { 0, -0.0f, INFINITY, 1 };
+	float expected[4] = { -INFINITY, -INFINITY, INFINITY, 0 };
+	float results[4];
+	FastLogArray(specials, results, 4);
+	for (int32 i = 0; i < 4; i++)
+	{
+		Test_CheckMessage(FastLog(specials[i]) == expected[i], "FastLog(%g) = %g", specials[i], FastLog(specials[i]));
+		Test_CheckMessage(results[i] == expected[i], "FastLogArray(%g) = %g", specials[i], results[i]);
+	}
+	Test_Check(isnan(FastLog(-1)));
+	Test_Check(isnan(FastLog(NAN)));
+}
+
+static void TestPow()
+{
+	uint32 random = 6;
+	// |b*log(a)| stays below 4*ln(1000) = 27.6 and 6*ln(1e6) = 82.9.
+	FillLogUniform(inputA, &random, 1e-3f, 1e3f, false);
+	FillUniform(inputB, &random, -4, 4);
+	CheckUlpError("pow a [1e-3, 1e3], b [-4, 4]", ReferencePow, ScalarPow, ArrayPow, 19);
+	FillLogUniform(inputA, &random, 1e-6f, 1e6f, false);
+	FillUniform(inputB, &random, -6, 6);
+	CheckUlpError("pow a [1e-6, 1e6], b [-6, 6]", ReferencePow, ScalarPow, ArrayPow, 68);
+
+	Test_Check(FastPow(0, 0) == 1);
+	Test_Check(FastPow(5, 0) == 1);
+	Test_Check(FastPow(0, 2) == 0);
+	Test_Check(FastPow(0, -1) == INFINITY);
+	Test_CheckNear(FastPow(2, 10), 1024, 1024*2e-6);
+}
+
+// the array forms handle any count and alignment, the ends go through the scalar forms.
+static void TestArrayEnds()
+{
+	uint32 random = 7;
+	FillUniform(inputA, &random, -10, 10);
+	int32 mismatches = 0;
+	for (int32 offset = 0; offset < 8; offset++)
+	{
+		for (int32 count = 0; count < 40; count++)
+		{
+			MemSet(output, 0, 64*sizeof(float));
+			FastSinArray(inputA+offset, output+offset, count);
+			for (int32 i = 0; i < 64; i++)
+			{
+				bool written = i >= offset && i < offset+count;
+				if (written ? Abs(output[i]-sinf(inputA[i])) > 1e-6f : output[i] != 0)
+				{
+					mismatches++;
+				}
+			}
+		}
+	}
+	Test_Check(mismatches == 0);
+}
+
+int main()
+{
+	Test_Init();
+	inputA = (float*)MAlloc(TestFastMath_SampleCount*sizeof(float));
+	inputB = (float*)MAlloc(TestFastMath_SampleCount*sizeof(float));
+	output = (float*)MAlloc(TestFastMath_SampleCount*sizeof(float));
+	Test_Run(TestSinCos);
+	Test_Run(TestTan);
+	Test_Run(TestAtan);
+	Test_Run(TestExp);
+	Test_Run(TestLog);
+	Test_Run(TestPow);
+	Test_Run(TestArrayEnds);
+	MFree(output);
+	MFree(inputB);
+	MFree(inputA);
+	return Test_Finish();
+}
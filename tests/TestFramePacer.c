@@ -0,0 +1,166 @@
+#include "Test.h"
+
+#include "common/FramePacer.h"
+#include "common/Math.h"
+
+// frames run on a simulated clock. every read of it moves it forward a microsecond, like spinning on a real one, and
+// sleeps last as long as asked plus the oversleep set for the case.
+
+#define TestFramePacer_TickStep 10
+// 60 hz.
+#define TestFramePacer_FrameTicks 166667
+
+static uint64 simulatedNow;
+static int64 simulatedOversleep;
+
+static uint64 SimulatedGetTicks()
+{
+	simulatedNow += TestFramePacer_TickStep;
+	return simulatedNow;
+}
+
+static void SimulatedSleepTicks(int64 ticks)
+{
+	simulatedNow += ticks+simulatedOversleep;
+}
+
+static void InitSimulated(FramePacer* pacer, int64 oversleep)
+{
+	simulatedNow = 1000000;
+	simulatedOversleep = oversleep;
+	FramePacer_Init(pacer, TestFramePacer_FrameTicks);
+	pacer->getTicks = SimulatedGetTicks;
+	pacer->sleepTicks = SimulatedSleepTicks;
+}
+
+// runs frameCount frames that each take workTicks before waiting, returns the largest wake error.
+static int64 RunFrames(FramePacer* pacer, int32 frameCount, int64 workTicks)
+{
+	int64 maxWakeError = Int64Min;
+	for (int32 i = 0; i < frameCount; i++)
+	{
+		simulatedNow += workTicks;
+		maxWakeError = MaxI64(maxWakeError, FramePacer_Wait(pacer));
+	}
+	return maxWakeError;
+}
+
+static void TestOnTime()
+{
+	FramePacer pacer;
+	InitSimulated(&pacer, 5000);
+	// the first wait only starts the schedule.
+	Test_Check(FramePacer_Wait(&pacer) == 0);
+	Test_Check(pacer.stats.frameCount == 0);
+	uint64 start = simulatedNow;
+
+	int64 maxWakeError = RunFrames(&pacer, 100, 50000);
+	Test_Check(maxWakeError >= 0 && maxWakeError < TestFramePacer_TickStep);
+	Test_Check(pacer.stats.frameCount == 100);
+	Test_Check(pacer.stats.missedCount == 0);
+	Test_Check(pacer.stats.overrunCount == 0);
+	Test_Check(pacer.stats.minWakeErrorTicks >= 0);
+	Test_Check(FramePacerStats_GetMeanWakeErrorTicks(&pacer.stats) < TestFramePacer_TickStep);
+	Test_Check(FramePacerStats_GetWakeErrorStdDevTicks(&pacer.stats) < TestFramePacer_TickStep);
+	// the schedule doesn't drift, frame n wakes n frames after the first deadline.
+	Test_CheckNear((double)(simulatedNow-start), 100.0*TestFramePacer_FrameTicks, TestFramePacer_TickStep);
+	// the slack grew to cover twice the oversleep, which is what kept every frame on time.
+	Test_Check(pacer.sleepSlackTicks >= 2*5000);
+}
+
+static void TestSlackAdapts()
+{
+	FramePacer pacer;
+	InitSimulated(&pacer, 0);
+	FramePacer_Wait(&pacer);
+	// an accurate sleep lets the slack decay towards its minimum, 100 microseconds.
+	RunFrames(&pacer, 200, 50000);
+	Test_Check(pacer.sleepSlackTicks >= 1000 && pacer.sleepSlackTicks < 1100);
+	Test_Check(pacer.stats.missedCount == 0);
+
+	// a sudden 3 ms oversleep makes one frame late, after that the slack covers it.
+	simulatedOversleep = 30000;
+	FramePacer_ResetStats(&pacer);
+	int64 maxWakeError = RunFrames(&pacer, 50, 50000);
+	Test_Check(pacer.stats.missedCount == 1);
+	Test_Check(maxWakeError > 25000 && maxWakeError <= 30000+TestFramePacer_TickStep);
+	Test_Check(pacer.sleepSlackTicks >= 2*30000);
+	Test_Check(RunFrames(&pacer, 50, 50000) < TestFramePacer_TickStep);
+	Test_Check(pacer.stats.missedCount == 1);
+}
+
+static void TestOverrun()
+{
+	FramePacer pacer;
+	InitSimulated(&pacer, 2000);
+	FramePacer_Wait(&pacer);
+	RunFrames(&pacer, 10, 50000);
+
+	// work longer than a frame is past the deadline before waiting. the schedule restarts instead of catching up.
+	RunFrames(&pacer, 5, TestFramePacer_FrameTicks+40000);
+	Test_Check(pacer.stats.overrunCount == 5);
+	Test_Check(pacer.stats.missedCount == 5);
+	Test_Check(pacer.stats.maxWakeErrorTicks >= 40000);
+
+	// a little over the frame time once isn't a whole frame behind, the next deadline still holds.
+	FramePacer_ResetStats(&pacer);
+	RunFrames(&pacer, 1, TestFramePacer_FrameTicks+1000);
+	Test_Check(pacer.stats.overrunCount == 1);
+	Test_Check(RunFrames(&pacer, 20, 50000) < TestFramePacer_TickStep);
+	Test_Check(pacer.stats.overrunCount == 1);
+	Test_Check(pacer.stats.missedCount == 1);
+
+	// a new target restarts the schedule from the next wait.
+	FramePacer_SetTargetFrameTicks(&pacer, TestFramePacer_FrameTicks/2);
+	Test_Check(FramePacer_Wait(&pacer) == 0);
+	uint64 start = simulatedNow;
+	Test_Check(RunFrames(&pacer, 20, 10000) < TestFramePacer_TickStep);
+	Test_CheckNear((double)(simulatedNow-start), 20.0*(TestFramePacer_FrameTicks/2), TestFramePacer_TickStep);
+}
+
+static void TestFixedTimestep()
+{
+	FixedTimestep timestep;
+	FixedTimestep_Init(&timestep, 100, 4);
+	Test_Check(FixedTimestep_Advance(&timestep, 250) == 2);
+	Test_CheckNear(FixedTimestep_GetAlpha(&timestep), 0.5f, 1e-6f);
+	Test_Check(FixedTimestep_Advance(&timestep, -5) == 0);
+	Test_CheckNear(FixedTimestep_GetAlpha(&timestep), 0.5f, 1e-6f);
+
+	// 10 steps are due but only 4 run, the 6 past the cap are dropped and the fraction is kept.
+	Test_Check(FixedTimestep_Advance(&timestep, 1000) == 4);
+	Test_Check(timestep.droppedTicks == 600);
+	Test_CheckNear(FixedTimestep_GetAlpha(&timestep), 0.5f, 1e-6f);
+	Test_Check(FixedTimestep_Advance(&timestep, 49) == 0);
+	Test_CheckNear(FixedTimestep_GetAlpha(&timestep), 0.99f, 1e-6f);
+	Test_Check(FixedTimestep_Advance(&timestep, 1) == 1);
+	Test_CheckNear(FixedTimestep_GetAlpha(&timestep), 0, 1e-6f);
+
+	// over random frames, time is either stepped, dropped or still waiting in the accumulator.
+	FixedTimestep_Init(&timestep, 166667, 5);
+	uint32 random = 1;
+	int64 elapsedSum = 0, steppedSum = 0;
+	int32 badAlphas = 0;
+	for (int32 i = 0; i < 10000; i++)
+	{
+		int64 elapsed = Test_Random(&random)%(i%100 == 0 ? 2000000 : 400000);
+		elapsedSum += elapsed;
+		int32 steps = FixedTimestep_Advance(&timestep, elapsed);
+		steppedSum += steps*timestep.stepTicks;
+		float alpha = FixedTimestep_GetAlpha(&timestep);
+		badAlphas += steps < 0 || steps > 5 || alpha < 0 || alpha >= 1;
+	}
+	Test_Check(badAlphas == 0);
+	Test_Check(timestep.droppedTicks > 0);
+	Test_Check(steppedSum+(int64)timestep.droppedTicks+timestep.accumulatorTicks == elapsedSum);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestOnTime);
+	Test_Run(TestSlackAdapts);
+	Test_Run(TestOverrun);
+	Test_Run(TestFixedTimestep);
+	return Test_Finish();
+}
@@ -0,0 +1,216 @@
+#include "Test.h"
+
+#include "common/CString.h"
+#include "common/File.h"
+#include "draw/FrameStats.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+// frames are fed to FrameStats_OnPresent with synthetic timestamps, presents take a fixed 30 ticks.
+
+#define TestFrameStats_PresentTicks 30
+
+static uint64 presentEnd;
+
+static void StartFrames(FrameStats* stats)
+{
+	FrameStats_Init(stats);
+	presentEnd = 1000000;
+	// the first present only starts the timeline.
+	FrameStats_OnPresent(stats, presentEnd-TestFrameStats_PresentTicks, presentEnd);
+}
+
+static void Present(FrameStats* stats, uint64 frameTicks)
+{
+	presentEnd += frameTicks;
+	FrameStats_OnPresent(stats, presentEnd-TestFrameStats_PresentTicks, presentEnd);
+}
+
+static void GetTempPath(char* dest, int32 destLength, const char* name)
+{
+	const char* directory = getenv("TMPDIR");
+	SPrintF(dest, destLength, "%s/kirin_test_%d_%s", directory ? directory : "/tmp", (int)getpid(), name);
+}
+
+static int32 CountLines(const char* text)
+{
+	int32 count = 0;
+	for (const char* c = text; *c; c++)
+	{
+		count += *c == '\n';
+	}
+	return count;
+}
+
+static void TestHistogramBuckets()
+{
+	int32 mismatches = 0;
+	for (int32 i = 0; i < FrameStatsHistogram_BucketCount; i++)
+	{
+		uint64 min = FrameStatsHistogram_GetBucketMin(i);
+		mismatches += FrameStatsHistogram_GetBucketIndex(min) != i;
+		if (i > 0)
+		{
+			// the value just below a bucket is the last one of the bucket before it.
+			mismatches += FrameStatsHistogram_GetBucketIndex(min-1) != i-1;
+			mismatches += FrameStatsHistogram_GetBucketMin(i-1) >= min;
+		}
+	}
+	Test_Check(mismatches == 0);
+
+	// any value lies in its bucket, which is at most an eighth of its size wide.
+	uint32 random = 1;
+	int32 outside = 0;
+	for (int32 i = 0; i < 100000; i++)
+	{
+		uint64 ticks = ((uint64)Test_Random(&random) << 32 | Test_Random(&random)) >> (Test_Random(&random)%64);
+		ticks &= ((uint64)1 << FrameStatsHistogram_MaxValueBits)-1;
+		int32 index = FrameStatsHistogram_GetBucketIndex(ticks);
+		uint64 min = FrameStatsHistogram_GetBucketMin(index);
+		uint64 next = index+1 < FrameStatsHistogram_BucketCount ? FrameStatsHistogram_GetBucketMin(index+1) : (uint64)1 << FrameStatsHistogram_MaxValueBits;
+		outside += ticks < min || ticks >= next || (ticks >= FrameStatsHistogram_SubBucketCount && (next-min)*FrameStatsHistogram_SubBucketCount > min);
+	}
+	Test_Check(outside == 0);
+	// larger values than the histogram covers land in the last bucket.
+	Test_Check(FrameStatsHistogram_GetBucketIndex((uint64)1 << FrameStatsHistogram_MaxValueBits) == FrameStatsHistogram_BucketCount-1);
+	Test_Check(FrameStatsHistogram_GetBucketIndex(~(uint64)0) == FrameStatsHistogram_BucketCount-1);
+}
+
+static void TestPercentiles()
+{
+	static FrameStats stats;
+	StartFrames(&stats);
+	// frame times of 100 to 100000 ticks in a scrambled order.
+	for (int32 i = 0; i < 1000; i++)
+	{
+		gDrawStatCounters.meshDraws = i;
+		Present(&stats, (uint64)((i*7919)%1000+1)*100);
+	}
+	Test_Check(stats.sampleCount == 1000);
+	Test_Check(gDrawStatCounters.meshDraws == 0);
+	Test_Check(FrameStats_GetSample(&stats, 0)->drawCounters.meshDraws == 999);
+	Test_Check(FrameStats_GetSample(&stats, 0)->ticks[FrameStatsChannel_Frame] == (uint64)((999*7919)%1000+1)*100);
+
+	FrameStatsSummary frame = FrameStats_GetSummary(&stats, FrameStatsChannel_Frame);
+	Test_Check(frame.sampleCount == 1000);
+	Test_Check(frame.p50 == 50000 && frame.p95 == 95000 && frame.p99 == 99000 && frame.max == 100000);
+	Test_CheckNear(frame.mean, 50050, 1e-6);
+	// the cpu time is the frame time without the present.
+	FrameStatsSummary cpu = FrameStats_GetSummary(&stats, FrameStatsChannel_Cpu);
+	Test_Check(cpu.p50 == 50000-TestFrameStats_PresentTicks && cpu.max == 100000-TestFrameStats_PresentTicks);
+	// no gpu results yet.
+	Test_Check(FrameStats_GetSummary(&stats, FrameStatsChannel_Gpu).sampleCount == 0);
+
+	const FrameStatsHistogram* histogram = &stats.histograms[FrameStatsChannel_Frame];
+	uint64 bucketSum = 0, belowMedian = 0;
+	for (int32 i = 0; i < FrameStatsHistogram_BucketCount; i++)
+	{
+		bucketSum += histogram->counts[i];
+		belowMedian += FrameStatsHistogram_GetBucketMin(i) < FrameStatsHistogram_GetBucketMin(FrameStatsHistogram_GetBucketIndex(50000)) ? histogram->counts[i] : 0;
+	}
+	Test_Check(histogram->totalCount == 1000 && bucketSum == 1000);
+	// the median's bucket starts below it, at most an eighth of it.
+	Test_Check(belowMedian <= 500 && belowMedian >= 500-50000/FrameStatsHistogram_SubBucketCount/100);
+}
+
+static void TestWindow()
+{
+	static FrameStats stats;
+	StartFrames(&stats);
+	uint64 thresholds[] = { 5000, 10000 };
+	FrameStats_SetHitchThresholds(&stats, thresholds, ArrayCountOf(thresholds));
+	// frame n takes 10*(n+1) ticks.
+	for (int32 i = 0; i < FrameStats_WindowSize+300; i++)
+	{
+		Present(&stats, (uint64)(i+1)*10);
+	}
+	Test_Check(stats.sampleCount == FrameStats_WindowSize);
+	Test_Check(FrameStats_GetSample(&stats, 0)->frameNumber == FrameStats_WindowSize+299);
+	Test_Check(FrameStats_GetSample(&stats, FrameStats_WindowSize-1)->frameNumber == 300);
+	Test_Check(FrameStats_GetSample(&stats, FrameStats_WindowSize) == null);
+	Test_Check(FrameStats_GetSample(&stats, -1) == null);
+
+	// percentiles cover the window, the histogram and the hitches everything.
+	FrameStatsSummary frame = FrameStats_GetSummary(&stats, FrameStatsChannel_Frame);
+	Test_Check(frame.sampleCount == FrameStats_WindowSize);
+	Test_Check(frame.p50 == (300+FrameStats_WindowSize/2)*10);
+	Test_Check(frame.max == (FrameStats_WindowSize+300)*10);
+	Test_Check(stats.histograms[FrameStatsChannel_Frame].totalCount == FrameStats_WindowSize+300);
+	// strictly longer than the threshold.
+	Test_Check(stats.hitchCounts[0] == FrameStats_WindowSize+300-500);
+	Test_Check(stats.hitchCounts[1] == FrameStats_WindowSize+300-1000);
+
+	// gpu results match their frame by number and the first one for a frame is kept.
+	uint64 newest = FrameStats_GetSample(&stats, 0)->frameNumber;
+	FrameStats_SetGpuTicks(&stats, newest-3, 500);
+	FrameStats_SetGpuTicks(&stats, newest-3, 700);
+	FrameStats_SetGpuTicks(&stats, newest-2, 0);
+	// not presented yet and already out of the window.
+	FrameStats_SetGpuTicks(&stats, newest+1, 900);
+	FrameStats_SetGpuTicks(&stats, 100, 900);
+	Test_Check(FrameStats_GetSample(&stats, 3)->ticks[FrameStatsChannel_Gpu] == 500);
+	Test_Check(FrameStats_GetSample(&stats, 2)->ticks[FrameStatsChannel_Gpu] == 1);
+	Test_Check(FrameStats_GetSample(&stats, 0)->ticks[FrameStatsChannel_Gpu] == 0);
+	Test_Check(stats.histograms[FrameStatsChannel_Gpu].totalCount == 2);
+	FrameStatsSummary gpu = FrameStats_GetSummary(&stats, FrameStatsChannel_Gpu);
+	Test_Check(gpu.sampleCount == 2 && gpu.max == 500 && gpu.p50 == 1);
+
+	// a reset keeps the thresholds and the timeline.
+	FrameStats_Reset(&stats);
+	Test_Check(stats.sampleCount == 0 && stats.hitchCounts[1] == 0 && stats.histograms[FrameStatsChannel_Frame].totalCount == 0);
+	Present(&stats, 20000);
+	Test_Check(stats.sampleCount == 1 && stats.hitchCounts[0] == 1 && stats.hitchCounts[1] == 1);
+	Test_Check(FrameStats_GetSample(&stats, 0)->frameNumber == newest+1);
+	Test_Check(FrameStats_GetSample(&stats, 0)->ticks[FrameStatsChannel_Frame] == 20000);
+}
+
+static void TestCSV()
+{
+	static FrameStats stats;
+	StartFrames(&stats);
+	uint64 thresholds[] = { 150 };
+	FrameStats_SetHitchThresholds(&stats, thresholds, 1);
+	for (int32 i = 0; i < 3; i++)
+	{
+		gDrawStatCounters.meshDraws = 5+i;
+		Present(&stats, (uint64)(i+1)*100);
+	}
+	FrameStats_SetGpuTicks(&stats, 1, 40);
+
+	char path[512];
+	GetTempPath(path, sizeof(path), "frames.csv");
+	Test_Check(FrameStats_WriteCSV(&stats, path));
+	int64 length;
+	char* text = File_ReadCStringFileAlloc(path, &length);
+	Test_Check(text && CountLines(text) == 4);
+	// oldest frame first, in miliseconds.
+	Test_Check(text && StrFind(text, "\n0,0.0100,0.0070,0.0000,0,5,0,0,0,0\n1,0.0200,0.0170,0.0040,0,6,0,0,0,0\n2,0.0300,0.0270,0.0000,0,7,0,0,0,0\n"));
+	MFree(text);
+
+	Test_Check(FrameStats_WriteSummaryCSV(&stats, path));
+	text = File_ReadCStringFileAlloc(path, &length);
+	Test_Check(text && StrFind(text, "\nframe,3,0.0200,0.0200,0.0300,0.0300,0.0300\n"));
+	Test_Check(text && StrFind(text, "\ngpu,1,0.0040,0.0040,0.0040,0.0040,0.0040\n"));
+	Test_Check(text && StrFind(text, "hitch_threshold_ms,count\n0.0150,2\n"));
+	MFree(text);
+
+	// 100, 200 and 300 ticks and the cpu times 30 ticks below them fall in 6 different buckets, the gpu time in a 7th.
+	Test_Check(FrameStats_WriteHistogramCSV(&stats, path));
+	text = File_ReadCStringFileAlloc(path, &length);
+	Test_Check(text && CountLines(text) == 1+7);
+	MFree(text);
+	remove(path);
+
+	Test_Check(!FrameStats_WriteCSV(&stats, "/nonexistent_directory/frames.csv"));
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestHistogramBuckets);
+	Test_Run(TestPercentiles);
+	Test_Run(TestWindow);
+	Test_Run(TestCSV);
+	return Test_Finish();
+}
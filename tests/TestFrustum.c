@@ -0,0 +1,144 @@
+#include "Test.h"
+
+#include "common/Frustum.h"
+
+#define TestFrustum_ObjectCount 100000
+
+static Frustum MakeFrustum(View* view, Transformer* cameraToWorld)
+{
+	View_InitPerspective(view, 16.0f/9.0f, DegToRad(70));
+	RigidTransform camera = RigidTransform_New(Quat_Normalize(Quat_New(0.1f, 0.2f, 0.3f, 0.9f)), Vec3_New(5, -3, 2), 1);
+	*cameraToWorld = RigidTransform_ToTransformer(&camera);
+	return Frustum_FromView(view, cameraToWorld, 0.5f, 400);
+}
+
+static float MinPlaneDistance(const Frustum* frustum, Vec3 point)
+{
+	float result = FloatMax;
+	for (int32 i = 0; i < FrustumPlane_Count; i++)
+	{
+		result = Min(result, Abs(Plane_DistToPoint(frustum->planes[i], point)));
+	}
+	return result;
+}
+
+static void TestFromView()
+{
+	View view;
+	Transformer cameraToWorld;
+	Frustum frustum = MakeFrustum(&view, &cameraToWorld);
+	Transformer worldToCamera = Transformer_Inverse(&cameraToWorld);
+
+	// points are inside exactly when they project onto the screen between the near and far plane.
+	uint32 random = 1;
+	int32 mismatches = 0;
+	for (int32 i = 0; i < TestFrustum_ObjectCount; i++)
+	{
+		Vec3 point = Vec3_New(Test_RandomFloat(&random, -500, 500), Test_RandomFloat(&random, -500, 500), Test_RandomFloat(&random, -500, 500));
+		Vec3 local = Transformer_ApplyPoint(&worldToCamera, point);
+		bool inside = false;
+		if (local.x > 0.5f && local.x < 400)
+		{
+			Vec3 projected = View_WorldToView(&view, &local);
+			inside = Abs(projected.x) <= 0.5f && Abs(projected.y) <= 0.5f;
+		}
+		// points within rounding of a plane can go either way.
+		if (Frustum_TestSphere(&frustum, point, 0) != inside && MinPlaneDistance(&frustum, point) > 1e-3f)
+		{
+			mismatches++;
+		}
+	}
+	Test_Check(mismatches == 0);
+
+	View ortho;
+	View_InitOrtho(&ortho, 1.5f, 0.01f);
+	Frustum orthoFrustum = Frustum_FromView(&ortho, &cameraToWorld, 0, 100);
+	mismatches = 0;
+	for (int32 i = 0; i < TestFrustum_ObjectCount; i++)
+	{
+		Vec3 point = Vec3_New(Test_RandomFloat(&random, -200, 200), Test_RandomFloat(&random, -200, 200), Test_RandomFloat(&random, -200, 200));
+		Vec3 local = Transformer_ApplyPoint(&worldToCamera, point);
+		bool inside = local.x >= 0 && local.x <= 100 && Abs(local.y*ortho.xScale) <= 0.5f && Abs(local.z*ortho.yScale) <= 0.5f;
+		if (Frustum_TestSphere(&orthoFrustum, point, 0) != inside && MinPlaneDistance(&orthoFrustum, point) > 1e-3f)
+		{
+			mismatches++;
+		}
+	}
+	Test_Check(mismatches == 0);
+}
+
+static void TestCullMatchesSingleTests()
+{
+	View view;
+	Transformer cameraToWorld;
+	Frustum frustum = MakeFrustum(&view, &cameraToWorld);
+
+	// one float of offset so the simd loads aren't aligned.
+	float* storage = (float*)MAlloc((TestFrustum_ObjectCount+1)*7*sizeof(float));
+	float* arrays[7];
+	for (int32 i = 0; i < 7; i++)
+	{
+		arrays[i] = storage+1+i*(TestFrustum_ObjectCount+1);
+	}
+	SphereSoA spheres = { { arrays[0], arrays[1], arrays[2] }, arrays[3] };
+	AabbSoA aabbs = { { arrays[0], arrays[1], arrays[2] }, { arrays[4], arrays[5], arrays[6] } };
+	uint32 random = 2;
+	for (int32 i = 0; i < TestFrustum_ObjectCount; i++)
+	{
+		for (int32 k = 0; k < 3; k++)
+		{
+			arrays[k][i] = Test_RandomFloat(&random, -500, 500);
+		}
+		for (int32 k = 3; k < 7; k++)
+		{
+			arrays[k][i] = Test_RandomFloat(&random, 0.1f, 20);
+		}
+	}
+
+	int32* expected = (int32*)MAlloc(TestFrustum_ObjectCount*sizeof(int32));
+	int32* indices = (int32*)MAlloc(TestFrustum_ObjectCount*sizeof(int32));
+	// counts around the simd widths and the parallel split.
+	const int32 counts[] = { 0, 1, 3, 4, 5, 8, 13, 1000, TestFrustum_ObjectCount };
+	for (int32 c = 0; c < (int32)ArrayCountOf(counts); c++)
+	{
+		int32 count = counts[c];
+
+		int32 expectedCount = 0;
+		for (int32 i = 0; i < count; i++)
+		{
+			if (Frustum_TestSphere(&frustum, Vec3_New(arrays[0][i], arrays[1][i], arrays[2][i]), arrays[3][i]))
+			{
+				expected[expectedCount++] = i;
+			}
+		}
+		int32 culled = Frustum_CullSpheres(&frustum, &spheres, count, indices);
+		Test_CheckMessage(culled == expectedCount && MemCmp(indices, expected, culled*sizeof(int32)) == 0, "spheres, count %d", count);
+		culled = Frustum_CullSpheresParallel(&frustum, &spheres, count, indices, 3);
+		Test_CheckMessage(culled == expectedCount && MemCmp(indices, expected, culled*sizeof(int32)) == 0, "parallel spheres, count %d", count);
+
+		expectedCount = 0;
+		for (int32 i = 0; i < count; i++)
+		{
+			if (Frustum_TestAabb(&frustum, Vec3_New(arrays[0][i], arrays[1][i], arrays[2][i]), Vec3_New(arrays[4][i], arrays[5][i], arrays[6][i])))
+			{
+				expected[expectedCount++] = i;
+			}
+		}
+		culled = Frustum_CullAabbs(&frustum, &aabbs, count, indices);
+		Test_CheckMessage(culled == expectedCount && MemCmp(indices, expected, culled*sizeof(int32)) == 0, "aabbs, count %d", count);
+		culled = Frustum_CullAabbsParallel(&frustum, &aabbs, count, indices, 3);
+		Test_CheckMessage(culled == expectedCount && MemCmp(indices, expected, culled*sizeof(int32)) == 0, "parallel aabbs, count %d", count);
+	}
+
+	MFree(indices);
+	MFree(expected);
+	MFree(storage);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestFromView);
+	Test_Run(TestCullMatchesSingleTests);
+	return Test_Finish();
+}
@@ -0,0 +1,275 @@
+#include "Test.h"
+
+#include "draw/Draw.h"
+#include "draw/FrameStats.h"
+#include "draw/GpuProfiler.h"
+#include "draw/null/DrawBackendNull.h"
+
+// the profiler runs on the null backend with queries wrapped by a stub gpu. every timestamp is 1000 nanoseconds, so 10
+// ticks, after the one before it, and pipeline statistics queries count 7 primitives and 11 samples. a query's result is
+// available once the frame it was made in is below completedFrames, unless it's the stalled frame. Present does what
+// Window_Present does around the present.
+
+#define TestGpuProfiler_MaxQueries (1 << 16)
+#define TestGpuProfiler_TimestampStep 1000
+#define TestGpuProfiler_TicksPerStep 10
+
+static DrawBackend backend;
+static uint64 queryValues[TestGpuProfiler_MaxQueries];
+static int64 queryFrames[TestGpuProfiler_MaxQueries];
+static uint32 activeQueries[GpuQueryType_Count];
+static uint64 gpuClock;
+// presents so far.
+static int64 currentFrame;
+static int64 completedFrames;
+static int64 stalledFrame;
+static uint64 presentEnd;
+
+static void StubQueryTimestamp(uint32 query)
+{
+	if (query < TestGpuProfiler_MaxQueries)
+	{
+		gpuClock += TestGpuProfiler_TimestampStep;
+		queryValues[query] = gpuClock;
+		queryFrames[query] = currentFrame;
+	}
+	DrawBackendNull_Get()->queryTimestamp(query);
+}
+
+static void StubQueryBegin(uint32 query, GpuQueryType type)
+{
+	activeQueries[type] = query;
+	DrawBackendNull_Get()->queryBegin(query, type);
+}
+
+static void StubQueryEnd(GpuQueryType type)
+{
+	uint32 query = activeQueries[type];
+	if (query < TestGpuProfiler_MaxQueries)
+	{
+		queryValues[query] = type == GpuQueryType_PrimitivesGenerated ? 7 : 11;
+		queryFrames[query] = currentFrame;
+	}
+	DrawBackendNull_Get()->queryEnd(type);
+}
+
+static bool StubQueryGetResult(uint32 query, uint64* result)
+{
+	DrawBackendNull_Get()->queryGetResult(query, result);
+	if (query >= TestGpuProfiler_MaxQueries || queryFrames[query] >= completedFrames || queryFrames[query] == stalledFrame)
+	{
+		return false;
+	}
+	*result = queryValues[query];
+	return true;
+}
+
+static void Init(GpuProfiler* profiler, bool pipelineStatistics)
+{
+	backend = *DrawBackendNull_Get();
+	backend.queryTimestamp = StubQueryTimestamp;
+	backend.queryBegin = StubQueryBegin;
+	backend.queryEnd = StubQueryEnd;
+	backend.queryGetResult = StubQueryGetResult;
+	Draw_Init(&backend);
+	gpuClock = 0;
+	currentFrame = 0;
+	completedFrames = 0;
+	stalledFrame = -1;
+	presentEnd = 1000000;
+	GpuProfiler_Init(profiler, pipelineStatistics);
+}
+
+static void Free(GpuProfiler* profiler)
+{
+	GpuProfiler_Free(profiler);
+	Draw_Free();
+}
+
+// when gpuKeepsUp, the frame that was just presented is finished by the time the next one begins.
+static void Present(GpuProfiler* profiler, FrameStats* frameStats, bool gpuKeepsUp)
+{
+	GpuProfiler_EndFrame(profiler, frameStats);
+	currentFrame++;
+	if (gpuKeepsUp)
+	{
+		completedFrames = currentFrame;
+	}
+	if (frameStats)
+	{
+		presentEnd += 160000;
+		FrameStats_OnPresent(frameStats, presentEnd-30, presentEnd);
+	}
+	GpuProfiler_BeginFrame(profiler, frameStats);
+}
+
+static void RecordScopes(GpuProfiler* profiler, int32 count)
+{
+	for (int32 i = 0; i < count; i++)
+	{
+		GpuProfiler_BeginScope(profiler, "scope");
+		GpuProfiler_EndScope(profiler);
+	}
+}
+
+static const char* scopeNames[4] = { "a", "b", "c", "d" };
+
+static void TestNesting()
+{
+	GpuProfiler profiler;
+	Init(&profiler, true);
+	DrawBackendNullCounters before = gDrawBackendNullCounters;
+	GpuProfiler_BeginScope(&profiler, scopeNames[0]);
+	GpuProfiler_BeginScope(&profiler, scopeNames[1]);
+	GpuProfiler_EndScope(&profiler);
+	GpuProfiler_BeginScope(&profiler, scopeNames[2]);
+	GpuProfiler_EndScope(&profiler);
+	GpuProfiler_EndScope(&profiler);
+	GpuProfiler_BeginScope(&profiler, scopeNames[3]);
+	GpuProfiler_EndScope(&profiler);
+	// only the outermost scopes count primitives and samples.
+	Test_Check(gDrawBackendNullCounters.calls[DrawBackendCall_QueryBegin]-before.calls[DrawBackendCall_QueryBegin] == 4);
+	Test_Check(GpuProfiler_GetLastFrame(&profiler)->frameNumber == -1);
+	Present(&profiler, null, true);
+
+	// the frame's timestamps are begin, a, b, b end, c, c end, a end, d, d end, end.
+	const GpuProfilerFrame* frame = GpuProfiler_GetLastFrame(&profiler);
+	Test_Check(frame->scopeCount == 4);
+	Test_Check(frame->ticks == 9*TestGpuProfiler_TicksPerStep);
+	int32 depths[4] = { 0, 1, 1, 0 };
+	uint64 ticks[4] = { 5*TestGpuProfiler_TicksPerStep, TestGpuProfiler_TicksPerStep, TestGpuProfiler_TicksPerStep, TestGpuProfiler_TicksPerStep };
+	for (int32 i = 0; i < 4; i++)
+	{
+		const GpuProfilerScope* scope = &frame->scopes[i];
+		Test_Check(scope->name == scopeNames[i]);
+		Test_Check(scope->depth == depths[i] && scope->ticks == ticks[i]);
+		Test_Check(scope->primitivesGenerated == (depths[i] == 0 ? 7u : 0u) && scope->samplesPassed == (depths[i] == 0 ? 11u : 0u));
+	}
+	Test_Check(frame->primitivesGenerated == 14 && frame->samplesPassed == 22);
+	Test_Check(profiler.droppedFrames == 0 && profiler.droppedScopes == 0);
+	Free(&profiler);
+}
+
+static void TestDroppedScopes()
+{
+	GpuProfiler profiler;
+	Init(&profiler, false);
+	RecordScopes(&profiler, GpuProfiler_MaxScopes-1);
+	// the outer scope is measured, the one inside it and the ones after it aren't.
+	GpuProfiler_BeginScope(&profiler, "outer");
+	RecordScopes(&profiler, 1);
+	GpuProfiler_EndScope(&profiler);
+	RecordScopes(&profiler, 5);
+	Test_Check(profiler.droppedScopes == 6 && profiler.depth == 0);
+	Present(&profiler, null, true);
+	const GpuProfilerFrame* frame = GpuProfiler_GetLastFrame(&profiler);
+	Test_Check(frame->scopeCount == GpuProfiler_MaxScopes);
+	Test_Check(frame->scopes[GpuProfiler_MaxScopes-1].depth == 0 && frame->scopes[GpuProfiler_MaxScopes-1].ticks == TestGpuProfiler_TicksPerStep);
+
+	// the next frame has all its scopes again.
+	RecordScopes(&profiler, 3);
+	Present(&profiler, null, true);
+	Test_Check(GpuProfiler_GetLastFrame(&profiler)->scopeCount == 3 && profiler.droppedScopes == 6);
+	Free(&profiler);
+}
+
+static void TestDroppedFrames()
+{
+	GpuProfiler profiler;
+	Init(&profiler, false);
+	// the gpu never gets anything done, the queries of every frame in flight are used up after the third present.
+	for (int32 i = 0; i < 10; i++)
+	{
+		RecordScopes(&profiler, 1);
+		Present(&profiler, null, false);
+	}
+	Test_Check(profiler.recordedFrames == GpuProfiler_MaxFramesInFlight && profiler.readFrames == 0);
+	Test_Check(profiler.droppedFrames == 10-(GpuProfiler_MaxFramesInFlight-1));
+	Test_Check(profiler.recording == null && profiler.droppedScopes == 0);
+	Test_Check(GpuProfiler_GetLastFrame(&profiler)->frameNumber == -1 && GpuProfiler_GetLastFrame(&profiler)->scopeCount == 0);
+
+	// once it catches up every frame is read and measuring starts again.
+	uint64 droppedFrames = profiler.droppedFrames;
+	Present(&profiler, null, true);
+	Test_Check(profiler.readFrames == GpuProfiler_MaxFramesInFlight && profiler.recording != null);
+	Test_Check(profiler.droppedFrames == droppedFrames && GpuProfiler_GetLastFrame(&profiler)->scopeCount == 1);
+	Free(&profiler);
+}
+
+static void TestReadbackOrder()
+{
+	GpuProfiler profiler;
+	Init(&profiler, false);
+	// frame i has i+1 scopes.
+	for (int32 i = 0; i < GpuProfiler_MaxFramesInFlight-1; i++)
+	{
+		RecordScopes(&profiler, i+1);
+		Present(&profiler, null, false);
+	}
+	RecordScopes(&profiler, GpuProfiler_MaxFramesInFlight);
+
+	// frame 1 is late while the frames after it are done, only frame 0 can be read.
+	stalledFrame = 1;
+	Present(&profiler, null, true);
+	Test_Check(profiler.readFrames == 1 && GpuProfiler_GetLastFrame(&profiler)->scopeCount == 1);
+	Present(&profiler, null, true);
+	Test_Check(profiler.readFrames == 1);
+
+	// then the rest come in order, the last one read is the newest.
+	stalledFrame = -1;
+	Present(&profiler, null, false);
+	Test_Check(profiler.readFrames == GpuProfiler_MaxFramesInFlight+1 && profiler.readFrames == profiler.recordedFrames);
+	Test_Check(profiler.droppedFrames == 1);
+	Test_Check(GpuProfiler_GetLastFrame(&profiler)->scopeCount == 0);
+	Free(&profiler);
+}
+
+static void TestFrameNumbers()
+{
+	GpuProfiler profiler;
+	Init(&profiler, false);
+	FrameStats* frameStats = (FrameStats*)MAlloc(sizeof(FrameStats));
+	FrameStats_Init(frameStats);
+	// the profiler's frame i has i scopes, so i*2+1 steps. frame 0 ends before FrameStats' first present and frame i is
+	// FrameStats' frame i-1.
+	int32 frameCount = 20;
+	for (int32 i = 0; i < frameCount; i++)
+	{
+		RecordScopes(&profiler, i);
+		Present(&profiler, frameStats, true);
+		if (i == 0)
+		{
+			Test_Check(GpuProfiler_GetLastFrame(&profiler)->frameNumber == -1 && frameStats->sampleCount == 0);
+		}
+	}
+	Test_Check(frameStats->sampleCount == frameCount-1);
+	Test_Check(GpuProfiler_GetLastFrame(&profiler)->frameNumber == frameCount-2);
+	for (int32 age = 0; age < frameStats->sampleCount; age++)
+	{
+		const FrameStatsSample* sample = FrameStats_GetSample(frameStats, age);
+		uint64 expected = (uint64)((sample->frameNumber+1)*2+1)*TestGpuProfiler_TicksPerStep;
+		Test_Check(sample->ticks[FrameStatsChannel_Gpu] == expected);
+	}
+
+	// results that arrive late still land on their own frame.
+	Present(&profiler, frameStats, false);
+	Present(&profiler, frameStats, false);
+	const FrameStatsSample* newest = FrameStats_GetSample(frameStats, 0);
+	Test_Check(newest->ticks[FrameStatsChannel_Gpu] == 0);
+	Present(&profiler, frameStats, true);
+	Test_Check(FrameStats_GetSample(frameStats, 1)->ticks[FrameStatsChannel_Gpu] == TestGpuProfiler_TicksPerStep);
+	Test_Check(FrameStats_GetSample(frameStats, 0)->ticks[FrameStatsChannel_Gpu] == TestGpuProfiler_TicksPerStep);
+	MFree(frameStats);
+	Free(&profiler);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestNesting);
+	Test_Run(TestDroppedScopes);
+	Test_Run(TestDroppedFrames);
+	Test_Run(TestReadbackOrder);
+	Test_Run(TestFrameNumbers);
+	return Test_Finish();
+}
@@ -0,0 +1,188 @@
+#include "Test.h"
+
+#include "common/CString.h"
+#include "common/Log.h"
+#include "common/Math.h"
+#include "common/Thread.h"
+
+// collects everything written to it.
+typedef struct CaptureSink
+{
+	LogSink sink;
+	char* text;
+	int64 length;
+	int64 capacity;
+	int32 warningCount;
+} CaptureSink;
+
+static void CaptureWrite(LogSink* self, LogLevel level, LogCategory category, const char* text, int32 length)
+{
+	Unused(category);
+	CaptureSink* capture = (CaptureSink*)self->userData;
+	if (capture->length+length+1 > capture->capacity)
+	{
+		capture->capacity = MaxI64(capture->length+length+1, capture->capacity*2);
+		capture->text = (char*)MRealloc(capture->text, capture->capacity);
+	}
+	MemCpy(capture->text+capture->length, text, length);
+	capture->length += length;
+	capture->text[capture->length] = 0;
+	if (level == LogLevel_Warning)
+	{
+		capture->warningCount++;
+	}
+}
+
+static CaptureSink capture;
+
+static void ResetCapture()
+{
+	MFree(capture.text);
+	capture.text = null;
+	capture.length = 0;
+	capture.capacity = 0;
+	capture.warningCount = 0;
+}
+
+static void TestFormatting()
+{
+	Log_Init();
+	LogF(LogLevel_Info, LogCategory_General, "%d|%5.2f|%-4s|%*d|%.*s|%lld|%zu|%ls|%%|%c|%s", 42, 3.14159, "ab", 4, 7, 3, "abcdef",
+		-5ll, (size_t)99, L"wide", 'Q', "end");
+	Log_Flush();
+	Test_Check(capture.text && StrCmp(capture.text, "42| 3.14|ab  |   7|abc|-5|99|wide|%|Q|end", true) == 0);
+	ResetCapture();
+
+	Log_SetMinLevel(LogLevel_Warning);
+	LogF(LogLevel_Info, LogCategory_General, "filtered");
+	Log_SetMinLevel(LogLevel_Debug);
+	Log_SetCategoryEnabled(LogCategory_Draw, false);
+	LogF(LogLevel_Error, LogCategory_Draw, "filtered");
+	Log_SetCategoryEnabled(LogCategory_Draw, true);
+	Log_Flush();
+	Test_Check(capture.length == 0);
+	Log_Free();
+}
+
+static void TestLongMessages()
+{
+	// longer than a record, so written synchronously, and long %s arguments, like shader info logs.
+	const int32 lengths[] = { 3000, Log_ThreadBufferSize/4, 40000 };
+	for (int32 i = 0; i < (int32)ArrayCountOf(lengths); i++)
+	{
+		char* big = (char*)MAlloc(lengths[i]+1);
+		MemSet(big, 'a'+i, lengths[i]);
+		big[lengths[i]] = 0;
+
+		Log_Init();
+		PrintF("before ");
+		PrintF("%sshader %s:\n%s", "vertex ", "compilation failed", big);
+		Log_Write(LogLevel_Info, LogCategory_General, big);
+		PrintF(" after");
+		Log_Free();
+
+		int64 expectedLength = StrLen("before ")+StrLen("vertex shader compilation failed:\n")+lengths[i]*2+StrLen(" after");
+		Test_CheckMessage(capture.length == expectedLength, "length %d: wrote %lld, expected %lld", lengths[i], (long long)capture.length, (long long)expectedLength);
+		Test_Check(capture.text && StrNCmp(capture.text, "before vertex shader", 20, true) == 0);
+		Test_Check(capture.text && StrCmp(capture.text+capture.length-6, " after", true) == 0);
+		ResetCapture();
+		MFree(big);
+	}
+}
+
+static void TestWarningsNotDropped()
+{
+	Log_Init();
+	// far more than a ring holds, faster than the flush thread drains it.
+	const int32 count = 20000;
+	uint32 droppedBefore = Log_GetDroppedCount();
+	for (int32 i = 0; i < count; i++)
+	{
+		LogF(LogLevel_Warning, LogCategory_General, "w%05d\n", i);
+	}
+	Log_Free();
+	Test_Check(Log_GetDroppedCount() == droppedBefore);
+	Test_Check(capture.length == (int64)count*7);
+	ResetCapture();
+}
+
+static volatile uint32 stopLogging;
+
+static void LogUntilStopped(void* userData)
+{
+	Unused(userData);
+	while (!Atomic_LoadAcquire32(&stopLogging))
+	{
+		LogF(LogLevel_Info, LogCategory_General, "%d %s\n", 1, "info");
+		LogF(LogLevel_Warning, LogCategory_General, "%d\n", 2);
+	}
+}
+
+static void TestFreeWhileLogging()
+{
+	// threads keep logging while the log is stopped and restarted under them. run under asan or tsan to see it's safe.
+	Thread threads[4];
+	Log_Init();
+	for (int32 i = 0; i < 4; i++)
+	{
+		Thread_Start(&threads[i], LogUntilStopped, null);
+	}
+	for (int32 i = 0; i < 100; i++)
+	{
+		Log_Free();
+		Log_Init();
+	}
+	Atomic_StoreRelease32(&stopLogging, true);
+	for (int32 i = 0; i < 4; i++)
+	{
+		Thread_Join(&threads[i]);
+	}
+	Log_Free();
+	Test_Check(capture.warningCount > 0);
+	ResetCapture();
+}
+
+static void LogChunk(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	Unused(userData);
+	Unused(start);
+	Unused(count);
+	LogF(LogLevel_Info, LogCategory_General, "%d", chunkIndex);
+}
+
+static void TestThreadExit()
+{
+	// Thread_ParallelFor starts new threads every call, their rings go away once they've exited and been drained.
+	Log_Init();
+	int32 messageCount = 0;
+	for (int32 i = 0; i < 200; i++)
+	{
+		messageCount += Thread_ParallelFor(4, 4, 1, 1, LogChunk, null);
+	}
+	Log_Flush();
+	// only the calling thread's is left.
+	Test_Check(Log_GetThreadBufferCount() == 1);
+	Test_Check(capture.length == messageCount);
+	Log_Free();
+	Test_Check(Log_GetThreadBufferCount() == 0);
+	ResetCapture();
+}
+
+int main()
+{
+	Test_Init();
+	capture.sink.write = CaptureWrite;
+	capture.sink.userData = &capture;
+	Log_RemoveSink(Log_GetConsoleSink());
+	Log_AddSink(&capture.sink);
+
+	Test_Run(TestFormatting);
+	Test_Run(TestLongMessages);
+	Test_Run(TestWarningsNotDropped);
+	Test_Run(TestFreeWhileLogging);
+	Test_Run(TestThreadExit);
+
+	Log_RemoveSink(&capture.sink);
+	Log_AddSink(Log_GetConsoleSink());
+	return Test_Finish();
+}
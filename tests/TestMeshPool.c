@@ -0,0 +1,252 @@
+#include "Test.h"
+
+#include "draw/Draw.h"
+#include "draw/Mesh.h"
+#include "draw/MeshPool.h"
+#include "draw/Shader.h"
+#include "draw/null/DrawBackendNull.h"
+
+// the pool runs on the null backend with buffer uploads and multi draw indirect calls wrapped. stream buffers are plain
+// memory there, so each call's commands and the draw data their baseInstance points at are read back when it's made,
+// before later writes can reuse the memory. each draw's data holds its index in the order it was recorded.
+
+#define TestMeshPool_MaxDraws 200000
+#define TestMeshPool_MeshCount 5
+
+typedef struct TestDrawData
+{
+	int32 index;
+	float padding[15];
+} TestDrawData;
+
+typedef struct TestCommand
+{
+	Shader* shader;
+	DrawIndexedIndirectCommand command;
+	// the index in the draw data baseInstance points at.
+	int32 drawIndex;
+} TestCommand;
+
+static DrawBackend backend;
+static StreamBuffer* streamBuffers[8];
+static int32 streamBufferCount;
+static Shader* currentShader;
+static TestCommand* commands;
+static int32 commandCount;
+static int32 indirectCallCount;
+static int32 lastUploadOffset, lastUploadSize;
+
+static void LogStreamBufferInit(StreamBuffer* streamBuffer)
+{
+	DrawBackendNull_Get()->streamBufferInit(streamBuffer);
+	if (streamBufferCount < ArrayCountOf(streamBuffers))
+	{
+		streamBuffers[streamBufferCount++] = streamBuffer;
+	}
+}
+
+static const uint8* GetStreamData(int32 handle)
+{
+	for (int32 i = 0; i < streamBufferCount; i++)
+	{
+		if (streamBuffers[i]->internalHandle == handle)
+		{
+			return streamBuffers[i]->persistentData;
+		}
+	}
+	return null;
+}
+
+static void LogShaderSet(Shader* shader)
+{
+	currentShader = shader;
+	DrawBackendNull_Get()->shaderSet(shader);
+}
+
+static void LogIndexBufferUpdateData(IndexBuffer* indexBuffer, int32 offset, int32 size, void* data)
+{
+	lastUploadOffset = offset;
+	lastUploadSize = size;
+	DrawBackendNull_Get()->indexBufferUpdateData(indexBuffer, offset, size, data);
+}
+
+static void LogMeshDrawIndexedIndirect(Mesh* mesh, int32 commandBuffer, int32 commandOffset, int32 count)
+{
+	indirectCallCount++;
+	const DrawIndexedIndirectCommand* source = (const DrawIndexedIndirectCommand*)(GetStreamData(commandBuffer)+commandOffset);
+	const uint8* drawData = mesh->vertexBufferCount > 1 ? GetStreamData(mesh->vertexBuffers[1].internalHandle) : null;
+	for (int32 i = 0; i < count && commandCount < TestMeshPool_MaxDraws; i++)
+	{
+		TestCommand* logged = &commands[commandCount++];
+		logged->shader = currentShader;
+		logged->command = source[i];
+		logged->drawIndex = drawData ? ((const TestDrawData*)drawData)[source[i].baseInstance].index : -1;
+	}
+	DrawBackendNull_Get()->meshDrawIndexedIndirect(mesh, commandBuffer, commandOffset, count);
+}
+
+static Shader shaders[3];
+static MeshPoolRange ranges[TestMeshPool_MeshCount];
+static VertexFormatItem vertexFormat[] =
+{
+	{ .inputIndex = 0, .bufferIndex = 0, .offset = 0, .stride = 12, .type = VertexFormatType_Float, .componentCount = 3 },
+};
+static VertexFormatItem drawDataFormat[] =
+{
+	{ .inputIndex = 1, .offset = 0, .stride = sizeof(TestDrawData), .type = VertexFormatType_Float, .componentCount = 4 },
+};
+
+static void Init(MeshPool* pool)
+{
+	backend = *DrawBackendNull_Get();
+	backend.streamBufferInit = LogStreamBufferInit;
+	backend.shaderSet = LogShaderSet;
+	backend.indexBufferUpdateData = LogIndexBufferUpdateData;
+	backend.meshDrawIndexedIndirect = LogMeshDrawIndexedIndirect;
+	streamBufferCount = 0;
+	Draw_Init(&backend);
+	commands = (TestCommand*)MAlloc(TestMeshPool_MaxDraws*sizeof(TestCommand));
+	commandCount = 0;
+	indirectCallCount = 0;
+
+	MeshPool_Init(pool, vertexFormat, 1, drawDataFormat, 1, 1000, 3000);
+	// meshes of 3 to 7 vertices with as many triangles.
+	float vertices[7*3] = { 0 };
+	uint32 indices[7*3];
+	for (int32 i = 0; i < ArrayCountOf(indices); i++)
+	{
+		indices[i] = i%7;
+	}
+	for (int32 i = 0; i < TestMeshPool_MeshCount; i++)
+	{
+		int32 vertexCount = 3+i;
+		ranges[i] = MeshPool_Add(pool, vertices, vertexCount, indices, vertexCount*3);
+	}
+}
+
+static void Free(MeshPool* pool)
+{
+	MeshPool_Free(pool);
+	MFree(commands);
+	Draw_Free();
+}
+
+static Shader* GetShader(int32 drawIndex)
+{
+	return &shaders[(drawIndex/5)%ArrayCountOf(shaders)];
+}
+
+static void Record(MeshPool* pool, int32 drawCount)
+{
+	DrawState drawState = { 0 };
+	for (int32 i = 0; i < drawCount; i++)
+	{
+		TestDrawData data = { i };
+		MeshPool_Draw(pool, GetShader(i), &drawState, ranges[i%TestMeshPool_MeshCount], &data);
+	}
+}
+
+// every draw was issued once, with its own range and shader and draw data.
+static int32 CountWrongCommands(int32 drawCount)
+{
+	bool* seen = (bool*)MAlloc(drawCount*sizeof(bool));
+	MemSet(seen, 0, drawCount*sizeof(bool));
+	int32 wrong = commandCount != drawCount;
+	for (int32 i = 0; i < commandCount; i++)
+	{
+		int32 drawIndex = commands[i].drawIndex;
+		if (drawIndex < 0 || drawIndex >= drawCount || seen[drawIndex])
+		{
+			wrong++;
+			continue;
+		}
+		seen[drawIndex] = true;
+		MeshPoolRange range = ranges[drawIndex%TestMeshPool_MeshCount];
+		const DrawIndexedIndirectCommand* command = &commands[i].command;
+		wrong += commands[i].shader != GetShader(drawIndex);
+		wrong += command->indexCount != (uint32)range.indexCount || command->firstIndex != (uint32)range.firstIndex || command->baseVertex != range.baseVertex;
+		wrong += command->instanceCount != 1;
+	}
+	MFree(seen);
+	return wrong;
+}
+
+static void TestAdd()
+{
+	MeshPool pool;
+	Init(&pool);
+	// each range starts where the last one ended, indices stay relative to the mesh's vertices.
+	int32 firstIndex = 0, baseVertex = 0;
+	for (int32 i = 0; i < TestMeshPool_MeshCount; i++)
+	{
+		Test_Check(ranges[i].firstIndex == firstIndex && ranges[i].baseVertex == baseVertex && ranges[i].indexCount == (3+i)*3);
+		firstIndex += ranges[i].indexCount;
+		baseVertex += 3+i;
+	}
+	Test_Check(pool.vertexCount == baseVertex && pool.indexCount == firstIndex);
+	// the last upload went right after the previous indices, in bytes.
+	Test_Check(lastUploadOffset == ranges[TestMeshPool_MeshCount-1].firstIndex*(int32)sizeof(uint32));
+	Test_Check(lastUploadSize == ranges[TestMeshPool_MeshCount-1].indexCount*(int32)sizeof(uint32));
+	Free(&pool);
+}
+
+static void TestSubmit()
+{
+	MeshPool pool;
+	Init(&pool);
+	Record(&pool, 1000);
+	Test_Check(pool.bucketCount == 3);
+	MeshPool_Submit(&pool);
+	Test_Check(CountWrongCommands(1000) == 0);
+	// one call per bucket, in the order the buckets were first used.
+	Test_Check(indirectCallCount == 3);
+	Test_Check(commands[0].shader == &shaders[0] && commands[400].shader == &shaders[1] && commands[999].shader == &shaders[2]);
+
+	// the next frame reuses the buckets, and a bucket that gets no draws is skipped.
+	commandCount = 0;
+	indirectCallCount = 0;
+	DrawState drawState = { 0 };
+	for (int32 i = 0; i < 10; i++)
+	{
+		TestDrawData data = { i };
+		MeshPool_Draw(&pool, &shaders[2], &drawState, ranges[i%TestMeshPool_MeshCount], &data);
+	}
+	drawState.blendMode = BlendMode_Alpha;
+	TestDrawData data = { 10 };
+	MeshPool_Draw(&pool, &shaders[2], &drawState, ranges[0], &data);
+	Test_Check(pool.bucketCount == 4);
+	MeshPool_Submit(&pool);
+	Test_Check(indirectCallCount == 2 && commandCount == 11);
+	Test_Check(commands[10].drawIndex == 10 && commands[9].drawIndex == 9);
+	MeshPool_Submit(&pool);
+	Test_Check(indirectCallCount == 2);
+	Free(&pool);
+}
+
+// more draws than the instance stream takes at once. the pool submits what it has mid record, and the draws after
+// that get baseInstances in the new part of the stream.
+static void TestMidRecordSubmit()
+{
+	MeshPool pool;
+	Init(&pool);
+	int32 maxDraws = Draw_GetMaxStreamedInstances(sizeof(TestDrawData));
+	int32 drawCount = maxDraws*2+100;
+	Test_Check(drawCount <= TestMeshPool_MaxDraws);
+	Record(&pool, drawCount);
+	// two submits happened already.
+	Test_Check(indirectCallCount == 6 && commandCount == maxDraws*2);
+	Test_Check(pool.drawCount == 100);
+	MeshPool_Submit(&pool);
+	Draw_EndFrame();
+	Test_Check(CountWrongCommands(drawCount) == 0);
+	Free(&pool);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestAdd);
+	Test_Run(TestSubmit);
+	Test_Run(TestMidRecordSubmit);
+	return Test_Finish();
+}
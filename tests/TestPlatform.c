@@ -0,0 +1,277 @@
+#include "Test.h"
+
+#include "common/CString.h"
+#include "common/File.h"
+#include "common/Thread.h"
+#include "common/Time.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#define TestPlatform_ThreadCount 8
+#define TestPlatform_Increments 20000
+
+typedef struct CounterTest
+{
+	Mutex mutex;
+	int64 counter;
+} CounterTest;
+
+static void IncrementUnderLock(void* userData)
+{
+	CounterTest* test = (CounterTest*)userData;
+	for (int32 i = 0; i < TestPlatform_Increments; i++)
+	{
+		Mutex_Lock(&test->mutex);
+		// recursive, the inner lock must not deadlock.
+		Mutex_Lock(&test->mutex);
+		test->counter++;
+		Mutex_Unlock(&test->mutex);
+		Mutex_Unlock(&test->mutex);
+	}
+}
+
+static void TestMutex()
+{
+	CounterTest test = { 0 };
+	Thread threads[TestPlatform_ThreadCount];
+	for (int32 i = 0; i < TestPlatform_ThreadCount; i++)
+	{
+		Thread_Start(&threads[i], IncrementUnderLock, &test);
+	}
+	for (int32 i = 0; i < TestPlatform_ThreadCount; i++)
+	{
+		Thread_Join(&threads[i]);
+	}
+	Test_Check(test.counter == (int64)TestPlatform_ThreadCount*TestPlatform_Increments);
+	Mutex_Free(&test.mutex);
+}
+
+typedef struct PingPongTest
+{
+	Semaphore ping;
+	Semaphore pong;
+	volatile int32 value;
+} PingPongTest;
+
+static void Ponger(void* userData)
+{
+	PingPongTest* test = (PingPongTest*)userData;
+	for (int32 i = 0; i < 1000; i++)
+	{
+		Semaphore_Wait(&test->ping);
+		test->value++;
+		Semaphore_Signal(&test->pong);
+	}
+}
+
+static void TestSemaphore()
+{
+	PingPongTest test = { 0 };
+	Thread thread;
+	Thread_Start(&thread, Ponger, &test);
+	bool inLockstep = true;
+	for (int32 i = 0; i < 1000; i++)
+	{
+		Semaphore_Signal(&test.ping);
+		Semaphore_Wait(&test.pong);
+		inLockstep &= test.value == i+1;
+	}
+	Thread_Join(&thread);
+	Test_Check(inLockstep);
+
+	// counts accumulate when nobody waits.
+	Semaphore counted = { 0 };
+	for (int32 i = 0; i < 5; i++)
+	{
+		Semaphore_Signal(&counted);
+	}
+	for (int32 i = 0; i < 5; i++)
+	{
+		Semaphore_Wait(&counted);
+	}
+	Test_Check(counted.count == 0);
+
+	Semaphore_Free(&counted);
+	Semaphore_Free(&test.ping);
+	Semaphore_Free(&test.pong);
+}
+
+typedef struct ParallelForTest
+{
+	uint8* visits;
+	int64 granularity;
+	volatile int32 badChunks;
+	int64 chunkStarts[Thread_MaxParallelForChunks];
+} ParallelForTest;
+
+static void VisitRange(void* userData, int64 start, int64 count, int32 chunkIndex)
+{
+	ParallelForTest* test = (ParallelForTest*)userData;
+	if (chunkIndex < 0 || chunkIndex >= Thread_MaxParallelForChunks || start%test->granularity != 0)
+	{
+		Atomic_Increment32(&test->badChunks);
+		return;
+	}
+	test->chunkStarts[chunkIndex] = start;
+	for (int64 i = start; i < start+count; i++)
+	{
+		test->visits[i]++;
+	}
+}
+
+static void TestParallelFor()
+{
+	const int64 counts[] = { 1, 7, 1000, 100003 };
+	const int32 threadCounts[] = { 0, 1, 3, 64, 200 };
+	for (int32 c = 0; c < (int32)ArrayCountOf(counts); c++)
+	{
+		for (int32 t = 0; t < (int32)ArrayCountOf(threadCounts); t++)
+		{
+			ParallelForTest test = { 0 };
+			test.visits = (uint8*)MAlloc(counts[c]);
+			MemSet(test.visits, 0, counts[c]);
+			test.granularity = 16;
+			int32 chunkCount = Thread_ParallelFor(counts[c], threadCounts[t], 1, test.granularity, VisitRange, &test);
+
+			bool everyIndexOnce = true;
+			for (int64 i = 0; i < counts[c]; i++)
+			{
+				everyIndexOnce &= test.visits[i] == 1;
+			}
+			bool startsIncrease = true;
+			for (int32 i = 1; i < chunkCount; i++)
+			{
+				startsIncrease &= test.chunkStarts[i] > test.chunkStarts[i-1];
+			}
+			Test_CheckMessage(everyIndexOnce && startsIncrease && test.badChunks == 0 && chunkCount >= 1 && chunkCount <= Thread_MaxParallelForChunks,
+				"count %lld, threads %d, chunks %d", (long long)counts[c], threadCounts[t], chunkCount);
+			MFree(test.visits);
+		}
+	}
+
+	// minCountPerThread limits the number of chunks.
+	ParallelForTest test = { 0 };
+	test.visits = (uint8*)MAlloc(1000);
+	MemSet(test.visits, 0, 1000);
+	test.granularity = 1;
+	Test_Check(Thread_ParallelFor(1000, 8, 500, 1, VisitRange, &test) <= 2);
+	MFree(test.visits);
+
+	Test_Check(Thread_ParallelFor(0, 4, 1, 1, VisitRange, &test) == 0);
+	Test_Check(Thread_GetHardwareThreadCount() >= 1);
+}
+
+static void TestTime()
+{
+	uint64 previous = GetTicks();
+	bool monotonic = true;
+	for (int32 i = 0; i < 100000; i++)
+	{
+		uint64 now = GetTicks();
+		monotonic &= now >= previous;
+		previous = now;
+	}
+	Test_Check(monotonic);
+
+	// 20 miliseconds.
+	uint64 startTicks = GetTicks();
+	uint64 startCycles = GetCycles();
+	SleepTicks(200000);
+	uint64 elapsedTicks = GetTicks()-startTicks;
+	uint64 elapsedCycleTicks = CyclesToTicks(GetCycles()-startCycles);
+	Test_Check(elapsedTicks >= 200000);
+	// the cycle counter is calibrated against the tick counter, they should agree to well within a percent.
+	Test_CheckNear(elapsedCycleTicks, elapsedTicks, elapsedTicks/50+100);
+	Test_Check(GetCycleFrequency() > 0);
+}
+
+static void GetTempPath(char* dest, int32 destLength, const char* name)
+{
+	const char* directory = getenv("TMPDIR");
+	SPrintF(dest, destLength, "%s/kirin_test_%d_%s", directory ? directory : "/tmp", (int)getpid(), name);
+}
+
+static void TestFile()
+{
+	char path[512];
+	GetTempPath(path, sizeof(path), "file.bin");
+
+	const int32 size = 300000;
+	uint8* data = (uint8*)MAlloc(size);
+	for (int32 i = 0; i < size; i++)
+	{
+		data[i] = (uint8)(i*31+7);
+	}
+	Test_Check(File_WriteBinaryFile(path, data, size));
+
+	int64 readSize = 0;
+	uint8* read = File_ReadBinaryFileAlloc(path, &readSize);
+	Test_Check(read && readSize == size && MemCmp(read, data, size) == 0);
+	MFree(read);
+
+	File file;
+	File_Init(&file);
+	Test_Check(File_Open(&file, path, FileMode_Read));
+	Test_Check(File_GetSize(&file) == size);
+	File_SetOffset(&file, 1000);
+	uint8 chunk[100];
+	Test_Check(File_ReadBinary(&file, chunk, sizeof(chunk)) == sizeof(chunk));
+	Test_Check(MemCmp(chunk, data+1000, sizeof(chunk)) == 0);
+	Test_Check(File_GetOffset(&file) == 1100);
+	// reads stop at the end of the file.
+	File_SetOffset(&file, size-10);
+	Test_Check(File_ReadBinary(&file, chunk, sizeof(chunk)) == 10);
+	File_Close(&file);
+
+	File_Init(&file);
+	Test_Check(File_Open(&file, path, FileMode_Append));
+	Test_Check(File_WriteBinary(&file, (const uint8*)"tail", 4) == 4);
+	File_Close(&file);
+
+	int64 length = 0;
+	char* text = File_ReadCStringFileAlloc(path, &length);
+	Test_Check(text && length == size+4 && MemCmp(text+size, "tail", 4) == 0 && text[length] == 0);
+	MFree(text);
+	MFree(data);
+
+	remove(path);
+	Test_Check(File_ReadBinaryFileAlloc(path, &readSize) == null);
+	File_Init(&file);
+	Test_Check(!File_Open(&file, path, FileMode_Read));
+}
+
+static void TestPrintF()
+{
+	char buffer[16];
+	Test_Check(SPrintF(buffer, sizeof(buffer), "%d-%s", 42, "abc") && StrCmp(buffer, "42-abc", true) == 0);
+	// false when it doesn't fit.
+	Test_Check(!SPrintF(buffer, sizeof(buffer), "%s", "a string longer than 16"));
+
+	char* allocated = SPrintFAlloc("%s %d %.2f", "long enough to need the heap", 7, 0.5);
+	Test_Check(StrCmp(allocated, "long enough to need the heap 7 0.50", true) == 0);
+	MFree(allocated);
+
+	wchar_t wide[32];
+	Test_Check(SPrintFW(wide, ArrayCountOf(wide), L"%d %ls", 5, L"wide") && StrCmpW(wide, L"5 wide", true) == 0);
+	wchar_t* wideAllocated = SPrintFWAlloc(L"%ls-%d", L"abc", 12345);
+	Test_Check(StrCmpW(wideAllocated, L"abc-12345", true) == 0);
+	MFree(wideAllocated);
+
+	int32 a = 0;
+	float b = 0;
+	Test_Check(SScanF("12 3.5", "%d %f", &a, &b) == 2 && a == 12 && b == 3.5f);
+	Test_Check(SScanFW(L"-4", L"%d", &a) == 1 && a == -4);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestMutex);
+	Test_Run(TestSemaphore);
+	Test_Run(TestParallelFor);
+	Test_Run(TestTime);
+	Test_Run(TestFile);
+	Test_Run(TestPrintF);
+	return Test_Finish();
+}
@@ -0,0 +1,143 @@
+#include "Test.h"
+
+#include "common/RadixSort.h"
+
+#include <float.h>
+
+// keys of the given kind. uniform ones use every digit, the others leave digits the same in every key, which get skipped.
+typedef enum TestKeys
+{
+	TestKeys_Uniform,
+	TestKeys_FewValues,
+	TestKeys_LowDigitOnly,
+	TestKeys_Descending,
+	TestKeys_Count
+} TestKeys;
+
+static uint64 MakeKey(TestKeys kind, uint32* random, int64 index, int64 count)
+{
+	uint64 r = (uint64)Test_Random(random) << 32 | Test_Random(random);
+	switch (kind)
+	{
+		case TestKeys_Uniform: return r;
+		case TestKeys_FewValues: return (r%16) << 40;
+		case TestKeys_LowDigitOnly: return 0x1234567800000000ull | (r & 0xff);
+		default: return (uint64)(count-index);
+	}
+}
+
+// keys ascend, each value follows its key, and equal keys keep their order.
+static int64 CountSortErrors(const uint64* keys, const uint64* originalKeys, const int32* values, int64 count)
+{
+	int64 errors = 0;
+	for (int64 i = 0; i < count; i++)
+	{
+		if (values && originalKeys[values[i]] != keys[i])
+		{
+			errors++;
+		}
+		if (i > 0 && (keys[i-1] > keys[i] || (values && keys[i-1] == keys[i] && values[i-1] > values[i])))
+		{
+			errors++;
+		}
+	}
+	return errors;
+}
+
+static void CheckSorts(int64 count, bool parallel)
+{
+	uint64* keys = (uint64*)MAlloc((count+1)*sizeof(uint64));
+	uint64* originalKeys = (uint64*)MAlloc((count+1)*sizeof(uint64));
+	uint32* keys32 = (uint32*)MAlloc((count+1)*sizeof(uint32));
+	int32* values = (int32*)MAlloc((count+1)*sizeof(int32));
+	uint32 random = (uint32)count+1;
+	for (int32 kind = 0; kind < TestKeys_Count; kind++)
+	{
+		for (int32 withValues = 0; withValues < 2; withValues++)
+		{
+			int32* sortValues = withValues ? values : null;
+			for (int64 i = 0; i < count; i++)
+			{
+				originalKeys[i] = keys[i] = MakeKey(kind, &random, i, count);
+				values[i] = (int32)i;
+			}
+			if (parallel)
+			{
+				RadixSort_U64Parallel(keys, sortValues, count, null, 4);
+			}
+			else
+			{
+				RadixSort_U64(keys, sortValues, count, null);
+			}
+			int64 errors = CountSortErrors(keys, originalKeys, sortValues, count);
+			Test_CheckMessage(errors == 0, "u64, %lld keys, kind %d, values %d, parallel %d: %lld errors", (long long)count, kind, withValues, parallel, (long long)errors);
+
+			// 32 bit keys get the low half, or the high half when that's where the interesting bits are.
+			int32 shift = kind == TestKeys_FewValues ? 32 : 0;
+			for (int64 i = 0; i < count; i++)
+			{
+				keys32[i] = (uint32)(originalKeys[i] >> shift);
+				originalKeys[i] = keys32[i];
+				values[i] = (int32)i;
+			}
+			void* scratch = MAlloc(RadixSort_GetScratchSize(count, 4, withValues));
+			if (parallel)
+			{
+				RadixSort_U32Parallel(keys32, sortValues, count, scratch, 4);
+			}
+			else
+			{
+				RadixSort_U32(keys32, sortValues, count, scratch);
+			}
+			MFree(scratch);
+			for (int64 i = 0; i < count; i++)
+			{
+				keys[i] = keys32[i];
+			}
+			errors = CountSortErrors(keys, originalKeys, sortValues, count);
+			Test_CheckMessage(errors == 0, "u32, %lld keys, kind %d, values %d, parallel %d: %lld errors", (long long)count, kind, withValues, parallel, (long long)errors);
+		}
+	}
+	MFree(values);
+	MFree(keys32);
+	MFree(originalKeys);
+	MFree(keys);
+}
+
+static void TestSizes()
+{
+	// around the insertion sort cutoff and the parallel threshold.
+	int64 counts[] = { 0, 1, 2, 5, 63, 64, 65, 100, 1000, 12345, RadixSort_MinKeysPerThread*4+77 };
+	for (int32 i = 0; i < ArrayCountOf(counts); i++)
+	{
+		CheckSorts(counts[i], false);
+		CheckSorts(counts[i], true);
+	}
+}
+
+static void TestFloatKeys()
+{
+	float floats[] = { 3.0f, -1.0f, 0.0f, -0.0f, 1e-40f, -1e-40f, 1e30f, -1e30f, INFINITY, -INFINITY, 0.5f, -0.5f, FLT_MAX, -FLT_MIN };
+	int32 count = ArrayCountOf(floats);
+	uint32 keys[ArrayCountOf(floats)];
+	RadixSort_FloatsToKeys(floats, keys, count);
+	for (int32 i = 0; i < count; i++)
+	{
+		Test_Check(RadixSort_FloatToKey(floats[i]) == keys[i]);
+		Test_Check(RadixSort_KeyToFloat(keys[i]) == floats[i]);
+	}
+	RadixSort_U32(keys, null, count, null);
+	for (int32 i = 1; i < count; i++)
+	{
+		Test_Check(RadixSort_KeyToFloat(keys[i-1]) <= RadixSort_KeyToFloat(keys[i]));
+	}
+	Test_Check(signbit(RadixSort_KeyToFloat(keys[6])) && RadixSort_KeyToFloat(keys[7]) == 0 && !signbit(RadixSort_KeyToFloat(keys[7])));
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestSizes);
+	Test_Run(TestFloatKeys);
+	return Test_Finish();
+}
@@ -0,0 +1,239 @@
+#include "Test.h"
+
+#include "common/Time.h"
+#include "draw/Draw.h"
+#include "draw/null/DrawBackendNull.h"
+#include "platform/Window.h"
+
+// platform/ isn't part of the cmake build, Window.c needs sdl. the render thread is compiled in here, with the two
+// Window functions it uses doing what Window.c does on a stub WindowBackend and the null draw backend.
+#include "platform/RenderThread.c"
+
+#define TestRenderThread_MaxEvents 4096
+// a call logs its value, a present logs this.
+#define TestRenderThread_Present -1
+
+static volatile int32 eventCount;
+static int32 events[TestRenderThread_MaxEvents];
+// presents wait for presentGate while blockPresents is set.
+static volatile uint32 blockPresents;
+static Semaphore presentGate;
+static volatile int32 presentsStarted;
+static volatile uint32 deviceThreadId;
+static volatile int32 wrongThreadPresents;
+
+static void LogEvent(int32 value)
+{
+	int32 index = Atomic_Increment32(&eventCount)-1;
+	if (index < TestRenderThread_MaxEvents)
+	{
+		events[index] = value;
+	}
+}
+
+static void StubPresent(Window* window)
+{
+	Unused(window);
+	Atomic_Increment32(&presentsStarted);
+	if (deviceThreadId != Thread_GetCurrentId())
+	{
+		Atomic_Increment32(&wrongThreadPresents);
+	}
+	if (Atomic_LoadAcquire32(&blockPresents))
+	{
+		Semaphore_Wait(&presentGate);
+	}
+	LogEvent(TestRenderThread_Present);
+}
+
+static void StubSetDeviceCurrent(Window* window, bool current)
+{
+	Unused(window);
+	deviceThreadId = current ? Thread_GetCurrentId() : 0;
+}
+
+static WindowBackend stubBackend = {
+	.present = StubPresent,
+	.setDeviceCurrent = StubSetDeviceCurrent,
+};
+
+void Window_Present(Window* self)
+{
+	if (Draw_GetBackend())
+	{
+		Draw_EndFrame();
+	}
+	self->backend->present(self);
+}
+
+void Window_SetDeviceCurrent(Window* self, bool current)
+{
+	self->backend->setDeviceCurrent(self, current);
+}
+
+static void LogCall(void* userData)
+{
+	LogEvent((int32)(size_t)userData);
+}
+
+static Window window;
+
+static void Init(RenderThread* renderThread, int32 frameCount)
+{
+	eventCount = 0;
+	presentsStarted = 0;
+	wrongThreadPresents = 0;
+	blockPresents = false;
+	presentGate = (Semaphore){ 0 };
+	window = (Window){ 0 };
+	window.backend = &stubBackend;
+	Draw_Init(DrawBackendNull_Get());
+	window.backend->setDeviceCurrent(&window, true);
+	RenderThread_Init(renderThread, &window, frameCount);
+}
+
+static void Free(RenderThread* renderThread)
+{
+	RenderThread_Free(renderThread);
+	Test_Check(deviceThreadId == Thread_GetCurrentId());
+	Test_Check(wrongThreadPresents == 0);
+	Semaphore_Free(&presentGate);
+	Draw_Free();
+}
+
+// frame f records calls with values f*10 to f*10+2.
+static void SubmitFrame(RenderThread* renderThread, int32 frame)
+{
+	CommandList* list = RenderThread_BeginFrame(renderThread);
+	for (int32 i = 0; i < 3; i++)
+	{
+		CommandList_Call(list, LogCall, (void*)(size_t)(frame*10+i));
+	}
+	RenderThread_EndFrame(renderThread);
+}
+
+static void TestCallOrder()
+{
+	RenderThread renderThread;
+	Init(&renderThread, 2);
+	int32 expectedCount = 0;
+	for (int32 round = 0; round < 50; round++)
+	{
+		int32 frameCount = round%4;
+		for (int32 f = 0; f < frameCount; f++)
+		{
+			SubmitFrame(&renderThread, f+1);
+		}
+		// the call waits for every frame before it and is logged after their presents.
+		RenderThread_Call(&renderThread, LogCall, (void*)(size_t)1000);
+		expectedCount += frameCount*4+1;
+		Test_Check(eventCount == expectedCount);
+		int32 start = expectedCount-(frameCount*4+1);
+		for (int32 f = 0; f < frameCount && expectedCount <= TestRenderThread_MaxEvents; f++)
+		{
+			const int32* frameEvents = &events[start+f*4];
+			Test_Check(frameEvents[0] == (f+1)*10 && frameEvents[1] == (f+1)*10+1 && frameEvents[2] == (f+1)*10+2);
+			Test_Check(frameEvents[3] == TestRenderThread_Present);
+		}
+		Test_Check(expectedCount > TestRenderThread_MaxEvents || events[expectedCount-1] == 1000);
+		if (expectedCount > TestRenderThread_MaxEvents)
+		{
+			break;
+		}
+	}
+	Test_Check(renderThread.presentedFrames == renderThread.submittedFrames);
+	Free(&renderThread);
+}
+
+typedef struct BeginFrameTest
+{
+	RenderThread* renderThread;
+	volatile int32 begun;
+} BeginFrameTest;
+
+static void BeginFrameMain(void* userData)
+{
+	BeginFrameTest* test = (BeginFrameTest*)userData;
+	RenderThread_BeginFrame(test->renderThread);
+	Atomic_Exchange32(&test->begun, 1);
+	RenderThread_EndFrame(test->renderThread);
+}
+
+static void TestBeginFrameBlocks(int32 frameCount)
+{
+	RenderThread renderThread;
+	Init(&renderThread, frameCount);
+	Atomic_StoreRelease32(&blockPresents, true);
+	// the first frame is presenting and holds on to its list, the others wait in the queue.
+	for (int32 f = 0; f < frameCount; f++)
+	{
+		SubmitFrame(&renderThread, f);
+	}
+	while (Atomic_LoadAcquire32((volatile uint32*)&presentsStarted) == 0)
+	{
+		Thread_Yield();
+	}
+
+	BeginFrameTest test = { &renderThread, 0 };
+	Thread thread;
+	Thread_Start(&thread, BeginFrameMain, &test);
+	// 20 milliseconds is plenty for a thread that isn't blocked.
+	SleepTicks(200000);
+	Test_Check(test.begun == 0);
+	Test_Check(renderThread.presentedFrames == 0);
+
+	// one present finishing frees one list.
+	Semaphore_Signal(&presentGate);
+	Thread_Join(&thread);
+	Test_Check(test.begun == 1);
+	Test_Check(renderThread.presentedFrames >= 1);
+
+	Atomic_StoreRelease32(&blockPresents, false);
+	for (int32 i = 0; i < frameCount+1; i++)
+	{
+		Semaphore_Signal(&presentGate);
+	}
+	Free(&renderThread);
+	Test_Check(renderThread.presentedFrames == (uint32)frameCount+1);
+}
+
+static void TestBeginFrameBlocksDouble()
+{
+	TestBeginFrameBlocks(2);
+}
+
+static void TestBeginFrameBlocksTriple()
+{
+	TestBeginFrameBlocks(3);
+}
+
+static void TestFreeDrains()
+{
+	RenderThread renderThread;
+	Init(&renderThread, 3);
+	Atomic_StoreRelease32(&blockPresents, true);
+	SubmitFrame(&renderThread, 0);
+	SubmitFrame(&renderThread, 1);
+	// a frame still being recorded is submitted by Free too.
+	CommandList* list = RenderThread_BeginFrame(&renderThread);
+	CommandList_Call(list, LogCall, (void*)(size_t)1000);
+	Test_Check(renderThread.presentedFrames == 0);
+	for (int32 i = 0; i < 3; i++)
+	{
+		Semaphore_Signal(&presentGate);
+	}
+	Free(&renderThread);
+	Test_Check(renderThread.presentedFrames == 3 && renderThread.submittedFrames == 3);
+	Test_Check(eventCount == 2*4+2);
+	Test_Check(events[eventCount-2] == 1000 && events[eventCount-1] == TestRenderThread_Present);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestCallOrder);
+	Test_Run(TestBeginFrameBlocksDouble);
+	Test_Run(TestBeginFrameBlocksTriple);
+	Test_Run(TestFreeDrains);
+	return Test_Finish();
+}
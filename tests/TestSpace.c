@@ -0,0 +1,469 @@
+#include "Test.h"
+
+#include "common/Space.h"
+
+#include <float.h>
+
+// the simd kernels against their scalar references. without fma both do the same operations and only the order of
+// additions differs, with fma the products aren't rounded before they're added. either way the results differ by a few
+// ulp of the largest term, which is what the tolerances below allow for.
+
+#define TestSpace_Iterations 100000
+// in FLT_EPSILON of the result's magnitude, or of 1 when the result is smaller than that.
+#define TestSpace_ProductTolerance 16
+#define TestSpace_InverseTolerance 32
+// quaternion and rigid transform results against their matrix counterparts, which round differently all the way through.
+#define TestSpace_RotationTolerance 64
+// composed rotations drift off rigid, and the transpose Transformer_Inverse still uses for them ignores the drift. it
+// can be up to the rigid tolerance in Space.c, 1e-5 of the squared scale.
+#define TestSpace_RigidDriftTolerance (1e-5f/FLT_EPSILON)
+
+static float RelativeError(const float* a, const float* b, int32 count)
+{
+	float maxError = 0;
+	for (int32 i = 0; i < count; i++)
+	{
+		float error = fabsf(a[i]-b[i])/(FLT_EPSILON*fmaxf(1.0f, fabsf(b[i])));
+		// nan never compares less, count it as a failure.
+		if (!(error <= maxError))
+		{
+			maxError = isnan(error) ? FloatMax : error;
+		}
+	}
+	return maxError;
+}
+
+static Matrix4 RandomMatrix4(uint32* random)
+{
+	Matrix4 result;
+	for (int32 i = 0; i < 16; i++)
+	{
+		(&result.values[0][0])[i] = Test_RandomFloat(random, -2, 2);
+	}
+	return result;
+}
+
+static Transformer RandomTransformer(uint32* random)
+{
+	Transformer result;
+	for (int32 i = 0; i < 9; i++)
+	{
+		(&result.mat.values[0][0])[i] = Test_RandomFloat(random, -2, 2);
+	}
+	result.pos = Vec3_New(Test_RandomFloat(random, -100, 100), Test_RandomFloat(random, -100, 100), Test_RandomFloat(random, -100, 100));
+	return result;
+}
+
+static Quat RandomQuat(uint32* random)
+{
+	return Quat_Normalize(Quat_New(Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1)));
+}
+
+static Vec3 RandomAxis(uint32* random)
+{
+	return Vec3_Normalize(Vec3_New(Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1)));
+}
+
+static RigidTransform RandomRigidTransform(uint32* random)
+{
+	Vec3 pos = Vec3_New(Test_RandomFloat(random, -100, 100), Test_RandomFloat(random, -100, 100), Test_RandomFloat(random, -100, 100));
+	return RigidTransform_New(RandomQuat(random), pos, Test_RandomFloat(random, 0.5f, 2));
+}
+
+// q and -q are the same rotation.
+static float QuatError(const Quat a, const Quat b)
+{
+	Quat sameSign = Quat_Dot(a, b) < 0 ? Quat_New(-b.x, -b.y, -b.z, -b.w) : b;
+	return RelativeError(&a.x, &sameSign.x, 4);
+}
+
+// the inverses against Matrix4_InverseScalar. pos is a sum of products of pos and the inverse, measured against the
+// largest of them.
+static float InverseError(const Transformer* transformer)
+{
+	Transformer inverse = Transformer_Inverse(transformer);
+	Matrix4 matrix = Transformer_ToMatrix4(transformer);
+	Matrix4 reference = Matrix4_InverseScalar(&matrix);
+	float maxError = 0;
+	float rowLength = 0;
+	for (int32 y = 0; y < 3; y++)
+	{
+		maxError = fmaxf(maxError, RelativeError(inverse.mat.values[y], reference.values[y], 3));
+		rowLength = fmaxf(rowLength, Vec3_Length(Vec3_New(reference.values[y][0], reference.values[y][1], reference.values[y][2])));
+	}
+	float posScale = fmaxf(1.0f, Vec3_Length(transformer->pos)*rowLength);
+	for (int32 k = 0; k < 3; k++)
+	{
+		float error = fabsf((&inverse.pos.x)[k]-reference.values[3][k])/(FLT_EPSILON*posScale);
+		maxError = fmaxf(maxError, isnan(error) ? FloatMax : error);
+	}
+	return maxError;
+}
+
+static void TestMatrix4Multiply()
+{
+	uint32 random = 1;
+	float maxError = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Matrix4 a = RandomMatrix4(&random);
+		Matrix4 b = RandomMatrix4(&random);
+		Matrix4 simd = Matrix4_Multiply(&a, &b);
+		Matrix4 scalar = Matrix4_MultiplyScalar(&a, &b);
+		maxError = fmaxf(maxError, RelativeError(&simd.values[0][0], &scalar.values[0][0], 16));
+	}
+	printf("Matrix4_Multiply max error %.2f\n", maxError);
+	Test_Check(maxError <= TestSpace_ProductTolerance);
+
+	// identity is exact on every path.
+	uint32 identityRandom = 2;
+	Matrix4 a = RandomMatrix4(&identityRandom);
+	Matrix4 left = Matrix4_Multiply(&Matrix4_identity, &a);
+	Matrix4 right = Matrix4_Multiply(&a, &Matrix4_identity);
+	Test_Check(MemCmp(&left, &a, sizeof(Matrix4)) == 0 && MemCmp(&right, &a, sizeof(Matrix4)) == 0);
+}
+
+static void TestMatrix4Transpose()
+{
+	uint32 random = 3;
+	bool exact = true;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Matrix4 a = RandomMatrix4(&random);
+		Matrix4 simd = Matrix4_Transpose(&a);
+		Matrix4 scalar = Matrix4_TransposeScalar(&a);
+		exact &= MemCmp(&simd, &scalar, sizeof(Matrix4)) == 0;
+	}
+	Test_Check(exact);
+}
+
+static void TestMatrix4Inverse()
+{
+	uint32 random = 4;
+	float maxError = 0;
+	float maxIdentityError = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		// diagonally dominant, so well conditioned and the difference is rounding, not the condition number.
+		Matrix4 a = RandomMatrix4(&random);
+		for (int32 k = 0; k < 4; k++)
+		{
+			a.values[k][k] += 8;
+		}
+		Matrix4 simd = Matrix4_Inverse(&a);
+		Matrix4 scalar = Matrix4_InverseScalar(&a);
+		maxError = fmaxf(maxError, RelativeError(&simd.values[0][0], &scalar.values[0][0], 16));
+
+		Matrix4 product = Matrix4_MultiplyScalar(&a, &simd);
+		maxIdentityError = fmaxf(maxIdentityError, RelativeError(&product.values[0][0], &Matrix4_identity.values[0][0], 16));
+	}
+	printf("Matrix4_Inverse max error %.2f, a*inverse(a) against identity %.2f\n", maxError, maxIdentityError);
+	Test_Check(maxError <= TestSpace_InverseTolerance);
+	Test_Check(maxIdentityError <= TestSpace_InverseTolerance);
+
+	// a pure scale inverts exactly.
+	Matrix4 scale = Matrix4_identity;
+	scale.values[0][0] = 2;
+	scale.values[1][1] = 4;
+	scale.values[2][2] = 0.5f;
+	Matrix4 inverse = Matrix4_Inverse(&scale);
+	Test_Check(inverse.values[0][0] == 0.5f && inverse.values[1][1] == 0.25f && inverse.values[2][2] == 2 && inverse.values[3][3] == 1);
+}
+
+static void TestMatrix4ApplyPoint()
+{
+	uint32 random = 5;
+	float maxError4 = 0;
+	float maxError3 = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Matrix4 a = RandomMatrix4(&random);
+		Vec4 point4 = Vec4_New(Test_RandomFloat(&random, -2, 2), Test_RandomFloat(&random, -2, 2), Test_RandomFloat(&random, -2, 2), Test_RandomFloat(&random, -2, 2));
+		Vec3 point3 = Vec3_New(point4.x, point4.y, point4.z);
+
+		Vec4 simd4 = Matrix4_ApplyPoint4(&a, point4);
+		Vec4 scalar4 = Matrix4_ApplyPoint4Scalar(&a, point4);
+		maxError4 = fmaxf(maxError4, RelativeError(&simd4.x, &scalar4.x, 4));
+
+		Vec3 simd3 = Matrix4_ApplyPoint(&a, point3);
+		Vec3 scalar3 = Matrix4_ApplyPointScalar(&a, point3);
+		maxError3 = fmaxf(maxError3, RelativeError(&simd3.x, &scalar3.x, 3));
+	}
+	printf("Matrix4_ApplyPoint4 max error %.2f, Matrix4_ApplyPoint %.2f\n", maxError4, maxError3);
+	Test_Check(maxError4 <= TestSpace_ProductTolerance);
+	Test_Check(maxError3 <= TestSpace_ProductTolerance);
+}
+
+static void TestTransformerMultiply()
+{
+	uint32 random = 6;
+	float maxError = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Transformer a = RandomTransformer(&random);
+		Transformer b = RandomTransformer(&random);
+		Transformer simd = Transformer_Multiply(&a, &b);
+		Transformer scalar = Transformer_MultiplyScalar(&a, &b);
+		maxError = fmaxf(maxError, RelativeError(&simd.mat.values[0][0], &scalar.mat.values[0][0], 9));
+		// pos is a sum of products of magnitude up to a few hundred, measure it against that.
+		for (int32 k = 0; k < 3; k++)
+		{
+			float error = fabsf((&simd.pos.x)[k]-(&scalar.pos.x)[k])/(FLT_EPSILON*1000);
+			maxError = fmaxf(maxError, isnan(error) ? FloatMax : error);
+		}
+	}
+	printf("Transformer_Multiply max error %.2f\n", maxError);
+	Test_Check(maxError <= TestSpace_ProductTolerance);
+
+	Transformer a = RandomTransformer(&random);
+	Transformer identity = Transformer_Multiply(&a, &Transformer_identity);
+	Test_Check(MemCmp(&identity.mat, &a.mat, sizeof(Matrix3)) == 0);
+}
+
+static void TestTransformerInverse()
+{
+	uint32 random = 7;
+	// rotations, rotations with a uniform scale, both composed a few dozen times, non uniform scales and shears.
+	float maxErrors[5] = { 0 };
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Vec3 pos = Vec3_New(Test_RandomFloat(&random, -100, 100), Test_RandomFloat(&random, -100, 100), Test_RandomFloat(&random, -100, 100));
+		Transformer rotation = { Quat_ToMatrix3(RandomQuat(&random)), pos };
+		maxErrors[0] = fmaxf(maxErrors[0], InverseError(&rotation));
+
+		RigidTransform rigid = RandomRigidTransform(&random);
+		Transformer scaled = RigidTransform_ToTransformer(&rigid);
+		maxErrors[1] = fmaxf(maxErrors[1], InverseError(&scaled));
+
+		if (i%100 == 0)
+		{
+			Transformer composed = scaled;
+			for (int32 k = 0; k < 40; k++)
+			{
+				Transformer next = { Quat_ToMatrix3(RandomQuat(&random)), Vec3_New(Test_RandomFloat(&random, -1, 1), 0, 0) };
+				composed = Transformer_Multiply(&composed, &next);
+			}
+			maxErrors[2] = fmaxf(maxErrors[2], InverseError(&composed));
+		}
+
+		Transformer nonUniform = rotation;
+		for (int32 y = 0; y < 3; y++)
+		{
+			float scale = Test_RandomFloat(&random, 0.5f, 2);
+			nonUniform.mat.values[y][0] *= scale;
+			nonUniform.mat.values[y][1] *= scale;
+			nonUniform.mat.values[y][2] *= scale;
+		}
+		maxErrors[3] = fmaxf(maxErrors[3], InverseError(&nonUniform));
+
+		// diagonally dominant, so well conditioned.
+		Transformer sheared = RandomTransformer(&random);
+		for (int32 k = 0; k < 3; k++)
+		{
+			sheared.mat.values[k][k] += 6;
+		}
+		maxErrors[4] = fmaxf(maxErrors[4], InverseError(&sheared));
+	}
+	printf("Transformer_Inverse max error rotation %.2f, scaled %.2f, composed %.2f, non uniform %.2f, sheared %.2f\n", maxErrors[0], maxErrors[1], maxErrors[2], maxErrors[3], maxErrors[4]);
+	Test_Check(maxErrors[0] <= TestSpace_InverseTolerance);
+	Test_Check(maxErrors[1] <= TestSpace_InverseTolerance);
+	Test_Check(maxErrors[2] <= TestSpace_RigidDriftTolerance);
+	Test_Check(maxErrors[3] <= TestSpace_InverseTolerance);
+	Test_Check(maxErrors[4] <= TestSpace_InverseTolerance);
+
+	// a zero matrix isn't rigid, it doesn't divide by its zero scale and gets the zero Matrix3_Inverse gives singular ones.
+	Transformer zeroInverse = Transformer_Inverse(&Transformer_zero);
+	// -0 compares equal.
+	int32 nonZero = zeroInverse.pos.x != 0 || zeroInverse.pos.y != 0 || zeroInverse.pos.z != 0;
+	for (int32 k = 0; k < 9; k++)
+	{
+		nonZero += (&zeroInverse.mat.values[0][0])[k] != 0;
+	}
+	Test_Check(nonZero == 0);
+}
+
+static void TestQuatMatrix3()
+{
+	uint32 random = 8;
+	float maxRoundTripError = 0;
+	float maxMatrixError = 0;
+	float maxProductError = 0;
+	float maxPointError = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Quat q = RandomQuat(&random);
+		// every fourth one is a half turn or close to it, where Quat_FromMatrix3 can't divide by w.
+		if (i%4 == 0)
+		{
+			q = Quat_FromAxisAngle(RandomAxis(&random), PI32-Test_RandomFloat(&random, 0, 1e-3f)*(i%8 == 0));
+		}
+		Matrix3 matrix = Quat_ToMatrix3(q);
+		Quat roundTrip = Quat_FromMatrix3(&matrix);
+		maxRoundTripError = fmaxf(maxRoundTripError, QuatError(roundTrip, q));
+		Matrix3 roundTripMatrix = Quat_ToMatrix3(roundTrip);
+		maxRoundTripError = fmaxf(maxRoundTripError, RelativeError(&roundTripMatrix.values[0][0], &matrix.values[0][0], 9));
+
+		Vec3 axis = RandomAxis(&random);
+		float angle = Test_RandomFloat(&random, -2*PI32, 2*PI32);
+		Matrix3 fromQuat = Quat_ToMatrix3(Quat_FromAxisAngle(axis, angle));
+		Matrix3 fromAxisAngle = Matrix3_FromAxisAngle(axis, angle);
+		maxMatrixError = fmaxf(maxMatrixError, RelativeError(&fromQuat.values[0][0], &fromAxisAngle.values[0][0], 9));
+
+		// the product applies a first, like Matrix3_Multiply.
+		Quat other = RandomQuat(&random);
+		Matrix3 otherMatrix = Quat_ToMatrix3(other);
+		Matrix3 product = Quat_ToMatrix3(Quat_Multiply(q, other));
+		Matrix3 matrixProduct = Matrix3_Multiply(&matrix, &otherMatrix);
+		maxProductError = fmaxf(maxProductError, RelativeError(&product.values[0][0], &matrixProduct.values[0][0], 9));
+
+		Vec3 point = Vec3_New(Test_RandomFloat(&random, -2, 2), Test_RandomFloat(&random, -2, 2), Test_RandomFloat(&random, -2, 2));
+		Vec3 rotated = Quat_ApplyPoint(q, point);
+		Vec3 matrixRotated = Matrix3_ApplyPoint(&matrix, point);
+		maxPointError = fmaxf(maxPointError, RelativeError(&rotated.x, &matrixRotated.x, 3));
+	}
+	printf("Quat_FromMatrix3 round trip max error %.2f, Quat_FromAxisAngle %.2f, Quat_Multiply %.2f, Quat_ApplyPoint %.2f\n", maxRoundTripError, maxMatrixError, maxProductError, maxPointError);
+	Test_Check(maxRoundTripError <= TestSpace_RotationTolerance);
+	Test_Check(maxMatrixError <= TestSpace_RotationTolerance);
+	Test_Check(maxProductError <= TestSpace_RotationTolerance);
+	Test_Check(maxPointError <= TestSpace_RotationTolerance);
+
+	// half turns about each axis take the branches that divide by x, y and z.
+	for (int32 k = 0; k < 3; k++)
+	{
+		Vec3 axis = Vec3_New(k == 0, k == 1, k == 2);
+		Quat q = Quat_FromAxisAngle(axis, PI32);
+		Matrix3 matrix = Quat_ToMatrix3(q);
+		Test_Check(QuatError(Quat_FromMatrix3(&matrix), q) <= TestSpace_RotationTolerance);
+	}
+	Matrix3 identity = Quat_ToMatrix3(Quat_identity);
+	Test_Check(MemCmp(&identity, &Matrix3_identity, sizeof(Matrix3)) == 0);
+}
+
+static void TestQuatInterpolation()
+{
+	uint32 random = 9;
+	float maxEndError = 0;
+	float maxAngleError = 0;
+	int32 notUnit = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		Quat from = RandomQuat(&random);
+		Quat to = RandomQuat(&random);
+		// the factor is clamped.
+		maxEndError = fmaxf(maxEndError, QuatError(Quat_Slerp(from, to, 0), from));
+		maxEndError = fmaxf(maxEndError, QuatError(Quat_Slerp(from, to, 1), to));
+		maxEndError = fmaxf(maxEndError, QuatError(Quat_Slerp(from, to, -1), from));
+		maxEndError = fmaxf(maxEndError, QuatError(Quat_Slerp(from, to, 2), to));
+		maxEndError = fmaxf(maxEndError, QuatError(Quat_Nlerp(from, to, 0), from));
+		maxEndError = fmaxf(maxEndError, QuatError(Quat_Nlerp(from, to, 1), to));
+
+		// slerp turns at a constant rate, the short way round.
+		float factor = Test_RandomFloat(&random, 0, 1);
+		Quat slerp = Quat_Slerp(from, to, factor);
+		float angle = ACos(fminf(fabsf(Quat_Dot(from, to)), 1.0f));
+		float angleFrom = ACos(fminf(fabsf(Quat_Dot(from, slerp)), 1.0f));
+		float angleTo = ACos(fminf(fabsf(Quat_Dot(slerp, to)), 1.0f));
+		maxAngleError = fmaxf(maxAngleError, fmaxf(fabsf(angleFrom-factor*angle), fabsf(angleTo-(1-factor)*angle)));
+
+		Quat nlerp = Quat_Nlerp(from, to, factor);
+		notUnit += fabsf(Quat_Dot(slerp, slerp)-1) > 1e-5f || fabsf(Quat_Dot(nlerp, nlerp)-1) > 1e-5f;
+	}
+	printf("Quat_Slerp and Quat_Nlerp endpoint max error %.2f, Quat_Slerp angle max error %g\n", maxEndError, maxAngleError);
+	Test_Check(maxEndError <= TestSpace_RotationTolerance);
+	// acos near 0 turns an ulp of the dot into about 3.5e-4 radians.
+	Test_Check(maxAngleError <= 1e-3f);
+	Test_Check(notUnit == 0);
+
+	// q and -q are the same rotation. interpolating between them stays at q instead of turning a full circle.
+	Quat q = RandomQuat(&random);
+	Quat antipodal = Quat_New(-q.x, -q.y, -q.z, -q.w);
+	for (int32 i = 0; i <= 4; i++)
+	{
+		Test_Check(QuatError(Quat_Slerp(q, antipodal, i*0.25f), q) <= TestSpace_RotationTolerance);
+		Test_Check(QuatError(Quat_Nlerp(q, antipodal, i*0.25f), q) <= TestSpace_RotationTolerance);
+	}
+	// a half turn apart has a dot of 0, the middle is a quarter turn from both.
+	Quat halfTurn = Quat_Multiply(q, Quat_FromAxisAngle(Vec3_New(0, 0, 1), PI32));
+	Quat middle = Quat_Slerp(q, halfTurn, 0.5f);
+	Test_CheckNear(fabsf(Quat_Dot(middle, q)), Cos(PI32/4), 1e-5f);
+	Test_CheckNear(fabsf(Quat_Dot(middle, halfTurn)), Cos(PI32/4), 1e-5f);
+}
+
+// in FLT_EPSILON of scale, the size of the largest term that went into a position.
+static float PosError(const Vec3 a, const Vec3 b, float scale)
+{
+	float maxError = 0;
+	for (int32 k = 0; k < 3; k++)
+	{
+		float error = fabsf((&a.x)[k]-(&b.x)[k])/(FLT_EPSILON*fmaxf(1.0f, scale));
+		maxError = fmaxf(maxError, isnan(error) ? FloatMax : error);
+	}
+	return maxError;
+}
+
+// RigidTransform against the same transforms as Transformer.
+static void TestRigidTransform()
+{
+	uint32 random = 10;
+	float maxMultiplyError = 0;
+	float maxInverseError = 0;
+	float maxPointError = 0;
+	float maxRoundTripError = 0;
+	for (int32 i = 0; i < TestSpace_Iterations; i++)
+	{
+		RigidTransform a = RandomRigidTransform(&random);
+		RigidTransform b = RandomRigidTransform(&random);
+		Transformer aTransformer = RigidTransform_ToTransformer(&a);
+		Transformer bTransformer = RigidTransform_ToTransformer(&b);
+
+		RigidTransform product = RigidTransform_Multiply(&a, &b);
+		Transformer productTransformer = RigidTransform_ToTransformer(&product);
+		Transformer reference = Transformer_Multiply(&aTransformer, &bTransformer);
+		maxMultiplyError = fmaxf(maxMultiplyError, RelativeError(&productTransformer.mat.values[0][0], &reference.mat.values[0][0], 9));
+		maxMultiplyError = fmaxf(maxMultiplyError, PosError(productTransformer.pos, reference.pos, Vec3_Length(a.pos)*b.scale+Vec3_Length(b.pos)));
+
+		RigidTransform inverse = RigidTransform_Inverse(&a);
+		Transformer inverseTransformer = RigidTransform_ToTransformer(&inverse);
+		Transformer inverseReference = Transformer_Inverse(&aTransformer);
+		maxInverseError = fmaxf(maxInverseError, RelativeError(&inverseTransformer.mat.values[0][0], &inverseReference.mat.values[0][0], 9));
+		maxInverseError = fmaxf(maxInverseError, PosError(inverseTransformer.pos, inverseReference.pos, Vec3_Length(a.pos)/a.scale));
+
+		Vec3 point = Vec3_New(Test_RandomFloat(&random, -100, 100), Test_RandomFloat(&random, -100, 100), Test_RandomFloat(&random, -100, 100));
+		Vec3 applied = RigidTransform_ApplyPoint(&a, point);
+		Vec3 transformerApplied = Transformer_ApplyPoint(&aTransformer, point);
+		maxPointError = fmaxf(maxPointError, PosError(applied, transformerApplied, Vec3_Length(point)*a.scale+Vec3_Length(a.pos)));
+
+		RigidTransform roundTrip = RigidTransform_FromTransformer(&aTransformer);
+		maxRoundTripError = fmaxf(maxRoundTripError, QuatError(roundTrip.rot, a.rot));
+		maxRoundTripError = fmaxf(maxRoundTripError, RelativeError(&roundTrip.scale, &a.scale, 1));
+	}
+	printf("RigidTransform_Multiply max error %.2f, RigidTransform_Inverse %.2f, RigidTransform_ApplyPoint %.2f, RigidTransform_FromTransformer %.2f\n", maxMultiplyError, maxInverseError, maxPointError, maxRoundTripError);
+	Test_Check(maxMultiplyError <= TestSpace_RotationTolerance);
+	Test_Check(maxInverseError <= TestSpace_RotationTolerance);
+	Test_Check(maxPointError <= TestSpace_RotationTolerance);
+	Test_Check(maxRoundTripError <= TestSpace_RotationTolerance);
+
+	// a transform times its inverse is the identity.
+	RigidTransform a = RandomRigidTransform(&random);
+	RigidTransform inverse = RigidTransform_Inverse(&a);
+	RigidTransform identity = RigidTransform_Multiply(&a, &inverse);
+	Test_Check(QuatError(identity.rot, Quat_identity) <= TestSpace_RotationTolerance);
+	Test_CheckNear(identity.scale, 1, 1e-6f);
+	Test_Check(Vec3_Length(identity.pos) < 1e-4f);
+}
+
+int main()
+{
+	Test_Init();
+	printf("simd: sse2 %d, avx %d, fma %d\n", SIMD_SSE2, SIMD_AVX, SIMD_FMA);
+	Test_Run(TestMatrix4Multiply);
+	Test_Run(TestMatrix4Transpose);
+	Test_Run(TestMatrix4Inverse);
+	Test_Run(TestMatrix4ApplyPoint);
+	Test_Run(TestTransformerMultiply);
+	Test_Run(TestTransformerInverse);
+	Test_Run(TestQuatMatrix3);
+	Test_Run(TestQuatInterpolation);
+	Test_Run(TestRigidTransform);
+	return Test_Finish();
+}
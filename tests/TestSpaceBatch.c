@@ -0,0 +1,291 @@
+#include "Test.h"
+
+#include "common/SpaceBatch.h"
+
+#include <float.h>
+
+// every mode and layout of the batch transforms against the single point functions in Space.h. counts that don't fill
+// a simd block, arrays that start off 16 byte alignment and in place batches go through the scalar ends and the
+// streaming prologue, the large count is past the streaming threshold and is split over threads by the parallel versions.
+
+// in FLT_EPSILON of the result's length, or of 1 when it's shorter. the order of operations differs from Space.c and
+// with fma the products aren't rounded.
+#define TestSpaceBatch_Tolerance 64
+// past SpaceBatch_StreamingThresholdBytes, and more than two threads worth of SpaceBatch_MinPointsPerThread.
+#define TestSpaceBatch_LargeCount 700001
+// written to the output past count, a batch can't touch it.
+#define TestSpaceBatch_Sentinel 12345.0f
+
+typedef enum TestLayout
+{
+	TestLayout_AoS,
+	TestLayout_SoA,
+	TestLayout_AoSParallel,
+	TestLayout_SoAParallel,
+	TestLayout_Count,
+} TestLayout;
+
+typedef struct TestBatch
+{
+	PointTransformMode mode;
+	Matrix4 matrix;
+	Transformer transformer;
+	Matrix3 inverse;
+	Vec3* points;
+	Vec3* expected;
+	Vec3* results;
+	// room for the largest count and 3 floats of offset.
+	float* aos[2];
+	float* soa[2][3];
+} TestBatch;
+
+static const int32 smallCounts[] = { 0, 1, 3, 4, 7, 8, 9, 33, 1001 };
+
+// a well conditioned random 3x3, so the normal matrix doesn't lose precision.
+static void RandomUpper(Matrix4* matrix, uint32* random)
+{
+	for (int32 y = 0; y < 3; y++)
+	{
+		for (int32 x = 0; x < 3; x++)
+		{
+			matrix->values[y][x] = Test_RandomFloat(random, -1, 1)+(x == y ? 3 : 0);
+		}
+	}
+}
+
+static void InitBatch(TestBatch* batch, PointTransformMode mode, uint32* random)
+{
+	batch->mode = mode;
+	batch->matrix = Matrix4_identity;
+	RandomUpper(&batch->matrix, random);
+	batch->matrix.values[3][0] = Test_RandomFloat(random, -100, 100);
+	batch->matrix.values[3][1] = Test_RandomFloat(random, -100, 100);
+	batch->matrix.values[3][2] = Test_RandomFloat(random, -100, 100);
+	if (mode == PointTransformMode_Affine)
+	{
+		// the w column is ignored.
+		batch->matrix.values[0][3] = Test_RandomFloat(random, -1, 1);
+		batch->matrix.values[3][3] = Test_RandomFloat(random, 2, 3);
+	}
+	else if (mode == PointTransformMode_Projective)
+	{
+		// like a perspective projection, points have z from 1 to 10 and w stays above 1.
+		batch->matrix.values[0][3] = Test_RandomFloat(random, -0.1f, 0.1f);
+		batch->matrix.values[1][3] = Test_RandomFloat(random, -0.1f, 0.1f);
+		batch->matrix.values[2][3] = 1;
+		batch->matrix.values[3][3] = 0.5f;
+	}
+	batch->transformer = Transformer_FromMatrix4(&batch->matrix);
+	batch->inverse = Matrix3_Inverse(&batch->transformer.mat);
+
+	int64 count = TestSpaceBatch_LargeCount;
+	batch->points = (Vec3*)MAlloc(count*sizeof(Vec3));
+	batch->expected = (Vec3*)MAlloc(count*sizeof(Vec3));
+	batch->results = (Vec3*)MAlloc(count*sizeof(Vec3));
+	for (int32 i = 0; i < 2; i++)
+	{
+		batch->aos[i] = (float*)MAlloc((count*3+3)*sizeof(float));
+		for (int32 c = 0; c < 3; c++)
+		{
+			batch->soa[i][c] = (float*)MAlloc((count+3)*sizeof(float));
+		}
+	}
+
+	for (int64 i = 0; i < count; i++)
+	{
+		Vec3 point = Vec3_New(Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, 1, 10));
+		// a few zero normals, which stay zero.
+		if (mode == PointTransformMode_Normal && i%97 == 0)
+		{
+			point = Vec3_New(0, 0, 0);
+		}
+		batch->points[i] = point;
+
+		if (mode == PointTransformMode_Affine)
+		{
+			batch->expected[i] = Matrix4_ApplyPoint(&batch->matrix, point);
+		}
+		else if (mode == PointTransformMode_Projective)
+		{
+			Vec4 projected = Matrix4_ApplyPoint4(&batch->matrix, Vec4_New(point.x, point.y, point.z, 1));
+			batch->expected[i] = Vec3_New(projected.x/projected.w, projected.y/projected.w, projected.z/projected.w);
+		}
+		else
+		{
+			// point*(inverse transposed) is inverse*point.
+			batch->expected[i] = Vec3_Normalize(Matrix3_ApplyPointTransposed(&batch->inverse, point));
+		}
+	}
+}
+
+static void FreeBatch(TestBatch* batch)
+{
+	for (int32 i = 0; i < 2; i++)
+	{
+		MFree(batch->aos[i]);
+		for (int32 c = 0; c < 3; c++)
+		{
+			MFree(batch->soa[i][c]);
+		}
+	}
+	MFree(batch->results);
+	MFree(batch->expected);
+	MFree(batch->points);
+}
+
+// runs the first count points through the layout with inputs offset floats past an aligned address and outputs
+// outOffset floats past one, or in place. returns the largest error, sentinels that changed count as FloatMax.
+static float RunBatch(TestBatch* batch, TestLayout layout, int64 count, int32 offset, int32 outOffset, bool inPlace)
+{
+	static_assert(TestLayout_Count == 4, "enum has changed.");
+	float maxError = 0;
+	bool parallel = layout == TestLayout_AoSParallel || layout == TestLayout_SoAParallel;
+	if (layout == TestLayout_AoS || layout == TestLayout_AoSParallel)
+	{
+		float* in = batch->aos[0]+offset;
+		float* out = inPlace ? in : batch->aos[1]+outOffset;
+		MemCpy(in, batch->points, count*sizeof(Vec3));
+		if (!inPlace)
+		{
+			for (int32 i = 0; i < 3-outOffset; i++)
+			{
+				out[count*3+i] = TestSpaceBatch_Sentinel;
+			}
+		}
+		if (parallel)
+		{
+			Matrix4_TransformPointsParallel(&batch->matrix, batch->mode, (const Vec3*)in, (Vec3*)out, count, 4);
+		}
+		else
+		{
+			Matrix4_TransformPoints(&batch->matrix, batch->mode, (const Vec3*)in, (Vec3*)out, count);
+		}
+		MemCpy(batch->results, out, count*sizeof(Vec3));
+		if (!inPlace)
+		{
+			for (int32 i = 0; i < 3-outOffset; i++)
+			{
+				maxError = out[count*3+i] == TestSpaceBatch_Sentinel ? maxError : FloatMax;
+			}
+		}
+	}
+	else
+	{
+		// the three arrays get different offsets, so they don't line up for streaming unless offset is 0.
+		Vec3SoA in = { batch->soa[0][0]+offset, batch->soa[0][1]+offset, batch->soa[0][2]+(offset ? 3-offset : 0) };
+		Vec3SoA out = { batch->soa[1][0]+outOffset, batch->soa[1][1]+outOffset, batch->soa[1][2]+outOffset };
+		if (inPlace)
+		{
+			out = in;
+		}
+		for (int64 i = 0; i < count; i++)
+		{
+			in.x[i] = batch->points[i].x;
+			in.y[i] = batch->points[i].y;
+			in.z[i] = batch->points[i].z;
+		}
+		if (!inPlace)
+		{
+			out.x[count] = out.y[count] = out.z[count] = TestSpaceBatch_Sentinel;
+		}
+		if (parallel)
+		{
+			Matrix4_TransformPointsSoAParallel(&batch->matrix, batch->mode, &in, &out, count, 4);
+		}
+		else
+		{
+			Matrix4_TransformPointsSoA(&batch->matrix, batch->mode, &in, &out, count);
+		}
+		for (int64 i = 0; i < count; i++)
+		{
+			batch->results[i] = Vec3_New(out.x[i], out.y[i], out.z[i]);
+		}
+		if (!inPlace && (out.x[count] != TestSpaceBatch_Sentinel || out.y[count] != TestSpaceBatch_Sentinel || out.z[count] != TestSpaceBatch_Sentinel))
+		{
+			maxError = FloatMax;
+		}
+	}
+
+	for (int64 i = 0; i < count; i++)
+	{
+		Vec3 expected = batch->expected[i];
+		float length = fmaxf(1.0f, Vec3_Length(expected));
+		float error = Vec3_Length(Vec3_Sub(batch->results[i], expected))/(FLT_EPSILON*length);
+		// nan never compares less, count it as a failure.
+		if (!(error <= maxError))
+		{
+			maxError = isnan(error) ? FloatMax : error;
+		}
+	}
+	return maxError;
+}
+
+static void TestMode(PointTransformMode mode, uint32 seed)
+{
+	uint32 random = seed;
+	TestBatch batch;
+	InitBatch(&batch, mode, &random);
+
+	// the affine matrix is the transformer's, which gives the same points.
+	if (mode == PointTransformMode_Affine)
+	{
+		float maxError = 0;
+		for (int32 i = 0; i < 1000; i++)
+		{
+			Vec3 point = Transformer_ApplyPoint(&batch.transformer, batch.points[i]);
+			maxError = fmaxf(maxError, Vec3_Length(Vec3_Sub(point, batch.expected[i]))/(FLT_EPSILON*fmaxf(1.0f, Vec3_Length(point))));
+		}
+		Test_Check(maxError <= TestSpaceBatch_Tolerance);
+	}
+
+	float maxError = 0;
+	for (int32 layout = 0; layout < TestLayout_Count; layout++)
+	{
+		for (int32 c = 0; c < ArrayCountOf(smallCounts); c++)
+		{
+			for (int32 offset = 0; offset < 4; offset++)
+			{
+				maxError = fmaxf(maxError, RunBatch(&batch, (TestLayout)layout, smallCounts[c], offset, (offset+1)%4, false));
+				maxError = fmaxf(maxError, RunBatch(&batch, (TestLayout)layout, smallCounts[c], offset, 0, true));
+			}
+		}
+		maxError = fmaxf(maxError, RunBatch(&batch, (TestLayout)layout, TestSpaceBatch_LargeCount, 0, 0, false));
+		maxError = fmaxf(maxError, RunBatch(&batch, (TestLayout)layout, TestSpaceBatch_LargeCount, 1, 2, false));
+		maxError = fmaxf(maxError, RunBatch(&batch, (TestLayout)layout, TestSpaceBatch_LargeCount, 3, 0, true));
+	}
+	printf("%s max error %.2f\n", PointTransformMode_ToString(mode), maxError);
+	Test_Check(maxError <= TestSpaceBatch_Tolerance);
+
+	// threadCount <= 0 uses every hardware thread.
+	Vec3* out = (Vec3*)MAlloc(TestSpaceBatch_LargeCount*sizeof(Vec3));
+	Matrix4_TransformPointsParallel(&batch.matrix, mode, batch.points, out, TestSpaceBatch_LargeCount, 0);
+	Matrix4_TransformPoints(&batch.matrix, mode, batch.points, batch.results, TestSpaceBatch_LargeCount);
+	Test_Check(MemCmp(out, batch.results, TestSpaceBatch_LargeCount*sizeof(Vec3)) == 0);
+	MFree(out);
+
+	FreeBatch(&batch);
+}
+
+static void TestAffine()
+{
+	TestMode(PointTransformMode_Affine, 1);
+}
+
+static void TestProjective()
+{
+	TestMode(PointTransformMode_Projective, 2);
+}
+
+static void TestNormal()
+{
+	TestMode(PointTransformMode_Normal, 3);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestAffine);
+	Test_Run(TestProjective);
+	Test_Run(TestNormal);
+	return Test_Finish();
+}
@@ -0,0 +1,180 @@
+#include "Test.h"
+
+#include "common/Math.h"
+#include "common/SpatialGrid.h"
+
+#define TestSpatialGrid_ObjectCount 3000
+
+typedef struct TestObject
+{
+	Vec3 pos;
+	float radius;
+	int32 handle;
+} TestObject;
+
+static int32 handleToObject[TestSpatialGrid_ObjectCount];
+static int32 queryHandles[TestSpatialGrid_ObjectCount];
+
+static bool SphereOverlapsAabb(const Aabb* box, Vec3 center, float radius)
+{
+	float dx = Max(Max(box->min.x-center.x, center.x-box->max.x), 0);
+	float dy = Max(Max(box->min.y-center.y, center.y-box->max.y), 0);
+	float dz = Max(Max(box->min.z-center.z, center.z-box->max.z), 0);
+	return dx*dx+dy*dy+dz*dz <= radius*radius;
+}
+
+// both queries have to return exactly the objects a brute force test finds, each once.
+static bool QueryMatches(const SpatialGrid* grid, const TestObject* objects, Vec3 center, float radius, bool box)
+{
+	Aabb query = { Vec3_Sub(center, Vec3_New(radius, radius*0.5f, radius)), Vec3_Add(center, Vec3_New(radius, radius, radius*2)) };
+	int32 count = box ? SpatialGrid_QueryAabb(grid, query, queryHandles, TestSpatialGrid_ObjectCount) : SpatialGrid_QuerySphere(grid, center, radius, queryHandles, TestSpatialGrid_ObjectCount);
+	static char found[TestSpatialGrid_ObjectCount];
+	MemSet(found, 0, sizeof(found));
+	for (int32 i = 0; i < count; i++)
+	{
+		int32 object = handleToObject[queryHandles[i]];
+		if (object < 0 || found[object])
+		{
+			return false;
+		}
+		found[object] = 1;
+	}
+	for (int32 i = 0; i < TestSpatialGrid_ObjectCount; i++)
+	{
+		const TestObject* object = &objects[i];
+		bool overlaps = false;
+		if (object->handle >= 0)
+		{
+			float reach = radius+object->radius;
+			overlaps = box ? SphereOverlapsAabb(&query, object->pos, object->radius) : Vec3_SqrLength(Vec3_Sub(object->pos, center)) <= reach*reach;
+		}
+		if (overlaps != (found[i] != 0))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void TestRandomOperations()
+{
+	static TestObject objects[TestSpatialGrid_ObjectCount];
+	for (int32 i = 0; i < TestSpatialGrid_ObjectCount; i++)
+	{
+		objects[i].handle = -1;
+		handleToObject[i] = -1;
+	}
+	SpatialGrid grid;
+	SpatialGrid_Init(&grid, 3);
+	uint32 random = 1;
+	int32 mismatches = 0;
+	for (int32 step = 0; step < 200000; step++)
+	{
+		TestObject* object = &objects[Test_Random(&random)%TestSpatialGrid_ObjectCount];
+		float op = Test_RandomFloat(&random, 0, 1);
+		if (object->handle < 0)
+		{
+			if (op < 0.6f)
+			{
+				object->pos = Vec3_New(Test_RandomFloat(&random, -50, 50), Test_RandomFloat(&random, -50, 50), Test_RandomFloat(&random, 0, 20));
+				object->radius = Test_RandomFloat(&random, 0, 2);
+				object->handle = SpatialGrid_Insert(&grid, object->pos, object->radius);
+				handleToObject[object->handle] = (int32)(object-objects);
+			}
+		}
+		else if (op < 0.1f)
+		{
+			SpatialGrid_Remove(&grid, object->handle);
+			handleToObject[object->handle] = -1;
+			object->handle = -1;
+		}
+		else
+		{
+			// mostly small steps that stay in the cell, some jumps far away.
+			if (op < 0.15f)
+			{
+				object->pos = Vec3_New(Test_RandomFloat(&random, -500, 500), Test_RandomFloat(&random, -500, 500), Test_RandomFloat(&random, 0, 20));
+			}
+			else
+			{
+				object->pos = Vec3_Add(object->pos, Vec3_New(Test_RandomFloat(&random, -0.5f, 0.5f), Test_RandomFloat(&random, -0.5f, 0.5f), Test_RandomFloat(&random, -0.5f, 0.5f)));
+			}
+			SpatialGrid_Move(&grid, object->handle, object->pos);
+		}
+
+		if (step%500 == 0)
+		{
+			Vec3 center = Vec3_New(Test_RandomFloat(&random, -50, 50), Test_RandomFloat(&random, -50, 50), Test_RandomFloat(&random, 0, 20));
+			float radius = Test_RandomFloat(&random, 0, 10);
+			mismatches += !QueryMatches(&grid, objects, center, radius, false);
+			mismatches += !QueryMatches(&grid, objects, center, radius, true);
+			// big enough to walk the cells instead of the range.
+			mismatches += !QueryMatches(&grid, objects, center, 400, false);
+		}
+	}
+	Test_Check(mismatches == 0);
+	SpatialGrid_Free(&grid);
+}
+
+static void TestRebuild()
+{
+	static TestObject objects[TestSpatialGrid_ObjectCount];
+	static float x[TestSpatialGrid_ObjectCount], y[TestSpatialGrid_ObjectCount], z[TestSpatialGrid_ObjectCount], radii[TestSpatialGrid_ObjectCount];
+	SpatialGrid grid;
+	SpatialGrid_Init(&grid, 4);
+	uint32 random = 2;
+	int32 mismatches = 0;
+	for (int32 frame = 0; frame < 20; frame++)
+	{
+		for (int32 i = 0; i < TestSpatialGrid_ObjectCount; i++)
+		{
+			x[i] = Test_RandomFloat(&random, -100, 100);
+			y[i] = Test_RandomFloat(&random, -100, 100);
+			z[i] = Test_RandomFloat(&random, -10, 10);
+			radii[i] = Test_RandomFloat(&random, 0, 3);
+			objects[i] = (TestObject){ Vec3_New(x[i], y[i], z[i]), radii[i], i };
+			handleToObject[i] = i;
+		}
+		Vec3SoA positions = { x, y, z };
+		SpatialGrid_Rebuild(&grid, &positions, radii, TestSpatialGrid_ObjectCount);
+		for (int32 q = 0; q < 20; q++)
+		{
+			Vec3 center = Vec3_New(Test_RandomFloat(&random, -100, 100), Test_RandomFloat(&random, -100, 100), 0);
+			mismatches += !QueryMatches(&grid, objects, center, Test_RandomFloat(&random, 0, 15), q & 1);
+		}
+	}
+	Test_Check(mismatches == 0);
+	SpatialGrid_Free(&grid);
+}
+
+// queries covering far more cells than int64 can count, run under ubsan to catch overflows.
+static void TestHugeQueries()
+{
+	SpatialGrid grid;
+	SpatialGrid_Init(&grid, 1);
+	int32 nearHandle = SpatialGrid_Insert(&grid, Vec3_New(1, 2, 3), 0.5f);
+	int32 farHandle = SpatialGrid_Insert(&grid, Vec3_New(-1e30f, 1e30f, 0), 0);
+	int32 handles[4];
+	// squared distances this big are inf in float, so the far object may or may not be counted.
+	int32 count = SpatialGrid_QuerySphere(&grid, Vec3_New(0, 0, 0), 1e20f, handles, 4);
+	Test_Check(count >= 1 && count <= 2 && handles[0] == nearHandle);
+	Test_Check(SpatialGrid_QuerySphere(&grid, Vec3_New(1e10f, 0, 0), 1e9f, handles, 4) == 0);
+	Test_Check(SpatialGrid_QuerySphere(&grid, Vec3_New(0, 0, 0), FloatMax, handles, 4) == 2);
+	Aabb huge = { Vec3_New(-1e30f, -1e30f, -1e30f), Vec3_New(1e30f, 1e30f, 1e30f) };
+	Test_Check(SpatialGrid_QueryAabb(&grid, huge, handles, 4) == 2 && handles[0]+handles[1] == nearHandle+farHandle);
+	Aabb flat = { Vec3_New(-1e20f, -1e20f, 2.5f), Vec3_New(1e20f, 1e20f, 3.5f) };
+	Test_Check(SpatialGrid_QueryAabb(&grid, flat, handles, 4) == 1 && handles[0] == nearHandle);
+	// long in one axis and a single cell in the others.
+	Aabb line = { Vec3_New(-1e20f, 2, 3), Vec3_New(1e20f, 2, 3) };
+	Test_Check(SpatialGrid_QueryAabb(&grid, line, handles, 4) == 1 && handles[0] == nearHandle);
+	SpatialGrid_Free(&grid);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestRandomOperations);
+	Test_Run(TestRebuild);
+	Test_Run(TestHugeQueries);
+	return Test_Finish();
+}
@@ -0,0 +1,198 @@
+#include "Test.h"
+
+#include "common/Math.h"
+#include "common/TransformHierarchy.h"
+
+// a random mix of adds, removes and local changes, checked against worlds computed up the parent chain after each
+// update. handles are tracked here with their parents to know the expected tree.
+
+#define TestTransformHierarchy_MaxHandles 20000
+
+static int32 testParents[TestTransformHierarchy_MaxHandles];
+static bool testAlive[TestTransformHierarchy_MaxHandles];
+static Transformer testLocals[TestTransformHierarchy_MaxHandles];
+static Transformer testWorlds[TestTransformHierarchy_MaxHandles];
+static bool testWorldDone[TestTransformHierarchy_MaxHandles];
+
+static Transformer MakeRandomTransformer(uint32* random)
+{
+	Vec3 axis = Vec3_Normalize(Vec3_New(Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, 1, 3)));
+	Transformer result;
+	result.mat = Matrix3_FromAxisAngle(axis, Test_RandomFloat(random, -1, 1));
+	result.pos = Vec3_New(Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1), Test_RandomFloat(random, -1, 1));
+	return result;
+}
+
+static Transformer GetExpectedWorld(int32 handle)
+{
+	if (!testWorldDone[handle])
+	{
+		testWorlds[handle] = testLocals[handle];
+		if (testParents[handle] >= 0)
+		{
+			Transformer parent = GetExpectedWorld(testParents[handle]);
+			testWorlds[handle] = Transformer_Multiply(&testLocals[handle], &parent);
+		}
+		testWorldDone[handle] = true;
+	}
+	return testWorlds[handle];
+}
+
+static bool IsDescendant(int32 handle, int32 ancestor)
+{
+	for (int32 h = handle; h >= 0; h = testParents[h])
+	{
+		if (h == ancestor)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static void TestRandomOperations()
+{
+	TransformHierarchy hierarchy;
+	TransformHierarchy_Init(&hierarchy);
+	static int32 handles[TestTransformHierarchy_MaxHandles];
+	int32 handleCount = 0;
+	uint32 random = 1;
+	int32 worldErrors = 0, matrixErrors = 0, structureErrors = 0;
+	for (int32 round = 0; round < 200; round++)
+	{
+		int32 addCount = Test_Random(&random)%200;
+		for (int32 a = 0; a < addCount && handleCount < TestTransformHierarchy_MaxHandles; a++)
+		{
+			int32 parent = handleCount > 0 && Test_Random(&random)%8 ? handles[Test_Random(&random)%handleCount] : -1;
+			Transformer local = MakeRandomTransformer(&random);
+			int32 handle = TransformHierarchy_Add(&hierarchy, parent, &local);
+			if (handle >= TestTransformHierarchy_MaxHandles)
+			{
+				Test_CheckMessage(false, "handle %d, with at most %d alive", handle, handleCount+1);
+				TransformHierarchy_Free(&hierarchy);
+				return;
+			}
+			testParents[handle] = parent;
+			testAlive[handle] = true;
+			testLocals[handle] = local;
+			handles[handleCount++] = handle;
+		}
+
+		if (Test_Random(&random)%10 == 0 && handleCount > 0)
+		{
+			int32 removed = handles[Test_Random(&random)%handleCount];
+			TransformHierarchy_Remove(&hierarchy, removed);
+			int32 kept = 0;
+			for (int32 i = 0; i < handleCount; i++)
+			{
+				if (IsDescendant(handles[i], removed))
+				{
+					testAlive[handles[i]] = false;
+				}
+			}
+			for (int32 i = 0; i < handleCount; i++)
+			{
+				if (testAlive[handles[i]])
+				{
+					handles[kept++] = handles[i];
+				}
+			}
+			handleCount = kept;
+		}
+
+		for (int32 s = 0; s < 50 && handleCount > 0; s++)
+		{
+			int32 handle = handles[Test_Random(&random)%handleCount];
+			testLocals[handle] = MakeRandomTransformer(&random);
+			TransformHierarchy_SetLocal(&hierarchy, handle, &testLocals[handle]);
+		}
+		if (round & 1)
+		{
+			TransformHierarchy_Update(&hierarchy);
+		}
+		else
+		{
+			TransformHierarchy_UpdateParallel(&hierarchy, 3);
+		}
+
+		MemSet(testWorldDone, 0, sizeof(testWorldDone));
+		for (int32 i = 0; i < handleCount; i++)
+		{
+			int32 handle = handles[i];
+			Transformer expected = GetExpectedWorld(handle);
+			const Transformer* world = TransformHierarchy_GetWorld(&hierarchy, handle);
+			const float* a = (const float*)&expected;
+			const float* b = (const float*)world;
+			for (int32 k = 0; k < 12; k++)
+			{
+				if (Abs(a[k]-b[k]) > 1e-3f*(1+Abs(a[k])))
+				{
+					worldErrors++;
+					break;
+				}
+			}
+			int32 index = TransformHierarchy_GetIndex(&hierarchy, handle);
+			Matrix4 matrix = Transformer_ToMatrix4(world);
+			matrixErrors += MemCmp(&matrix, &hierarchy.worldMatrices[index], sizeof(Matrix4)) != 0;
+			int32 parentIndex = hierarchy.parents[index];
+			structureErrors += (testParents[handle] < 0) != (parentIndex < 0) || parentIndex >= index || (parentIndex >= 0 && hierarchy.handles[parentIndex] != testParents[handle]);
+		}
+		structureErrors += handleCount != hierarchy.nodeCount;
+		for (int32 i = 0; i < hierarchy.nodeCount; i++)
+		{
+			int32 parent = hierarchy.parents[i];
+			structureErrors += (parent >= 0 && i >= parent+hierarchy.subtreeSizes[parent]) || hierarchy.dirty[i];
+		}
+	}
+	Test_Check(worldErrors == 0);
+	Test_Check(matrixErrors == 0);
+	Test_Check(structureErrors == 0);
+	TransformHierarchy_Free(&hierarchy);
+}
+
+// the parallel update splits subtrees differently but has to compute the same bits.
+static void TestParallelMatchesSerial()
+{
+	int32 count = TransformHierarchy_MinNodesPerThread*8;
+	TransformHierarchy serial, parallel;
+	TransformHierarchy_Init(&serial);
+	TransformHierarchy_Init(&parallel);
+	int32* handles = (int32*)MAlloc(count*sizeof(int32));
+	uint32 random = 2;
+	for (int32 i = 0; i < count; i++)
+	{
+		// a few deep roots with wide trees under them.
+		int32 parent = i%(count/4) == 0 ? -1 : handles[i-1-(int32)(Test_Random(&random)%MinI(i, 8))];
+		Transformer local = MakeRandomTransformer(&random);
+		handles[i] = TransformHierarchy_Add(&serial, parent, &local);
+		TransformHierarchy_Add(&parallel, parent, &local);
+	}
+	TransformHierarchy_Update(&serial);
+	TransformHierarchy_UpdateParallel(&parallel, 4);
+	Test_Check(MemCmp(serial.worlds, parallel.worlds, count*sizeof(Transformer)) == 0);
+
+	for (int32 i = 0; i < count/50; i++)
+	{
+		int32 handle = handles[Test_Random(&random)%count];
+		Transformer local = MakeRandomTransformer(&random);
+		TransformHierarchy_SetLocal(&serial, handle, &local);
+		TransformHierarchy_SetLocal(&parallel, handle, &local);
+	}
+	TransformHierarchy_Update(&serial);
+	TransformHierarchy_UpdateParallel(&parallel, 4);
+	Test_Check(MemCmp(serial.worlds, parallel.worlds, count*sizeof(Transformer)) == 0);
+	Test_Check(MemCmp(serial.worldMatrices, parallel.worldMatrices, count*sizeof(Matrix4)) == 0);
+	Test_Check(serial.updatedRangeCount == parallel.updatedRangeCount);
+
+	MFree(handles);
+	TransformHierarchy_Free(&parallel);
+	TransformHierarchy_Free(&serial);
+}
+
+int main()
+{
+	Test_Init();
+	Test_Run(TestRandomOperations);
+	Test_Run(TestParallelMatchesSerial);
+	return Test_Finish();
+}